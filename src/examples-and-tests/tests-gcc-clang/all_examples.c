@@ -4,9 +4,29 @@
 void dyn_arena_usage();
 void arena_usage();
 void string_usage();
+void string_builder_usage();
+void string_search_usage();
+void string_number_usage();
+void utf8_usage();
+void encoding_usage();
+void file_usage();
 void vector_usage();
+void small_vector_usage();
+void vector_sort_usage();
+void vector_search_usage();
+void soa_vector_usage();
+void vector_scan_usage();
+void deque_usage();
+void heap_usage();
+void bitvec_usage();
+void parallel_usage();
+void queue_usage();
+void thread_pool_usage();
 void dict_usage();
 void dict_custom_hashing();
+void interner_usage();
+void btree_usage();
+void bloom_usage();
 
 #define SNIFEX_API_IMPLEMENTATION
 #include "../../snifex-api.h"
@@ -16,9 +36,29 @@ int main1() {
   dyn_arena_usage();
   arena_usage();
   string_usage();
+  string_builder_usage();
+  string_search_usage();
+  string_number_usage();
+  utf8_usage();
+  encoding_usage();
+  file_usage();
   vector_usage();
+  small_vector_usage();
+  vector_sort_usage();
+  vector_search_usage();
+  soa_vector_usage();
+  vector_scan_usage();
+  deque_usage();
+  heap_usage();
+  bitvec_usage();
+  parallel_usage();
+  queue_usage();
+  thread_pool_usage();
   dict_usage();
   dict_custom_hashing();
+  interner_usage();
+  btree_usage();
+  bloom_usage();
 
   printf("\n\33[4;32mAll Tests passed!\33[0m\n");
   return 0;
@@ -43,5 +83,5 @@ int main() {
   dict_del(&dict, 6);
   printf("Buckets and entries %zu, %zu\n", dict.b_len, dict.entries.len);
   dict_free(&dict);
-  return 0;
+  return main1();
 }
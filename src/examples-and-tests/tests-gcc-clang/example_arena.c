@@ -22,6 +22,8 @@ void dyn_arena_usage() {
 
   size_t my_float_obj = dyn_arena_alloc(&arena1, sizeof(float), sizeof(float));
   *dyn_arena_get(float, arena1, my_float_obj) = 10;
+  // Only the padding needed to align the float is skipped
+  assert(my_float_obj == sizeof(float));
 
   //-
   //- Reserving at least x bytes in capacity
@@ -48,5 +50,15 @@ void arena_usage() {
   void* exceeding_allocation = arena_alloc(&arena, 97, 1);
   assert(exceeding_allocation == NULL);
 
+  //-
+  //- Aligned allocations
+  //-
+  Arena words = arena_create(64);
+  char* byte = (char*)arena_alloc(&words, 1, 1);
+  uint64_t* word = (uint64_t*)arena_alloc(&words, sizeof(uint64_t), 8);
+  assert(byte != NULL && word != NULL);
+  assert((char*)word - byte == 8 && words.top == 16);
+  arena_free(&words);
+
   arena_free(&arena);
 }
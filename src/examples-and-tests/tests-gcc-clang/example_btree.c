@@ -0,0 +1,74 @@
+#include "../../snifex-api.h"
+
+DefineBTree(uint64_t, uint32_t);
+
+typedef const char* cstr;
+#define cstr_less(a, b) (strcmp(a, b) < 0)
+DefineBTreeLess(cstr, int, cstr_less);
+
+void btree_usage() {
+  BTree(uint64_t, uint32_t) tree = btree_create(uint64_t, uint32_t);
+
+  //-
+  //- Put, get and delete, like a dictionary
+  //-
+  for (uint32_t i = 0; i < 1000; i++) {
+    // Out of order timestamps
+    assert(!btree_put(uint64_t, uint32_t, &tree, (i * 7919) % 1000 * 10, i,
+                      NULL));
+  }
+  assert(tree.len == 1000);
+  uint32_t old;
+  assert(btree_put(uint64_t, uint32_t, &tree, 0, 42, &old) && old == 0);
+  assert(*btree_get(uint64_t, uint32_t, &tree, 0) == 42);
+  assert(btree_get(uint64_t, uint32_t, &tree, 5) == NULL);
+  assert(btree_del(uint64_t, uint32_t, &tree, 0, &old) && old == 42);
+  assert(!btree_del(uint64_t, uint32_t, &tree, 0, NULL));
+  assert(tree.len == 999);
+
+  //-
+  //- Range queries: all the keys in [2000, 3000), in order
+  //-
+  uint64_t expected = 2000;
+  for (BTreeIter(uint64_t, uint32_t) it =
+           btree_lower_bound(uint64_t, uint32_t, &tree, 1995);
+       btree_iter_valid(it) && *btree_iter_key(it) < 3000;
+       btree_iter_next(uint64_t, uint32_t, &it)) {
+    assert(*btree_iter_key(it) == expected);
+    expected += 10;
+  }
+  assert(expected == 3000);
+  BTreeIter(uint64_t, uint32_t) end =
+      btree_lower_bound(uint64_t, uint32_t, &tree, 10000);
+  assert(!btree_iter_valid(end));
+
+  //-
+  //- Deleting everything
+  //-
+  size_t count = 0;
+  for (BTreeIter(uint64_t, uint32_t) it =
+           btree_first(uint64_t, uint32_t, &tree);
+       btree_iter_valid(it); btree_iter_next(uint64_t, uint32_t, &it)) {
+    count++;
+  }
+  assert(count == 999);
+  for (uint64_t k = 10; k < 10000; k += 10) {
+    assert(btree_del(uint64_t, uint32_t, &tree, k, NULL));
+  }
+  assert(tree.len == 0);
+  assert(!btree_iter_valid(btree_first(uint64_t, uint32_t, &tree)));
+  btree_free(&tree);
+
+  //-
+  //- Custom orderings
+  //-
+  BTree(cstr, int) words = btree_create(cstr, int);
+  btree_put(cstr, int, &words, "pear", 3, NULL);
+  btree_put(cstr, int, &words, "apple", 1, NULL);
+  btree_put(cstr, int, &words, "fig", 2, NULL);
+  BTreeIter(cstr, int) it = btree_first(cstr, int, &words);
+  assert(strcmp(*btree_iter_key(it), "apple") == 0);
+  btree_iter_next(cstr, int, &it);
+  assert(*btree_iter_val(it) == 2);
+  btree_free(&words);
+}
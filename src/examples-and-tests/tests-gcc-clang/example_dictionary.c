@@ -30,6 +30,23 @@ void dict_usage() {
   dict_put(&dict, ((MyStruct){1, 2.0}), 69.0, &old_value);
   assert(*dict_get(&dict, ((MyStruct){1, 2.0})) == 69.0);
 
+  // Without HASHFUNC, keys go through the default hash, which uses every
+  // byte of them, even of keys shorter than 8 bytes
+  const uint32_t one = 1, two = 2;
+  assert(snifex_api_hash_num_func(&one, sizeof(one)) !=
+         snifex_api_hash_num_func(&two, sizeof(two)));
+  assert(snifex_api_hash_num_func("ab", 2) !=
+         snifex_api_hash_num_func("ba", 2));
+  // All 256 one-byte keys land on different hashes
+  uint64_t byte_hashes[256];
+  for (size_t b = 0; b < 256; b++) {
+    const uint8_t byte = (uint8_t)b;
+    byte_hashes[b] = snifex_api_hash_num_func(&byte, 1);
+    for (size_t prev = 0; prev < b; prev++) {
+      assert(byte_hashes[prev] != byte_hashes[b]);
+    }
+  }
+
   dict_free(&dict);
 }
 
@@ -0,0 +1,61 @@
+#include "../../snifex-api.h"
+
+void count_words(void* ctx, size_t start, size_t end, Arena* scratch) {
+  (void)scratch;
+  SyncStrInterner* interner = ctx;
+  for (size_t i = start; i < end; i++) {
+    // Ten distinct words, interned from many threads at once
+    char word[] = {'w', (char)('0' + i % 10)};
+    sync_str_intern(interner, (string){.ptr = word, .len = sizeof word});
+  }
+}
+
+void interner_usage() {
+  //-
+  //- Interning strings
+  //-
+  StrInterner interner = str_interner_create();
+
+  // The same bytes always get the same ID, wherever they come from
+  char header[] = "Content-Type";
+  uint32_t content_type = str_intern(&interner, strlit("Content-Type"));
+  uint32_t host = str_intern(&interner, strlit("Host"));
+  assert(content_type == 0 && host == 1);
+  assert(str_intern(&interner, strlit(header)) == content_type);
+
+  // The interner owns a copy, so the original can go away
+  header[0] = 'X';
+  assert(str_eq(str_interner_get(&interner, content_type),
+                strlit("Content-Type")));
+
+  // Looking up does not intern
+  uint32_t id;
+  assert(str_interner_find(&interner, strlit("Host"), &id) && id == host);
+  assert(!str_interner_find(&interner, strlit("Accept"), &id));
+  assert(interner.len == 2);
+
+  // IDs are dense, so they can index plain arrays
+  for (int i = 0; i < 10000; i++) {
+    char name[16];
+    int len = snprintf(name, sizeof name, "tag%d", i % 1000);
+    str_intern(&interner, (string){.ptr = name, .len = (size_t)len});
+  }
+  assert(interner.len == 2 + 1000);
+  assert(str_eq(str_interner_get(&interner, 2 + 999), strlit("tag999")));
+
+  str_interner_free(&interner);
+
+  //-
+  //- Sharing an interner between threads
+  //-
+  SyncStrInterner* shared = sync_str_interner_create();
+  ThreadPool* pool = thread_pool_create(4);
+  thread_pool_parallel_for(pool, 10000, 100, count_words, shared);
+  assert(sync_str_interner_len(shared) == 10);
+
+  assert(sync_str_interner_find(shared, strlit("w7"), &id));
+  assert(str_eq(sync_str_interner_get(shared, id), strlit("w7")));
+
+  thread_pool_free(pool);
+  sync_str_interner_free(shared);
+}
@@ -0,0 +1,73 @@
+#include "../../snifex-api.h"
+
+DefineVec(uint32_t);
+DefineVec(uint64_t);
+
+#define u32_less(a, b) ((a) < (b))
+DefineVecSort(uint32_t, u32, u32_less);
+
+static void square_chunk(ParChunk chunk) {
+  uint32_t* nums = chunk.ptr;
+  for (size_t i = 0; i < chunk.len; i++) { nums[i] *= nums[i]; }
+}
+
+static void sum_chunk(ParChunk chunk) {
+  const uint32_t* nums = chunk.ptr;
+  uint64_t* acc = chunk.acc;
+  for (size_t i = 0; i < chunk.len; i++) { *acc += nums[i]; }
+}
+
+static void sum_combine(void* result, const void* partial, void* ctx) {
+  *(uint64_t*)result += *(const uint64_t*)partial;
+}
+
+static void shutdown_task(void* ctx, Arena* scratch) { parallel_shutdown(); }
+
+void parallel_usage() {
+  // By default as many threads as online processors are used
+  parallel_set_thread_count(4);
+  assert(parallel_thread_count() == 4);
+
+  Vec(uint32_t) nums = vec_create(uint32_t, 1);
+  for (uint32_t i = 0; i < 100000; i++) { vec_push(&nums, i % 1000); }
+
+  //-
+  //- Parallel for: the function gets called on whole chunks of the vector
+  //-
+  vec_parallel_for(&nums, square_chunk, NULL);
+  assert(*vec_idx(nums, 999) == 999 * 999);
+
+  //-
+  //- Parallel reduce: the result must hold the identity of the reduction
+  //-
+  uint64_t sum = 0;
+  vec_parallel_reduce(&nums, &sum, sum_chunk, sum_combine, NULL);
+  uint64_t expected_sum = 0;
+  for (size_t i = 0; i < nums.len; i++) { expected_sum += *vec_idx(nums, i); }
+  assert(sum == expected_sum);
+
+  //-
+  //- Parallel sorting
+  //-
+  Vec(uint32_t) nums_copy = vec_create(uint32_t, 1);
+  vec_append(&nums_copy, nums);
+
+  vec_parallel_sort(u32, &nums);
+  vec_parallel_radix_sort(&nums_copy);
+  for (size_t i = 1; i < nums.len; i++) {
+    assert(*vec_idx(nums, i - 1) <= *vec_idx(nums, i));
+    assert(*vec_idx(nums, i) == *vec_idx(nums_copy, i));
+  }
+
+  // The workers are kept between calls, and stopped only on request. Racing
+  // shutdowns stop them once
+  ThreadPool* stoppers = thread_pool_create(2);
+  WaitGroup wg = wait_group_create();
+  thread_pool_submit(stoppers, &wg, shutdown_task, NULL);
+  thread_pool_submit(stoppers, &wg, shutdown_task, NULL);
+  thread_pool_wait(stoppers, &wg);
+  thread_pool_free(stoppers);
+  parallel_set_thread_count(0);
+  vec_free(&nums);
+  vec_free(&nums_copy);
+}
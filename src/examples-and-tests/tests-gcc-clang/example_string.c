@@ -50,6 +50,18 @@ void string_usage() {
       strlit("This is a string 'Normal C string literal' and its size 23"),
       fmt_str));
 
+  // `str_fmt` formats straight into the arena. When the result does not fit,
+  // nothing is allocated and `len` tells how much room would have been needed
+  Arena tiny = arena_create(8);
+  string fits = str_fmt(&tiny, "%d-%d", 12, 34);
+  assert(str_eq(fits, strlit("12-34")) && tiny.top == fits.len);
+  string too_long = str_fmt(&tiny, "%s", "does not fit");
+  assert(too_long.ptr == NULL && too_long.len == 12 && tiny.top == fits.len);
+  // So do copies, instead of writing through a `NULL` allocation
+  string no_copy = str_copy(&tiny, strlit("does not fit"));
+  assert(no_copy.ptr == NULL && no_copy.len == 12 && tiny.top == fits.len);
+  arena_free(&tiny);
+
   // If you want to print/format a string longer than INT_MAX, you have to use
   // `str_join`:
   Vec(string) to_join =
@@ -64,3 +76,187 @@ void string_usage() {
   vec_free(&to_join);
   arena_free(&scratch);
 }
+
+void string_builder_usage() {
+  //-
+  //- Building a string on the heap
+  //-
+  StrBuilder sb = str_builder_create(0);
+  str_builder_append(&sb, strlit("{\"id\":"));
+  str_builder_append_i64(&sb, -42);
+  str_builder_append(&sb, strlit(",\"max\":"));
+  str_builder_append_u64(&sb, UINT64_MAX);
+  str_builder_append(&sb, strlit(",\"ratio\":"));
+  str_builder_append_f64(&sb, 0.1);
+  str_builder_append_char(&sb, ',');
+  str_builder_append_fmt(&sb, "\"name\":\"%s\"", "snifex");
+  str_builder_append_char(&sb, '}');
+
+  // The view points straight into the builder's buffer
+  assert(str_eq(str_builder_view(&sb),
+                strlit("{\"id\":-42,\"max\":18446744073709551615,"
+                       "\"ratio\":0.1,\"name\":\"snifex\"}")));
+
+  // Doubles are printed with the fewest digits that read back the same
+  str_builder_clear(&sb);
+  str_builder_append_f64(&sb, 1.0 / 3.0);
+  assert(str_eq(str_builder_view(&sb), strlit("0.3333333333333333")));
+
+  // Formatted output longer than the spare capacity grows the buffer
+  str_builder_clear(&sb);
+  for (int i = 0; i < 100; i++) { str_builder_append_fmt(&sb, "%03d,", i); }
+  assert(sb.len == 400 && memcmp(sb.buf + 396, "099,", 4) == 0);
+  str_builder_free(&sb);
+
+  //-
+  //- Building a string in an arena
+  //-
+  Arena arena = arena_create(4096);
+  StrBuilder asb = str_builder_create_in(&arena, 4);
+  for (int i = 0; i < 10; i++) {
+    str_builder_append_i64(&asb, i);
+    str_builder_append_char(&asb, ' ');
+  }
+  // Since it was the last allocation, the buffer grew in place, and freeing
+  // gives the unused capacity back to the arena. The string stays valid
+  str_builder_free(&asb);
+  string built = str_builder_view(&asb);
+  assert(str_eq(built, strlit("0 1 2 3 4 5 6 7 8 9 ")));
+  assert(arena.top == built.len);
+  arena_free(&arena);
+
+  // Growth stops at the end of the arena: only what is asked for has to fit
+  Arena small = arena_create(40);
+  StrBuilder full = str_builder_create_in(&small, 16);
+  string filler = strlit("0123456789abcdefghij");
+  assert(str_builder_append(&full, str_slice(filler, 0, 17)));
+  assert(str_builder_append(&full, str_slice(filler, 0, 10)));
+  assert(str_builder_append(&full, str_slice(filler, 0, 10)));
+  assert(full.len == 37 && full.cap == 40 && small.top == 40);
+  // What doesn't fit is refused, and the builder stays as it was
+  assert(!str_builder_append(&full, strlit("four")));
+  assert(!str_builder_append_i64(&full, -100));
+  assert(full.len == 37);
+  // Formatting takes no extra byte for the terminator, even on the last bytes
+  assert(str_builder_append_fmt(&full, "%s", "xyz"));
+  assert(full.len == 40 && memcmp(full.buf + 37, "xyz", 3) == 0);
+  assert(!str_builder_append_char(&full, '!'));
+  arena_free(&small);
+}
+
+void string_search_usage() {
+  string body = strlit("GET /index.html HTTP/1.1\r\nHost: example.com\r\n"
+                       "Accept: */*\r\n\r\n");
+
+  //-
+  //- Searching
+  //-
+  // Every search returns `str.len` when there is no match
+  assert(str_find_char(body, ' ') == 3);
+  assert(str_rfind_char(body, ':') == 51);
+  assert(str_find_char(body, '#') == body.len);
+  assert(str_count_char(body, '\n') == 4);
+
+  assert(str_find(body, strlit("Host")) == 26);
+  assert(str_rfind(body, strlit("\r\n")) == body.len - 2);
+  assert(str_find(body, strlit("Cookie")) == body.len);
+  assert(str_count(body, strlit("\r\n")) == 4);
+
+  assert(str_contains(body, strlit("example.com")));
+  assert(str_starts_with(body, strlit("GET ")));
+  assert(str_ends_with(body, strlit("\r\n\r\n")));
+
+  //-
+  //- Splitting
+  //-
+  // The pieces are views into `body`, nothing gets allocated
+  StrSplit lines = str_lines(body);
+  string line;
+  size_t n_lines = 0;
+  while (str_split_next(&lines, &line)) {
+    if (n_lines == 1) { assert(str_eq(line, strlit("Host: example.com"))); }
+    n_lines++;
+  }
+  // The empty line ends the headers
+  assert(n_lines == 4 && line.len == 0);
+
+  StrSplit words = str_split(strlit("a, b,, c"), strlit(", "));
+  string word;
+  string expected[] = {strlit("a"), strlit("b,"), strlit("c")};
+  size_t n_words = 0;
+  while (str_split_next(&words, &word)) {
+    assert(str_eq(word, expected[n_words++]));
+  }
+  assert(n_words == 3);
+}
+
+void string_number_usage() {
+  Arena arena = arena_create(1024);
+
+  //-
+  //- Parsing numbers
+  //-
+  // The whole view must be the number, so fields can be parsed in place
+  string row = strlit("42,-17,3.25e2,18446744073709551616");
+  StrSplit fields = str_split(row, strlit(","));
+  string field;
+
+  uint64_t u;
+  str_split_next(&fields, &field);
+  assert(str_parse_u64(field, &u) && u == 42);
+
+  int64_t i;
+  str_split_next(&fields, &field);
+  assert(str_parse_i64(field, &i) && i == -17);
+  assert(!str_parse_u64(field, &u));
+
+  double d;
+  str_split_next(&fields, &field);
+  assert(str_parse_f64(field, &d) && d == 325.0);
+
+  // Numbers that don't fit are rejected
+  str_split_next(&fields, &field);
+  assert(!str_parse_u64(field, &u));
+
+  assert(str_parse_f64(strlit("-.5"), &d) && d == -0.5);
+  assert(!str_parse_f64(strlit("1e"), &d));
+  assert(!str_parse_f64(strlit(" 1"), &d));
+
+  // Long inputs keep a sticky digit past the cut, so halfway cases still
+  // round the right way
+  char digits[1024];
+  memset(digits, '0', sizeof digits);
+  memcpy(digits, "1.00000000000000011102230246251565404236316680908203125", 55);
+  digits[sizeof digits - 1] = '1';
+  assert(str_parse_f64((string){.ptr = digits, .len = sizeof digits}, &d) &&
+         d == 1.0 + 0x1p-52);
+  assert(!str_parse_i64(strlit(""), &i));
+
+  //-
+  //- Formatting numbers
+  //-
+  assert(str_eq(str_from_u64(&arena, UINT64_MAX),
+                strlit("18446744073709551615")));
+  assert(str_eq(str_from_i64(&arena, INT64_MIN),
+                strlit("-9223372036854775808")));
+
+  // Doubles get the shortest representation that reads back the same
+  assert(str_eq(str_from_f64(&arena, 0.1), strlit("0.1")));
+  assert(str_eq(str_from_f64(&arena, 0.1 + 0.2),
+                strlit("0.30000000000000004")));
+  assert(str_eq(str_from_f64(&arena, 1500.0), strlit("1500")));
+  assert(str_eq(str_from_f64(&arena, 1e300), strlit("1e+300")));
+  // Subnormals have fewer digits to spare
+  assert(str_eq(str_from_f64(&arena, 5e-324), strlit("5e-324")));
+
+  // The special values read back too
+  assert(str_eq(str_from_f64(&arena, -INFINITY), strlit("-inf")));
+  assert(str_parse_f64(str_from_f64(&arena, INFINITY), &d) && d == INFINITY);
+  assert(str_parse_f64(str_from_f64(&arena, NAN), &d) && d != d);
+  assert(!str_parse_f64(strlit("infinity"), &d));
+
+  string formatted = str_from_f64(&arena, 2.0 / 3.0);
+  assert(str_parse_f64(formatted, &d) && d == 2.0 / 3.0);
+
+  arena_free(&arena);
+}
@@ -0,0 +1,86 @@
+#include "../../snifex-api.h"
+
+#define POOL_TASKS 64
+
+typedef struct {
+  size_t index;
+  size_t len;
+} PoolItem;
+
+void label_task(void* ctx, Arena* scratch) {
+  PoolItem* item = ctx;
+  // The scratch arena is reset between tasks, no need to free
+  string label = str_fmt(scratch, "item #%zu", item->index);
+  item->len = label.len;
+}
+
+typedef struct {
+  ThreadPool* pool;
+  uint32_t n;
+  uint64_t result;
+} FibTask;
+
+void fib_task(void* ctx, Arena* scratch) {
+  FibTask* task = ctx;
+  if (task->n < 2) {
+    task->result = task->n;
+    return;
+  }
+  FibTask a = {.pool = task->pool, .n = task->n - 1};
+  FibTask b = {.pool = task->pool, .n = task->n - 2};
+  // Waiting inside a task runs other tasks instead of blocking the worker
+  WaitGroup wg = wait_group_create();
+  thread_pool_submit(task->pool, &wg, fib_task, &a);
+  fib_task(&b, scratch);
+  thread_pool_wait(task->pool, &wg);
+  task->result = a.result + b.result;
+}
+
+void square_range(void* ctx, size_t start, size_t end, Arena* scratch) {
+  uint64_t* squares = ctx;
+  for (size_t i = start; i < end; i++) { squares[i] = (uint64_t)i * i; }
+}
+
+void thread_pool_usage() {
+  ThreadPool* pool = thread_pool_create(4);
+#if defined(SNIFEX_API_PTHREADS) || defined(SNIFEX_API_WIN_THREADS)
+  assert(thread_pool_thread_count(pool) == 4);
+#endif
+
+  //-
+  //- Submit a batch of tasks and wait for all of them
+  //-
+  PoolItem items[POOL_TASKS];
+  WaitGroup wg = wait_group_create();
+  for (size_t i = 0; i < POOL_TASKS; i++) {
+    items[i] = (PoolItem){.index = i};
+    thread_pool_submit(pool, &wg, label_task, &items[i]);
+  }
+  thread_pool_wait(pool, &wg);
+  for (size_t i = 0; i < POOL_TASKS; i++) {
+    assert(items[i].len == (i < 10 ? 7 : 8));
+  }
+
+  //-
+  //- Tasks can spawn and wait for subtasks
+  //-
+  FibTask fib = {.pool = pool, .n = 18};
+  wg = wait_group_create();
+  thread_pool_submit(pool, &wg, fib_task, &fib);
+  thread_pool_wait(pool, &wg);
+  assert(fib.result == 2584);
+
+  //-
+  //- Parallel for over an index range
+  //-
+  const size_t len = 100003;
+  uint64_t* squares = malloc(len * sizeof(uint64_t));
+  thread_pool_parallel_for(pool, len, 0, square_range, squares);
+  for (size_t i = 0; i < len; i++) { assert(squares[i] == (uint64_t)i * i); }
+  memset(squares, 0, len * sizeof(uint64_t));
+  thread_pool_parallel_for(pool, len, 1000, square_range, squares);
+  assert(squares[len - 1] == (uint64_t)(len - 1) * (len - 1));
+  free(squares);
+
+  thread_pool_free(pool);
+}
@@ -37,6 +37,41 @@ void vector_usage() {
   assert(*vec_idx(int_vec_front, 4) == 5);
   assert(*vec_idx(int_vec_front, 5) == 6);
 
+  //-
+  //- Order-preserving insertion and removal
+  //-
+  uint16_t to_insert[] = {10, 11, 12};
+  vec_insert_range(&int_vec_front, 1, to_insert, 3);  // 1 10 11 12 2 3 4 5 6
+  vec_remove_range(&int_vec_front, 4, 6);             // 1 10 11 12 4 5 6
+  vec_insert(&int_vec_front, 0, 0);                   // 0 1 10 11 12 4 5 6
+  vec_remove(&int_vec_front, 1);                      // 0 10 11 12 4 5 6
+  uint16_t to_splice[] = {7, 8};
+  vec_splice(&int_vec_front, 1, 3, to_splice, 2);     // 0 7 8 4 5 6
+  vec_extend_from_array(&int_vec_front, to_insert, 3);
+
+  uint16_t expected[] = {0, 7, 8, 4, 5, 6, 10, 11, 12};
+  assert(int_vec_front.len == 9);
+  for (size_t i = 0; i < int_vec_front.len; i++) {
+    assert(*vec_idx(int_vec_front, i) == expected[i]);
+  }
+
+  //-
+  //- Reserving, resizing, clearing and shrinking
+  //-
+  vec_reserve(&int_vec, 100);
+  assert(int_vec.cap >= 100 && int_vec.len == 0);
+
+  vec_resize(&int_vec, 10);  // New elements are zeroed
+  assert(int_vec.len == 10 && *vec_idx(int_vec, 9) == 0);
+
+  vec_resize(&int_vec, 2);
+  vec_shrink_to_fit(&int_vec);
+  assert(int_vec.len == 2 && int_vec.cap == 2);
+
+  vec_clear(&int_vec);
+  vec_shrink_to_fit(&int_vec);
+  assert(int_vec.len == 0 && int_vec.cap == 1);
+
   //-
   //- Freeing the vector
   //-
@@ -44,3 +79,357 @@ void vector_usage() {
   vec_free(&int_vec_back);
   vec_free(&int_vec);
 }
+
+DefineSmallVec(uint16_t, 4);
+
+void small_vector_usage() {
+  //-
+  //- Create Small Vector. Up to 4 elements are stored inline, no allocation
+  //-
+  SmallVec(uint16_t, 4) small_vec = smallvec_create(uint16_t, 4);
+
+  smallvec_push(&small_vec, 1);
+  smallvec_push(&small_vec, 2);
+  smallvec_push(&small_vec, 3);
+  assert(small_vec.heap == NULL && small_vec.cap == 4);
+
+  //-
+  //- Appending past the inline capacity spills to the heap
+  //-
+  SmallVec(uint16_t, 4) small_vec_back = smallvec_create(uint16_t, 4);
+  smallvec_push(&small_vec_back, 4);
+  smallvec_push(&small_vec_back, 5);
+
+  smallvec_append(&small_vec, &small_vec_back);
+  assert(small_vec.heap != NULL && small_vec.len == 5);
+  for (size_t i = 0; i < small_vec.len; i++) {
+    assert(*smallvec_idx(&small_vec, i) == i + 1);
+  }
+
+  smallvec_pop(&small_vec);
+  assert(*smallvec_last(&small_vec) == 4);
+
+  //-
+  //- Viewing it as a normal vector, E.G. for `str_join`
+  //-
+  Vec(uint16_t) view = smallvec_as_vec(uint16_t, &small_vec);
+  assert(view.len == 4 && *vec_idx(view, 3) == 4);
+
+  smallvec_free(&small_vec);
+  smallvec_free(&small_vec_back);
+}
+
+typedef struct {
+  uint32_t id;
+  float score;
+} Record;
+
+DefineVec(Record);
+DefineVec(int32_t);
+DefineVec(float);
+
+#define u16_less(a, b) ((a) < (b))
+#define record_id_less(a, b) ((a).id < (b).id)
+
+DefineVecSort(uint16_t, u16, u16_less);
+DefineVecSort(Record, by_id, record_id_less);
+
+void vector_sort_usage() {
+  //-
+  //- Sorting with an inlined comparison
+  //-
+  Vec(uint16_t) nums = vec_create(uint16_t, 1);
+  for (uint16_t i = 0; i < 1000; i++) { vec_push(&nums, (i * 7919) % 1000); }
+  vec_sort(u16, &nums);
+  for (size_t i = 0; i < nums.len; i++) { assert(*vec_idx(nums, i) == i); }
+
+  //-
+  //- Stable sorting keeps the order of equal elements
+  //-
+  Vec(Record) records = vec_create(Record, 1);
+  for (uint32_t i = 0; i < 100; i++) {
+    vec_push(&records, ((Record){.id = i % 3, .score = (float)i}));
+  }
+  Vec(Record) records_copy = vec_create(Record, 1);
+  vec_append(&records_copy, records);
+
+  vec_stable_sort(by_id, &records);
+  for (size_t i = 1; i < records.len; i++) {
+    Record prev = *vec_idx(records, i - 1);
+    Record curr = *vec_idx(records, i);
+    assert(prev.id < curr.id ||
+           (prev.id == curr.id && prev.score < curr.score));
+  }
+
+  //-
+  //- Radix sorting numbers, or structs by a numerical field
+  //-
+  Vec(int32_t) ints = vec_from(int32_t, 5, -3, 100000, -100000, 0, 7);
+  vec_radix_sort(&ints);
+  int32_t expected_ints[] = {-100000, -3, 0, 5, 7, 100000};
+  for (size_t i = 0; i < ints.len; i++) {
+    assert(*vec_idx(ints, i) == expected_ints[i]);
+  }
+
+  Vec(float) floats = vec_from(float, 1.5f, -2.25f, 0.0f, -0.5f, 1e30f, -1e30f);
+  vec_radix_sort(&floats);
+  float expected_floats[] = {-1e30f, -2.25f, -0.5f, 0.0f, 1.5f, 1e30f};
+  for (size_t i = 0; i < floats.len; i++) {
+    assert(*vec_idx(floats, i) == expected_floats[i]);
+  }
+
+  vec_radix_sort_by(&records_copy, id);  // Radix sort is stable too
+  for (size_t i = 0; i < records.len; i++) {
+    assert(vec_idx(records, i)->score == vec_idx(records_copy, i)->score);
+  }
+
+  vec_free(&nums);
+  vec_free(&records);
+  vec_free(&records_copy);
+  vec_free(&ints);
+  vec_free(&floats);
+}
+
+DefineVecSearch(uint16_t, u16, u16_less);
+
+void vector_search_usage() {
+  //-
+  //- Branchless binary search on a sorted vector
+  //-
+  Vec(uint16_t) nums = vec_create(uint16_t, 1);
+  for (uint16_t i = 0; i < 500; i++) { vec_push(&nums, (uint16_t)(i * 2)); }
+  assert(vec_lower_bound(u16, nums, 0) == 0);
+  assert(vec_lower_bound(u16, nums, 10) == 5);
+  assert(vec_lower_bound(u16, nums, 11) == 6);
+  assert(vec_upper_bound(u16, nums, 10) == 6);
+  assert(vec_lower_bound(u16, nums, 5000) == nums.len);
+  assert(*vec_bsearch(u16, nums, 998) == 998);
+  assert(vec_bsearch(u16, nums, 999) == NULL);
+
+  //-
+  //- Eytzinger layout, faster than binary search for big vectors
+  //-
+  Vec(uint16_t) eytzinger = vec_eytzinger(u16, nums);
+  for (uint16_t key = 0; key < 1001; key++) {
+    size_t i = vec_eytzinger_search(u16, eytzinger, key);
+    size_t j = vec_lower_bound(u16, nums, key);
+    assert(i == eytzinger.len ? j == nums.len
+                              : eytzinger.ptr[i] == nums.ptr[j]);
+  }
+
+  //-
+  //- Set operations between sorted vectors
+  //-
+  Vec(uint16_t) odds = vec_from(uint16_t, 1, 3, 5, 7);
+  Vec(uint16_t) some = vec_from(uint16_t, 2, 3, 4, 4, 9);
+  Vec(uint16_t) uni = vec_union(u16, odds, some);
+  Vec(uint16_t) inter = vec_intersection(u16, odds, some);
+  Vec(uint16_t) diff = vec_difference(u16, some, odds);
+  uint16_t expected_uni[] = {1, 2, 3, 4, 4, 5, 7, 9};
+  uint16_t expected_inter[] = {3};
+  uint16_t expected_diff[] = {2, 4, 4, 9};
+  assert(uni.len == 8 && inter.len == 1 && diff.len == 4);
+  for (size_t i = 0; i < uni.len; i++) {
+    assert(uni.ptr[i] == expected_uni[i]);
+  }
+  assert(inter.ptr[0] == expected_inter[0]);
+  for (size_t i = 0; i < diff.len; i++) {
+    assert(diff.ptr[i] == expected_diff[i]);
+  }
+
+  vec_free(&nums);
+  vec_free(&eytzinger);
+  vec_free(&odds);
+  vec_free(&some);
+  vec_free(&uni);
+  vec_free(&inter);
+  vec_free(&diff);
+}
+
+typedef struct {
+  uint32_t id;
+  float score;
+  uint64_t flags;
+} Entry;
+
+#define ENTRY_FIELDS(X) X(uint32_t, id) X(float, score) X(uint64_t, flags)
+DefineSoAVec(Entry, ENTRY_FIELDS);
+
+void soa_vector_usage() {
+  //-
+  //- Pushing whole elements, storing one column per field
+  //-
+  SoAVec(Entry) entries = soavec_create(Entry, 1);
+  for (uint32_t i = 0; i < 100; i++) {
+    Entry entry = {.id = i, .score = (float)i / 2, .flags = (uint64_t)i << 32};
+    soavec_push(Entry, &entries, entry);
+  }
+  assert(entries.len == 100 && entries.cap >= 100);
+  assert((uintptr_t)entries.score % 64 == 0);
+  assert((uintptr_t)entries.flags % 64 == 0);
+
+  //-
+  //- Scanning a single column
+  //-
+  float total = 0;
+  for (size_t i = 0; i < entries.len; i++) { total += entries.score[i]; }
+  assert(total == 2475.0f);
+  *soavec_idx(entries, score, 3) = 10.0f;
+  assert(entries.score[3] == 10.0f);
+
+  //-
+  //- Reading and writing whole elements
+  //-
+  Entry third = soavec_get(Entry, entries, 3);
+  assert(third.id == 3 && third.score == 10.0f && third.flags == 3ull << 32);
+  third.id = 1000;
+  soavec_set(Entry, &entries, 3, third);
+  assert(entries.id[3] == 1000);
+
+  //-
+  //- Removing elements keeps the columns in sync
+  //-
+  Entry removed = soavec_swap_remove(Entry, &entries, 0);
+  assert(removed.id == 0 && entries.len == 99);
+  assert(entries.id[0] == 99 && entries.score[0] == 49.5f);
+  assert(entries.flags[0] == 99ull << 32);
+  Entry last = soavec_pop(Entry, &entries);
+  assert(last.id == 98 && entries.len == 98);
+
+  soavec_clear(&entries);
+  assert(entries.len == 0);
+  soavec_free(&entries);
+}
+
+DefineVec(uint32_t);
+DefineVec(uint64_t);
+
+void vector_scan_usage() {
+  //-
+  //- Vectorized find and count
+  //-
+  Vec(uint32_t) ids = vec_create(uint32_t, 1);
+  for (uint32_t i = 0; i < 1000; i++) { vec_push(&ids, i % 100); }
+  assert(vec_find(ids, 42) == 42);
+  assert(vec_find(ids, 100) == ids.len);
+  assert(vec_count(ids, 42) == 10);
+
+  Vec(uint64_t) big = vec_from(uint64_t, 1, UINT64_MAX, 1ull << 63, 7, 7);
+  assert(vec_find(big, 7) == 3 && vec_count(big, 7) == 2);
+
+  //-
+  //- Vectorized min and max
+  //-
+  assert(vec_min(ids) == 0 && vec_max(ids) == 99);
+  assert(vec_min(big) == 1 && vec_max(big) == UINT64_MAX);
+
+  Vec(float) temps = vec_from(float, 3.5f, -1.0f, 20.25f, 0.0f, -7.5f);
+  assert(vec_find(temps, 0.0f) == 3);
+  assert(vec_min(temps) == -7.5f && vec_max(temps) == 20.25f);
+
+  //-
+  //- Other types use a scalar loop
+  //-
+  Vec(uint16_t) small = vec_from(uint16_t, 5, 3, 9, 3);
+  assert(vec_find(small, 3) == 1 && vec_count(small, 3) == 2);
+  assert(vec_min(small) == 3 && vec_max(small) == 9);
+
+  vec_free(&ids);
+  vec_free(&big);
+  vec_free(&temps);
+  vec_free(&small);
+}
+
+DefineDeque(uint32_t);
+
+void deque_usage() {
+  //-
+  //- Pushing and popping at both ends
+  //-
+  Deque(uint32_t) queue = deque_create(uint32_t, 3);
+  assert(queue.cap == 4);
+  deque_push_back(&queue, 1);
+  deque_push_back(&queue, 2);
+  deque_push_back(&queue, 3);
+  assert(deque_pop_front(&queue) == 1);
+  assert(deque_pop_front(&queue) == 2);
+  deque_push_back(&queue, 4);
+  deque_push_back(&queue, 5);  // Wraps around the end of the buffer
+  deque_push_front(&queue, 0);
+  assert(queue.len == 4 && *deque_idx(queue, 0) == 0);
+  assert(deque_pop_back(&queue) == 5);
+  deque_push_back(&queue, 5);
+
+  //-
+  //- Growing keeps the order even when wrapped around
+  //-
+  for (uint32_t i = 6; i < 20; i++) { deque_push_back(&queue, i); }
+  uint32_t expected = 0;
+  for (size_t i = 0; i < queue.len; i++) {
+    if (expected == 1) { expected = 3; }
+    assert(*deque_idx(queue, i) == expected++);
+  }
+
+  //-
+  //- Zero-copy draining through the contiguous spans
+  //-
+  deque_drop_front(&queue, 10);
+  for (uint32_t i = 20; i < 34; i++) { deque_push_back(&queue, i); }
+  const uint32_t* first = deque_first_span(queue);
+  const uint32_t* second = deque_second_span(queue);
+  size_t first_len = deque_first_span_len(queue);
+  size_t second_len = deque_second_span_len(queue);
+  assert(first_len + second_len == queue.len && second_len > 0);
+  for (size_t i = 0; i < first_len; i++) { assert(first[i] == 12 + i); }
+  for (size_t i = 0; i < second_len; i++) {
+    assert(second[i] == 12 + first_len + i);
+  }
+  deque_drop_front(&queue, first_len + second_len);
+  assert(queue.len == 0);
+
+  deque_clear(&queue);
+  deque_free(&queue);
+}
+
+#define u32_less(a, b) ((a) < (b))
+#define score_greater(a, b) ((a).score > (b).score)
+DefineHeap(uint32_t, u32_min, u32_less);
+DefineDaryHeap(Record, best_score, score_greater, 4);
+
+void heap_usage() {
+  //-
+  //- Priority queue: the smallest element is always on top
+  //-
+  Vec(uint32_t) queue = vec_create(uint32_t, 1);
+  for (uint32_t i = 0; i < 100; i++) {
+    heap_push(u32_min, &queue, (i * 37) % 100);
+  }
+  assert(*heap_peek(u32_min, queue) == 0);
+  for (uint32_t i = 0; i < 100; i++) { assert(heap_pop(u32_min, &queue) == i); }
+  assert(queue.len == 0);
+
+  //-
+  //- Heapifying a whole vector at once, with 4 children per node
+  //-
+  Vec(Record) records = vec_create(Record, 1);
+  for (uint32_t i = 0; i < 50; i++) {
+    Record r = {.id = i, .score = (float)((i * 13) % 50)};
+    vec_push(&records, r);
+  }
+  heapify(best_score, &records);
+  assert(heap_peek(best_score, records)->score == 49.0f);
+  Record best = heap_pop(best_score, &records);
+  assert(best.score == 49.0f && heap_peek(best_score, records)->score == 48.0f);
+
+  //-
+  //- Selecting the best k elements without sorting everything
+  //-
+  Vec(Record) top = heap_top_k(best_score, records, 3);
+  assert(top.len == 3);
+  assert(top.ptr[0].score == 48.0f && top.ptr[1].score == 47.0f);
+  assert(top.ptr[2].score == 46.0f);
+
+  vec_free(&queue);
+  vec_free(&records);
+  vec_free(&top);
+}
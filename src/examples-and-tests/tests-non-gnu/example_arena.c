@@ -25,6 +25,8 @@ void dyn_arena_usage() {
   float* float_obj;
   dyn_arena_get(float_obj, float, arena1, float_idx);
   *float_obj = 10;
+  // Only the padding needed to align the float is skipped
+  assert(float_idx == sizeof(float));
 
   //-
   //- Reserving at least x bytes in capacity
@@ -51,5 +53,15 @@ void arena_usage() {
   void* exceeding_allocation = arena_alloc(&arena, 97, 1);
   assert(exceeding_allocation == NULL);
 
+  //-
+  //- Aligned allocations
+  //-
+  Arena words = arena_create(64);
+  char* byte = (char*)arena_alloc(&words, 1, 1);
+  uint64_t* word = (uint64_t*)arena_alloc(&words, sizeof(uint64_t), 8);
+  assert(byte != NULL && word != NULL);
+  assert((char*)word - byte == 8 && words.top == 16);
+  arena_free(&words);
+
   arena_free(&arena);
 }
@@ -0,0 +1,90 @@
+#include "../../snifex-api.h"
+
+void bitvec_usage() {
+  BitVec bv = bitvec_create(200);
+  assert(bv.len == 200 && bitvec_popcount(&bv) == 0);
+
+  //-
+  //- Single bits
+  //-
+  bitvec_set(&bv, 3);
+  bitvec_set(&bv, 64);
+  bitvec_set(&bv, 199);
+  bitvec_flip(&bv, 10);
+  bitvec_assign(&bv, 11, true);
+  bitvec_reset(&bv, 3);
+  assert(!bitvec_test(&bv, 3) && bitvec_test(&bv, 10) && bitvec_test(&bv, 64));
+  assert(bitvec_popcount(&bv) == 4);
+
+  //-
+  //- Iterating the set bits
+  //-
+  size_t expected[] = {10, 11, 64, 199};
+  size_t n = 0;
+  for (size_t i = bitvec_next_set(&bv, 0); i < bv.len;
+       i = bitvec_next_set(&bv, i + 1)) {
+    assert(i == expected[n++]);
+  }
+  assert(n == 4);
+  assert(bitvec_next_clear(&bv, 10) == 12);
+
+  //-
+  //- Whole-vector operations
+  //-
+  BitVec other = bitvec_create(200);
+  bitvec_fill(&other, true);
+  assert(bitvec_popcount(&other) == 200);  // The tail of the last word is clear
+  bitvec_reset(&other, 64);
+  bitvec_and(&other, &bv);
+  assert(bitvec_popcount(&other) == 3 && !bitvec_test(&other, 64));
+  bitvec_xor(&other, &bv);
+  assert(bitvec_popcount(&other) == 1 && bitvec_test(&other, 64));
+  bitvec_or(&other, &bv);
+  bitvec_andnot(&other, &bv);
+  assert(bitvec_popcount(&other) == 0);
+  bitvec_not(&other);
+  assert(bitvec_popcount(&other) == 200);
+  assert(bitvec_next_clear(&other, 0) == other.len);
+  bitvec_free(&other);
+
+  //-
+  //- Growing
+  //-
+  bitvec_resize(&bv, 100);
+  assert(bitvec_popcount(&bv) == 3);
+  bitvec_resize(&bv, 300);
+  assert(!bitvec_test(&bv, 199));  // Bits cut off don't come back
+  bitvec_push(&bv, true);
+  assert(bv.len == 301 && bitvec_test(&bv, 300));
+  bitvec_free(&bv);
+
+  //-
+  //- In an arena
+  //-
+  Arena arena = arena_create(1024);
+  BitVec in_arena = bitvec_create_in(&arena, 1000);
+  bitvec_set(&in_arena, 999);
+  assert(bitvec_next_set(&in_arena, 0) == 999);
+  bitvec_free(&in_arena);  // Does nothing
+  arena_free(&arena);
+
+  //-
+  //- Rank and select
+  //-
+  BitVec sparse = bitvec_create(5000);
+  for (size_t i = 0; i < sparse.len; i += 3) { bitvec_set(&sparse, i); }
+  BitRank rank = bitrank_create(&sparse);
+  assert(rank.ones == 1667);
+  for (size_t i = 0; i <= sparse.len; i += 7) {
+    assert(bitrank_rank1(&rank, i) == (i + 2) / 3);
+    assert(bitrank_rank0(&rank, i) == i - (i + 2) / 3);
+  }
+  for (size_t k = 0; k < rank.ones; k++) {
+    assert(bitrank_select1(&rank, k) == k * 3);
+  }
+  assert(bitrank_select1(&rank, rank.ones) == sparse.len);
+  assert(bitrank_select0(&rank, 0) == 1 && bitrank_select0(&rank, 1) == 2);
+  assert(bitrank_select0(&rank, 2) == 4);
+  bitrank_free(&rank);
+  bitvec_free(&sparse);
+}
@@ -0,0 +1,58 @@
+#include "../../snifex-api.h"
+
+#define BLOOM_KEYS 10000
+
+void bloom_usage() {
+  //-
+  //- Sizing from the expected number of keys and false positive rate
+  //-
+  assert(bloom_bits_for(1000, 0.01) == 9586);  // ~9.6 bits per key
+  assert(bloom_hashes_for(1000, 9586) == 7);
+
+  BloomFilter bf = bloom_create_for(BLOOM_KEYS, 0.01);
+  assert(bf.n_hashes == 7 && bf.n_blocks * 512 >= 95851);
+  assert((uintptr_t)bf.words % 64 == 0);  // Blocks are cache lines
+
+  //-
+  //- No false negatives, few false positives
+  //-
+  bool found;
+  for (uint64_t i = 0; i < BLOOM_KEYS; i++) {
+    bloom_add(uint64_t, &bf, i * 2);
+  }
+  for (uint64_t i = 0; i < BLOOM_KEYS; i++) {
+    bloom_contains(found, uint64_t, &bf, i * 2);
+    assert(found);
+  }
+  size_t false_positives = 0;
+  for (uint64_t i = 0; i < BLOOM_KEYS; i++) {
+    bloom_contains(found, uint64_t, &bf, i * 2 + 1);
+    false_positives += found;
+  }
+  assert(false_positives < BLOOM_KEYS * 3 / 100);
+
+  bloom_clear(&bf);
+  bloom_contains(found, uint64_t, &bf, 0);
+  assert(!found);
+  bloom_free(&bf);
+
+  //-
+  //- Counting filters can remove keys
+  //-
+  CountingBloomFilter cbf = cbloom_create_for(BLOOM_KEYS, 0.01);
+  for (uint32_t i = 0; i < BLOOM_KEYS; i++) { cbloom_add(uint32_t, &cbf, i); }
+  for (uint32_t i = 0; i < BLOOM_KEYS; i += 2) {
+    cbloom_remove(uint32_t, &cbf, i);
+  }
+  size_t removed_found = 0;
+  for (uint32_t i = 0; i < BLOOM_KEYS; i++) {
+    cbloom_contains(found, uint32_t, &cbf, i);
+    if (i % 2 == 1) {
+      assert(found);
+    } else {
+      removed_found += found;
+    }
+  }
+  assert(removed_found < BLOOM_KEYS / 2 * 3 / 100);
+  cbloom_free(&cbf);
+}
@@ -0,0 +1,74 @@
+#include "../../snifex-api.h"
+
+void encoding_usage() {
+  Arena arena = arena_create(1024);
+
+  //-
+  //- JSON strings
+  //-
+  // Nothing to escape: the input comes back as is, without allocating
+  string plain = strlit("hello, world");
+  assert(str_json_escape(&arena, plain).ptr == plain.ptr);
+
+  string quoted = str_json_escape(&arena, strlit("say \"hi\"\n\t\x01"));
+  assert(str_eq(quoted, strlit("say \\\"hi\\\"\\n\\t\\u0001")));
+
+  string text;
+  assert(str_json_unescape(&arena, quoted, &text));
+  assert(str_eq(text, strlit("say \"hi\"\n\t\x01")));
+  // Surrogate pairs become a single 4-byte UTF-8 sequence
+  assert(str_json_unescape(&arena, strlit("\\u00e9\\ud83d\\udc4b"), &text));
+  assert(str_eq(text, strlit("\xC3\xA9\xF0\x9F\x91\x8B")));
+  assert(!str_json_unescape(&arena, strlit("\\udc4b"), &text));
+  assert(!str_json_unescape(&arena, strlit("trailing \\"), &text));
+
+  //-
+  //- Percent-encoding
+  //-
+  assert(str_url_encode(&arena, strlit("a-b_c.d~e")).ptr != NULL);
+  string url = str_url_encode(&arena, strlit("a b&c=d/é"));
+  assert(str_eq(url, strlit("a%20b%26c%3Dd%2F%C3%A9")));
+  assert(str_url_decode(&arena, url, &text));
+  assert(str_eq(text, strlit("a b&c=d/é")));
+  assert(!str_url_decode(&arena, strlit("100%"), &text));
+  assert(!str_url_decode(&arena, strlit("%zz"), &text));
+
+  //-
+  //- Hex and base64
+  //-
+  // `strlit` stops at the first NUL, so binary data needs an explicit length
+  char raw[] = "\x00\xFFsnifex";
+  string bytes = {.ptr = raw, .len = sizeof(raw) - 1};
+  string hex = str_hex_encode(&arena, bytes);
+  assert(str_eq(hex, strlit("00ff736e69666578")));
+  assert(str_hex_decode(&arena, strlit("00FF736E69666578"), &text));
+  assert(str_eq(text, bytes));
+  assert(!str_hex_decode(&arena, strlit("abc"), &text));
+
+  string b64 = str_base64_encode(&arena, strlit("snifex!"));
+  assert(str_eq(b64, strlit("c25pZmV4IQ==")));
+  assert(str_base64_decode(&arena, b64, &text));
+  assert(str_eq(text, strlit("snifex!")));
+  // Padding is optional
+  assert(str_base64_decode(&arena, strlit("c25pZmV4IQ"), &text));
+  assert(str_eq(text, strlit("snifex!")));
+  assert(!str_base64_decode(&arena, strlit("c25pZ*V4"), &text));
+
+  // Invalid input leaves `text` empty and gives the buffer back
+  const size_t top = arena.top;
+  assert(!str_hex_decode(&arena, strlit("00zz"), &text));
+  assert(text.ptr == NULL && text.len == 0 && arena.top == top);
+  assert(!str_url_decode(&arena, strlit("ok%2"), &text));
+  assert(text.ptr == NULL && arena.top == top);
+
+  //-
+  //- Full arenas
+  //-
+  Arena tiny = arena_create(8);
+  assert(str_hex_encode(&tiny, strlit("too long")).ptr == NULL);
+  assert(!str_json_unescape(&tiny, strlit("\\n is more than 8 bytes"), &text));
+  assert(text.ptr == NULL);
+  arena_free(&tiny);
+
+  arena_free(&arena);
+}
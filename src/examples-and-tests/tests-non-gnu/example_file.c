@@ -0,0 +1,138 @@
+#include "../../snifex-api.h"
+
+void file_usage() {
+#ifdef SNIFEX_API_POSIX_IO
+  const char* path = "snifex_file_usage.txt";
+  FILE* file = fopen(path, "w");
+  assert(file != NULL);
+  fputs("first line\nsecond line\n", file);
+  fclose(file);
+
+  //-
+  //- Mapping
+  //-
+  string mapped;
+  assert(str_map_file(path, &mapped));
+  assert(str_eq(mapped, strlit("first line\nsecond line\n")));
+  // The view works with every string function, without copying the file
+  assert(str_find_char(mapped, '\n') == 10);
+  str_unmap_file(mapped);
+
+  //-
+  //- Reading in an arena
+  //-
+  Arena arena = arena_create(1024);
+  string content;
+  assert(str_read_file(&arena, path, &content));
+  assert(str_eq(content, strlit("first line\nsecond line\n")));
+  assert(arena.top == content.len);
+  // Unlike mapped files, the content can be modified
+  content.ptr[0] = 'F';
+
+  // Files that don't exist, directories, and arenas too full
+  assert(!str_map_file("snifex_missing.txt", &mapped) && mapped.len == 0);
+  assert(!str_read_file(&arena, ".", &content) && content.ptr == NULL);
+  Arena tiny = arena_create(8);
+  assert(!str_read_file(&tiny, path, &content) && content.ptr == NULL);
+  arena_free(&tiny);
+
+  //-
+  //- Reading line by line
+  //-
+  file = fopen(path, "w");
+  assert(file != NULL);
+  fputs("  id=1  \r\nid=22\n\nid=333", file);
+  fclose(file);
+
+  // A tiny buffer, so records cross refills and the buffer has to grow
+  const int fd = open(path, O_RDONLY);
+  assert(fd >= 0);
+  StrReader reader = str_reader_create(fd, 4);
+  string ids[3];
+  size_t n_ids = 0;
+  string line;
+  size_t n_lines = 0;
+  while (str_reader_next_line(&reader, &line)) {
+    n_lines++;
+    line = str_trim(line);
+    if (str_is_empty(line)) { continue; }
+    // Lines only live until the next read, the ones to keep are copied
+    ids[n_ids++] = str_copy(&arena, str_slice(line, 3, line.len));
+  }
+  assert(!reader.failed && n_lines == 4 && n_ids == 3);
+  assert(str_eq(ids[0], strlit("1")) && str_eq(ids[2], strlit("333")));
+  str_reader_free(&reader);
+
+  // Any byte can end records
+  lseek(fd, 0, SEEK_SET);
+  reader = str_reader_create(fd, 64);
+  string record;
+  assert(str_reader_next(&reader, '=', &record));
+  assert(str_eq(record, strlit("  id")));
+  str_reader_free(&reader);
+  close(fd);
+
+  //-
+  //- Writing
+  //-
+  const int out_fd = open(path, O_WRONLY | O_TRUNC);
+  assert(out_fd >= 0);
+  StrWriter writer = str_writer_create(out_fd, 16);
+  assert(str_writer_write(&writer, strlit("header\n")));
+  // A large payload is only referenced, and written by the next flush
+  // together with what is around it, in a single `writev`
+  string payload = str_alloc(&arena, 300);
+  memset(payload.ptr, 'x', payload.len);
+  assert(str_writer_write_view(&writer, payload));
+  assert(str_writer_write_view(&writer, strlit("\nfooter\n")));
+  assert(str_writer_flush(&writer));
+  str_writer_free(&writer);
+  close(out_fd);
+
+  assert(str_read_file(&arena, path, &content));
+  assert(content.len == 7 + 300 + 8);
+  assert(str_starts_with(content, strlit("header\nxxx")));
+  assert(str_ends_with(content, strlit("xxx\nfooter\n")));
+
+  // A failed flush keeps what it couldn't write, for a later one to retry.
+  // Here a full non-blocking pipe takes the output a part at a time
+  int pipe_fds[2];
+  assert(pipe(pipe_fds) == 0);
+  assert(fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK) == 0);
+  const size_t big_len = 1 << 20;
+  string big = {.ptr = (char*)malloc(big_len), .len = big_len};
+  memset(big.ptr, 'y', big.len);
+  StrWriter piped = str_writer_create(pipe_fds[1], 16);
+  assert(str_writer_write(&piped, strlit("head\n")));
+  assert(str_writer_write_view(&piped, big));
+  assert(str_writer_write(&piped, strlit("tail\n")));
+
+  char* const received = (char*)malloc(big_len + 10);
+  size_t received_len = 0;
+  size_t failed_flushes = 0;
+  while (!str_writer_flush(&piped)) {
+    assert(errno == EAGAIN || errno == EWOULDBLOCK);
+    failed_flushes++;
+    const ssize_t n = read(pipe_fds[0], received + received_len, 4096);
+    assert(n > 0);
+    received_len += (size_t)n;
+  }
+  close(pipe_fds[1]);
+  for (ssize_t n; (n = read(pipe_fds[0], received + received_len, 4096)) > 0;) {
+    received_len += (size_t)n;
+  }
+  close(pipe_fds[0]);
+  str_writer_free(&piped);
+
+  const string all = {.ptr = received, .len = received_len};
+  assert(failed_flushes > 0 && all.len == big_len + 10);
+  assert(str_starts_with(all, strlit("head\nyyy")));
+  assert(str_ends_with(all, strlit("yyytail\n")));
+  assert(str_count_char(all, 'y') == big_len);
+  free(received);
+  free(big.ptr);
+
+  arena_free(&arena);
+  remove(path);
+#endif  // SNIFEX_API_POSIX_IO
+}
@@ -0,0 +1,96 @@
+#include "../../snifex-api.h"
+
+typedef struct {
+  uint32_t producer;
+  uint32_t seq;
+} Message;
+
+DefineSpscQueue(uint64_t);
+DefineMpmcQueue(Message);
+
+#define QUEUE_ITEMS 10000
+#define MPMC_PRODUCERS 2
+
+typedef struct {
+  SpscQueue(uint64_t) spsc;
+  MpmcQueue(Message) mpmc;
+  uint64_t spsc_sum;
+  uint32_t mpmc_received[MPMC_PRODUCERS];
+} QueueTest;
+
+void spsc_task(void* ctx, size_t i, Arena* scratch) {
+  QueueTest* test = ctx;
+  if (i == 0) {
+    for (uint64_t n = 1; n <= QUEUE_ITEMS; n++) {
+      while (!spsc_push(uint64_t, &test->spsc, n)) {}
+    }
+  } else {
+    uint64_t prev = 0, n;
+    while (prev != QUEUE_ITEMS) {
+      if (!spsc_pop(uint64_t, &test->spsc, &n)) { continue; }
+      assert(n == prev + 1);  // FIFO order
+      test->spsc_sum += n;
+      prev = n;
+    }
+  }
+}
+
+void mpmc_task(void* ctx, size_t i, Arena* scratch) {
+  QueueTest* test = ctx;
+  if (i < MPMC_PRODUCERS) {
+    for (uint32_t n = 0; n < QUEUE_ITEMS; n++) {
+      Message msg = {.producer = (uint32_t)i, .seq = n};
+      while (!mpmc_push(Message, &test->mpmc, msg)) {}
+    }
+  } else {
+    // A single consumer, so each producer's messages arrive in order
+    Message msg;
+    uint32_t received = 0;
+    while (received != MPMC_PRODUCERS * QUEUE_ITEMS) {
+      if (!mpmc_pop(Message, &test->mpmc, &msg)) { continue; }
+      assert(msg.seq == test->mpmc_received[msg.producer]);
+      test->mpmc_received[msg.producer]++;
+      received++;
+    }
+  }
+}
+
+void queue_usage() {
+  QueueTest test = {
+      .spsc = spsc_create(uint64_t, 100),
+      .mpmc = mpmc_create(Message, 100),
+  };
+  assert(test.spsc.mask == 127 && test.mpmc.mask == 127);
+
+  //-
+  //- Full and empty queues fail instead of blocking
+  //-
+  uint64_t n;
+  assert(!spsc_pop(uint64_t, &test.spsc, &n));
+  for (uint64_t i = 0; i < 128; i++) {
+    assert(spsc_push(uint64_t, &test.spsc, i));
+  }
+  assert(!spsc_push(uint64_t, &test.spsc, 128));
+  for (uint64_t i = 0; i < 128; i++) {
+    assert(spsc_pop(uint64_t, &test.spsc, &n) && n == i);
+  }
+
+  //-
+  //- Handing elements between threads
+  //-
+  parallel_set_thread_count(2);
+  parallel_run(2, spsc_task, &test);
+  assert(test.spsc_sum == (uint64_t)QUEUE_ITEMS * (QUEUE_ITEMS + 1) / 2);
+
+  parallel_set_thread_count(MPMC_PRODUCERS + 1);
+  parallel_run(MPMC_PRODUCERS + 1, mpmc_task, &test);
+  for (size_t i = 0; i < MPMC_PRODUCERS; i++) {
+    assert(test.mpmc_received[i] == QUEUE_ITEMS);
+  }
+  Message msg;
+  assert(!mpmc_pop(Message, &test.mpmc, &msg));
+  parallel_set_thread_count(0);
+
+  spsc_free(&test.spsc);
+  mpmc_free(&test.mpmc);
+}
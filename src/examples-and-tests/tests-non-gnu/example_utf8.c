@@ -0,0 +1,47 @@
+#include "../../snifex-api.h"
+
+void utf8_usage() {
+  //-
+  //- Validating
+  //-
+  string greeting = strlit("Ciao, 世界! 👋");
+  assert(str_utf8_valid(greeting));
+  // A lone continuation byte, an overlong '/' and a UTF-16 surrogate
+  assert(!str_utf8_valid(strlit("abc\x80")));
+  assert(!str_utf8_valid(strlit("\xC0\xAF")));
+  assert(!str_utf8_valid(strlit("\xED\xA0\x80")));
+  // A sequence cut short at the end of the string
+  assert(!str_utf8_valid(str_slice(greeting, 0, greeting.len - 1)));
+
+  //-
+  //- Counting and decoding code points
+  //-
+  assert(greeting.len == 18 && str_utf8_count(greeting) == 11);
+
+  uint32_t cp;
+  assert(str_utf8_decode(strlit("世"), &cp) == 3 && cp == 0x4E16);
+
+  Utf8Iter it = str_utf8_iter(greeting);
+  uint32_t last = 0;
+  size_t n_cps = 0;
+  while (str_utf8_next(&it, &cp)) {
+    last = cp;
+    n_cps++;
+  }
+  assert(n_cps == 11 && last == 0x1F44B);
+
+  // Every byte of an invalid sequence decodes to U+FFFD
+  it = str_utf8_iter(strlit("a\xE2\x82z"));
+  uint32_t expected[] = {'a', UTF8_REPLACEMENT, UTF8_REPLACEMENT, 'z'};
+  for (size_t i = 0; str_utf8_next(&it, &cp); i++) {
+    assert(cp == expected[i]);
+  }
+
+  //-
+  //- Trimming
+  //-
+  // U+3000 (ideographic space) and U+00A0 (no-break space) are trimmed too
+  string padded = strlit("\xE3\x80\x80 h\xC3\xA9llo\xC2\xA0\n");
+  assert(str_eq(str_utf8_trim(padded), strlit("h\xC3\xA9llo")));
+  assert(str_is_empty(str_utf8_trim(strlit(" \xC2\xA0 "))));
+}
@@ -47,6 +47,45 @@ void vector_usage() {
     assert(*x_ptr == to_check[i]);
   }
 
+  //-
+  //- Order-preserving insertion and removal
+  //-
+  uint16_t to_insert[] = {10, 11, 12};
+  vec_insert_range(uint16_t, &int_vec_front, 1, to_insert, 3);
+  vec_remove_range(uint16_t, &int_vec_front, 4, 6);
+  vec_insert(uint16_t, &int_vec_front, 0, 0);
+  vec_remove(uint16_t, &int_vec_front, 1);
+  uint16_t to_splice[] = {7, 8};
+  vec_splice(uint16_t, &int_vec_front, 1, 3, to_splice, 2);
+  vec_extend_from_array(uint16_t, &int_vec_front, to_insert, 3);
+
+  uint16_t expected[] = {0, 7, 8, 4, 5, 6, 10, 11, 12};
+  assert(int_vec_front.len == 9);
+  for (size_t i = 0; i < int_vec_front.len; i++) {
+    uint16_t* x_ptr;
+    vec_idx(x_ptr, uint16_t, int_vec_front, i);
+    assert(*x_ptr == expected[i]);
+  }
+
+  //-
+  //- Reserving, resizing, clearing and shrinking
+  //-
+  vec_reserve(uint16_t, &int_vec, 100);
+  assert(int_vec.cap >= 100 && int_vec.len == 0);
+
+  vec_resize(uint16_t, &int_vec, 10);  // New elements are zeroed
+  uint16_t* zeroed_ptr;
+  vec_idx(zeroed_ptr, uint16_t, int_vec, 9);
+  assert(int_vec.len == 10 && *zeroed_ptr == 0);
+
+  vec_resize(uint16_t, &int_vec, 2);
+  vec_shrink_to_fit(uint16_t, &int_vec);
+  assert(int_vec.len == 2 && int_vec.cap == 2);
+
+  vec_clear(uint16_t, &int_vec);
+  vec_shrink_to_fit(uint16_t, &int_vec);
+  assert(int_vec.len == 0 && int_vec.cap == 1);
+
   //-
   //- Freeing the vector
   //-
@@ -54,3 +93,398 @@ void vector_usage() {
   vec_free(&int_vec_back);
   vec_free(&int_vec);
 }
+
+DefineSmallVec(uint16_t, 4);
+
+void small_vector_usage() {
+  //-
+  //- Create Small Vector. Up to 4 elements are stored inline, no allocation
+  //-
+  SmallVec(uint16_t, 4) small_vec;
+  smallvec_create(small_vec, uint16_t, 4);
+
+  smallvec_push(uint16_t, 4, &small_vec, 1);
+  smallvec_push(uint16_t, 4, &small_vec, 2);
+  smallvec_push(uint16_t, 4, &small_vec, 3);
+  assert(small_vec.heap == NULL && small_vec.cap == 4);
+
+  //-
+  //- Appending past the inline capacity spills to the heap
+  //-
+  SmallVec(uint16_t, 4) small_vec_back;
+  smallvec_create(small_vec_back, uint16_t, 4);
+  smallvec_push(uint16_t, 4, &small_vec_back, 4);
+  smallvec_push(uint16_t, 4, &small_vec_back, 5);
+
+  smallvec_append(uint16_t, 4, &small_vec, &small_vec_back);
+  assert(small_vec.heap != NULL && small_vec.len == 5);
+  for (size_t i = 0; i < small_vec.len; i++) {
+    uint16_t* x_ptr;
+    smallvec_idx(x_ptr, uint16_t, 4, &small_vec, i);
+    assert(*x_ptr == i + 1);
+  }
+
+  smallvec_pop(uint16_t, 4, &small_vec);
+  uint16_t* last_ptr;
+  smallvec_last(last_ptr, uint16_t, 4, &small_vec);
+  assert(*last_ptr == 4);
+
+  //-
+  //- Viewing it as a normal vector, E.G. for `str_join`
+  //-
+  Vec(uint16_t) view;
+  smallvec_as_vec(view, uint16_t, 4, &small_vec);
+  assert(view.len == 4);
+
+  smallvec_free(&small_vec);
+  smallvec_free(&small_vec_back);
+}
+
+typedef struct {
+  uint32_t id;
+  float score;
+} Record;
+
+DefineVec(Record);
+DefineVec(int32_t);
+DefineVec(float);
+
+#define u16_less(a, b) ((a) < (b))
+#define record_id_less(a, b) ((a).id < (b).id)
+
+DefineVecSort(uint16_t, u16, u16_less);
+DefineVecSort(Record, by_id, record_id_less);
+
+void vector_sort_usage() {
+  //-
+  //- Sorting with an inlined comparison
+  //-
+  Vec(uint16_t) nums;
+  vec_create(nums, uint16_t, 1);
+  for (uint16_t i = 0; i < 1000; i++) {
+    vec_push(uint16_t, &nums, (i * 7919) % 1000);
+  }
+  vec_sort(u16, &nums);
+  for (size_t i = 0; i < nums.len; i++) { assert(nums.ptr[i] == i); }
+
+  //-
+  //- Stable sorting keeps the order of equal elements
+  //-
+  Vec(Record) records;
+  vec_create(records, Record, 1);
+  for (uint32_t i = 0; i < 100; i++) {
+    Record r = {.id = i % 3, .score = (float)i};
+    vec_push(Record, &records, r);
+  }
+  Vec(Record) records_copy;
+  vec_create(records_copy, Record, 1);
+  vec_append(Record, &records_copy, records);
+
+  vec_stable_sort(by_id, &records);
+  for (size_t i = 1; i < records.len; i++) {
+    Record prev = records.ptr[i - 1];
+    Record curr = records.ptr[i];
+    assert(prev.id < curr.id ||
+           (prev.id == curr.id && prev.score < curr.score));
+  }
+
+  //-
+  //- Radix sorting numbers, or structs by a numerical field
+  //-
+  Vec(int32_t) ints;
+  vec_from(ints, int32_t, 5, -3, 100000, -100000, 0, 7);
+  vec_radix_sort(int32_t, &ints);
+  int32_t expected_ints[] = {-100000, -3, 0, 5, 7, 100000};
+  for (size_t i = 0; i < ints.len; i++) {
+    assert(ints.ptr[i] == expected_ints[i]);
+  }
+
+  Vec(float) floats;
+  vec_from(floats, float, 1.5f, -2.25f, 0.0f, -0.5f, 1e30f, -1e30f);
+  vec_radix_sort(float, &floats);
+  float expected_floats[] = {-1e30f, -2.25f, -0.5f, 0.0f, 1.5f, 1e30f};
+  for (size_t i = 0; i < floats.len; i++) {
+    assert(floats.ptr[i] == expected_floats[i]);
+  }
+
+  vec_radix_sort_by(Record, &records_copy, uint32_t, id);  // Stable too
+  for (size_t i = 0; i < records.len; i++) {
+    assert(records.ptr[i].score == records_copy.ptr[i].score);
+  }
+
+  vec_free(&nums);
+  vec_free(&records);
+  vec_free(&records_copy);
+  vec_free(&ints);
+  vec_free(&floats);
+}
+
+DefineVecSearch(uint16_t, u16, u16_less);
+
+void vector_search_usage() {
+  //-
+  //- Branchless binary search on a sorted vector
+  //-
+  Vec(uint16_t) nums;
+  vec_create(nums, uint16_t, 1);
+  for (uint16_t i = 0; i < 500; i++) {
+    vec_push(uint16_t, &nums, (uint16_t)(i * 2));
+  }
+  assert(vec_lower_bound(u16, nums, 0) == 0);
+  assert(vec_lower_bound(u16, nums, 10) == 5);
+  assert(vec_lower_bound(u16, nums, 11) == 6);
+  assert(vec_upper_bound(u16, nums, 10) == 6);
+  assert(vec_lower_bound(u16, nums, 5000) == nums.len);
+  assert(*vec_bsearch(u16, nums, 998) == 998);
+  assert(vec_bsearch(u16, nums, 999) == NULL);
+
+  //-
+  //- Eytzinger layout, faster than binary search for big vectors
+  //-
+  Vec(uint16_t) eytzinger = vec_eytzinger(u16, nums);
+  for (uint16_t key = 0; key < 1001; key++) {
+    size_t i = vec_eytzinger_search(u16, eytzinger, key);
+    size_t j = vec_lower_bound(u16, nums, key);
+    assert(i == eytzinger.len ? j == nums.len
+                              : eytzinger.ptr[i] == nums.ptr[j]);
+  }
+
+  //-
+  //- Set operations between sorted vectors
+  //-
+  Vec(uint16_t) odds;
+  vec_from(odds, uint16_t, 1, 3, 5, 7);
+  Vec(uint16_t) some;
+  vec_from(some, uint16_t, 2, 3, 4, 4, 9);
+  Vec(uint16_t) uni = vec_union(u16, odds, some);
+  Vec(uint16_t) inter = vec_intersection(u16, odds, some);
+  Vec(uint16_t) diff = vec_difference(u16, some, odds);
+  uint16_t expected_uni[] = {1, 2, 3, 4, 4, 5, 7, 9};
+  uint16_t expected_inter[] = {3};
+  uint16_t expected_diff[] = {2, 4, 4, 9};
+  assert(uni.len == 8 && inter.len == 1 && diff.len == 4);
+  for (size_t i = 0; i < uni.len; i++) {
+    assert(uni.ptr[i] == expected_uni[i]);
+  }
+  assert(inter.ptr[0] == expected_inter[0]);
+  for (size_t i = 0; i < diff.len; i++) {
+    assert(diff.ptr[i] == expected_diff[i]);
+  }
+
+  vec_free(&nums);
+  vec_free(&eytzinger);
+  vec_free(&odds);
+  vec_free(&some);
+  vec_free(&uni);
+  vec_free(&inter);
+  vec_free(&diff);
+}
+
+typedef struct {
+  uint32_t id;
+  float score;
+  uint64_t flags;
+} Entry;
+
+#define ENTRY_FIELDS(X) X(uint32_t, id) X(float, score) X(uint64_t, flags)
+DefineSoAVec(Entry, ENTRY_FIELDS);
+
+void soa_vector_usage() {
+  //-
+  //- Pushing whole elements, storing one column per field
+  //-
+  SoAVec(Entry) entries = soavec_create(Entry, 1);
+  for (uint32_t i = 0; i < 100; i++) {
+    Entry entry = {.id = i, .score = (float)i / 2, .flags = (uint64_t)i << 32};
+    soavec_push(Entry, &entries, entry);
+  }
+  assert(entries.len == 100 && entries.cap >= 100);
+  assert((uintptr_t)entries.score % 64 == 0);
+  assert((uintptr_t)entries.flags % 64 == 0);
+
+  //-
+  //- Scanning a single column
+  //-
+  float total = 0;
+  for (size_t i = 0; i < entries.len; i++) { total += entries.score[i]; }
+  assert(total == 2475.0f);
+  *soavec_idx(entries, score, 3) = 10.0f;
+  assert(entries.score[3] == 10.0f);
+
+  //-
+  //- Reading and writing whole elements
+  //-
+  Entry third = soavec_get(Entry, entries, 3);
+  assert(third.id == 3 && third.score == 10.0f && third.flags == 3ull << 32);
+  third.id = 1000;
+  soavec_set(Entry, &entries, 3, third);
+  assert(entries.id[3] == 1000);
+
+  //-
+  //- Removing elements keeps the columns in sync
+  //-
+  Entry removed = soavec_swap_remove(Entry, &entries, 0);
+  assert(removed.id == 0 && entries.len == 99);
+  assert(entries.id[0] == 99 && entries.score[0] == 49.5f);
+  assert(entries.flags[0] == 99ull << 32);
+  Entry last = soavec_pop(Entry, &entries);
+  assert(last.id == 98 && entries.len == 98);
+
+  soavec_clear(&entries);
+  assert(entries.len == 0);
+  soavec_free(&entries);
+}
+
+DefineVec(uint32_t);
+DefineVec(uint64_t);
+
+void vector_scan_usage() {
+  //-
+  //- Vectorized find and count
+  //-
+  Vec(uint32_t) ids;
+  vec_create(ids, uint32_t, 1);
+  for (uint32_t i = 0; i < 1000; i++) { vec_push(uint32_t, &ids, i % 100); }
+  size_t idx, count;
+  vec_find(idx, uint32_t, ids, 42);
+  assert(idx == 42);
+  vec_find(idx, uint32_t, ids, 100);
+  assert(idx == ids.len);
+  vec_count(count, uint32_t, ids, 42);
+  assert(count == 10);
+
+  Vec(uint64_t) big;
+  vec_from(big, uint64_t, 1, UINT64_MAX, 1ull << 63, 7, 7);
+  vec_find(idx, uint64_t, big, 7);
+  vec_count(count, uint64_t, big, 7);
+  assert(idx == 3 && count == 2);
+
+  //-
+  //- Vectorized min and max
+  //-
+  uint32_t min_id, max_id;
+  vec_min(min_id, uint32_t, ids);
+  vec_max(max_id, uint32_t, ids);
+  assert(min_id == 0 && max_id == 99);
+
+  uint64_t min_big, max_big;
+  vec_min(min_big, uint64_t, big);
+  vec_max(max_big, uint64_t, big);
+  assert(min_big == 1 && max_big == UINT64_MAX);
+
+  Vec(float) temps;
+  vec_from(temps, float, 3.5f, -1.0f, 20.25f, 0.0f, -7.5f);
+  float min_temp, max_temp;
+  vec_find(idx, float, temps, 0.0f);
+  vec_min(min_temp, float, temps);
+  vec_max(max_temp, float, temps);
+  assert(idx == 3 && min_temp == -7.5f && max_temp == 20.25f);
+
+  vec_free(&ids);
+  vec_free(&big);
+  vec_free(&temps);
+}
+
+DefineDeque(uint32_t);
+
+void deque_usage() {
+  //-
+  //- Pushing and popping at both ends
+  //-
+  Deque(uint32_t) queue;
+  deque_create(queue, uint32_t, 3);
+  assert(queue.cap == 4);
+  uint32_t val;
+  uint32_t* val_ptr;
+  deque_push_back(uint32_t, &queue, 1);
+  deque_push_back(uint32_t, &queue, 2);
+  deque_push_back(uint32_t, &queue, 3);
+  deque_pop_front(val, uint32_t, &queue);
+  assert(val == 1);
+  deque_pop_front(val, uint32_t, &queue);
+  assert(val == 2);
+  deque_push_back(uint32_t, &queue, 4);
+  deque_push_back(uint32_t, &queue, 5);  // Wraps around the end of the buffer
+  deque_push_front(uint32_t, &queue, 0);
+  deque_idx(val_ptr, uint32_t, queue, 0);
+  assert(queue.len == 4 && *val_ptr == 0);
+  deque_pop_back(val, uint32_t, &queue);
+  assert(val == 5);
+  deque_push_back(uint32_t, &queue, 5);
+
+  //-
+  //- Growing keeps the order even when wrapped around
+  //-
+  for (uint32_t i = 6; i < 20; i++) { deque_push_back(uint32_t, &queue, i); }
+  uint32_t expected = 0;
+  for (size_t i = 0; i < queue.len; i++) {
+    if (expected == 1) { expected = 3; }
+    deque_idx(val_ptr, uint32_t, queue, i);
+    assert(*val_ptr == expected++);
+  }
+
+  //-
+  //- Zero-copy draining through the contiguous spans
+  //-
+  deque_drop_front(&queue, 10);
+  for (uint32_t i = 20; i < 34; i++) { deque_push_back(uint32_t, &queue, i); }
+  const uint32_t* first = deque_first_span(queue);
+  const uint32_t* second = deque_second_span(queue);
+  size_t first_len = deque_first_span_len(queue);
+  size_t second_len = deque_second_span_len(queue);
+  assert(first_len + second_len == queue.len && second_len > 0);
+  for (size_t i = 0; i < first_len; i++) { assert(first[i] == 12 + i); }
+  for (size_t i = 0; i < second_len; i++) {
+    assert(second[i] == 12 + first_len + i);
+  }
+  deque_drop_front(&queue, first_len + second_len);
+  assert(queue.len == 0);
+
+  deque_clear(&queue);
+  deque_free(&queue);
+}
+
+#define u32_less(a, b) ((a) < (b))
+#define score_greater(a, b) ((a).score > (b).score)
+DefineHeap(uint32_t, u32_min, u32_less);
+DefineDaryHeap(Record, best_score, score_greater, 4);
+
+void heap_usage() {
+  //-
+  //- Priority queue: the smallest element is always on top
+  //-
+  Vec(uint32_t) queue;
+  vec_create(queue, uint32_t, 1);
+  for (uint32_t i = 0; i < 100; i++) {
+    heap_push(u32_min, &queue, (i * 37) % 100);
+  }
+  assert(*heap_peek(u32_min, queue) == 0);
+  for (uint32_t i = 0; i < 100; i++) { assert(heap_pop(u32_min, &queue) == i); }
+  assert(queue.len == 0);
+
+  //-
+  //- Heapifying a whole vector at once, with 4 children per node
+  //-
+  Vec(Record) records;
+  vec_create(records, Record, 1);
+  for (uint32_t i = 0; i < 50; i++) {
+    Record r = {.id = i, .score = (float)((i * 13) % 50)};
+    vec_push(Record, &records, r);
+  }
+  heapify(best_score, &records);
+  assert(heap_peek(best_score, records)->score == 49.0f);
+  Record best = heap_pop(best_score, &records);
+  assert(best.score == 49.0f && heap_peek(best_score, records)->score == 48.0f);
+
+  //-
+  //- Selecting the best k elements without sorting everything
+  //-
+  Vec(Record) top = heap_top_k(best_score, records, 3);
+  assert(top.len == 3);
+  assert(top.ptr[0].score == 48.0f && top.ptr[1].score == 47.0f);
+  assert(top.ptr[2].score == 46.0f);
+
+  vec_free(&queue);
+  vec_free(&records);
+  vec_free(&top);
+}
@@ -5,8 +5,11 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <float.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -21,6 +24,7 @@
 /// These include:
 ///   - The OS_* utility macros, for identifying OSs and platforms
 ///   - The asserting macros
+///   - Compiler hints like @ref SNIFEX_API_PREFETCH
 /// @{
 
 #if !defined(NO_GNU_SNIFEX_API_TESTS)
@@ -68,6 +72,50 @@
 #pragma comment(lib, "DbgHelp.lib")
 #endif  // OS_WIN
 
+/// @brief Hints the CPU to load the cache line of `addr` ahead of time
+///
+/// Expands to nothing but the evaluation of `addr` when the compiler builtin
+/// is not available. It never faults, even on invalid addresses.
+/// @param addr Any pointer expression
+/// @hideinitializer
+#ifdef SNIFEX_API_GNU_EXTENSIONS
+#define SNIFEX_API_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define SNIFEX_API_PREFETCH(addr) ((void)(addr))
+#endif
+
+#if !defined(SNIFEX_API_NO_THREADS)
+#if defined(OS_UNIX)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#define SNIFEX_API_PTHREADS
+#elif defined(OS_WIN)
+#include <windows.h>
+#define SNIFEX_API_WIN_THREADS
+#endif
+#endif  // !SNIFEX_API_NO_THREADS
+
+#if defined(OS_UNIX)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define SNIFEX_API_POSIX_IO
+#endif  // OS_UNIX
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && \
+    !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define SNIFEX_API_C11_ATOMICS
+#define SNIFEX_API_ATOMICS
+#elif defined(__GNUC__)
+#define SNIFEX_API_GNU_ATOMICS
+#define SNIFEX_API_ATOMICS
+#endif
+
 /// @cond EXCLUDE_DOC
 void __snifex_api_assert_fail(const char* expr,
                               const char* file,
@@ -266,6 +314,11 @@ extern void* arena_alloc(Arena* const arena,
 /// only if `dyn_arena->cap < min_cap`.
 /// @post `dyn_arena->buf != NULL` if `malloc` did not fail
 extern void dyn_arena_reserve(DynArena* const dyn_arena, const size_t min_cap);
+/// @brief Resets an @ref Arena, making all of its memory available again
+///
+/// Does not free anything: all the pointers previously returned by @ref
+/// arena_alloc must be considered invalid.
+extern void arena_reset(Arena* const arena);
 /// @brief Frees a @ref DynArena
 extern void dyn_arena_free(DynArena* const dyn_arena);
 /// @brief Frees an @ref Arena
@@ -327,6 +380,59 @@ extern void arena_free(Arena* const arena);
 /// @see @ref DefineVec for more info
 #define Vec(t) Vec_##t
 
+/// @brief Growth policy: the new capacity is `(cap + 1) * 2`
+#define SNIFEX_API_VEC_GROWTH_DOUBLE 0
+/// @brief Growth policy: the new capacity is `cap + cap / 2 + 1`
+#define SNIFEX_API_VEC_GROWTH_ONE_AND_HALF 1
+/// @brief Growth policy: doubles, but once the buffer is bigger than a page its
+/// size in bytes gets rounded up to a multiple of @ref SNIFEX_API_PAGE_SIZE
+///
+/// Page-multiple sizes are what the allocator hands out for big blocks anyways
+/// (mmap), so this way we do not waste the tail of the last page, and
+/// `realloc` can grow the mapping in place (mremap) instead of copying.
+#define SNIFEX_API_VEC_GROWTH_PAGE 2
+
+// Like `HASHFUNC` for dictionaries, the growth policy can be chosen by defining
+// this macro before including the header. Since it gets expanded at the call
+// site, it can even be redefined between two different usages.
+#ifndef SNIFEX_API_VEC_GROWTH
+/// @brief The growth policy used by all vector macros that could reallocate
+///
+/// Must be one of @ref SNIFEX_API_VEC_GROWTH_DOUBLE (the default), @ref
+/// SNIFEX_API_VEC_GROWTH_ONE_AND_HALF or @ref SNIFEX_API_VEC_GROWTH_PAGE
+#define SNIFEX_API_VEC_GROWTH SNIFEX_API_VEC_GROWTH_DOUBLE
+#endif
+
+#ifndef SNIFEX_API_PAGE_SIZE
+/// @brief Page size used by @ref SNIFEX_API_VEC_GROWTH_PAGE
+#define SNIFEX_API_PAGE_SIZE 4096
+#endif
+
+/// @cond EXCLUDE_DOC
+size_t snifex_api_vec_next_cap(const size_t cap,
+                               const size_t min_cap,
+                               const size_t elem_size,
+                               const uint8_t policy);
+void* snifex_api_vec_grow(void* ptr,
+                          size_t* const cap,
+                          const size_t min_cap,
+                          const size_t elem_size,
+                          const uint8_t policy);
+void* snifex_api_vec_shrink(void* ptr,
+                            size_t* const cap,
+                            const size_t len,
+                            const size_t elem_size);
+void* snifex_api_vec_splice(void* ptr,
+                            size_t* const cap,
+                            size_t* const len,
+                            const size_t at,
+                            const size_t remove_count,
+                            const void* items,
+                            const size_t insert_count,
+                            const size_t elem_size,
+                            const uint8_t policy);
+/// @endcond
+
 #ifdef SNIFEX_API_GNU_EXTENSIONS
 /// @brief Create a vector of `t`s with an initial capacity of `init_cap`
 ///
@@ -401,20 +507,18 @@ extern void arena_free(Arena* const arena);
 /// @pre `vec_ptr != NULL`
 /// @post `vec_ptr->ptr != NULL` if `realloc` did not fail
 /// @hideinitializer
-#define vec_push(vec_ptr, val)                                              \
-  do {                                                                      \
-    const __typeof(*(vec_ptr)->ptr) vecp_val = (val);                       \
-    __typeof(vec_ptr) vecp_vec_ptr = (vec_ptr);                             \
-    assert(vecp_vec_ptr != NULL);                                           \
-    if (vecp_vec_ptr->len + 1 > vecp_vec_ptr->cap) {                        \
-      vecp_vec_ptr->cap += 1;                                               \
-      vecp_vec_ptr->cap *= 2;                                               \
-      vecp_vec_ptr->ptr =                                                   \
-          realloc(vecp_vec_ptr->ptr, vecp_vec_ptr->cap * sizeof(vecp_val)); \
-      assert(vecp_vec_ptr->ptr != NULL);                                    \
-    }                                                                       \
-    *(vecp_vec_ptr->ptr + vecp_vec_ptr->len) = vecp_val;                    \
-    vecp_vec_ptr->len += 1;                                                 \
+#define vec_push(vec_ptr, val)                                          \
+  do {                                                                  \
+    const __typeof(*(vec_ptr)->ptr) vecp_val = (val);                   \
+    __typeof(vec_ptr) vecp_vec_ptr = (vec_ptr);                         \
+    assert(vecp_vec_ptr != NULL);                                       \
+    if (vecp_vec_ptr->len + 1 > vecp_vec_ptr->cap) {                    \
+      vecp_vec_ptr->ptr = snifex_api_vec_grow(                          \
+          vecp_vec_ptr->ptr, &vecp_vec_ptr->cap, vecp_vec_ptr->len + 1, \
+          sizeof(vecp_val), SNIFEX_API_VEC_GROWTH);                     \
+    }                                                                   \
+    *(vecp_vec_ptr->ptr + vecp_vec_ptr->len) = vecp_val;                \
+    vecp_vec_ptr->len += 1;                                             \
   } while (0)
 
 /// @brief Pops value from the end of the vector, reducing it's length by 1 (if
@@ -447,18 +551,207 @@ extern void arena_free(Arena* const arena);
     assert(veca_front_ptr != NULL);                                    \
                                                                        \
     if (veca_front_ptr->len + veca_back.len > veca_front_ptr->cap) {   \
-      veca_front_ptr->cap += veca_back.len;                            \
-      veca_front_ptr->cap *= 1.5;                                      \
-      veca_front_ptr->ptr =                                            \
-          realloc(veca_front_ptr->ptr,                                 \
-                  veca_front_ptr->cap * sizeof(*veca_front_ptr->ptr)); \
-      assert(veca_front_ptr->ptr != NULL);                             \
+      veca_front_ptr->ptr = snifex_api_vec_grow(                       \
+          veca_front_ptr->ptr, &veca_front_ptr->cap,                   \
+          veca_front_ptr->len + veca_back.len,                         \
+          sizeof(*veca_front_ptr->ptr), SNIFEX_API_VEC_GROWTH);        \
+    }                                                                  \
+    if (veca_back.len != 0) {                                          \
+      memcpy(veca_front_ptr->ptr + veca_front_ptr->len, veca_back.ptr, \
+             veca_back.len * sizeof(*veca_front_ptr->ptr));            \
     }                                                                  \
-    memcpy(veca_front_ptr->ptr + veca_front_ptr->len, veca_back.ptr,   \
-           veca_back.len * sizeof(*veca_front_ptr->ptr));              \
     veca_front_ptr->len += veca_back.len;                              \
   } while (0)
 
+/// @brief Reserves capacity for at least `min_cap` elements
+///
+/// Like @ref dyn_arena_reserve, it is not a guaranteed realloc: it COULD
+/// trigger one, but only if `vec_ptr->cap < min_cap`. The new capacity follows
+/// @ref SNIFEX_API_VEC_GROWTH, so reserving in a loop is still amortized.
+///
+/// @param vec_ptr Pointer to the vector
+/// @param min_cap The minimum capacity the vector must have afterwards
+/// @pre `vec_ptr != NULL`
+/// @post `vec_ptr->cap >= min_cap`
+/// @hideinitializer
+#define vec_reserve(vec_ptr, min_cap)                          \
+  do {                                                         \
+    __typeof(vec_ptr) vecr_vec_ptr = (vec_ptr);                \
+    const size_t vecr_min_cap = (min_cap);                     \
+    assert(vecr_vec_ptr != NULL);                              \
+    if (vecr_min_cap > vecr_vec_ptr->cap) {                    \
+      vecr_vec_ptr->ptr = snifex_api_vec_grow(                 \
+          vecr_vec_ptr->ptr, &vecr_vec_ptr->cap, vecr_min_cap, \
+          sizeof(*vecr_vec_ptr->ptr), SNIFEX_API_VEC_GROWTH);  \
+    }                                                          \
+  } while (0)
+
+/// @brief Sets the length of the vector to `new_len`
+///
+/// If the vector grows, the new elements are zeroed.
+///
+/// @note
+/// Could trigger reallocation
+///
+/// @param vec_ptr Pointer to the vector
+/// @param new_len The new length of the vector
+/// @pre `vec_ptr != NULL`
+/// @post `vec_ptr->len == new_len`
+/// @hideinitializer
+#define vec_resize(vec_ptr, new_len)                     \
+  do {                                                   \
+    __typeof(vec_ptr) vecrs_vec_ptr = (vec_ptr);         \
+    const size_t vecrs_new_len = (new_len);              \
+    assert(vecrs_vec_ptr != NULL);                       \
+    if (vecrs_new_len > vecrs_vec_ptr->len) {            \
+      vec_reserve(vecrs_vec_ptr, vecrs_new_len);         \
+      memset(vecrs_vec_ptr->ptr + vecrs_vec_ptr->len, 0, \
+             (vecrs_new_len - vecrs_vec_ptr->len) *      \
+                 sizeof(*vecrs_vec_ptr->ptr));           \
+    }                                                    \
+    vecrs_vec_ptr->len = vecrs_new_len;                  \
+  } while (0)
+
+/// @brief Shrinks the capacity of the vector to its length
+///
+/// Gives back to the allocator the memory that is not used. Since a vector
+/// always has a buffer, the capacity never goes below 1.
+///
+/// @param vec_ptr Pointer to the vector
+/// @pre `vec_ptr != NULL`
+/// @hideinitializer
+#define vec_shrink_to_fit(vec_ptr)                                      \
+  do {                                                                  \
+    __typeof(vec_ptr) vecstf_vec_ptr = (vec_ptr);                       \
+    assert(vecstf_vec_ptr != NULL);                                     \
+    vecstf_vec_ptr->ptr = snifex_api_vec_shrink(                        \
+        vecstf_vec_ptr->ptr, &vecstf_vec_ptr->cap, vecstf_vec_ptr->len, \
+        sizeof(*vecstf_vec_ptr->ptr));                                  \
+  } while (0)
+
+/// @brief Removes all the elements of the vector, keeping its capacity
+///
+/// @param vec_ptr Pointer to the vector
+/// @pre `vec_ptr != NULL`
+/// @hideinitializer
+#define vec_clear(vec_ptr)                       \
+  do {                                           \
+    __typeof(vec_ptr) veccl_vec_ptr = (vec_ptr); \
+    assert(veccl_vec_ptr != NULL);               \
+    veccl_vec_ptr->len = 0;                      \
+  } while (0)
+
+/// @brief Replaces `remove_count` elements at index `at` with `insert_count`
+/// elements copied from `items_ptr`
+///
+/// This is the general form of every order-preserving insertion and removal:
+/// it does a single capacity check and shifts the tail of the vector with a
+/// single `memmove`, no matter how many elements are inserted or removed.
+///
+/// @note
+/// Could trigger reallocation
+///
+/// @param vec_ptr Pointer to the vector
+/// @param at Index of the first element to replace
+/// @param remove_count Number of elements to remove starting at `at`
+/// @param items_ptr Pointer to the C array of elements to insert
+/// @param insert_count Number of elements in `items_ptr`
+/// @pre `vec_ptr != NULL`
+/// @pre `at + remove_count <= vec_ptr->len`
+/// @pre `items_ptr` does not point inside the vector itself
+/// @hideinitializer
+#define vec_splice(vec_ptr, at, remove_count, items_ptr, insert_count)      \
+  do {                                                                      \
+    __typeof(vec_ptr) vecsp_vec_ptr = (vec_ptr);                            \
+    const __typeof(*vecsp_vec_ptr->ptr)* vecsp_items = (items_ptr);         \
+    assert(vecsp_vec_ptr != NULL);                                          \
+    vecsp_vec_ptr->ptr = snifex_api_vec_splice(                             \
+        vecsp_vec_ptr->ptr, &vecsp_vec_ptr->cap, &vecsp_vec_ptr->len, (at), \
+        (remove_count), vecsp_items, (insert_count),                        \
+        sizeof(*vecsp_vec_ptr->ptr), SNIFEX_API_VEC_GROWTH);                \
+  } while (0)
+
+/// @brief Inserts `count` elements copied from a C array at index `at`,
+/// shifting the following elements back
+///
+/// @note
+/// Could trigger reallocation
+///
+/// @param vec_ptr Pointer to the vector
+/// @param at Index at which the first element gets inserted
+/// @param items_ptr Pointer to the C array of elements to insert
+/// @param count Number of elements in `items_ptr`
+/// @pre `vec_ptr != NULL`
+/// @pre `at <= vec_ptr->len`
+/// @see @ref vec_splice
+/// @hideinitializer
+#define vec_insert_range(vec_ptr, at, items_ptr, count) \
+  vec_splice((vec_ptr), (at), 0, (items_ptr), (count))
+
+/// @brief Removes the elements in the range [`start`, `end`), maintaining the
+/// elements' order
+///
+/// @param vec_ptr Pointer to the vector
+/// @param start Index of the first element to remove
+/// @param end Index after the last element to remove
+/// @pre `vec_ptr != NULL`
+/// @pre `start <= end && end <= vec_ptr->len`
+/// @see @ref vec_splice
+/// @hideinitializer
+#define vec_remove_range(vec_ptr, start, end)                             \
+  do {                                                                    \
+    const size_t vecrr_start = (start);                                   \
+    const size_t vecrr_end = (end);                                       \
+    assert(vecrr_start <= vecrr_end);                                     \
+    vec_splice((vec_ptr), vecrr_start, vecrr_end - vecrr_start, NULL, 0); \
+  } while (0)
+
+/// @brief Appends `count` elements copied from a C array to the back of the
+/// vector
+///
+/// @note
+/// Could trigger reallocation
+///
+/// @param vec_ptr Pointer to the vector
+/// @param items_ptr Pointer to the C array of elements to append
+/// @param count Number of elements in `items_ptr`
+/// @pre `vec_ptr != NULL`
+/// @hideinitializer
+#define vec_extend_from_array(vec_ptr, items_ptr, count)                      \
+  do {                                                                        \
+    __typeof(vec_ptr) vecefa_vec_ptr = (vec_ptr);                             \
+    assert(vecefa_vec_ptr != NULL);                                           \
+    vec_splice(vecefa_vec_ptr, vecefa_vec_ptr->len, 0, (items_ptr), (count)); \
+  } while (0)
+
+/// @brief Inserts a value at index `at`, shifting the following elements back
+///
+/// @note
+/// Could trigger reallocation
+///
+/// @param vec_ptr Pointer to the vector
+/// @param at Index at which the value gets inserted
+/// @param val Value to insert
+/// @pre `vec_ptr != NULL`
+/// @pre `at <= vec_ptr->len`
+/// @hideinitializer
+#define vec_insert(vec_ptr, at, val)                    \
+  do {                                                  \
+    const __typeof(*(vec_ptr)->ptr) vecins_val = (val); \
+    vec_splice((vec_ptr), (at), 0, &vecins_val, 1);     \
+  } while (0)
+
+/// @brief Removes the element at index `idx`, maintaining the elements' order
+///
+/// Unlike @ref vec_swap_remove this is linear time
+///
+/// @param vec_ptr Pointer to the vector
+/// @param idx Index of the element to remove
+/// @pre `vec_ptr != NULL`
+/// @pre `idx < vec_ptr->len`
+/// @hideinitializer
+#define vec_remove(vec_ptr, idx) vec_splice((vec_ptr), (idx), 1, NULL, 0)
+
 /// @brief Perform a 'swap remove' on vector
 ///
 /// A 'swap remove' is a specific type of deletion on arrays that is constant
@@ -571,20 +864,18 @@ extern void arena_free(Arena* const arena);
 /// @pre `vec_ptr != NULL`
 /// @post `vec_ptr->ptr != NULL` if `realloc` did not fail
 /// @hideinitializer
-#define vec_push(t, vec_ptr, val)                                    \
-  do {                                                               \
-    assert(vec_ptr != NULL);                                         \
-    const t vecp_val = (val);                                        \
-    Vec(t)* vecp_vec_ptr = (vec_ptr);                                \
-    if (vecp_vec_ptr->len + 1 > vecp_vec_ptr->cap) {                 \
-      vecp_vec_ptr->cap += 1;                                        \
-      vecp_vec_ptr->cap *= 2;                                        \
-      vecp_vec_ptr->ptr =                                            \
-          realloc(vecp_vec_ptr->ptr, vecp_vec_ptr->cap * sizeof(t)); \
-      assert(vecp_vec_ptr->ptr != NULL);                             \
-    }                                                                \
-    *(vecp_vec_ptr->ptr + vecp_vec_ptr->len) = vecp_val;             \
-    vecp_vec_ptr->len += 1;                                          \
+#define vec_push(t, vec_ptr, val)                                       \
+  do {                                                                  \
+    assert(vec_ptr != NULL);                                            \
+    const t vecp_val = (val);                                           \
+    Vec(t)* vecp_vec_ptr = (vec_ptr);                                   \
+    if (vecp_vec_ptr->len + 1 > vecp_vec_ptr->cap) {                    \
+      vecp_vec_ptr->ptr = (t*)snifex_api_vec_grow(                      \
+          vecp_vec_ptr->ptr, &vecp_vec_ptr->cap, vecp_vec_ptr->len + 1, \
+          sizeof(t), SNIFEX_API_VEC_GROWTH);                            \
+    }                                                                   \
+    *(vecp_vec_ptr->ptr + vecp_vec_ptr->len) = vecp_val;                \
+    vecp_vec_ptr->len += 1;                                             \
   } while (0)
 
 /// @brief Pops value from the end of the vector, reducing it's length by 1 (if
@@ -612,23 +903,223 @@ extern void arena_free(Arena* const arena);
 /// @pre `front_ptr != NULL`
 /// @post `front_ptr->ptr != NULL` if `realloc` did not fail
 /// @hideinitializer
-#define vec_append(t, front_ptr, back)                                   \
-  do {                                                                   \
-    Vec(t)* veca_front_ptr = (front_ptr);                                \
-    Vec(t) veca_back = (back);                                           \
-                                                                         \
-    if (veca_front_ptr->len + veca_back.len > veca_front_ptr->cap) {     \
-      veca_front_ptr->cap += veca_back.len;                              \
-      veca_front_ptr->cap *= 1.5;                                        \
-      veca_front_ptr->ptr =                                              \
-          realloc(veca_front_ptr->ptr, veca_front_ptr->cap * sizeof(t)); \
-      assert(veca_front_ptr->ptr != NULL);                               \
-    }                                                                    \
-    memcpy(veca_front_ptr->ptr + veca_front_ptr->len, veca_back.ptr,     \
-           veca_back.len * sizeof(t));                                   \
-    veca_front_ptr->len += veca_back.len;                                \
+#define vec_append(t, front_ptr, back)                                 \
+  do {                                                                 \
+    Vec(t)* veca_front_ptr = (front_ptr);                              \
+    Vec(t) veca_back = (back);                                         \
+                                                                       \
+    if (veca_front_ptr->len + veca_back.len > veca_front_ptr->cap) {   \
+      veca_front_ptr->ptr = (t*)snifex_api_vec_grow(                   \
+          veca_front_ptr->ptr, &veca_front_ptr->cap,                   \
+          veca_front_ptr->len + veca_back.len, sizeof(t),              \
+          SNIFEX_API_VEC_GROWTH);                                      \
+    }                                                                  \
+    if (veca_back.len != 0) {                                          \
+      memcpy(veca_front_ptr->ptr + veca_front_ptr->len, veca_back.ptr, \
+             veca_back.len * sizeof(t));                               \
+    }                                                                  \
+    veca_front_ptr->len += veca_back.len;                              \
+  } while (0)
+
+/// @brief Reserves capacity for at least `min_cap` elements
+///
+/// Like @ref dyn_arena_reserve, it is not a guaranteed realloc: it COULD
+/// trigger one, but only if `vec_ptr->cap < min_cap`. The new capacity follows
+/// @ref SNIFEX_API_VEC_GROWTH, so reserving in a loop is still amortized.
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector
+/// @param min_cap The minimum capacity the vector must have afterwards
+/// @pre `vec_ptr != NULL`
+/// @post `vec_ptr->cap >= min_cap`
+/// @hideinitializer
+#define vec_reserve(t, vec_ptr, min_cap)                                  \
+  do {                                                                    \
+    Vec(t)* vecr_vec_ptr = (vec_ptr);                                     \
+    const size_t vecr_min_cap = (min_cap);                                \
+    assert(vecr_vec_ptr != NULL);                                         \
+    if (vecr_min_cap > vecr_vec_ptr->cap) {                               \
+      vecr_vec_ptr->ptr = (t*)snifex_api_vec_grow(                        \
+          vecr_vec_ptr->ptr, &vecr_vec_ptr->cap, vecr_min_cap, sizeof(t), \
+          SNIFEX_API_VEC_GROWTH);                                         \
+    }                                                                     \
+  } while (0)
+
+/// @brief Sets the length of the vector to `new_len`
+///
+/// If the vector grows, the new elements are zeroed.
+///
+/// @note
+/// Could trigger reallocation
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector
+/// @param new_len The new length of the vector
+/// @pre `vec_ptr != NULL`
+/// @post `vec_ptr->len == new_len`
+/// @hideinitializer
+#define vec_resize(t, vec_ptr, new_len)                         \
+  do {                                                          \
+    Vec(t)* vecrs_vec_ptr = (vec_ptr);                          \
+    const size_t vecrs_new_len = (new_len);                     \
+    assert(vecrs_vec_ptr != NULL);                              \
+    if (vecrs_new_len > vecrs_vec_ptr->len) {                   \
+      vec_reserve(t, vecrs_vec_ptr, vecrs_new_len);             \
+      memset(vecrs_vec_ptr->ptr + vecrs_vec_ptr->len, 0,        \
+             (vecrs_new_len - vecrs_vec_ptr->len) * sizeof(t)); \
+    }                                                           \
+    vecrs_vec_ptr->len = vecrs_new_len;                         \
+  } while (0)
+
+/// @brief Shrinks the capacity of the vector to its length
+///
+/// Gives back to the allocator the memory that is not used. Since a vector
+/// always has a buffer, the capacity never goes below 1.
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector
+/// @pre `vec_ptr != NULL`
+/// @hideinitializer
+#define vec_shrink_to_fit(t, vec_ptr)                                   \
+  do {                                                                  \
+    Vec(t)* vecstf_vec_ptr = (vec_ptr);                                 \
+    assert(vecstf_vec_ptr != NULL);                                     \
+    vecstf_vec_ptr->ptr = (t*)snifex_api_vec_shrink(                    \
+        vecstf_vec_ptr->ptr, &vecstf_vec_ptr->cap, vecstf_vec_ptr->len, \
+        sizeof(t));                                                     \
+  } while (0)
+
+/// @brief Removes all the elements of the vector, keeping its capacity
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector
+/// @pre `vec_ptr != NULL`
+/// @hideinitializer
+#define vec_clear(t, vec_ptr)          \
+  do {                                 \
+    Vec(t)* veccl_vec_ptr = (vec_ptr); \
+    assert(veccl_vec_ptr != NULL);     \
+    veccl_vec_ptr->len = 0;            \
+  } while (0)
+
+/// @brief Replaces `remove_count` elements at index `at` with `insert_count`
+/// elements copied from `items_ptr`
+///
+/// This is the general form of every order-preserving insertion and removal:
+/// it does a single capacity check and shifts the tail of the vector with a
+/// single `memmove`, no matter how many elements are inserted or removed.
+///
+/// @note
+/// Could trigger reallocation
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector
+/// @param at Index of the first element to replace
+/// @param remove_count Number of elements to remove starting at `at`
+/// @param items_ptr Pointer to the C array of elements to insert
+/// @param insert_count Number of elements in `items_ptr`
+/// @pre `vec_ptr != NULL`
+/// @pre `at + remove_count <= vec_ptr->len`
+/// @pre `items_ptr` does not point inside the vector itself
+/// @hideinitializer
+#define vec_splice(t, vec_ptr, at, remove_count, items_ptr, insert_count)   \
+  do {                                                                      \
+    Vec(t)* vecsp_vec_ptr = (vec_ptr);                                      \
+    const t* vecsp_items = (items_ptr);                                     \
+    assert(vecsp_vec_ptr != NULL);                                          \
+    vecsp_vec_ptr->ptr = (t*)snifex_api_vec_splice(                         \
+        vecsp_vec_ptr->ptr, &vecsp_vec_ptr->cap, &vecsp_vec_ptr->len, (at), \
+        (remove_count), vecsp_items, (insert_count), sizeof(t),             \
+        SNIFEX_API_VEC_GROWTH);                                             \
+  } while (0)
+
+/// @brief Inserts `count` elements copied from a C array at index `at`,
+/// shifting the following elements back
+///
+/// @note
+/// Could trigger reallocation
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector
+/// @param at Index at which the first element gets inserted
+/// @param items_ptr Pointer to the C array of elements to insert
+/// @param count Number of elements in `items_ptr`
+/// @pre `vec_ptr != NULL`
+/// @pre `at <= vec_ptr->len`
+/// @see @ref vec_splice
+/// @hideinitializer
+#define vec_insert_range(t, vec_ptr, at, items_ptr, count) \
+  vec_splice(t, (vec_ptr), (at), 0, (items_ptr), (count))
+
+/// @brief Removes the elements in the range [`start`, `end`), maintaining the
+/// elements' order
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector
+/// @param start Index of the first element to remove
+/// @param end Index after the last element to remove
+/// @pre `vec_ptr != NULL`
+/// @pre `start <= end && end <= vec_ptr->len`
+/// @see @ref vec_splice
+/// @hideinitializer
+#define vec_remove_range(t, vec_ptr, start, end)                             \
+  do {                                                                       \
+    const size_t vecrr_start = (start);                                      \
+    const size_t vecrr_end = (end);                                          \
+    assert(vecrr_start <= vecrr_end);                                        \
+    vec_splice(t, (vec_ptr), vecrr_start, vecrr_end - vecrr_start, NULL, 0); \
+  } while (0)
+
+/// @brief Appends `count` elements copied from a C array to the back of the
+/// vector
+///
+/// @note
+/// Could trigger reallocation
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector
+/// @param items_ptr Pointer to the C array of elements to append
+/// @param count Number of elements in `items_ptr`
+/// @pre `vec_ptr != NULL`
+/// @hideinitializer
+#define vec_extend_from_array(t, vec_ptr, items_ptr, count)            \
+  do {                                                                 \
+    Vec(t)* vecefa_vec_ptr = (vec_ptr);                                \
+    assert(vecefa_vec_ptr != NULL);                                    \
+    vec_splice(t, vecefa_vec_ptr, vecefa_vec_ptr->len, 0, (items_ptr), \
+               (count));                                               \
+  } while (0)
+
+/// @brief Inserts a value at index `at`, shifting the following elements back
+///
+/// @note
+/// Could trigger reallocation
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector
+/// @param at Index at which the value gets inserted
+/// @param val Value to insert
+/// @pre `vec_ptr != NULL`
+/// @pre `at <= vec_ptr->len`
+/// @hideinitializer
+#define vec_insert(t, vec_ptr, at, val)                \
+  do {                                                 \
+    const t vecins_val = (val);                        \
+    vec_splice(t, (vec_ptr), (at), 0, &vecins_val, 1); \
   } while (0)
 
+/// @brief Removes the element at index `idx`, maintaining the elements' order
+///
+/// Unlike @ref vec_swap_remove this is linear time
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector
+/// @param idx Index of the element to remove
+/// @pre `vec_ptr != NULL`
+/// @pre `idx < vec_ptr->len`
+/// @hideinitializer
+#define vec_remove(t, vec_ptr, idx) vec_splice(t, (vec_ptr), (idx), 1, NULL, 0)
+
 /// @brief Perform a 'swap remove' on vector
 ///
 /// A 'swap remove' is a specific type of deletion on arrays that is constant
@@ -661,816 +1152,8805 @@ extern void arena_free(Arena* const arena);
 /// @hideinitializer
 #define vec_free(vec_ptr) free((vec_ptr)->ptr)
 
-/// @}
-
-/// @defgroup string String
-/// @brief Just... Strings 🙂
+/// @brief Macro to declare a specifically typed small vector
 ///
-/// All examples are <a
-/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
-/// @{
-
-/// @brief A sized string view.
+/// A small vector is a vector that keeps up to `N` elements inline, inside the
+/// struct itself, and only allocates (on the heap) once it grows past that.
+/// Most vectors in a program are tiny, so this saves an allocation (and a
+/// pointer chase) for each one of them.
 ///
-/// This a simple sized string view... Nothing else.
-/// For the uninitiated:
-/// - 'sized' means that we carry the length of the data with the data (the
-/// char*)
-/// - 'view' because the memory is not owned. That means that it is the user
-/// responsibility to manage the memory the string view is pointing to. The
-/// recommended way is using an arena.
+/// Since the elements can live inside the struct, all the macros that access
+/// them take a POINTER to the small vector instead of the small vector itself,
+/// otherwise we would be pointing into a copy. For the same reason, a small
+/// vector that is still inline can be copied by value, but one that has
+/// spilled to the heap must not be freed twice.
 ///
-/// @note
-/// These strings are NOT zero tailing (since they're string-views anyways)
-typedef struct string {
-  char* ptr;   ///< Internal string buffer
-  size_t len;  ///< Length of string
-} string;
-
-DefineVec(string);
-
-/// @brief Returns a string literal (char const*) to a @ref string format
-extern string strlit(char const* s);
-/// @brief Allocates a string of length `len` in an arena
-/// @pre `arena != NULL`
-extern string str_alloc(Arena* const arena, const size_t len);
-/// @brief Gets pointer to character at specific index
+/// Example:
+/// @code
+/// DefineSmallVec(int, 8);
 ///
-/// @pre `i >= 0` (since it's of type `size_t`)
-/// @pre `i < str.len`
-/// @pre `str.ptr != NULL` which should be true if the user did not mess with
-/// the `ptr` directly
-char* str_idx(const string str, const size_t i);
-/// @brief Returns whether the string is empty
+/// int main() {
+///   SmallVec(int, 8) small_vector;
+///   return 0;
+/// }
+/// @endcode
 ///
-/// An empty @ref string means that either the length is 0 or the internal `ptr`
-/// is NULL
-extern bool str_is_empty(const string str);
+/// This is a general documentation for the structs generated by this macro:
+/// @code
+/// typedef struct {
+///   t* heap;    // Heap buffer, NULL while the elements are stored inline
+///   size_t cap; // Capacity of the vector, `N` while the elements are inline
+///   size_t len; // Actual length of the vector
+///   t buf[N];   // Inline storage
+/// } SmallVec_t_N; // Where `t` is any type and `N` the inline capacity
+/// @endcode
+///
+/// @param t The type of the elements in the small vector
+/// @param N The inline capacity. Must be an integer literal since it's part of
+/// the type name
+/// @see - @ref SmallVec
+/// @see - @ref DefineVec
+#define DefineSmallVec(t, N) \
+  typedef struct {           \
+    t* heap;                 \
+    size_t cap;              \
+    size_t len;              \
+    t buf[N];                \
+  } SmallVec_##t##_##N
+
+/// @brief Macro to get the struct type of a small vector of `t`s with inline
+/// capacity `N`
+///
+/// @param t The type of the elements in the small vector
+/// @param N The inline capacity
+/// @see @ref DefineSmallVec for more info
+#define SmallVec(t, N) SmallVec_##t##_##N
 
-/// @brief Returns whether two @ref strings are equal
+/// @brief Get pointer to the first element of a small vector, wherever the
+/// elements are stored
 ///
-/// @par Implementation details
-/// Short-circuing if the length is equal and is 0. This is because memcmp with
-/// NULL pointers is U.B. in c99, even if the number of bytes copied is 0,
-/// and in this library empty strings can have a NULL pointer.
+/// @param sv_ptr Pointer to the small vector. It's evaluated more than once
+/// @hideinitializer
+#define smallvec_data(sv_ptr) \
+  ((sv_ptr)->heap != NULL ? (sv_ptr)->heap : (sv_ptr)->buf)
+
+/// @cond EXCLUDE_DOC
+void* snifex_api_smallvec_grow(void* heap,
+                               const void* inline_buf,
+                               size_t* const cap,
+                               const size_t len,
+                               const size_t min_cap,
+                               const size_t elem_size,
+                               const uint8_t policy);
+/// @endcond
+
+#ifdef SNIFEX_API_GNU_EXTENSIONS
+/// @brief Create an empty small vector of `t`s with inline capacity `N`
 ///
-/// @see @ref str_join for more info
-extern bool str_eq(const string a, const string b);
+/// Does not allocate.
+///
+/// @param t The type of the elements in the small vector
+/// @param N The inline capacity
+/// @hideinitializer
+#define smallvec_create(t, N) \
+  ((SmallVec(t, N)){.heap = NULL, .cap = (N), .len = 0})
 
-/// @brief Returns result of concatination of string `b` into `a`
+/// @brief Get pointer to element of small vector at specific index
 ///
-/// @par Implementation details
-/// If we are not careful we could execute memcpy(ptr, NULL, 0), where ptr is
-/// guaranteed not to be NULL, which is U.B. before c2y. Clang and GCC
-/// apparently handle this gratefully while MSVC does not. So to conform to c99
-/// we check for 0-len before memcpy-ing. This isn't not really a performance
-/// issue in release mode as it should just be optimised out (and gcc/clang with
-/// -O1 surely does)
+/// @param sv_ptr Pointer to the small vector we're indexing
+/// @param i The index of the element
+/// @return Pointer to the indexed element
+/// @pre `sv_ptr != NULL`
+/// @pre `i < sv_ptr->len`
+/// @hideinitializer
+#define smallvec_idx(sv_ptr, i)                            \
+  ({                                                       \
+    __typeof(sv_ptr) svi_sv_ptr = (sv_ptr);                \
+    const size_t svi_i = (i);                              \
+    assert(svi_sv_ptr != NULL && svi_i < svi_sv_ptr->len); \
+    &smallvec_data(svi_sv_ptr)[svi_i];                     \
+  })
+
+/// @brief Get pointer to last element of small vector
 ///
-/// @pre `arena != NULL`
-/// @see
-/// https://stackoverflow.com/questions/5243012/is-it-guaranteed-to-be-safe-to-perform-memcpy0-0-0
-extern string str_concat(Arena* const arena, const string a, const string b);
-/// @brief Returns copy of a string
+/// @param sv_ptr Pointer to the small vector
+/// @pre `sv_ptr != NULL`
+/// @pre `sv_ptr->len > 0`
+/// @hideinitializer
+#define smallvec_last(sv_ptr)                          \
+  ({                                                   \
+    __typeof(sv_ptr) svl_sv_ptr = (sv_ptr);            \
+    assert(svl_sv_ptr != NULL && svl_sv_ptr->len > 0); \
+    &smallvec_data(svl_sv_ptr)[svl_sv_ptr->len - 1];   \
+  })
+
+/// @brief Pushes value to the end of the small vector
 ///
-/// @pre `arena != NULL`
-extern string str_copy(Arena* const arena, const string str);
-/// @brief Joins a list of strings together and returns the returning string
+/// @note
+/// Could trigger a heap allocation, either when spilling the inline elements
+/// or when growing an already spilled small vector
 ///
-/// @pre `arena != NULL`
-extern string str_join(Arena* const arena, Vec(string) to_join);
-/// @brief Returns a formatted string
+/// @param sv_ptr Pointer to the small vector we're pushing to
+/// @param val Value to push
+/// @pre `val` must be the same type of the small vector elements
+/// @pre `sv_ptr != NULL`
+/// @hideinitializer
+#define smallvec_push(sv_ptr, val)                               \
+  do {                                                           \
+    const __typeof(*(sv_ptr)->buf) svp_val = (val);              \
+    __typeof(sv_ptr) svp_sv_ptr = (sv_ptr);                      \
+    assert(svp_sv_ptr != NULL);                                  \
+    if (svp_sv_ptr->len + 1 > svp_sv_ptr->cap) {                 \
+      svp_sv_ptr->heap = snifex_api_smallvec_grow(               \
+          svp_sv_ptr->heap, svp_sv_ptr->buf, &svp_sv_ptr->cap,   \
+          svp_sv_ptr->len, svp_sv_ptr->len + 1, sizeof(svp_val), \
+          SNIFEX_API_VEC_GROWTH);                                \
+    }                                                            \
+    smallvec_data(svp_sv_ptr)[svp_sv_ptr->len] = svp_val;        \
+    svp_sv_ptr->len += 1;                                        \
+  } while (0)
+
+/// @brief Pops value from the end of the small vector, reducing it's length by
+/// 1 (if possible)
 ///
-/// @pre `arena != NULL`
-/// @pre `fmt != NULL`
-extern string str_fmt(Arena* const arena, const char* fmt, ...);
-/// @brief Returns a string slice
+/// @param sv_ptr Pointer to the small vector we're popping from
+/// @pre `sv_ptr != NULL`
+/// @hideinitializer
+#define smallvec_pop(sv_ptr)                           \
+  do {                                                 \
+    __typeof(sv_ptr) svpop_sv_ptr = (sv_ptr);          \
+    assert(svpop_sv_ptr != NULL);                      \
+    if (svpop_sv_ptr->len > 0) svpop_sv_ptr->len -= 1; \
+  } while (0)
+
+/// @brief Appends items from a small vector to the back of another small vector
 ///
-/// @pre `start >= 0` (since it's of type `size_t`)
-/// @pre `end >= 0` (since it's of type `size_t`)
-/// @pre `start < str.len`
-/// @pre `end <= str.len`
-/// @pre `start <= end`
-extern string str_slice(const string str, const size_t start, const size_t end);
-/// @brief Returns a trimmed string
-extern string str_trim(const string str);
+/// @note
+/// Could trigger a heap allocation
+///
+/// @param front_ptr Pointer to the small vector we're appending to
+/// @param back_ptr Pointer to the small vector we're taking the items from.
+/// The items will be copied
+/// @pre `front_ptr != NULL && back_ptr != NULL`
+/// @hideinitializer
+#define smallvec_append(front_ptr, back_ptr)                            \
+  do {                                                                  \
+    __typeof(front_ptr) sva_front_ptr = (front_ptr);                    \
+    __typeof(back_ptr) sva_back_ptr = (back_ptr);                       \
+    assert(sva_front_ptr != NULL && sva_back_ptr != NULL);              \
+    const size_t sva_back_len = sva_back_ptr->len;                      \
+                                                                        \
+    if (sva_front_ptr->len + sva_back_len > sva_front_ptr->cap) {       \
+      sva_front_ptr->heap = snifex_api_smallvec_grow(                   \
+          sva_front_ptr->heap, sva_front_ptr->buf, &sva_front_ptr->cap, \
+          sva_front_ptr->len, sva_front_ptr->len + sva_back_len,        \
+          sizeof(*sva_front_ptr->buf), SNIFEX_API_VEC_GROWTH);          \
+    }                                                                   \
+    if (sva_back_len != 0) {                                            \
+      memmove(smallvec_data(sva_front_ptr) + sva_front_ptr->len,        \
+              smallvec_data(sva_back_ptr),                              \
+              sva_back_len * sizeof(*sva_front_ptr->buf));              \
+    }                                                                   \
+    sva_front_ptr->len += sva_back_len;                                 \
+  } while (0)
 
-/// @}
+/// @brief Get a read-only @ref Vec view of the elements of a small vector
+///
+/// Useful to pass a small vector to functions that take a @ref Vec, E.G. @ref
+/// str_join. The view must NOT be pushed to or freed, and it is invalidated by
+/// any operation on the small vector that could allocate.
+///
+/// @param t The type of the elements in the small vector
+/// @param sv_ptr Pointer to the small vector
+/// @pre `sv_ptr != NULL`
+/// @pre `Vec(t)` was declared with @ref DefineVec
+/// @hideinitializer
+#define smallvec_as_vec(t, sv_ptr)           \
+  ({                                         \
+    __typeof(sv_ptr) svav_sv_ptr = (sv_ptr); \
+    assert(svav_sv_ptr != NULL);             \
+    (Vec(t)){                                \
+        .ptr = smallvec_data(svav_sv_ptr),   \
+        .cap = svav_sv_ptr->len,             \
+        .len = svav_sv_ptr->len,             \
+    };                                       \
+  })
 
-/// @defgroup dict Dictionary
-/// @brief General type hashmaps
+#else  // NON SNIFEX_API_GNU_EXTENSIONS
+
+/// @brief Create an empty small vector of `t`s with inline capacity `N`
 ///
-/// This implementation of hashmap is somewhat reminiscent of stb-db's one. The
-/// inner workings are the same: an hashmap that uses open addressing (or closed
-/// hashing) where buckets do not cointain the entries them self but contain an
-/// index to a vector where we store entries contigiously.
-/// Of course, since they mimic the generic-like feeling of my @ref Vec, we have
-/// a different way of implementing parametric polymorphism, but the core
-/// hashmap implementation details are pretty much the same.
-/// I also implemented a default very simplistic hashing function, but added a
-/// way for users to use a custom hashing algorithm, and I highly suggest you do
-/// so.
+/// Does not allocate.
 ///
-/// All examples are <a
-/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
-/// @{
+/// @param lval_result_sv An lvalue of type `SmallVec(t, N)` to which the result
+/// is going to be set
+/// @param t The type of the elements in the small vector
+/// @param N The inline capacity
+/// @hideinitializer
+#define smallvec_create(lval_result_sv, t, N) \
+  do {                                        \
+    (lval_result_sv).heap = NULL;             \
+    (lval_result_sv).cap = (N);               \
+    (lval_result_sv).len = 0;                 \
+  } while (0)
 
-/// @cond EXCLUDE_DOC
-typedef struct bucket {
-  uint64_t hash;
-  size_t index;
-} Bucket;
-/// @endcond
+/// @brief Get pointer to element of small vector at specific index
+///
+/// @param lval_result_elem_ptr An lvalue of type `t*` to which the result is
+/// going to be set
+/// @param t The type of the elements in the small vector
+/// @param N The inline capacity
+/// @param sv_ptr Pointer to the small vector we're indexing
+/// @param i The index of the element
+/// @pre `sv_ptr != NULL`
+/// @pre `i < sv_ptr->len`
+/// @hideinitializer
+#define smallvec_idx(lval_result_elem_ptr, t, N, sv_ptr, i)   \
+  do {                                                        \
+    SmallVec(t, N)* svi_sv_ptr = (sv_ptr);                    \
+    const size_t svi_i = (i);                                 \
+    assert(svi_sv_ptr != NULL && svi_i < svi_sv_ptr->len);    \
+    lval_result_elem_ptr = &smallvec_data(svi_sv_ptr)[svi_i]; \
+  } while (0)
 
-/// @brief Macro to get the entry type of a dictionary mapping `K`s to `V`s
+/// @brief Get pointer to last element of small vector
 ///
-/// @param K Type of keys of the dictionary
-/// @param V Type of values of the dictionary
-/// @see @ref DefineDict for more info
-#define Entry(K, V) Entry_##K##_##V
-/// @brief Macro to get the type of a dictionary mapping `K`s to `V`s
+/// @param lval_result_elem_ptr An lvalue of type `t*` to which the result is
+/// going to be set
+/// @param t The type of the elements in the small vector
+/// @param N The inline capacity
+/// @param sv_ptr Pointer to the small vector
+/// @pre `sv_ptr != NULL`
+/// @pre `sv_ptr->len > 0`
+/// @hideinitializer
+#define smallvec_last(lval_result_elem_ptr, t, N, sv_ptr)                   \
+  do {                                                                      \
+    SmallVec(t, N)* svl_sv_ptr = (sv_ptr);                                  \
+    assert(svl_sv_ptr != NULL && svl_sv_ptr->len > 0);                      \
+    lval_result_elem_ptr = &smallvec_data(svl_sv_ptr)[svl_sv_ptr->len - 1]; \
+  } while (0)
+
+/// @brief Pushes value to the end of the small vector
 ///
-/// @param K Type of keys of the dictionary
-/// @param V Type of values of the dictionary
-/// @see @ref DefineDict for more info
-#define Dict(K, V) Dictionary_##K##_##V
-/// @brief Macro to get type of vector of entries from a dictionary mapping `K`s
-/// to `V`s
+/// @note
+/// Could trigger a heap allocation, either when spilling the inline elements
+/// or when growing an already spilled small vector
 ///
-/// @param K Type of keys of the dictionary
-/// @param V Type of values of the dictionary
-/// @see @ref DefineDict for more info
-#define VecEntry(K, V) Vec_Entry_##K##_##V
+/// @param t The type of the elements in the small vector
+/// @param N The inline capacity
+/// @param sv_ptr Pointer to the small vector we're pushing to
+/// @param val Value to push
+/// @pre `val` must be the same type of the small vector elements
+/// @pre `sv_ptr != NULL`
+/// @hideinitializer
+#define smallvec_push(t, N, sv_ptr, val)                       \
+  do {                                                         \
+    const t svp_val = (val);                                   \
+    SmallVec(t, N)* svp_sv_ptr = (sv_ptr);                     \
+    assert(svp_sv_ptr != NULL);                                \
+    if (svp_sv_ptr->len + 1 > svp_sv_ptr->cap) {               \
+      svp_sv_ptr->heap = (t*)snifex_api_smallvec_grow(         \
+          svp_sv_ptr->heap, svp_sv_ptr->buf, &svp_sv_ptr->cap, \
+          svp_sv_ptr->len, svp_sv_ptr->len + 1, sizeof(t),     \
+          SNIFEX_API_VEC_GROWTH);                              \
+    }                                                          \
+    smallvec_data(svp_sv_ptr)[svp_sv_ptr->len] = svp_val;      \
+    svp_sv_ptr->len += 1;                                      \
+  } while (0)
 
-/// @brief Macro to declare a specifically typed dictionary
+/// @brief Pops value from the end of the small vector, reducing it's length by
+/// 1 (if possible)
 ///
-/// The way I implemented generic dictionary is similar to that of vectors:
-/// by having macros instead of functions.
+/// @param t The type of the elements in the small vector
+/// @param N The inline capacity
+/// @param sv_ptr Pointer to the small vector we're popping from
+/// @pre `sv_ptr != NULL`
+/// @hideinitializer
+#define smallvec_pop(t, N, sv_ptr)                     \
+  do {                                                 \
+    SmallVec(t, N)* svpop_sv_ptr = (sv_ptr);           \
+    assert(svpop_sv_ptr != NULL);                      \
+    if (svpop_sv_ptr->len > 0) svpop_sv_ptr->len -= 1; \
+  } while (0)
+
+/// @brief Appends items from a small vector to the back of another small vector
 ///
-/// This macro is the equivalent of @ref DefineVec for dictionaries.
-/// Take a look at this example:
-/// @code
-/// DefineDict(int, float);
+/// @note
+/// Could trigger a heap allocation
 ///
-/// int main() {
-///   Dict(int, float) dictionary;
-///   return 0;
-/// }
-/// @endcode
+/// @param t The type of the elements in the small vectors
+/// @param N The inline capacity of the small vectors
+/// @param front_ptr Pointer to the small vector we're appending to
+/// @param back_ptr Pointer to the small vector we're taking the items from.
+/// The items will be copied
+/// @pre `front_ptr != NULL && back_ptr != NULL`
+/// @hideinitializer
+#define smallvec_append(t, N, front_ptr, back_ptr)                      \
+  do {                                                                  \
+    SmallVec(t, N)* sva_front_ptr = (front_ptr);                        \
+    SmallVec(t, N)* sva_back_ptr = (back_ptr);                          \
+    assert(sva_front_ptr != NULL && sva_back_ptr != NULL);              \
+    const size_t sva_back_len = sva_back_ptr->len;                      \
+                                                                        \
+    if (sva_front_ptr->len + sva_back_len > sva_front_ptr->cap) {       \
+      sva_front_ptr->heap = (t*)snifex_api_smallvec_grow(               \
+          sva_front_ptr->heap, sva_front_ptr->buf, &sva_front_ptr->cap, \
+          sva_front_ptr->len, sva_front_ptr->len + sva_back_len,        \
+          sizeof(t), SNIFEX_API_VEC_GROWTH);                            \
+    }                                                                   \
+    if (sva_back_len != 0) {                                            \
+      memmove(smallvec_data(sva_front_ptr) + sva_front_ptr->len,        \
+              smallvec_data(sva_back_ptr), sva_back_len * sizeof(t));   \
+    }                                                                   \
+    sva_front_ptr->len += sva_back_len;                                 \
+  } while (0)
+
+/// @brief Get a read-only @ref Vec view of the elements of a small vector
 ///
-/// This is a general documentation for the structs generated by this macro:
-/// @code
-/// typedef struct {
-///   K key;
-///   V value;
-/// } Entry_K_V;
+/// Useful to pass a small vector to functions that take a @ref Vec, E.G. @ref
+/// str_join. The view must NOT be pushed to or freed, and it is invalidated by
+/// any operation on the small vector that could allocate.
 ///
-/// typedef struct {
-///   Vec_Entry_K_V entries; /* Vector of all entries in the dictionary. Order
-///                             of entries is not guaranteed to be stable */
-///   uint64_t key[2];       /* This key is used for hashing. When creating a
-///                             dictionary it gets set to {0, 0}.
-///                             It's a uint128_t where the first uint64_t in the
-///                             array is the least significant one.
-///                             Unless your hashing function depends on one
-///                             (which by default it does not), you can ignore
-///                             the key */
-///   ...                    // internal stuff
-/// } Dictionary_K_V; // Where `K` and `V` are the types of keys and values
-/// @endcode
+/// @param lval_result_vec An lvalue of type `Vec(t)` to which the result is
+/// going to be set
+/// @param t The type of the elements in the small vector
+/// @param N The inline capacity
+/// @param sv_ptr Pointer to the small vector
+/// @pre `sv_ptr != NULL`
+/// @pre `Vec(t)` was declared with @ref DefineVec
+/// @hideinitializer
+#define smallvec_as_vec(lval_result_vec, t, N, sv_ptr) \
+  do {                                                 \
+    SmallVec(t, N)* svav_sv_ptr = (sv_ptr);            \
+    assert(svav_sv_ptr != NULL);                       \
+    lval_result_vec = (Vec(t)){                        \
+        .ptr = smallvec_data(svav_sv_ptr),             \
+        .cap = svav_sv_ptr->len,                       \
+        .len = svav_sv_ptr->len,                       \
+    };                                                 \
+  } while (0)
+#endif
+
+/// @brief Removes all the elements of the small vector
 ///
-/// @param t The type of the elements in the vector
-/// @see - @ref DefineVec
-/// @see - @ref Dict
+/// If the small vector has spilled, its heap buffer is kept.
 /// @hideinitializer
-#define DefineDict(K, V)      \
-  typedef struct {            \
-    K key;                    \
-    V value;                  \
-  } Entry(K, V);              \
-                              \
-  DefineVec(Entry_##K##_##V); \
-                              \
-  typedef struct {            \
-    VecEntry(K, V) entries;   \
-    Bucket* buckets;          \
-    size_t b_len;             \
-    size_t b_cap;             \
-    uint64_t key[2];          \
-  } Dict(K, V);
+#define smallvec_clear(sv_ptr) ((sv_ptr)->len = 0)
 
-// This is my way of implementing custom hashing algorithms. Honestly just
-// looking at the examples in the repo is the best way to see it in action
-#ifndef HASHFUNC
-#define hash_num(in_ptr, inlen, k0_u64, k1_u64) \
-  (snifex_api_hash_num_func(in_ptr, inlen))
+/// @brief Frees the small vector
+///
+/// Frees the heap buffer if the small vector has spilled, otherwise there is
+/// nothing to free
+/// @hideinitializer
+#define smallvec_free(sv_ptr) free((sv_ptr)->heap)
+
+/// @brief Below this number of elements the sorts switch to insertion sort
+#ifndef SNIFEX_API_SORT_INSERTION_THRESHOLD
+#define SNIFEX_API_SORT_INSERTION_THRESHOLD 16
 #endif
 
 /// @cond EXCLUDE_DOC
-uint64_t snifex_api_hash_num_func(const void* in, const size_t inlen);
-
-Bucket* snifex_api_find_bucket(Bucket* buckets,
-                               size_t bucket_cap,
-                               void* key,
-                               uint64_t hashed_key,
-                               void* entries,
-                               size_t entry_size,
-                               size_t key_size,
-                               bool include_tombs);
-void snifex_api_dict_grow(Bucket** buckets,
-                          size_t* bucket_cap,
-                          size_t* bucket_len);
+#define SNIFEX_API_RADIX_UNSIGNED 0
+#define SNIFEX_API_RADIX_SIGNED 1
+#define SNIFEX_API_RADIX_FLOAT 2
+
+// Tells apart floating-point, signed and unsigned types at compile time.
+// Signedness is checked against 1 rather than 0, which `-Wtype-limits` flags
+// as always false for unsigned types
+#define snifex_api_radix_kind(t)                            \
+  ((t)0.5 != (t)0 ? SNIFEX_API_RADIX_FLOAT                  \
+                  : ((t)-1 < (t)1 ? SNIFEX_API_RADIX_SIGNED \
+                                  : SNIFEX_API_RADIX_UNSIGNED))
+
+void snifex_api_radix_sort(void* ptr,
+                           const size_t len,
+                           const size_t elem_size,
+                           const size_t key_offset,
+                           const size_t key_size,
+                           const uint8_t kind);
 /// @endcond
 
-#ifdef SNIFEX_API_GNU_EXTENSIONS
-
-/// @brief Create a dictionary of `K`s to `V`s
+/// @brief Macro to declare the sorting functions for vectors of `t`s
 ///
-/// @par Implementation details
-/// The number of initial buckets is 8
+/// Instead of `qsort`'s comparator function pointer, the comparison is pasted
+/// straight into the sorting code so that the compiler can inline it. Since
+/// you might want to sort the same type in different ways, each ordering gets
+/// its own `name`. Take a look at this example:
+/// @code
+/// DefineVec(MyStruct);
+/// #define by_id_less(a, b) ((a).id < (b).id)
+/// DefineVecSort(MyStruct, by_id, by_id_less);
 ///
-/// @param K The type of the keys of dictionary's entries
-/// @param V The type of the values of dictionary's entries
-/// @hideinitializer
-#define dict_create(K, V)                    \
-  ((Dict(K, V)){                             \
-      .entries = vec_create(Entry(K, V), 8), \
-      .buckets = calloc(8, sizeof(Bucket)),  \
-      .b_cap = 8,                            \
-      .b_len = 0,                            \
-      .key = {0, 0},                         \
-  })
-
-/// @brief Inserts an entry in the hashmap
+/// int main() {
+///   Vec(MyStruct) vector = ...;
+///   vec_sort(by_id, &vector);
+///   return 0;
+/// }
+/// @endcode
 ///
-/// @note
-/// Could trigger bucket resizing
+/// The generated functions are:
+///   - `vec_sort_name`: an introsort (quicksort with median of three, falling
+///     back to heapsort on bad inputs and to insertion sort on small ranges).
+///     `O(n log n)` in the worst case, does not allocate, not stable.
+///   - `vec_stable_sort_name`: a merge sort. `O(n log n)` and stable, but it
+///     allocates a temporary buffer of half the length of the vector.
+///   - `vec_parallel_sort_name`: the introsort run on multiple threads, see
+///     @ref vec_parallel_sort.
 ///
-/// @param dict_ptr Pointer to the dictionary
-/// @param k Key of the entry we're inserting
-/// @param v Value of the entry we're inserting
-/// @param old_value_ptr If it's non-null, the value of this pointer will be set
-/// to the old value associated with the key, if there was one. Otherwise
-/// nothing happens.
-/// @hideinitializer
-#define dict_put(dict_ptr, k, v, old_value_ptr)                               \
-  ({                                                                          \
-    __auto_type dp_dict_ptr = (dict_ptr);                                     \
-    __typeof(dp_dict_ptr->entries.ptr->key) dp_k = (k);                       \
-    __typeof(dp_dict_ptr->entries.ptr->value) dp_v = (v);                     \
-    __typeof(&dp_v) _old_value_ptr = (old_value_ptr);                         \
-    uint64_t hasheddp_k =                                                     \
-        hash_num(&dp_k, sizeof(dp_k), dp_dict_ptr->key[0], dp_dict_ptr->[1]); \
-    Bucket* b = snifex_api_find_bucket(                                       \
-        dp_dict_ptr->buckets, dp_dict_ptr->b_cap, &dp_k, hasheddp_k,          \
-        dp_dict_ptr->entries.ptr, sizeof(*(dp_dict_ptr->entries.ptr)),        \
-        sizeof(dp_dict_ptr->entries.ptr->key), true);                         \
-    if (b->index > 1) {                                                       \
-      __auto_type e = vec_idx(dp_dict_ptr->entries, b->index - 2);            \
-      if (_old_value_ptr != NULL) { *_old_value_ptr = e->value; }             \
-      e->value = dp_v;                                                        \
-      true;                                                                   \
-    } else {                                                                  \
-      if (b->index == 0) dp_dict_ptr->b_len++;                                \
-      b->hash = hasheddp_k;                                                   \
-      b->index = dp_dict_ptr->entries.len + 2;                                \
-                                                                              \
-      if (dp_dict_ptr->b_len >= dp_dict_ptr->b_cap * 0.75) {                  \
-        snifex_api_dict_grow(&dp_dict_ptr->buckets, &dp_dict_ptr->b_cap,      \
-                             &dp_dict_ptr->b_len);                            \
-      }                                                                       \
-      __typeof(*dp_dict_ptr->entries.ptr) to_push_entry = {.key = dp_k,       \
-                                                           .value = dp_v};    \
-      vec_push((&dp_dict_ptr->entries), to_push_entry);                       \
-      false;                                                                  \
-    }                                                                         \
-  })
+/// @param t The type of the elements in the vector
+/// @param name The name of the ordering
+/// @param less A function or function-like macro taking two `t` values `a`
+/// and `b` and returning whether `a` goes strictly before `b`
+/// @pre `Vec(t)` was declared with @ref DefineVec
+/// @see - @ref vec_sort
+/// @see - @ref vec_stable_sort
+/// @see - @ref vec_parallel_sort
+/// @see - @ref vec_radix_sort for numerical vectors
+#define DefineVecSort(t, name, less)                                       \
+  static inline void snifex_api_insertion_sort_##name(t* a,                \
+                                                      const size_t n) {    \
+    for (size_t i = 1; i < n; i++) {                                       \
+      t x = a[i];                                                          \
+      size_t j = i;                                                        \
+      for (; j > 0 && less(x, a[j - 1]); j--) { a[j] = a[j - 1]; }         \
+      a[j] = x;                                                            \
+    }                                                                      \
+  }                                                                        \
+                                                                           \
+  static inline void snifex_api_sift_down_##name(t* a, size_t root,        \
+                                                 const size_t n) {         \
+    t x = a[root];                                                         \
+    for (;;) {                                                             \
+      size_t child = 2 * root + 1;                                         \
+      if (child >= n) { break; }                                           \
+      if (child + 1 < n && less(a[child], a[child + 1])) { child++; }      \
+      if (!less(x, a[child])) { break; }                                   \
+      a[root] = a[child];                                                  \
+      root = child;                                                        \
+    }                                                                      \
+    a[root] = x;                                                           \
+  }                                                                        \
+                                                                           \
+  static inline void snifex_api_heap_sort_##name(t* a, const size_t n) {   \
+    for (size_t i = n / 2; i-- > 0;) {                                     \
+      snifex_api_sift_down_##name(a, i, n);                                \
+    }                                                                      \
+    for (size_t end = n; end-- > 1;) {                                     \
+      t tmp = a[0];                                                        \
+      a[0] = a[end];                                                       \
+      a[end] = tmp;                                                        \
+      snifex_api_sift_down_##name(a, 0, end);                              \
+    }                                                                      \
+  }                                                                        \
+                                                                           \
+  static inline void snifex_api_intro_sort_##name(t* a, size_t n,          \
+                                                  size_t depth) {          \
+    while (n > SNIFEX_API_SORT_INSERTION_THRESHOLD) {                      \
+      if (depth == 0) {                                                    \
+        snifex_api_heap_sort_##name(a, n);                                 \
+        return;                                                            \
+      }                                                                    \
+      depth--;                                                             \
+                                                                           \
+      /* Median of three, which also leaves sentinels at both ends */      \
+      const size_t mid = n / 2;                                            \
+      t tmp;                                                               \
+      if (less(a[mid], a[0])) { tmp = a[mid], a[mid] = a[0], a[0] = tmp; } \
+      if (less(a[n - 1], a[0])) {                                          \
+        tmp = a[n - 1], a[n - 1] = a[0], a[0] = tmp;                       \
+      }                                                                    \
+      if (less(a[n - 1], a[mid])) {                                        \
+        tmp = a[n - 1], a[n - 1] = a[mid], a[mid] = tmp;                   \
+      }                                                                    \
+      const t pivot = a[mid];                                              \
+                                                                           \
+      /* Hoare partition. Unsigned wrap-around is well defined */          \
+      size_t i = (size_t)-1;                                               \
+      size_t j = n;                                                        \
+      for (;;) {                                                           \
+        do { i++; } while (less(a[i], pivot));                             \
+        do { j--; } while (less(pivot, a[j]));                             \
+        if (i >= j) { break; }                                             \
+        tmp = a[i], a[i] = a[j], a[j] = tmp;                               \
+      }                                                                    \
+                                                                           \
+      /* Recurse on the smaller half, loop on the bigger one */            \
+      const size_t left_len = j + 1;                                       \
+      if (left_len < n - left_len) {                                       \
+        snifex_api_intro_sort_##name(a, left_len, depth);                  \
+        a += left_len;                                                     \
+        n -= left_len;                                                     \
+      } else {                                                             \
+        snifex_api_intro_sort_##name(a + left_len, n - left_len, depth);   \
+        n = left_len;                                                      \
+      }                                                                    \
+    }                                                                      \
+    snifex_api_insertion_sort_##name(a, n);                                \
+  }                                                                        \
+                                                                           \
+  static inline void snifex_api_merge_sort_##name(t* a, t* tmp,            \
+                                                  const size_t n) {        \
+    if (n <= SNIFEX_API_SORT_INSERTION_THRESHOLD) {                        \
+      snifex_api_insertion_sort_##name(a, n);                              \
+      return;                                                              \
+    }                                                                      \
+    const size_t mid = n / 2;                                              \
+    snifex_api_merge_sort_##name(a, tmp, mid);                             \
+    snifex_api_merge_sort_##name(a + mid, tmp, n - mid);                   \
+    if (!less(a[mid], a[mid - 1])) { return; }                             \
+                                                                           \
+    /* Only the left half needs to be moved out of the way */              \
+    memcpy(tmp, a, mid * sizeof(t));                                       \
+    size_t i = 0, j = mid, k = 0;                                          \
+    while (i < mid && j < n) {                                             \
+      if (less(a[j], tmp[i])) {                                            \
+        a[k++] = a[j++];                                                   \
+      } else {                                                             \
+        a[k++] = tmp[i++];                                                 \
+      }                                                                    \
+    }                                                                      \
+    while (i < mid) { a[k++] = tmp[i++]; }                                 \
+  }                                                                        \
+                                                                           \
+  static inline void vec_sort_##name(Vec(t)* const vec) {                  \
+    assert(vec != NULL);                                                   \
+    size_t depth = 0;                                                      \
+    for (size_t n = vec->len; n > 1; n >>= 1) { depth += 2; }              \
+    snifex_api_intro_sort_##name(vec->ptr, vec->len, depth);               \
+  }                                                                        \
+                                                                           \
+  static inline void vec_stable_sort_##name(Vec(t)* const vec) {           \
+    assert(vec != NULL);                                                   \
+    if (vec->len <= SNIFEX_API_SORT_INSERTION_THRESHOLD) {                 \
+      snifex_api_insertion_sort_##name(vec->ptr, vec->len);                \
+      return;                                                              \
+    }                                                                      \
+    t* tmp = (t*)malloc((vec->len / 2) * sizeof(t));                       \
+    assert(tmp != NULL);                                                   \
+    snifex_api_merge_sort_##name(vec->ptr, tmp, vec->len);                 \
+    free(tmp);                                                             \
+  }                                                                        \
+                                                                           \
+  typedef struct {                                                         \
+    t* src;                                                                \
+    t* dst;                                                                \
+    size_t len;                                                            \
+    size_t runs;                                                           \
+    size_t width; /* In runs, 0 while sorting the single runs */           \
+  } snifex_api_par_sort_##name;                                            \
+                                                                           \
+  static inline void snifex_api_par_sort_task_##name(void* ctx, size_t i,  \
+                                                     Arena* scratch) {     \
+    snifex_api_par_sort_##name* job = (snifex_api_par_sort_##name*)ctx;    \
+    (void)scratch;                                                         \
+    if (job->width == 0) {                                                 \
+      const size_t lo = i * job->len / job->runs;                          \
+      const size_t hi = (i + 1) * job->len / job->runs;                    \
+      size_t depth = 0;                                                    \
+      for (size_t n = hi - lo; n > 1; n >>= 1) { depth += 2; }             \
+      snifex_api_intro_sort_##name(job->src + lo, hi - lo, depth);         \
+      return;                                                              \
+    }                                                                      \
+                                                                           \
+    size_t lo_run = i * 2 * job->width;                                    \
+    size_t mid_run = lo_run + job->width;                                  \
+    size_t hi_run = lo_run + 2 * job->width;                               \
+    if (mid_run > job->runs) { mid_run = job->runs; }                      \
+    if (hi_run > job->runs) { hi_run = job->runs; }                        \
+    const size_t lo = lo_run * job->len / job->runs;                       \
+    const size_t mid = mid_run * job->len / job->runs;                     \
+    const size_t hi = hi_run * job->len / job->runs;                       \
+                                                                           \
+    size_t l = lo, r = mid, k = lo;                                        \
+    while (l < mid && r < hi) {                                            \
+      if (less(job->src[r], job->src[l])) {                                \
+        job->dst[k++] = job->src[r++];                                     \
+      } else {                                                             \
+        job->dst[k++] = job->src[l++];                                     \
+      }                                                                    \
+    }                                                                      \
+    while (l < mid) { job->dst[k++] = job->src[l++]; }                     \
+    while (r < hi) { job->dst[k++] = job->src[r++]; }                      \
+  }                                                                        \
+                                                                           \
+  static inline void vec_parallel_sort_##name(Vec(t)* const vec) {         \
+    assert(vec != NULL);                                                   \
+    size_t runs = parallel_thread_count();                                 \
+    if (runs > vec->len / SNIFEX_API_PARALLEL_MIN_CHUNK) {                 \
+      runs = vec->len / SNIFEX_API_PARALLEL_MIN_CHUNK;                     \
+    }                                                                      \
+    if (runs < 2) {                                                        \
+      vec_sort_##name(vec);                                                \
+      return;                                                              \
+    }                                                                      \
+                                                                           \
+    t* tmp = (t*)malloc(vec->len * sizeof(t));                             \
+    assert(tmp != NULL);                                                   \
+    snifex_api_par_sort_##name job = {                                     \
+        .src = vec->ptr, .dst = tmp, .len = vec->len, .runs = runs,        \
+        .width = 0};                                                       \
+    parallel_run(runs, snifex_api_par_sort_task_##name, &job);             \
+    for (job.width = 1; job.width < runs; job.width *= 2) {                \
+      parallel_run((runs + 2 * job.width - 1) / (2 * job.width),           \
+                   snifex_api_par_sort_task_##name, &job);                 \
+      t* swap = job.src;                                                   \
+      job.src = job.dst;                                                   \
+      job.dst = swap;                                                      \
+    }                                                                      \
+    if (job.src != vec->ptr) {                                             \
+      memcpy(vec->ptr, job.src, vec->len * sizeof(t));                     \
+    }                                                                      \
+    free(tmp);                                                             \
+  }
 
-/// @brief Searches key in the dictionary, and returns pointer to the entry if
-/// found
+/// @brief Sorts a vector with the ordering `name`
 ///
-/// @param dict_ptr Pointer to the dictionary
-/// @param k Key of the entry we're searching
-/// @return `NULL` if there is no entry with associated key, entry pointer
-/// otherwise
+/// @param name The name of the ordering passed to @ref DefineVecSort
+/// @param vec_ptr Pointer to the vector to sort
+/// @pre `vec_ptr != NULL`
+/// @see @ref DefineVecSort for more info
 /// @hideinitializer
-#define dict_get(dict_ptr, k)                                            \
-  ({                                                                     \
-    __auto_type dg_dict_ptr = (dict_ptr);                                \
-    __typeof(dg_dict_ptr->entries.ptr->key) dg_k = (k);                  \
-    __typeof(&dg_dict_ptr->entries.ptr->value) res;                      \
-                                                                         \
-    if (dg_dict_ptr->b_len == 0) {                                       \
-      res = NULL;                                                        \
-    } else {                                                             \
-      Bucket* b = snifex_api_find_bucket(                                \
-          dg_dict_ptr->buckets, dg_dict_ptr->b_cap, &dg_k,               \
-          hash_num(&dg_k, sizeof(dg_k), dg_dict_ptr->key[0],             \
-                   dg_dict_ptr->key[1]),                                 \
-          dg_dict_ptr->entries.ptr, sizeof(*(dg_dict_ptr->entries.ptr)), \
-          sizeof(dg_dict_ptr->entries.ptr->key), false);                 \
-      if (b->index == 0) {                                               \
-        res = NULL;                                                      \
-      } else {                                                           \
-        res = &vec_idx(dg_dict_ptr->entries, (b->index - 2))->value;     \
-      }                                                                  \
-    }                                                                    \
-    res;                                                                 \
-  })
+#define vec_sort(name, vec_ptr) vec_sort_##name(vec_ptr)
 
-/// @brief Deletes entry from a dictionary
+/// @brief Stable-sorts a vector with the ordering `name`
 ///
-/// @par Implementation details
-/// It uses @ref vec_swap_remove to remove an entry. Because of that it does not
-/// guarantee order of the entry vector
+/// @param name The name of the ordering passed to @ref DefineVecSort
+/// @param vec_ptr Pointer to the vector to sort
+/// @pre `vec_ptr != NULL`
+/// @see @ref DefineVecSort for more info
+/// @hideinitializer
+#define vec_stable_sort(name, vec_ptr) vec_stable_sort_##name(vec_ptr)
+
+#ifdef SNIFEX_API_GNU_EXTENSIONS
+/// @brief Sorts a vector of numbers in ascending order with an LSD radix sort
 ///
-/// @param dict_ptr Pointer to the dictionary
-/// @param k Key of the entry we're deleting
-/// @return Whether entry with associated key exists and was removed
+/// Works with any integer type and with `float`s and `double`s. Since this
+/// project assumes IEEE 754, floats are sorted by their bits: flipping the sign
+/// bit of positive numbers and all the bits of negative ones makes them compare
+/// as unsigned integers. This means that `-0.0` goes before `0.0`, and NaNs go
+/// at the ends (depending on their sign bit).
+///
+/// It's linear time, does one pass per byte of the type (passes where all the
+/// elements share the same byte are skipped) and allocates a temporary buffer
+/// as big as the vector. The sort is stable.
+///
+/// @param vec_ptr Pointer to the vector to sort
+/// @pre `vec_ptr != NULL`
 /// @hideinitializer
-#define dict_del(dict_ptr, k)                                              \
-  ({                                                                       \
-    __auto_type dd_dict_ptr = (dict_ptr);                                  \
-    __typeof(dd_dict_ptr->entries.ptr->key) dd_k = (k);                    \
-                                                                           \
-    if (dd_dict_ptr->b_len == 0) {                                         \
-      false;                                                               \
-    } else {                                                               \
-      Bucket* b = snifex_api_find_bucket(                                  \
-          dd_dict_ptr->buckets, dd_dict_ptr->b_cap, &dd_k,                 \
-          hash_num(&dd_k, sizeof(dd_k), dd_dict_ptr->key[0],               \
-                   dd_dict_ptr->key[1]),                                   \
-          dd_dict_ptr->entries.ptr, sizeof(*(dd_dict_ptr->entries.ptr)),   \
-          sizeof(dd_dict_ptr->entries.ptr->key), false);                   \
-      if (b->index == 0) {                                                 \
-        false;                                                             \
-      } else {                                                             \
-        __auto_type last_entry = *vec_last(dd_dict_ptr->entries);          \
-        __auto_type le_k = last_entry.key;                                 \
-        Bucket* last_b = snifex_api_find_bucket(                           \
-            dd_dict_ptr->buckets, dd_dict_ptr->b_cap, &le_k,               \
-            hash_num(&le_k, sizeof(le_k), dd_dict_ptr->key[0],             \
-                     dd_dict_ptr->key[1]),                                 \
-            dd_dict_ptr->entries.ptr, sizeof(*(dd_dict_ptr->entries.ptr)), \
-            sizeof(dd_dict_ptr->entries.ptr->key), false);                 \
-        last_b->index = b->index;                                          \
-        /* Remove and place tombstone */                                   \
-        vec_swap_remove(&dd_dict_ptr->entries, last_b->index - 2);         \
-        b->index = 1;                                                      \
-        true;                                                              \
-      }                                                                    \
-    }                                                                      \
-  })
+#define vec_radix_sort(vec_ptr)                                              \
+  do {                                                                       \
+    __typeof(vec_ptr) vecrs_vec_ptr = (vec_ptr);                             \
+    assert(vecrs_vec_ptr != NULL);                                           \
+    snifex_api_radix_sort(                                                   \
+        vecrs_vec_ptr->ptr, vecrs_vec_ptr->len, sizeof(*vecrs_vec_ptr->ptr), \
+        0, sizeof(*vecrs_vec_ptr->ptr),                                      \
+        snifex_api_radix_kind(__typeof(*vecrs_vec_ptr->ptr)));               \
+  } while (0)
 
-/// @brief Frees the dictionary
+/// @brief Stable-sorts a vector of structs by a numerical field with an LSD
+/// radix sort
 ///
-/// @param dict_ptr Pointer to the dictionary
+/// @param vec_ptr Pointer to the vector to sort
+/// @param field The name of the field used as key. Can be of any integer type,
+/// `float` or `double`
+/// @pre `vec_ptr != NULL`
+/// @see @ref vec_radix_sort for more info
 /// @hideinitializer
-#define dict_free(dict_ptr)               \
-  do {                                    \
-    __auto_type df_dict_ptr = (dict_ptr); \
-    free(df_dict_ptr->buckets);           \
-    vec_free(&df_dict_ptr->entries);      \
+#define vec_radix_sort_by(vec_ptr, field)                             \
+  do {                                                                \
+    __typeof(vec_ptr) vecrsb_vec_ptr = (vec_ptr);                     \
+    assert(vecrsb_vec_ptr != NULL);                                   \
+    snifex_api_radix_sort(                                            \
+        vecrsb_vec_ptr->ptr, vecrsb_vec_ptr->len,                     \
+        sizeof(*vecrsb_vec_ptr->ptr),                                 \
+        offsetof(__typeof(*vecrsb_vec_ptr->ptr), field),              \
+        sizeof(vecrsb_vec_ptr->ptr->field),                           \
+        snifex_api_radix_kind(__typeof(vecrsb_vec_ptr->ptr->field))); \
   } while (0)
 
-#else  // !SNIFEX_API_GNU_EXTENSIONS
+#else  // NON SNIFEX_API_GNU_EXTENSIONS
 
-/// @brief Create a dictionary of `K`s to `V`s
+/// @brief Sorts a vector of numbers in ascending order with an LSD radix sort
 ///
-/// @par Implementation details
-/// The number of initial buckets is 8
+/// Works with any integer type and with `float`s and `double`s. Since this
+/// project assumes IEEE 754, floats are sorted by their bits: flipping the sign
+/// bit of positive numbers and all the bits of negative ones makes them compare
+/// as unsigned integers. This means that `-0.0` goes before `0.0`, and NaNs go
+/// at the ends (depending on their sign bit).
 ///
-/// @param lval_result_dict An lvalue of type `Dict(K, V)` to which the result
-/// is going to be set
-/// @param K The type of the keys of dictionary's entries
-/// @param V The type of the values of dictionary's entries
+/// It's linear time, does one pass per byte of the type (passes where all the
+/// elements share the same byte are skipped) and allocates a temporary buffer
+/// as big as the vector. The sort is stable.
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector to sort
+/// @pre `vec_ptr != NULL`
 /// @hideinitializer
-#define dict_create(lval_result_dict, K, V)   \
-  do {                                        \
-    Vec(Entry_##K##_##V) e;                   \
-    vec_create(e, Entry(K, V), 8);            \
-    lval_result_dict = (Dict(K, V)){          \
-        .entries = e,                         \
-        .buckets = calloc(8, sizeof(Bucket)), \
-        .b_cap = 8,                           \
-        .b_len = 0,                           \
-        .key = {0, 0},                        \
-    };                                        \
+#define vec_radix_sort(t, vec_ptr)                                            \
+  do {                                                                        \
+    Vec(t)* vecrs_vec_ptr = (vec_ptr);                                        \
+    assert(vecrs_vec_ptr != NULL);                                            \
+    snifex_api_radix_sort(vecrs_vec_ptr->ptr, vecrs_vec_ptr->len,             \
+                          sizeof(t), 0, sizeof(t), snifex_api_radix_kind(t)); \
   } while (0)
 
-/// @brief Inserts an entry in the hashmap
+/// @brief Stable-sorts a vector of structs by a numerical field with an LSD
+/// radix sort
 ///
-/// @note
-/// Could trigger bucket resizing
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector to sort
+/// @param field_t The type of the field used as key. Can be any integer type,
+/// `float` or `double`
+/// @param field The name of the field used as key
+/// @pre `vec_ptr != NULL`
+/// @see @ref vec_radix_sort for more info
+/// @hideinitializer
+#define vec_radix_sort_by(t, vec_ptr, field_t, field)                     \
+  do {                                                                    \
+    Vec(t)* vecrsb_vec_ptr = (vec_ptr);                                   \
+    assert(vecrsb_vec_ptr != NULL);                                       \
+    snifex_api_radix_sort(vecrsb_vec_ptr->ptr, vecrsb_vec_ptr->len,       \
+                          sizeof(t), offsetof(t, field), sizeof(field_t), \
+                          snifex_api_radix_kind(field_t));                \
+  } while (0)
+#endif
+
+/// @brief Macro to declare the searching functions for sorted vectors of `t`s
 ///
-/// @param dict_ptr Pointer to the dictionary
-/// @param k_type The type of the keys in the dictionary
-/// @param v_type The type of the values in the dictionary
-/// @param k Key of the entry we're inserting
-/// @param v Value of the entry we're inserting
-/// @param old_value_ptr If it's non-null, the value of this pointer will be set
-/// to the old value associated with the key, if there was one. Otherwise
-/// nothing happens.
+/// Like @ref DefineVecSort, the comparison is pasted into the generated code,
+/// and the vectors must be sorted according to that same `less` (E.G. with
+/// @ref vec_sort). The same `name` can be used for both. Take a look at this
+/// example:
+/// @code
+/// DefineVec(uint32_t);
+/// #define u32_less(a, b) ((a) < (b))
+/// DefineVecSort(uint32_t, u32, u32_less);
+/// DefineVecSearch(uint32_t, u32, u32_less);
+///
+/// int main() {
+///   Vec(uint32_t) vector = ...;
+///   vec_sort(u32, &vector);
+///   uint32_t* found = vec_bsearch(u32, vector, 42);
+///   return 0;
+/// }
+/// @endcode
+///
+/// The generated functions are:
+///   - `vec_lower_bound_name`, `vec_upper_bound_name`, `vec_bsearch_name`: a
+///     branchless binary search, see @ref vec_lower_bound.
+///   - `vec_eytzinger_name`, `vec_eytzinger_search_name`: the same search on
+///     the Eytzinger (BFS) layout, see @ref vec_eytzinger.
+///   - `vec_union_name`, `vec_intersection_name`, `vec_difference_name`:
+///     linear-time set operations between sorted vectors, see @ref vec_union.
+///
+/// @param t The type of the elements in the vector
+/// @param name The name of the ordering
+/// @param less A function or function-like macro taking two `t` values `a`
+/// and `b` and returning whether `a` goes strictly before `b`
+/// @pre `Vec(t)` was declared with @ref DefineVec
+#define DefineVecSearch(t, name, less)                                       \
+  static inline size_t vec_lower_bound_##name(const Vec(t) vec,              \
+                                              const t key) {                 \
+    if (vec.len == 0) { return 0; }                                          \
+    const t* base = vec.ptr;                                                 \
+    size_t n = vec.len;                                                      \
+    while (n > 1) {                                                          \
+      const size_t half = n / 2;                                             \
+      SNIFEX_API_PREFETCH(&base[half / 2]);                                  \
+      SNIFEX_API_PREFETCH(&base[half + half / 2]);                           \
+      base = less(base[half], key) ? base + half : base;                     \
+      n -= half;                                                             \
+    }                                                                        \
+    return (size_t)(base - vec.ptr) + (less(*base, key) ? 1 : 0);            \
+  }                                                                          \
+                                                                             \
+  static inline size_t vec_upper_bound_##name(const Vec(t) vec,              \
+                                              const t key) {                 \
+    if (vec.len == 0) { return 0; }                                          \
+    const t* base = vec.ptr;                                                 \
+    size_t n = vec.len;                                                      \
+    while (n > 1) {                                                          \
+      const size_t half = n / 2;                                             \
+      SNIFEX_API_PREFETCH(&base[half / 2]);                                  \
+      SNIFEX_API_PREFETCH(&base[half + half / 2]);                           \
+      base = !less(key, base[half]) ? base + half : base;                    \
+      n -= half;                                                             \
+    }                                                                        \
+    return (size_t)(base - vec.ptr) + (!less(key, *base) ? 1 : 0);           \
+  }                                                                          \
+                                                                             \
+  static inline t* vec_bsearch_##name(const Vec(t) vec, const t key) {       \
+    const size_t i = vec_lower_bound_##name(vec, key);                       \
+    return i < vec.len && !less(key, vec.ptr[i]) ? &vec.ptr[i] : NULL;       \
+  }                                                                          \
+                                                                             \
+  static inline size_t snifex_api_eytzinger_fill_##name(                     \
+      const t* sorted, t* out, size_t i, const size_t k, const size_t n) {   \
+    if (k < n) {                                                             \
+      i = snifex_api_eytzinger_fill_##name(sorted, out, i, 2 * k + 1, n);    \
+      out[k] = sorted[i++];                                                  \
+      i = snifex_api_eytzinger_fill_##name(sorted, out, i, 2 * k + 2, n);    \
+    }                                                                        \
+    return i;                                                                \
+  }                                                                          \
+                                                                             \
+  static inline Vec(t) vec_eytzinger_##name(const Vec(t) sorted) {           \
+    Vec(t) out = {                                                           \
+        .ptr = (t*)malloc((sorted.len > 0 ? sorted.len : 1) * sizeof(t)),    \
+        .cap = sorted.len > 0 ? sorted.len : 1,                              \
+        .len = sorted.len,                                                   \
+    };                                                                       \
+    assert(out.ptr != NULL);                                                 \
+    snifex_api_eytzinger_fill_##name(sorted.ptr, out.ptr, 0, 0, sorted.len); \
+    return out;                                                              \
+  }                                                                          \
+                                                                             \
+  static inline size_t vec_eytzinger_search_##name(const Vec(t) eytzinger,   \
+                                                   const t key) {            \
+    /* 1-based indices make the children of k be 2k and 2k + 1 */            \
+    const size_t n = eytzinger.len;                                          \
+    const size_t block = 64 / sizeof(t) > 0 ? 64 / sizeof(t) : 1;            \
+    size_t k = 1;                                                            \
+    while (k <= n) {                                                         \
+      if (k * block <= n) {                                                  \
+        SNIFEX_API_PREFETCH(&eytzinger.ptr[k * block - 1]);                  \
+      }                                                                      \
+      k = 2 * k + (less(eytzinger.ptr[k - 1], key) ? 1 : 0);                 \
+    }                                                                        \
+    /* Undo the right turns taken after the last left one */                 \
+    while (k & 1) { k >>= 1; }                                               \
+    k >>= 1;                                                                 \
+    return k == 0 ? n : k - 1;                                               \
+  }                                                                          \
+                                                                             \
+  static inline Vec(t) snifex_api_set_op_##name(const Vec(t) a,              \
+                                                const Vec(t) b,              \
+                                                const size_t cap,            \
+                                                const bool keep_a,           \
+                                                const bool keep_b,           \
+                                                const bool keep_both) {      \
+    Vec(t) out = {                                                           \
+        .ptr = (t*)malloc((cap > 0 ? cap : 1) * sizeof(t)),                  \
+        .cap = cap > 0 ? cap : 1,                                            \
+        .len = 0,                                                            \
+    };                                                                       \
+    assert(out.ptr != NULL);                                                 \
+    size_t i = 0, j = 0;                                                     \
+    while (i < a.len && j < b.len) {                                         \
+      if (less(a.ptr[i], b.ptr[j])) {                                        \
+        if (keep_a) { out.ptr[out.len++] = a.ptr[i]; }                       \
+        i++;                                                                 \
+      } else if (less(b.ptr[j], a.ptr[i])) {                                 \
+        if (keep_b) { out.ptr[out.len++] = b.ptr[j]; }                       \
+        j++;                                                                 \
+      } else {                                                               \
+        if (keep_both) { out.ptr[out.len++] = a.ptr[i]; }                    \
+        i++;                                                                 \
+        j++;                                                                 \
+      }                                                                      \
+    }                                                                        \
+    if (keep_a) {                                                            \
+      for (; i < a.len; i++) { out.ptr[out.len++] = a.ptr[i]; }              \
+    }                                                                        \
+    if (keep_b) {                                                            \
+      for (; j < b.len; j++) { out.ptr[out.len++] = b.ptr[j]; }              \
+    }                                                                        \
+    return out;                                                              \
+  }                                                                          \
+                                                                             \
+  static inline Vec(t) vec_union_##name(const Vec(t) a, const Vec(t) b) {    \
+    return snifex_api_set_op_##name(a, b, a.len + b.len, true, true, true);  \
+  }                                                                          \
+                                                                             \
+  static inline Vec(t) vec_intersection_##name(const Vec(t) a,               \
+                                               const Vec(t) b) {             \
+    return snifex_api_set_op_##name(a, b, a.len < b.len ? a.len : b.len,     \
+                                    false, false, true);                     \
+  }                                                                          \
+                                                                             \
+  static inline Vec(t) vec_difference_##name(const Vec(t) a,                 \
+                                             const Vec(t) b) {               \
+    return snifex_api_set_op_##name(a, b, a.len, true, false, false);        \
+  }
+
+/// @brief Returns the index of the first element of a sorted vector that does
+/// not go before `key`, or `vec.len` if there is none
+///
+/// The binary search is branchless: the comparison only selects the next base
+/// pointer (a conditional move), and both possible next midpoints are
+/// prefetched, so the loop is bound by memory latency instead of branch
+/// mispredictions.
+///
+/// @param name The name of the ordering passed to @ref DefineVecSearch
+/// @param vec The sorted vector
+/// @param key The element to search
+/// @see @ref DefineVecSearch for more info
 /// @hideinitializer
-#define dict_put(k_type, v_type, dict_ptr, k, v, old_value_ptr)                \
-  ({                                                                           \
-    Dict(k_type, v_type)* dp_dict_ptr = (dict_ptr);                            \
-    k_type dp_k = (k);                                                         \
-    v_type dp_v = (v);                                                         \
-    v_type* _old_value_ptr = (old_value_ptr);                                  \
-    uint64_t hasheddp_k =                                                      \
-        hash_num(&dp_k, sizeof(dp_k), dp_dict_ptr->key[0], dp_dict_ptr->[1]);  \
-    Bucket* b = snifex_api_find_bucket(                                        \
-        dp_dict_ptr->buckets, dp_dict_ptr->b_cap, &dp_k, hasheddp_k,           \
-        dp_dict_ptr->entries.ptr, sizeof(*(dp_dict_ptr->entries.ptr)),         \
-        sizeof(dp_dict_ptr->entries.ptr->key), true);                          \
-    if (b->index > 1) {                                                        \
-      Entry(k_type, v_type) * e;                                               \
-      vec_idx(e, Entry(k_type, v_type), dp_dict_ptr->entries, b->index - 2);   \
-      if (_old_value_ptr != NULL) { *_old_value_ptr = e->value; }              \
-      e->value = dp_v;                                                         \
-      true;                                                                    \
-    } else {                                                                   \
-      if (b->index == 0) dp_dict_ptr->b_len++;                                 \
-      b->hash = hasheddp_k;                                                    \
-      b->index = dp_dict_ptr->entries.len + 2;                                 \
-                                                                               \
-      if (dp_dict_ptr->b_len >= dp_dict_ptr->b_cap * 0.75) {                   \
-        snifex_api_dict_grow(&dp_dict_ptr->buckets, &dp_dict_ptr->b_cap,       \
-                             &dp_dict_ptr->b_len);                             \
-      }                                                                        \
-      Entry(k_type, v_type) to_push_entry = {.key = dp_k, .value = dp_v};      \
-      vec_push(Entry(k_type, v_type), (&dp_dict_ptr->entries), to_push_entry); \
-      false;                                                                   \
-    }                                                                          \
-  })
+#define vec_lower_bound(name, vec, key) vec_lower_bound_##name((vec), (key))
+
+/// @brief Returns the index of the first element of a sorted vector that goes
+/// after `key`, or `vec.len` if there is none
+///
+/// @param name The name of the ordering passed to @ref DefineVecSearch
+/// @param vec The sorted vector
+/// @param key The element to search
+/// @see @ref vec_lower_bound for more info
+/// @hideinitializer
+#define vec_upper_bound(name, vec, key) vec_upper_bound_##name((vec), (key))
+
+/// @brief Returns a pointer to an element of a sorted vector equivalent to
+/// `key`, or `NULL` if there is none
+///
+/// @param name The name of the ordering passed to @ref DefineVecSearch
+/// @param vec The sorted vector
+/// @param key The element to search
+/// @see @ref vec_lower_bound for more info
+/// @hideinitializer
+#define vec_bsearch(name, vec, key) vec_bsearch_##name((vec), (key))
+
+/// @brief Returns a new vector with the elements of a sorted vector in
+/// Eytzinger layout
+///
+/// The Eytzinger layout stores a binary search tree in BFS order (like a
+/// binary heap): the first element is the root, and the children of the
+/// element at `k` are at `2k + 1` and `2k + 2`. The first levels of the search
+/// share the same few cache lines, and the descendants a few levels down are
+/// contiguous so they can be prefetched. For very large vectors this is way
+/// faster than a binary search on the sorted layout.
+///
+/// The new vector must be freed with @ref vec_free, and can be searched with
+/// @ref vec_eytzinger_search.
+///
+/// @param name The name of the ordering passed to @ref DefineVecSearch
+/// @param sorted The sorted vector
+/// @hideinitializer
+#define vec_eytzinger(name, sorted) vec_eytzinger_##name(sorted)
+
+/// @brief Returns the index in a vector in Eytzinger layout of the first
+/// element that does not go before `key`, or `eytzinger.len` if there is none
+///
+/// @param name The name of the ordering passed to @ref DefineVecSearch
+/// @param eytzinger The vector returned by @ref vec_eytzinger
+/// @param key The element to search
+/// @see @ref vec_eytzinger for more info
+/// @hideinitializer
+#define vec_eytzinger_search(name, eytzinger, key) \
+  vec_eytzinger_search_##name((eytzinger), (key))
+
+/// @brief Returns a new sorted vector with the union of two sorted vectors
+///
+/// Runs in linear time with a single allocation. Like in C++'s
+/// `std::set_union`, elements equivalent in both vectors are taken once, from
+/// `a`. The new vector must be freed with @ref vec_free.
+///
+/// @param name The name of the ordering passed to @ref DefineVecSearch
+/// @param a The first sorted vector
+/// @param b The second sorted vector
+/// @hideinitializer
+#define vec_union(name, a, b) vec_union_##name((a), (b))
+
+/// @brief Returns a new sorted vector with the elements of `a` that are also
+/// in `b`
+///
+/// @param name The name of the ordering passed to @ref DefineVecSearch
+/// @param a The first sorted vector
+/// @param b The second sorted vector
+/// @see @ref vec_union for more info
+/// @hideinitializer
+#define vec_intersection(name, a, b) vec_intersection_##name((a), (b))
+
+/// @brief Returns a new sorted vector with the elements of `a` that are not in
+/// `b`
+///
+/// @param name The name of the ordering passed to @ref DefineVecSearch
+/// @param a The first sorted vector
+/// @param b The second sorted vector
+/// @see @ref vec_union for more info
+/// @hideinitializer
+#define vec_difference(name, a, b) vec_difference_##name((a), (b))
+
+/// @cond EXCLUDE_DOC
+#define SNIFEX_API_SOA_ALIGN ((uintptr_t)64)
+#define snifex_api_soa_align_up(x) \
+  (((uintptr_t)(x) + SNIFEX_API_SOA_ALIGN - 1) & ~(SNIFEX_API_SOA_ALIGN - 1))
+
+// X-macros applied to each `(field_t, field)` of the field list
+#define SNIFEX_API_SOA_DECLARE(ft, f) ft* f;
+#define SNIFEX_API_SOA_ROW_SIZE(ft, f) +sizeof(ft)
+#define SNIFEX_API_SOA_SIZE(ft, f) \
+  size = snifex_api_soa_align_up(size) + cap * sizeof(ft);
+#define SNIFEX_API_SOA_LAYOUT(ft, f)        \
+  offset = snifex_api_soa_align_up(offset); \
+  out.f = (ft*)(base + offset);             \
+  offset += cap * sizeof(ft);
+#define SNIFEX_API_SOA_MOVE(ft, f) \
+  if (soa->len > 0) { memcpy(out.f, soa->f, soa->len * sizeof(ft)); }
+#define SNIFEX_API_SOA_PUSH(ft, f) soa->f[soa->len] = value.f;
+#define SNIFEX_API_SOA_GET(ft, f) value.f = soa.f[i];
+#define SNIFEX_API_SOA_SET(ft, f) soa->f[i] = value.f;
+#define SNIFEX_API_SOA_SWAP_REMOVE(ft, f) soa->f[i] = soa->f[soa->len];
+/// @endcond
+
+/// @brief Macro to declare a structure-of-arrays vector of `t`s
+///
+/// A @ref Vec(t) stores whole structs one after the other, so a loop reading
+/// a single field still drags all the others through the cache. A
+/// structure-of-arrays vector instead stores each field in its own contiguous
+/// array (a "column"), all sharing the same `len` and `cap`. Loops that only
+/// touch one or two fields of wide structs read just those columns, and can
+/// be vectorized by the compiler.
+///
+/// All the columns live in a single allocation, each one aligned to 64 bytes.
+/// The fields are given as an X-macro: a function-like macro taking another
+/// macro and applying it to each `(field_t, field)` pair. `t` must be a struct
+/// with (at least) those fields. Take a look at this example:
+/// @code
+/// typedef struct {
+///   uint32_t id;
+///   float score;
+///   char name[16];
+/// } Entry;
+///
+/// #define ENTRY_FIELDS(X) X(uint32_t, id) X(float, score)
+/// DefineSoAVec(Entry, ENTRY_FIELDS);
+///
+/// int main() {
+///   SoAVec(Entry) entries = soavec_create(Entry, 16);
+///   Entry entry = {.id = 1, .score = 0.5f};
+///   soavec_push(Entry, &entries, entry);
+///
+///   float total = 0;
+///   for (size_t i = 0; i < entries.len; i++) { total += entries.score[i]; }
+///
+///   soavec_free(&entries);
+///   return 0;
+/// }
+/// @endcode
+///
+/// Each column is a member of the struct, named like the field it stores, so
+/// `entries.score[i]` is the `score` of the `i`th element. Fields not in the
+/// list (like `name` above) are not stored, and are zeroed when reading whole
+/// elements back.
+///
+/// This is a general documentation for the structs generated by this macro:
+/// @code
+/// typedef struct {
+///   field_t* field; // One column for each field in the list
+///   ...
+///   void* buf;      // The single allocation backing all the columns
+///   size_t cap;     // Capacity of the vector
+///   size_t len;     // Actual length of the vector
+/// } SoAVec_t; // Where `t` is any struct type
+/// @endcode
+///
+/// The functions working with a specific `t` are generated alongside the
+/// struct, and called through the `soavec_*` macros.
+///
+/// @param t The struct type of the elements. Must be a single identifier
+/// @param fields The X-macro listing the fields to store
+/// @pre No field is named `buf`, `cap` or `len`
+/// @see - @ref SoAVec
+/// @see - @ref DefineVec
+#define DefineSoAVec(t, fields)                                              \
+  typedef struct {                                                           \
+    fields(SNIFEX_API_SOA_DECLARE)                                           \
+    void* buf;                                                               \
+    size_t cap;                                                              \
+    size_t len;                                                              \
+  } SoAVec_##t;                                                              \
+                                                                             \
+  static inline SoAVec_##t snifex_api_soavec_alloc_##t(const size_t cap) {   \
+    size_t size = 0;                                                         \
+    fields(SNIFEX_API_SOA_SIZE);                                             \
+                                                                             \
+    SoAVec_##t out;                                                          \
+    out.buf = malloc(size + SNIFEX_API_SOA_ALIGN - 1);                       \
+    assert(out.buf != NULL);                                                 \
+    out.cap = cap;                                                           \
+    out.len = 0;                                                             \
+                                                                             \
+    const uintptr_t pad =                                                    \
+        snifex_api_soa_align_up(out.buf) - (uintptr_t)out.buf;               \
+    char* const base = (char*)out.buf + pad;                                 \
+    size_t offset = 0;                                                       \
+    fields(SNIFEX_API_SOA_LAYOUT);                                           \
+    return out;                                                              \
+  }                                                                          \
+                                                                             \
+  static inline SoAVec_##t soavec_create_##t(const size_t init_cap) {        \
+    assert(init_cap > 0);                                                    \
+    return snifex_api_soavec_alloc_##t(init_cap);                            \
+  }                                                                          \
+                                                                             \
+  static inline void soavec_reserve_##t(SoAVec_##t* const soa,               \
+                                        const size_t min_cap) {              \
+    assert(soa != NULL);                                                     \
+    if (min_cap <= soa->cap) { return; }                                     \
+                                                                             \
+    SoAVec_##t out = snifex_api_soavec_alloc_##t(snifex_api_vec_next_cap(    \
+        soa->cap, min_cap, 0 fields(SNIFEX_API_SOA_ROW_SIZE),                \
+        SNIFEX_API_VEC_GROWTH));                                             \
+    fields(SNIFEX_API_SOA_MOVE);                                             \
+    out.len = soa->len;                                                      \
+    free(soa->buf);                                                          \
+    *soa = out;                                                              \
+  }                                                                          \
+                                                                             \
+  static inline void soavec_push_##t(SoAVec_##t* const soa, const t value) { \
+    assert(soa != NULL);                                                     \
+    if (soa->len == soa->cap) { soavec_reserve_##t(soa, soa->len + 1); }     \
+    fields(SNIFEX_API_SOA_PUSH);                                             \
+    soa->len++;                                                              \
+  }                                                                          \
+                                                                             \
+  static inline t soavec_get_##t(const SoAVec_##t soa, const size_t i) {     \
+    assert(i < soa.len);                                                     \
+    t value;                                                                 \
+    memset(&value, 0, sizeof(t));                                            \
+    fields(SNIFEX_API_SOA_GET);                                              \
+    return value;                                                            \
+  }                                                                          \
+                                                                             \
+  static inline void soavec_set_##t(SoAVec_##t* const soa, const size_t i,   \
+                                    const t value) {                         \
+    assert(soa != NULL && i < soa->len);                                     \
+    fields(SNIFEX_API_SOA_SET);                                              \
+  }                                                                          \
+                                                                             \
+  static inline t soavec_swap_remove_##t(SoAVec_##t* const soa,              \
+                                         const size_t i) {                   \
+    assert(soa != NULL && i < soa->len);                                     \
+    const t value = soavec_get_##t(*soa, i);                                 \
+    soa->len--;                                                              \
+    fields(SNIFEX_API_SOA_SWAP_REMOVE);                                      \
+    return value;                                                            \
+  }                                                                          \
+                                                                             \
+  static inline t soavec_pop_##t(SoAVec_##t* const soa) {                    \
+    assert(soa != NULL && soa->len > 0);                                     \
+    const t value = soavec_get_##t(*soa, soa->len - 1);                      \
+    soa->len--;                                                              \
+    return value;                                                            \
+  }
+
+/// @brief Macro to get the struct type of a structure-of-arrays vector of
+/// `t`s
+///
+/// @param t The struct type of the elements
+/// @see @ref DefineSoAVec for more info
+#define SoAVec(t) SoAVec_##t
+
+/// @brief Create a structure-of-arrays vector of `t`s with an initial capacity
+/// of `init_cap`
+///
+/// @param t The struct type of the elements
+/// @param init_cap The initial capacity of the vector
+/// @hideinitializer
+#define soavec_create(t, init_cap) soavec_create_##t(init_cap)
+
+/// @brief Get pointer to a field of an element of a structure-of-arrays
+/// vector
+///
+/// @param soa The vector we're indexing. It's evaluated more than once
+/// @param field The name of the field (and of its column)
+/// @param i The index of the element. It's evaluated more than once
+/// @return Pointer to the field, inside its column
+/// @pre `i < soa.len`
+/// @hideinitializer
+#define soavec_idx(soa, field, i) \
+  (assert((i) < (soa).len), &(soa).field[i])
+
+/// @brief Gathers the element at index `i` from all the columns
+///
+/// @param t The struct type of the elements
+/// @param soa The vector we're indexing
+/// @param i The index of the element
+/// @return The element, by value
+/// @pre `i < soa.len`
+/// @hideinitializer
+#define soavec_get(t, soa, i) soavec_get_##t((soa), (i))
+
+/// @brief Scatters `value` into all the columns at index `i`
+///
+/// @param t The struct type of the elements
+/// @param soa_ptr Pointer to the vector
+/// @param i The index of the element
+/// @param value The new element
+/// @pre `i < soa_ptr->len`
+/// @hideinitializer
+#define soavec_set(t, soa_ptr, i, value) soavec_set_##t((soa_ptr), (i), (value))
+
+/// @brief Push an element at the end of a structure-of-arrays vector
+///
+/// When full, all the columns are moved to a bigger allocation, growing
+/// according to @ref SNIFEX_API_VEC_GROWTH.
+///
+/// @param t The struct type of the elements
+/// @param soa_ptr Pointer to the vector
+/// @param value The element to push
+/// @hideinitializer
+#define soavec_push(t, soa_ptr, value) soavec_push_##t((soa_ptr), (value))
+
+/// @brief Removes the last element of a structure-of-arrays vector
+///
+/// @param t The struct type of the elements
+/// @param soa_ptr Pointer to the vector
+/// @return The removed element
+/// @pre `soa_ptr->len > 0`
+/// @hideinitializer
+#define soavec_pop(t, soa_ptr) soavec_pop_##t(soa_ptr)
+
+/// @brief Removes the element at index `i`, replacing it with the last one
+///
+/// Does not preserve the order of the elements, but runs in constant time.
+///
+/// @param t The struct type of the elements
+/// @param soa_ptr Pointer to the vector
+/// @param i The index of the element to remove
+/// @return The removed element
+/// @pre `i < soa_ptr->len`
+/// @hideinitializer
+#define soavec_swap_remove(t, soa_ptr, i) \
+  soavec_swap_remove_##t((soa_ptr), (i))
+
+/// @brief Makes sure the structure-of-arrays vector can hold at least
+/// `min_cap` elements without growing
+///
+/// @param t The struct type of the elements
+/// @param soa_ptr Pointer to the vector
+/// @param min_cap The minimum capacity
+/// @hideinitializer
+#define soavec_reserve(t, soa_ptr, min_cap) \
+  soavec_reserve_##t((soa_ptr), (min_cap))
+
+/// @brief Removes all the elements of the structure-of-arrays vector, keeping
+/// its allocation
+/// @hideinitializer
+#define soavec_clear(soa_ptr) ((soa_ptr)->len = 0)
+
+/// @brief Frees the structure-of-arrays vector
+/// @hideinitializer
+#define soavec_free(soa_ptr) free((soa_ptr)->buf)
+
+/// @cond EXCLUDE_DOC
+size_t snifex_api_vec_find_uint32_t(const uint32_t* ptr,
+                                    const size_t len,
+                                    const uint32_t x);
+size_t snifex_api_vec_count_uint32_t(const uint32_t* ptr,
+                                     const size_t len,
+                                     const uint32_t x);
+uint32_t snifex_api_vec_min_uint32_t(const uint32_t* ptr, const size_t len);
+uint32_t snifex_api_vec_max_uint32_t(const uint32_t* ptr, const size_t len);
+size_t snifex_api_vec_find_uint64_t(const uint64_t* ptr,
+                                    const size_t len,
+                                    const uint64_t x);
+size_t snifex_api_vec_count_uint64_t(const uint64_t* ptr,
+                                     const size_t len,
+                                     const uint64_t x);
+uint64_t snifex_api_vec_min_uint64_t(const uint64_t* ptr, const size_t len);
+uint64_t snifex_api_vec_max_uint64_t(const uint64_t* ptr, const size_t len);
+size_t snifex_api_vec_find_float(const float* ptr,
+                                 const size_t len,
+                                 const float x);
+size_t snifex_api_vec_count_float(const float* ptr,
+                                  const size_t len,
+                                  const float x);
+float snifex_api_vec_min_float(const float* ptr, const size_t len);
+float snifex_api_vec_max_float(const float* ptr, const size_t len);
+/// @endcond
+
+#ifdef SNIFEX_API_GNU_EXTENSIONS
+/// @cond EXCLUDE_DOC
+// Picks at compile time the SIMD kernel for the element type `T`, or evaluates
+// `fallback` for any other type. The arguments of the kernels that are not
+// picked still have to type-check, hence the `(U)0`
+#define snifex_api_simd_as(T, U, x) \
+  __builtin_choose_expr(__builtin_types_compatible_p(T, U), (x), (U)0)
+#define snifex_api_simd_scan(op, T, ptr, len, x, fallback)                    \
+  __builtin_choose_expr(                                                      \
+      __builtin_types_compatible_p(T, uint32_t),                              \
+      snifex_api_vec_##op##_uint32_t(ptr, len,                                \
+                                     snifex_api_simd_as(T, uint32_t, x)),     \
+      __builtin_choose_expr(                                                  \
+          __builtin_types_compatible_p(T, uint64_t),                          \
+          snifex_api_vec_##op##_uint64_t(ptr, len,                            \
+                                         snifex_api_simd_as(T, uint64_t, x)), \
+          __builtin_choose_expr(                                              \
+              __builtin_types_compatible_p(T, float),                         \
+              snifex_api_vec_##op##_float(ptr, len,                           \
+                                          snifex_api_simd_as(T, float, x)),   \
+              fallback)))
+#define snifex_api_simd_reduce(op, T, ptr, len, fallback)               \
+  __builtin_choose_expr(                                                \
+      __builtin_types_compatible_p(T, uint32_t),                        \
+      snifex_api_vec_##op##_uint32_t(ptr, len),                         \
+      __builtin_choose_expr(                                            \
+          __builtin_types_compatible_p(T, uint64_t),                    \
+          snifex_api_vec_##op##_uint64_t(ptr, len),                     \
+          __builtin_choose_expr(__builtin_types_compatible_p(T, float), \
+                                snifex_api_vec_##op##_float(ptr, len),  \
+                                fallback)))
+/// @endcond
+
+/// @brief Returns the index of the first element of the vector equal to `x`,
+/// or `vec.len` if there is none
+///
+/// For vectors of `uint32_t`, `uint64_t` and `float` the scan is vectorized:
+/// on x86-64 it uses AVX2 when the CPU supports it (checked at runtime) and
+/// SSE2 otherwise, comparing 16 to 32 elements per iteration. Every other
+/// type, and every other platform, falls back to a scalar loop using `==`.
+/// Define `SNIFEX_API_NO_SIMD` before including the implementation to always
+/// use the scalar loops.
+///
+/// @param vec The vector we're searching
+/// @param x The element to search
+/// @return The index of the element
+/// @hideinitializer
+#define vec_find(vec, x)                                                 \
+  ({                                                                     \
+    __typeof(vec) vecf_vec = (vec);                                      \
+    const __typeof(*vecf_vec.ptr) vecf_x = (x);                          \
+    const void* vecf_ptr = vecf_vec.ptr;                                 \
+    snifex_api_simd_scan(find, __typeof(vecf_x), vecf_ptr, vecf_vec.len, \
+                         vecf_x, ({                                      \
+                           size_t vecf_i = 0;                            \
+                           while (vecf_i < vecf_vec.len &&               \
+                                  !(vecf_vec.ptr[vecf_i] == vecf_x)) {   \
+                             vecf_i++;                                   \
+                           }                                             \
+                           vecf_i;                                       \
+                         }));                                            \
+  })
+
+/// @brief Returns the number of elements of the vector equal to `x`
+///
+/// @param vec The vector we're searching
+/// @param x The element to count
+/// @return The number of elements
+/// @see @ref vec_find for more info
+/// @hideinitializer
+#define vec_count(vec, x)                                                    \
+  ({                                                                         \
+    __typeof(vec) vecco_vec = (vec);                                         \
+    const __typeof(*vecco_vec.ptr) vecco_x = (x);                            \
+    const void* vecco_ptr = vecco_vec.ptr;                                   \
+    snifex_api_simd_scan(count, __typeof(vecco_x), vecco_ptr, vecco_vec.len, \
+                         vecco_x, ({                                         \
+                           size_t vecco_count = 0;                           \
+                           for (size_t i = 0; i < vecco_vec.len; i++) {      \
+                             vecco_count += vecco_vec.ptr[i] == vecco_x;     \
+                           }                                                 \
+                           vecco_count;                                      \
+                         }));                                                \
+  })
+
+/// @brief Returns the smallest element of the vector
+///
+/// Which `NaN` is returned, or whether one is returned at all, is unspecified
+/// for vectors of `float` containing `NaN`s.
+///
+/// @param vec The vector we're searching
+/// @return The smallest element, by value
+/// @pre `vec.len > 0`
+/// @see @ref vec_find for more info
+/// @hideinitializer
+#define vec_min(vec)                                                       \
+  ({                                                                       \
+    __typeof(vec) vecmin_vec = (vec);                                      \
+    assert(vecmin_vec.len > 0 && vecmin_vec.ptr != NULL);                  \
+    const void* vecmin_ptr = vecmin_vec.ptr;                               \
+    snifex_api_simd_reduce(min, __typeof(*vecmin_vec.ptr), vecmin_ptr,     \
+                           vecmin_vec.len, ({                              \
+                             __typeof(*vecmin_vec.ptr) vecmin_acc =        \
+                                 vecmin_vec.ptr[0];                        \
+                             for (size_t i = 1; i < vecmin_vec.len; i++) { \
+                               if (vecmin_vec.ptr[i] < vecmin_acc) {       \
+                                 vecmin_acc = vecmin_vec.ptr[i];           \
+                               }                                           \
+                             }                                             \
+                             vecmin_acc;                                   \
+                           }));                                            \
+  })
+
+/// @brief Returns the biggest element of the vector
+///
+/// @param vec The vector we're searching
+/// @return The biggest element, by value
+/// @pre `vec.len > 0`
+/// @see @ref vec_min for more info
+/// @hideinitializer
+#define vec_max(vec)                                                       \
+  ({                                                                       \
+    __typeof(vec) vecmax_vec = (vec);                                      \
+    assert(vecmax_vec.len > 0 && vecmax_vec.ptr != NULL);                  \
+    const void* vecmax_ptr = vecmax_vec.ptr;                               \
+    snifex_api_simd_reduce(max, __typeof(*vecmax_vec.ptr), vecmax_ptr,     \
+                           vecmax_vec.len, ({                              \
+                             __typeof(*vecmax_vec.ptr) vecmax_acc =        \
+                                 vecmax_vec.ptr[0];                        \
+                             for (size_t i = 1; i < vecmax_vec.len; i++) { \
+                               if (vecmax_vec.ptr[i] > vecmax_acc) {       \
+                                 vecmax_acc = vecmax_vec.ptr[i];           \
+                               }                                           \
+                             }                                             \
+                             vecmax_acc;                                   \
+                           }));                                            \
+  })
+
+#else  // NON SNIFEX_API_GNU_EXTENSIONS
+
+/// @brief Returns the index of the first element of the vector equal to `x`,
+/// or `vec.len` if there is none
+///
+/// The scan is vectorized: on x86-64 compilers supporting GNU builtins it uses
+/// AVX2 when the CPU supports it (checked at runtime) and SSE2 otherwise,
+/// comparing 16 to 32 elements per iteration. Everywhere else it is a scalar
+/// loop. Define `SNIFEX_API_NO_SIMD` before including the implementation to
+/// always use the scalar loops.
+///
+/// @param lval_result_idx An lvalue of type `size_t` to which the result is
+/// going to be set
+/// @param t The type of the elements in the vector. Must be one of
+/// `uint32_t`, `uint64_t` and `float`
+/// @param vec The vector we're searching
+/// @param x The element to search
+/// @hideinitializer
+#define vec_find(lval_result_idx, t, vec, x)                                  \
+  do {                                                                        \
+    Vec(t) vecf_vec = (vec);                                                  \
+    lval_result_idx = snifex_api_vec_find_##t(vecf_vec.ptr, vecf_vec.len, x); \
+  } while (0)
+
+/// @brief Counts the elements of the vector equal to `x`
+///
+/// @param lval_result_count An lvalue of type `size_t` to which the result is
+/// going to be set
+/// @param t The type of the elements in the vector. Must be one of
+/// `uint32_t`, `uint64_t` and `float`
+/// @param vec The vector we're searching
+/// @param x The element to count
+/// @see @ref vec_find for more info
+/// @hideinitializer
+#define vec_count(lval_result_count, t, vec, x)                    \
+  do {                                                             \
+    Vec(t) vecco_vec = (vec);                                      \
+    lval_result_count =                                            \
+        snifex_api_vec_count_##t(vecco_vec.ptr, vecco_vec.len, x); \
+  } while (0)
+
+/// @brief Finds the smallest element of the vector
+///
+/// Which `NaN` is returned, or whether one is returned at all, is unspecified
+/// for vectors of `float` containing `NaN`s.
+///
+/// @param lval_result_elem An lvalue of type `t` to which the result is going
+/// to be set
+/// @param t The type of the elements in the vector. Must be one of
+/// `uint32_t`, `uint64_t` and `float`
+/// @param vec The vector we're searching
+/// @pre `vec.len > 0`
+/// @see @ref vec_find for more info
+/// @hideinitializer
+#define vec_min(lval_result_elem, t, vec)                                      \
+  do {                                                                         \
+    Vec(t) vecmin_vec = (vec);                                                 \
+    lval_result_elem = snifex_api_vec_min_##t(vecmin_vec.ptr, vecmin_vec.len); \
+  } while (0)
+
+/// @brief Finds the biggest element of the vector
+///
+/// @param lval_result_elem An lvalue of type `t` to which the result is going
+/// to be set
+/// @param t The type of the elements in the vector. Must be one of
+/// `uint32_t`, `uint64_t` and `float`
+/// @param vec The vector we're searching
+/// @pre `vec.len > 0`
+/// @see @ref vec_min for more info
+/// @hideinitializer
+#define vec_max(lval_result_elem, t, vec)                                      \
+  do {                                                                         \
+    Vec(t) vecmax_vec = (vec);                                                 \
+    lval_result_elem = snifex_api_vec_max_##t(vecmax_vec.ptr, vecmax_vec.len); \
+  } while (0)
+#endif
+
+/// @brief Macro to declare a specifically typed deque
+///
+/// A deque is a ring buffer: the elements start at `head` and wrap around the
+/// end of the buffer, so pushing and popping at both ends is `O(1)` instead of
+/// the `O(n)` `memmove` of popping the front of a vector. The capacity is
+/// always a power of two, so indices wrap with a mask instead of a modulo.
+///
+/// Like @ref DefineVec, the metadata is packed with the data, so the buffer
+/// can come from any allocator as long as the deque is not grown past it.
+///
+/// Example:
+/// @code
+/// DefineDeque(int);
+///
+/// int main() {
+///   Deque(int) queue = deque_create(int, 16);
+///   deque_push_back(&queue, 1);
+///   int first = deque_pop_front(&queue);
+///   deque_free(&queue);
+///   return 0;
+/// }
+/// @endcode
+///
+/// This is a general documentation for the structs generated by this macro:
+/// @code
+/// typedef struct {
+///   t* ptr;      // Pointer to the ring buffer
+///   size_t cap;  // Capacity of the deque, always a power of two
+///   size_t head; // Index in the buffer of the first element
+///   size_t len;  // Actual length of the deque
+/// } Deque_t; // Where `t` is any type passed to the macro
+/// @endcode
+///
+/// @param t The type of the elements in the deque
+/// @see - @ref Deque
+/// @see - @ref DefineVec
+#define DefineDeque(t) \
+  typedef struct {     \
+    t* ptr;            \
+    size_t cap;        \
+    size_t head;       \
+    size_t len;        \
+  } Deque_##t
+
+/// @brief Macro to get the struct type of a deque of `t`s
+///
+/// @param t The type of the elements in the deque
+/// @see @ref DefineDeque for more info
+#define Deque(t) Deque_##t
+
+/// @cond EXCLUDE_DOC
+void* snifex_api_deque_grow(void* ptr,
+                            size_t* const cap,
+                            const size_t head,
+                            const size_t len,
+                            const size_t min_cap,
+                            const size_t elem_size);
+/// @endcond
+
+#ifdef SNIFEX_API_GNU_EXTENSIONS
+/// @brief Create a deque of `t`s with an initial capacity of at least
+/// `init_cap`
+///
+/// The capacity is rounded up to a power of two.
+///
+/// @param t The type of the elements in the deque
+/// @param init_cap The minimum initial capacity of the deque
+/// @hideinitializer
+#define deque_create(t, init_cap)                                    \
+  ({                                                                 \
+    const size_t dqc_init_cap = (init_cap);                          \
+    assert(dqc_init_cap > 0);                                        \
+                                                                     \
+    Deque(t) dqc_dq = {.ptr = NULL, .cap = 0, .head = 0, .len = 0};  \
+    dqc_dq.ptr = (t*)snifex_api_deque_grow(NULL, &dqc_dq.cap, 0, 0,  \
+                                           dqc_init_cap, sizeof(t)); \
+    dqc_dq;                                                          \
+  })
+
+/// @brief Get pointer to element of deque at specific index
+///
+/// Index `0` is the front of the deque.
+///
+/// @param dq The deque we're indexing
+/// @param i The index of the element
+/// @return Pointer to the indexed element
+/// @pre `i < dq.len`
+/// @hideinitializer
+#define deque_idx(dq, i)                                   \
+  ({                                                       \
+    __typeof(dq) dqi_dq = (dq);                            \
+    const size_t dqi_i = (i);                              \
+    assert(dqi_i < dqi_dq.len && dqi_dq.ptr != NULL);      \
+    &dqi_dq.ptr[(dqi_dq.head + dqi_i) & (dqi_dq.cap - 1)]; \
+  })
+
+/// @brief Makes sure the deque can hold at least `min_cap` elements without
+/// growing
+///
+/// @param dq_ptr Pointer to the deque
+/// @param min_cap The minimum capacity, rounded up to a power of two
+/// @pre `dq_ptr != NULL`
+/// @hideinitializer
+#define deque_reserve(dq_ptr, min_cap)                         \
+  do {                                                         \
+    __typeof(dq_ptr) dqr_dq_ptr = (dq_ptr);                    \
+    assert(dqr_dq_ptr != NULL);                                \
+    dqr_dq_ptr->ptr = snifex_api_deque_grow(                   \
+        dqr_dq_ptr->ptr, &dqr_dq_ptr->cap, dqr_dq_ptr->head,   \
+        dqr_dq_ptr->len, (min_cap), sizeof(*dqr_dq_ptr->ptr)); \
+  } while (0)
+
+/// @brief Pushes value to the back of the deque
+///
+/// @note
+/// Could trigger reallocation, doubling the capacity
+///
+/// @param dq_ptr Pointer to the deque we're pushing to
+/// @param val Value to push
+/// @pre `val` must be the same type of the deque elements
+/// @pre `dq_ptr != NULL`
+/// @hideinitializer
+#define deque_push_back(dq_ptr, val)                                 \
+  do {                                                               \
+    const __typeof(*(dq_ptr)->ptr) dqpb_val = (val);                 \
+    __typeof(dq_ptr) dqpb_dq_ptr = (dq_ptr);                         \
+    assert(dqpb_dq_ptr != NULL);                                     \
+    if (dqpb_dq_ptr->len == dqpb_dq_ptr->cap) {                      \
+      dqpb_dq_ptr->ptr = snifex_api_deque_grow(                      \
+          dqpb_dq_ptr->ptr, &dqpb_dq_ptr->cap, dqpb_dq_ptr->head,    \
+          dqpb_dq_ptr->len, dqpb_dq_ptr->len + 1, sizeof(dqpb_val)); \
+    }                                                                \
+    dqpb_dq_ptr->ptr[(dqpb_dq_ptr->head + dqpb_dq_ptr->len) &        \
+                     (dqpb_dq_ptr->cap - 1)] = dqpb_val;             \
+    dqpb_dq_ptr->len += 1;                                           \
+  } while (0)
+
+/// @brief Pushes value to the front of the deque
+///
+/// @note
+/// Could trigger reallocation, doubling the capacity
+///
+/// @param dq_ptr Pointer to the deque we're pushing to
+/// @param val Value to push
+/// @pre `val` must be the same type of the deque elements
+/// @pre `dq_ptr != NULL`
+/// @hideinitializer
+#define deque_push_front(dq_ptr, val)                                     \
+  do {                                                                    \
+    const __typeof(*(dq_ptr)->ptr) dqpf_val = (val);                      \
+    __typeof(dq_ptr) dqpf_dq_ptr = (dq_ptr);                              \
+    assert(dqpf_dq_ptr != NULL);                                          \
+    if (dqpf_dq_ptr->len == dqpf_dq_ptr->cap) {                           \
+      dqpf_dq_ptr->ptr = snifex_api_deque_grow(                           \
+          dqpf_dq_ptr->ptr, &dqpf_dq_ptr->cap, dqpf_dq_ptr->head,         \
+          dqpf_dq_ptr->len, dqpf_dq_ptr->len + 1, sizeof(dqpf_val));      \
+    }                                                                     \
+    dqpf_dq_ptr->head = (dqpf_dq_ptr->head - 1) & (dqpf_dq_ptr->cap - 1); \
+    dqpf_dq_ptr->ptr[dqpf_dq_ptr->head] = dqpf_val;                       \
+    dqpf_dq_ptr->len += 1;                                                \
+  } while (0)
+
+/// @brief Removes the element at the back of the deque
+///
+/// @param dq_ptr Pointer to the deque we're popping from
+/// @return The removed element
+/// @pre `dq_ptr != NULL`
+/// @pre `dq_ptr->len > 0`
+/// @hideinitializer
+#define deque_pop_back(dq_ptr)                                      \
+  ({                                                                \
+    __typeof(dq_ptr) dqpopb_dq_ptr = (dq_ptr);                      \
+    assert(dqpopb_dq_ptr != NULL && dqpopb_dq_ptr->len > 0);        \
+    dqpopb_dq_ptr->len -= 1;                                        \
+    dqpopb_dq_ptr->ptr[(dqpopb_dq_ptr->head + dqpopb_dq_ptr->len) & \
+                       (dqpopb_dq_ptr->cap - 1)];                   \
+  })
+
+/// @brief Removes the element at the front of the deque
+///
+/// @param dq_ptr Pointer to the deque we're popping from
+/// @return The removed element
+/// @pre `dq_ptr != NULL`
+/// @pre `dq_ptr->len > 0`
+/// @hideinitializer
+#define deque_pop_front(dq_ptr)                               \
+  ({                                                          \
+    __typeof(dq_ptr) dqpopf_dq_ptr = (dq_ptr);                \
+    assert(dqpopf_dq_ptr != NULL && dqpopf_dq_ptr->len > 0);  \
+    const __typeof(*dqpopf_dq_ptr->ptr) dqpopf_val =          \
+        dqpopf_dq_ptr->ptr[dqpopf_dq_ptr->head];              \
+    dqpopf_dq_ptr->head =                                     \
+        (dqpopf_dq_ptr->head + 1) & (dqpopf_dq_ptr->cap - 1); \
+    dqpopf_dq_ptr->len -= 1;                                  \
+    dqpopf_val;                                               \
+  })
+
+#else  // NON SNIFEX_API_GNU_EXTENSIONS
+
+/// @brief Create a deque of `t`s with an initial capacity of at least
+/// `init_cap`
+///
+/// The capacity is rounded up to a power of two.
+///
+/// @param lval_result_dq An lvalue of type `Deque(t)` to which the result is
+/// going to be set
+/// @param t The type of the elements in the deque
+/// @param init_cap The minimum initial capacity of the deque
+/// @hideinitializer
+#define deque_create(lval_result_dq, t, init_cap)                    \
+  do {                                                               \
+    const size_t dqc_init_cap = (init_cap);                          \
+    assert(dqc_init_cap > 0);                                        \
+                                                                     \
+    Deque(t) dqc_dq = {NULL, 0, 0, 0};                               \
+    dqc_dq.ptr = (t*)snifex_api_deque_grow(NULL, &dqc_dq.cap, 0, 0,  \
+                                           dqc_init_cap, sizeof(t)); \
+    lval_result_dq = dqc_dq;                                         \
+  } while (0)
+
+/// @brief Get pointer to element of deque at specific index
+///
+/// Index `0` is the front of the deque.
+///
+/// @param lval_result_elem_ptr An lvalue of type `t*` to which the result is
+/// going to be set
+/// @param t The type of the elements in the deque
+/// @param dq The deque we're indexing
+/// @param i The index of the element
+/// @pre `i < dq.len`
+/// @hideinitializer
+#define deque_idx(lval_result_elem_ptr, t, dq, i)              \
+  do {                                                         \
+    Deque(t) dqi_dq = (dq);                                    \
+    const size_t dqi_i = (i);                                  \
+    assert(dqi_i < dqi_dq.len && dqi_dq.ptr != NULL);          \
+    lval_result_elem_ptr =                                     \
+        &dqi_dq.ptr[(dqi_dq.head + dqi_i) & (dqi_dq.cap - 1)]; \
+  } while (0)
+
+/// @brief Makes sure the deque can hold at least `min_cap` elements without
+/// growing
+///
+/// @param t The type of the elements in the deque
+/// @param dq_ptr Pointer to the deque
+/// @param min_cap The minimum capacity, rounded up to a power of two
+/// @pre `dq_ptr != NULL`
+/// @hideinitializer
+#define deque_reserve(t, dq_ptr, min_cap)                    \
+  do {                                                       \
+    Deque(t)* dqr_dq_ptr = (dq_ptr);                         \
+    assert(dqr_dq_ptr != NULL);                              \
+    dqr_dq_ptr->ptr = (t*)snifex_api_deque_grow(             \
+        dqr_dq_ptr->ptr, &dqr_dq_ptr->cap, dqr_dq_ptr->head, \
+        dqr_dq_ptr->len, (min_cap), sizeof(t));              \
+  } while (0)
+
+/// @brief Pushes value to the back of the deque
+///
+/// @note
+/// Could trigger reallocation, doubling the capacity
+///
+/// @param t The type of the elements in the deque
+/// @param dq_ptr Pointer to the deque we're pushing to
+/// @param val Value to push
+/// @pre `dq_ptr != NULL`
+/// @hideinitializer
+#define deque_push_back(t, dq_ptr, val)                           \
+  do {                                                            \
+    const t dqpb_val = (val);                                     \
+    Deque(t)* dqpb_dq_ptr = (dq_ptr);                             \
+    assert(dqpb_dq_ptr != NULL);                                  \
+    if (dqpb_dq_ptr->len == dqpb_dq_ptr->cap) {                   \
+      dqpb_dq_ptr->ptr = (t*)snifex_api_deque_grow(               \
+          dqpb_dq_ptr->ptr, &dqpb_dq_ptr->cap, dqpb_dq_ptr->head, \
+          dqpb_dq_ptr->len, dqpb_dq_ptr->len + 1, sizeof(t));     \
+    }                                                             \
+    dqpb_dq_ptr->ptr[(dqpb_dq_ptr->head + dqpb_dq_ptr->len) &     \
+                     (dqpb_dq_ptr->cap - 1)] = dqpb_val;          \
+    dqpb_dq_ptr->len += 1;                                        \
+  } while (0)
+
+/// @brief Pushes value to the front of the deque
+///
+/// @note
+/// Could trigger reallocation, doubling the capacity
+///
+/// @param t The type of the elements in the deque
+/// @param dq_ptr Pointer to the deque we're pushing to
+/// @param val Value to push
+/// @pre `dq_ptr != NULL`
+/// @hideinitializer
+#define deque_push_front(t, dq_ptr, val)                                  \
+  do {                                                                    \
+    const t dqpf_val = (val);                                             \
+    Deque(t)* dqpf_dq_ptr = (dq_ptr);                                     \
+    assert(dqpf_dq_ptr != NULL);                                          \
+    if (dqpf_dq_ptr->len == dqpf_dq_ptr->cap) {                           \
+      dqpf_dq_ptr->ptr = (t*)snifex_api_deque_grow(                       \
+          dqpf_dq_ptr->ptr, &dqpf_dq_ptr->cap, dqpf_dq_ptr->head,         \
+          dqpf_dq_ptr->len, dqpf_dq_ptr->len + 1, sizeof(t));             \
+    }                                                                     \
+    dqpf_dq_ptr->head = (dqpf_dq_ptr->head - 1) & (dqpf_dq_ptr->cap - 1); \
+    dqpf_dq_ptr->ptr[dqpf_dq_ptr->head] = dqpf_val;                       \
+    dqpf_dq_ptr->len += 1;                                                \
+  } while (0)
+
+/// @brief Removes the element at the back of the deque
+///
+/// @param lval_result_elem An lvalue of type `t` to which the removed element
+/// is going to be set
+/// @param t The type of the elements in the deque
+/// @param dq_ptr Pointer to the deque we're popping from
+/// @pre `dq_ptr != NULL`
+/// @pre `dq_ptr->len > 0`
+/// @hideinitializer
+#define deque_pop_back(lval_result_elem, t, dq_ptr)                     \
+  do {                                                                  \
+    Deque(t)* dqpopb_dq_ptr = (dq_ptr);                                 \
+    assert(dqpopb_dq_ptr != NULL && dqpopb_dq_ptr->len > 0);            \
+    dqpopb_dq_ptr->len -= 1;                                            \
+    lval_result_elem =                                                  \
+        dqpopb_dq_ptr->ptr[(dqpopb_dq_ptr->head + dqpopb_dq_ptr->len) & \
+                           (dqpopb_dq_ptr->cap - 1)];                   \
+  } while (0)
+
+/// @brief Removes the element at the front of the deque
+///
+/// @param lval_result_elem An lvalue of type `t` to which the removed element
+/// is going to be set
+/// @param t The type of the elements in the deque
+/// @param dq_ptr Pointer to the deque we're popping from
+/// @pre `dq_ptr != NULL`
+/// @pre `dq_ptr->len > 0`
+/// @hideinitializer
+#define deque_pop_front(lval_result_elem, t, dq_ptr)            \
+  do {                                                          \
+    Deque(t)* dqpopf_dq_ptr = (dq_ptr);                         \
+    assert(dqpopf_dq_ptr != NULL && dqpopf_dq_ptr->len > 0);    \
+    lval_result_elem = dqpopf_dq_ptr->ptr[dqpopf_dq_ptr->head]; \
+    dqpopf_dq_ptr->head =                                       \
+        (dqpopf_dq_ptr->head + 1) & (dqpopf_dq_ptr->cap - 1);   \
+    dqpopf_dq_ptr->len -= 1;                                    \
+  } while (0)
+#endif
+
+/// @brief Get pointer to the first contiguous span of elements of the deque
+///
+/// The elements of a deque are at most in two contiguous spans: from `head` to
+/// the end of the buffer, and then from the start of the buffer. Together with
+/// @ref deque_second_span they give zero-copy access to all the elements in
+/// order, E.G. to build the `iovec`s of a `writev`, after which the written
+/// elements can be dropped with @ref deque_drop_front.
+///
+/// @param dq The deque. It's evaluated more than once
+/// @return Pointer to the front of the deque
+/// @see - @ref deque_first_span_len
+/// @hideinitializer
+#define deque_first_span(dq) (&(dq).ptr[(dq).head])
+
+/// @brief Get the number of elements in the first contiguous span of the deque
+///
+/// @param dq The deque. It's evaluated more than once
+/// @see @ref deque_first_span for more info
+/// @hideinitializer
+#define deque_first_span_len(dq) \
+  ((dq).len < (dq).cap - (dq).head ? (dq).len : (dq).cap - (dq).head)
+
+/// @brief Get pointer to the second contiguous span of elements of the deque,
+/// I.E. the ones that wrapped around the end of the buffer
+///
+/// @param dq The deque. It's evaluated more than once
+/// @see @ref deque_first_span for more info
+/// @hideinitializer
+#define deque_second_span(dq) ((dq).ptr)
+
+/// @brief Get the number of elements in the second contiguous span of the
+/// deque, `0` if the elements do not wrap around
+///
+/// @param dq The deque. It's evaluated more than once
+/// @see @ref deque_first_span for more info
+/// @hideinitializer
+#define deque_second_span_len(dq) ((dq).len - deque_first_span_len(dq))
+
+/// @brief Removes the first `n` elements of the deque in `O(1)`
+///
+/// @param dq_ptr Pointer to the deque. It's evaluated more than once
+/// @param n The number of elements to remove. It's evaluated more than once
+/// @pre `n <= dq_ptr->len`
+/// @hideinitializer
+#define deque_drop_front(dq_ptr, n)                                        \
+  do {                                                                     \
+    assert((dq_ptr) != NULL && (size_t)(n) <= (dq_ptr)->len);              \
+    (dq_ptr)->head = ((dq_ptr)->head + (size_t)(n)) & ((dq_ptr)->cap - 1); \
+    (dq_ptr)->len -= (size_t)(n);                                          \
+  } while (0)
+
+/// @brief Removes all the elements of the deque, keeping its buffer
+/// @hideinitializer
+#define deque_clear(dq_ptr) ((dq_ptr)->head = 0, (dq_ptr)->len = 0)
+
+/// @brief Frees the deque
+/// @hideinitializer
+#define deque_free(dq_ptr) free((dq_ptr)->ptr)
+
+/// @brief Macro to declare the binary heap functions for vectors of `t`s
+///
+/// Same as @ref DefineDaryHeap with `d` equal to 2.
+///
+/// @param t The type of the elements in the vector
+/// @param name The name of the ordering
+/// @param less A function or function-like macro taking two `t` values `a`
+/// and `b` and returning whether `a` goes strictly before `b`
+/// @pre `Vec(t)` was declared with @ref DefineVec
+#define DefineHeap(t, name, less) DefineDaryHeap(t, name, less, 2)
+
+/// @brief Macro to declare the heap (priority queue) functions for vectors of
+/// `t`s, with `d` children per node
+///
+/// The heap is just a @ref Vec(t) whose elements are kept in heap order, so it
+/// can be created, iterated and freed like any other vector. The element at
+/// the top (index `0`) is the one going first according to `less`, so `less`
+/// being `<` gives a min-heap, and `>` a max-heap. Like in
+/// @ref DefineVecSort, the comparison is pasted into the generated code so
+/// that the compiler can inline it.
+///
+/// With `d` equal to 4 the tree is half as deep, and the 4 children of a node
+/// are next to each other in memory, often in the same cache line. Pops do
+/// more comparisons per level but fewer cache misses, which is usually faster
+/// for heaps that do not fit in cache. Take a look at this example:
+/// @code
+/// DefineVec(Timer);
+/// #define deadline_less(a, b) ((a).deadline < (b).deadline)
+/// DefineDaryHeap(Timer, timers, deadline_less, 4);
+///
+/// int main() {
+///   Vec(Timer) queue = ...;
+///   heap_push(timers, &queue, timer);
+///   Timer next = heap_pop(timers, &queue);
+///   return 0;
+/// }
+/// @endcode
+///
+/// The generated functions are `heap_push_name`, `heap_pop_name`,
+/// `heap_peek_name`, `heapify_name` and `heap_top_k_name`, called through the
+/// macros with the same names.
+///
+/// @param t The type of the elements in the vector
+/// @param name The name of the ordering
+/// @param less A function or function-like macro taking two `t` values `a`
+/// and `b` and returning whether `a` goes strictly before `b`
+/// @param d The number of children per node. Must be a constant `>= 2`
+/// @pre `Vec(t)` was declared with @ref DefineVec
+/// @see - @ref heap_push
+#define DefineDaryHeap(t, name, less, d)                                       \
+  /* `worst_first` flips the ordering, used to keep the best k in top_k */     \
+  static inline void snifex_api_heap_sift_up_##name(t* a, size_t i,            \
+                                                    const bool worst_first) {  \
+    const t x = a[i];                                                          \
+    while (i > 0) {                                                            \
+      const size_t parent = (i - 1) / (d);                                     \
+      if (!(worst_first ? less(a[parent], x) : less(x, a[parent]))) { break; } \
+      a[i] = a[parent];                                                        \
+      i = parent;                                                              \
+    }                                                                          \
+    a[i] = x;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline void snifex_api_heap_sift_down_##name(                         \
+      t* a, const size_t n, size_t i, const bool worst_first) {                \
+    const t x = a[i];                                                          \
+    for (;;) {                                                                 \
+      const size_t first = (d) * i + 1;                                        \
+      if (first >= n) { break; }                                               \
+      const size_t last = n - first > (d) ? first + (d) : n;                   \
+      size_t best = first;                                                     \
+      for (size_t c = first + 1; c < last; c++) {                              \
+        if (worst_first ? less(a[best], a[c]) : less(a[c], a[best])) {         \
+          best = c;                                                            \
+        }                                                                      \
+      }                                                                        \
+      if (!(worst_first ? less(x, a[best]) : less(a[best], x))) { break; }     \
+      a[i] = a[best];                                                          \
+      i = best;                                                                \
+    }                                                                          \
+    a[i] = x;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline void heap_push_##name(Vec(t)* const heap, const t val) {       \
+    assert(heap != NULL);                                                      \
+    if (heap->len == heap->cap) {                                              \
+      heap->ptr = (t*)snifex_api_vec_grow(heap->ptr, &heap->cap,               \
+                                          heap->len + 1, sizeof(t),            \
+                                          SNIFEX_API_VEC_GROWTH);              \
+    }                                                                          \
+    heap->ptr[heap->len] = val;                                                \
+    snifex_api_heap_sift_up_##name(heap->ptr, heap->len++, false);             \
+  }                                                                            \
+                                                                               \
+  static inline t heap_pop_##name(Vec(t)* const heap) {                        \
+    assert(heap != NULL && heap->len > 0);                                     \
+    const t top = heap->ptr[0];                                                \
+    heap->ptr[0] = heap->ptr[--heap->len];                                     \
+    if (heap->len > 1) {                                                       \
+      snifex_api_heap_sift_down_##name(heap->ptr, heap->len, 0, false);        \
+    }                                                                          \
+    return top;                                                                \
+  }                                                                            \
+                                                                               \
+  static inline t* heap_peek_##name(const Vec(t) heap) {                       \
+    assert(heap.len > 0 && heap.ptr != NULL);                                  \
+    return &heap.ptr[0];                                                       \
+  }                                                                            \
+                                                                               \
+  static inline void heapify_##name(Vec(t)* const vec) {                       \
+    assert(vec != NULL);                                                       \
+    if (vec->len < 2) { return; }                                              \
+    for (size_t i = (vec->len - 2) / (d) + 1; i-- > 0;) {                      \
+      snifex_api_heap_sift_down_##name(vec->ptr, vec->len, i, false);          \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  static inline Vec(t) heap_top_k_##name(const Vec(t) vec, const size_t k) {   \
+    const size_t n = k < vec.len ? k : vec.len;                                \
+    Vec(t) out = {                                                             \
+        .ptr = (t*)malloc((n > 0 ? n : 1) * sizeof(t)),                        \
+        .cap = n > 0 ? n : 1,                                                  \
+        .len = n,                                                              \
+    };                                                                         \
+    assert(out.ptr != NULL);                                                   \
+    if (n == 0) { return out; }                                                \
+                                                                               \
+    /* The worst of the best `n` seen so far sits at the top */                \
+    memcpy(out.ptr, vec.ptr, n * sizeof(t));                                   \
+    for (size_t i = (n - 1) / (d) + 1; i-- > 0;) {                             \
+      snifex_api_heap_sift_down_##name(out.ptr, n, i, true);                   \
+    }                                                                          \
+    for (size_t i = n; i < vec.len; i++) {                                     \
+      if (less(vec.ptr[i], out.ptr[0])) {                                      \
+        out.ptr[0] = vec.ptr[i];                                               \
+        snifex_api_heap_sift_down_##name(out.ptr, n, 0, true);                 \
+      }                                                                        \
+    }                                                                          \
+    /* Moving the worst to the back one by one leaves them sorted */           \
+    for (size_t end = n - 1; end > 0; end--) {                                 \
+      const t tmp = out.ptr[0];                                                \
+      out.ptr[0] = out.ptr[end];                                               \
+      out.ptr[end] = tmp;                                                      \
+      snifex_api_heap_sift_down_##name(out.ptr, end, 0, true);                 \
+    }                                                                          \
+    return out;                                                                \
+  }
+
+/// @brief Pushes value into the heap
+///
+/// `O(log n)`.
+///
+/// @note
+/// Could trigger reallocation
+///
+/// @param name The name of the ordering passed to @ref DefineDaryHeap
+/// @param heap_ptr Pointer to the vector in heap order
+/// @param val Value to push
+/// @see @ref DefineDaryHeap for more info
+/// @hideinitializer
+#define heap_push(name, heap_ptr, val) heap_push_##name((heap_ptr), (val))
+
+/// @brief Removes the element at the top of the heap
+///
+/// `O(log n)`.
+///
+/// @param name The name of the ordering passed to @ref DefineDaryHeap
+/// @param heap_ptr Pointer to the vector in heap order
+/// @return The removed element, the first one according to the ordering
+/// @pre `heap_ptr->len > 0`
+/// @hideinitializer
+#define heap_pop(name, heap_ptr) heap_pop_##name(heap_ptr)
+
+/// @brief Get pointer to the element at the top of the heap
+///
+/// @param name The name of the ordering passed to @ref DefineDaryHeap
+/// @param heap The vector in heap order
+/// @return Pointer to the first element according to the ordering
+/// @pre `heap.len > 0`
+/// @hideinitializer
+#define heap_peek(name, heap) heap_peek_##name(heap)
+
+/// @brief Puts the elements of a vector in heap order, in place
+///
+/// Bottom-up construction, `O(n)`: faster than pushing the elements one by
+/// one.
+///
+/// @param name The name of the ordering passed to @ref DefineDaryHeap
+/// @param vec_ptr Pointer to the vector
+/// @hideinitializer
+#define heapify(name, vec_ptr) heapify_##name(vec_ptr)
+
+/// @brief Returns a new vector with the first `k` elements of a vector
+/// according to the ordering, sorted
+///
+/// Keeps the best `k` elements seen so far in a heap with the worst of them at
+/// the top, so it runs in `O(n log k)` with a single allocation of `k`
+/// elements, and `vec` is left untouched. The new vector must be freed with
+/// @ref vec_free.
+///
+/// @param name The name of the ordering passed to @ref DefineDaryHeap
+/// @param vec The vector, in any order
+/// @param k The number of elements to select. If bigger than `vec.len`, all
+/// the elements are returned
+/// @hideinitializer
+#define heap_top_k(name, vec, k) heap_top_k_##name((vec), (k))
+
+/// @}
+
+/// @defgroup bitvec Bit vector
+/// @brief Packed bits, with word-level operations and rank/select
+///
+/// A @ref BitVec stores 64 bits per `uint64_t` word, instead of the byte per
+/// bit of a `Vec(uint8_t)`. Bulk operations (and, or, popcount, searching for
+/// the next set bit...) work a whole word at a time, and popcount uses the
+/// hardware instruction when the CPU has it.
+///
+/// Bits past the length in the last word are always kept clear, so whole-word
+/// operations never see garbage.
+///
+/// A @ref BitRank built over a bit vector answers rank (how many ones before a
+/// position) in constant time and select (where is the k-th one) in
+/// logarithmic time, with a 25% space overhead.
+///
+/// All examples are <a
+/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
+/// @{
+
+/// @brief A vector of bits
+///
+/// Either owns its words (see @ref bitvec_create) or borrows them from an
+/// @ref Arena (see @ref bitvec_create_in), in which case it can not grow past
+/// its initial capacity and @ref bitvec_free does nothing.
+typedef struct bit_vec {
+  uint64_t* words;  ///< @brief The bits, bit `i` is bit `i % 64` of word `i /
+                    /// 64`
+  size_t len;       ///< @brief The number of bits
+  size_t cap;       ///< @brief The number of words allocated
+  bool in_arena;    ///< @brief Whether `words` is allocated in an arena
+} BitVec;
+
+/// @brief Rank/select support structure over a @ref BitVec
+///
+/// Built by @ref bitrank_create, it refers to the words of the bit vector: the
+/// bit vector must not change (nor be freed) while it's used.
+typedef struct bit_rank {
+  const uint64_t* words;  ///< @brief The words of the bit vector
+  size_t len;             ///< @brief The number of bits
+  size_t ones;            ///< @brief The number of set bits
+  uint64_t* counts;  ///< @brief Two words per 512 bits: the ones before the
+                     /// block, and 7 9-bit counts of the ones before each
+                     /// word in the block
+  size_t* hints;     ///< @brief Block of every 512th set bit, to narrow down
+                     /// select
+} BitRank;
+
+/// @brief Creates a bit vector of `len` clear bits
+extern BitVec bitvec_create(const size_t len);
+/// @brief Creates a bit vector of `len` clear bits, allocated in `arena`
+/// @pre `arena != NULL`
+extern BitVec bitvec_create_in(Arena* const arena, const size_t len);
+/// @brief Changes the number of bits. New bits are clear
+/// @pre Arena bit vectors can't grow past their capacity
+extern void bitvec_resize(BitVec* const bv, const size_t len);
+/// @brief Appends a bit
+/// @pre Arena bit vectors can't grow past their capacity
+extern void bitvec_push(BitVec* const bv, const bool bit);
+/// @brief Sets (or clears) all the bits
+extern void bitvec_fill(BitVec* const bv, const bool bit);
+/// @brief Frees the bit vector, unless it's allocated in an arena
+extern void bitvec_free(BitVec* const bv);
+
+/// @brief Returns bit `i`
+/// @pre `i < bv->len`
+static inline bool bitvec_test(const BitVec* const bv, const size_t i) {
+  assert(i < bv->len);
+  return (bv->words[i >> 6] >> (i & 63)) & 1;
+}
+/// @brief Sets bit `i` to 1
+/// @pre `i < bv->len`
+static inline void bitvec_set(BitVec* const bv, const size_t i) {
+  assert(i < bv->len);
+  bv->words[i >> 6] |= (uint64_t)1 << (i & 63);
+}
+/// @brief Resets bit `i` to 0, @ref bitvec_fill clears the whole vector
+/// @pre `i < bv->len`
+static inline void bitvec_reset(BitVec* const bv, const size_t i) {
+  assert(i < bv->len);
+  bv->words[i >> 6] &= ~((uint64_t)1 << (i & 63));
+}
+/// @brief Flips bit `i`
+/// @pre `i < bv->len`
+static inline void bitvec_flip(BitVec* const bv, const size_t i) {
+  assert(i < bv->len);
+  bv->words[i >> 6] ^= (uint64_t)1 << (i & 63);
+}
+/// @brief Sets bit `i` to `bit`, without branching
+/// @pre `i < bv->len`
+static inline void bitvec_assign(BitVec* const bv,
+                                 const size_t i,
+                                 const bool bit) {
+  assert(i < bv->len);
+  const uint64_t mask = (uint64_t)1 << (i & 63);
+  bv->words[i >> 6] = (bv->words[i >> 6] & ~mask) | (-(uint64_t)bit & mask);
+}
+
+/// @brief `dst &= src`, bit by bit
+/// @pre `dst->len == src->len`
+extern void bitvec_and(BitVec* const dst, const BitVec* const src);
+/// @brief `dst |= src`, bit by bit
+/// @pre `dst->len == src->len`
+extern void bitvec_or(BitVec* const dst, const BitVec* const src);
+/// @brief `dst ^= src`, bit by bit
+/// @pre `dst->len == src->len`
+extern void bitvec_xor(BitVec* const dst, const BitVec* const src);
+/// @brief `dst &= ~src`, bit by bit: clears in `dst` the bits set in `src`
+/// @pre `dst->len == src->len`
+extern void bitvec_andnot(BitVec* const dst, const BitVec* const src);
+/// @brief Flips all the bits
+extern void bitvec_not(BitVec* const bv);
+
+/// @brief Returns the number of set bits
+extern size_t bitvec_popcount(const BitVec* const bv);
+/// @brief Returns the index of the first set bit at or after `from`, or
+/// `bv->len` if there is none
+extern size_t bitvec_next_set(const BitVec* const bv, const size_t from);
+/// @brief Returns the index of the first clear bit at or after `from`, or
+/// `bv->len` if there is none
+extern size_t bitvec_next_clear(const BitVec* const bv, const size_t from);
+
+/// @brief Builds the rank/select structure of `bv`
+///
+/// One pass over the words. `bv` must not change while the result is used.
+extern BitRank bitrank_create(const BitVec* const bv);
+/// @brief Returns the number of set bits in [0, `i`)
+/// @pre `i <= rank->len`
+extern size_t bitrank_rank1(const BitRank* const rank, const size_t i);
+/// @brief Returns the number of clear bits in [0, `i`)
+/// @pre `i <= rank->len`
+extern size_t bitrank_rank0(const BitRank* const rank, const size_t i);
+/// @brief Returns the index of the set bit with `k` set bits before it, or
+/// `rank->len` if `k >= rank->ones`
+extern size_t bitrank_select1(const BitRank* const rank, const size_t k);
+/// @brief Returns the index of the clear bit with `k` clear bits before it, or
+/// `rank->len` if there are not that many
+extern size_t bitrank_select0(const BitRank* const rank, const size_t k);
+/// @brief Frees the rank/select structure (not the bit vector)
+extern void bitrank_free(BitRank* const rank);
+
+/// @}
+
+/// @defgroup parallel Parallel
+/// @brief Fork-join helpers to split work on vectors across threads
+///
+/// Each call splits the work in contiguous chunks, runs them on the workers of
+/// a shared @ref ThreadPool and returns once all of them are done. The pool is
+/// started by the first call and reused by all the following ones, so a call
+/// costs a few queue operations instead of creating threads. Every worker owns
+/// a scratch @ref Arena that gets reset before each chunk, so that temporaries
+/// (E.G. @ref str_fmt results) do not need `malloc`.
+///
+/// On platforms without threads (neither POSIX nor Windows) or without atomics
+/// (see @ref queue) everything runs on the calling thread.
+///
+/// All examples are <a
+/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
+/// @{
+
+#ifndef SNIFEX_API_PARALLEL_MIN_CHUNK
+/// @brief Minimum number of elements per chunk. Vectors shorter than twice this
+/// are processed on the calling thread only
+#define SNIFEX_API_PARALLEL_MIN_CHUNK 4096
+#endif
+
+#ifndef SNIFEX_API_PARALLEL_SCRATCH_SIZE
+/// @brief Size in bytes of the scratch @ref Arena of each thread
+#define SNIFEX_API_PARALLEL_SCRATCH_SIZE (64 * 1024)
+#endif
+
+/// @brief A chunk of a vector, as passed to the functions given to @ref
+/// vec_parallel_for and @ref vec_parallel_reduce
+typedef struct par_chunk {
+  void* ptr;       ///< @brief Pointer to the first element of the chunk
+  size_t start;    ///< @brief Index in the vector of the first element
+  size_t len;      ///< @brief Number of elements in the chunk
+  size_t index;    ///< @brief Index of the chunk, chunks are ordered
+  Arena* scratch;  ///< @brief Scratch arena of the thread, reset before every
+                   /// chunk. Never `NULL`
+  void* acc;       ///< @brief Partial result of this chunk, only for @ref
+                   /// vec_parallel_reduce (`NULL` otherwise)
+  void* ctx;       ///< @brief Context pointer given by the user
+} ParChunk;
+
+/// @brief Returns the number of threads used by the parallel functions
+///
+/// Unless set with @ref parallel_set_thread_count, it's the number of online
+/// processors
+extern size_t parallel_thread_count(void);
+/// @brief Sets the number of threads used by the parallel functions
+///
+/// `0` goes back to using the number of online processors. If the workers are
+/// already running with a different count, they're stopped and the next call
+/// starts them again.
+///
+/// @warning Must not be called while another thread is inside any parallel
+/// function (@ref parallel_run, `vec_parallel_*`, @ref parallel_shutdown or
+/// this one): stopping the workers frees them under the running call.
+extern void parallel_set_thread_count(const size_t count);
+/// @brief Stops the workers of the parallel functions, the next call starts
+/// them again
+///
+/// Useful before exiting, so that leak checkers see no running threads.
+///
+/// @warning Must not be called while another thread is inside any other
+/// parallel function (@ref parallel_run, `vec_parallel_*` or @ref
+/// parallel_set_thread_count), as it frees the workers they run on.
+extern void parallel_shutdown(void);
+/// @brief Runs `task(ctx, i, scratch)` for every `i` in [0, `n_tasks`) across
+/// the threads and waits for all of them
+///
+/// Tasks are split in contiguous ranges that idle workers steal from each
+/// other. If `n_tasks` is at most @ref parallel_thread_count and no other
+/// parallel call is running, every task gets a thread of its own. The calling
+/// thread waits, or runs other tasks when it is itself a worker. This is the
+/// building block of all the other parallel functions.
+/// @pre `task != NULL`
+extern void parallel_run(const size_t n_tasks,
+                         void (*task)(void* ctx, size_t i, Arena* scratch),
+                         void* ctx);
+
+/// @cond EXCLUDE_DOC
+void snifex_api_vec_parallel_for(void* ptr,
+                                 const size_t len,
+                                 const size_t elem_size,
+                                 void (*fn)(ParChunk chunk),
+                                 void* ctx);
+void snifex_api_vec_parallel_reduce(void* ptr,
+                                    const size_t len,
+                                    const size_t elem_size,
+                                    void* result,
+                                    const size_t result_size,
+                                    void (*fn)(ParChunk chunk),
+                                    void (*combine)(void* result,
+                                                    const void* partial,
+                                                    void* ctx),
+                                    void* ctx);
+void snifex_api_parallel_radix_sort(void* ptr,
+                                    const size_t len,
+                                    const size_t elem_size,
+                                    const size_t key_offset,
+                                    const size_t key_size,
+                                    const uint8_t kind);
+/// @endcond
+
+#ifdef SNIFEX_API_GNU_EXTENSIONS
+/// @brief Calls `fn` on chunks of the vector, in parallel
+///
+/// The function is called once per chunk instead of once per element, so that
+/// the inner loop can be inlined (and vectorized) by the compiler:
+/// @code
+/// void double_all(ParChunk chunk) {
+///   uint32_t* nums = chunk.ptr;
+///   for (size_t i = 0; i < chunk.len; i++) { nums[i] *= 2; }
+/// }
+///
+/// vec_parallel_for(&vector, double_all, NULL);
+/// @endcode
+///
+/// @param vec_ptr Pointer to the vector
+/// @param fn A `void (*)(ParChunk)` called on every chunk
+/// @param ctx A `void*` passed to every call as `chunk.ctx`
+/// @pre `vec_ptr != NULL`
+/// @hideinitializer
+#define vec_parallel_for(vec_ptr, fn, ctx)                                 \
+  do {                                                                     \
+    __typeof(vec_ptr) vecpf_vec_ptr = (vec_ptr);                           \
+    assert(vecpf_vec_ptr != NULL);                                         \
+    snifex_api_vec_parallel_for(vecpf_vec_ptr->ptr, vecpf_vec_ptr->len,    \
+                                sizeof(*vecpf_vec_ptr->ptr), (fn), (ctx)); \
+  } while (0)
+
+/// @brief Reduces the vector to a single value, in parallel
+///
+/// Every chunk gets its own partial result, `chunk.acc`, initialized as a copy
+/// of `*result_ptr` (which must therefore hold the identity of the reduction,
+/// E.G. 0 for a sum). Once all the chunks are done, the partial results are
+/// folded into `*result_ptr` in order with `combine`, so the result is
+/// deterministic as long as `combine` is associative.
+///
+/// @param vec_ptr Pointer to the vector
+/// @param result_ptr Pointer to the result, holding the identity of the
+/// reduction
+/// @param fn A `void (*)(ParChunk)` that reduces a chunk into `chunk.acc`
+/// @param combine A `void (*)(void* result, const void* partial, void* ctx)`
+/// that folds a partial result into the result
+/// @param ctx A `void*` passed to `fn` and `combine`
+/// @pre `vec_ptr != NULL && result_ptr != NULL`
+/// @hideinitializer
+#define vec_parallel_reduce(vec_ptr, result_ptr, fn, combine, ctx)            \
+  do {                                                                        \
+    __typeof(vec_ptr) vecpr_vec_ptr = (vec_ptr);                              \
+    __typeof(result_ptr) vecpr_result_ptr = (result_ptr);                     \
+    assert(vecpr_vec_ptr != NULL && vecpr_result_ptr != NULL);                \
+    snifex_api_vec_parallel_reduce(                                           \
+        vecpr_vec_ptr->ptr, vecpr_vec_ptr->len, sizeof(*vecpr_vec_ptr->ptr),  \
+        vecpr_result_ptr, sizeof(*vecpr_result_ptr), (fn), (combine), (ctx)); \
+  } while (0)
+
+/// @brief Parallel version of @ref vec_radix_sort
+///
+/// Every pass builds per-thread histograms and scatters in parallel. The sort
+/// is stable, and allocates a temporary buffer as big as the vector.
+///
+/// @param vec_ptr Pointer to the vector to sort
+/// @pre `vec_ptr != NULL`
+/// @hideinitializer
+#define vec_parallel_radix_sort(vec_ptr)                               \
+  do {                                                                 \
+    __typeof(vec_ptr) vecprs_vec_ptr = (vec_ptr);                      \
+    assert(vecprs_vec_ptr != NULL);                                    \
+    snifex_api_parallel_radix_sort(                                    \
+        vecprs_vec_ptr->ptr, vecprs_vec_ptr->len,                      \
+        sizeof(*vecprs_vec_ptr->ptr), 0, sizeof(*vecprs_vec_ptr->ptr), \
+        snifex_api_radix_kind(__typeof(*vecprs_vec_ptr->ptr)));        \
+  } while (0)
+
+#else  // NON SNIFEX_API_GNU_EXTENSIONS
+
+/// @brief Calls `fn` on chunks of the vector, in parallel
+///
+/// The function is called once per chunk instead of once per element, so that
+/// the inner loop can be inlined (and vectorized) by the compiler:
+/// @code
+/// void double_all(ParChunk chunk) {
+///   uint32_t* nums = chunk.ptr;
+///   for (size_t i = 0; i < chunk.len; i++) { nums[i] *= 2; }
+/// }
+///
+/// vec_parallel_for(uint32_t, &vector, double_all, NULL);
+/// @endcode
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector
+/// @param fn A `void (*)(ParChunk)` called on every chunk
+/// @param ctx A `void*` passed to every call as `chunk.ctx`
+/// @pre `vec_ptr != NULL`
+/// @hideinitializer
+#define vec_parallel_for(t, vec_ptr, fn, ctx)                           \
+  do {                                                                  \
+    Vec(t)* vecpf_vec_ptr = (vec_ptr);                                  \
+    assert(vecpf_vec_ptr != NULL);                                      \
+    snifex_api_vec_parallel_for(vecpf_vec_ptr->ptr, vecpf_vec_ptr->len, \
+                                sizeof(t), (fn), (ctx));                \
+  } while (0)
+
+/// @brief Reduces the vector to a single value, in parallel
+///
+/// Every chunk gets its own partial result, `chunk.acc`, initialized as a copy
+/// of `*result_ptr` (which must therefore hold the identity of the reduction,
+/// E.G. 0 for a sum). Once all the chunks are done, the partial results are
+/// folded into `*result_ptr` in order with `combine`, so the result is
+/// deterministic as long as `combine` is associative.
+///
+/// @param t The type of the elements in the vector
+/// @param r The type of the result
+/// @param vec_ptr Pointer to the vector
+/// @param result_ptr Pointer to the result, holding the identity of the
+/// reduction
+/// @param fn A `void (*)(ParChunk)` that reduces a chunk into `chunk.acc`
+/// @param combine A `void (*)(void* result, const void* partial, void* ctx)`
+/// that folds a partial result into the result
+/// @param ctx A `void*` passed to `fn` and `combine`
+/// @pre `vec_ptr != NULL && result_ptr != NULL`
+/// @hideinitializer
+#define vec_parallel_reduce(t, r, vec_ptr, result_ptr, fn, combine, ctx)   \
+  do {                                                                     \
+    Vec(t)* vecpr_vec_ptr = (vec_ptr);                                     \
+    r* vecpr_result_ptr = (result_ptr);                                    \
+    assert(vecpr_vec_ptr != NULL && vecpr_result_ptr != NULL);             \
+    snifex_api_vec_parallel_reduce(vecpr_vec_ptr->ptr, vecpr_vec_ptr->len, \
+                                   sizeof(t), vecpr_result_ptr, sizeof(r), \
+                                   (fn), (combine), (ctx));                \
+  } while (0)
+
+/// @brief Parallel version of @ref vec_radix_sort
+///
+/// Every pass builds per-thread histograms and scatters in parallel. The sort
+/// is stable, and allocates a temporary buffer as big as the vector.
+///
+/// @param t The type of the elements in the vector
+/// @param vec_ptr Pointer to the vector to sort
+/// @pre `vec_ptr != NULL`
+/// @hideinitializer
+#define vec_parallel_radix_sort(t, vec_ptr)                                  \
+  do {                                                                       \
+    Vec(t)* vecprs_vec_ptr = (vec_ptr);                                      \
+    assert(vecprs_vec_ptr != NULL);                                          \
+    snifex_api_parallel_radix_sort(vecprs_vec_ptr->ptr, vecprs_vec_ptr->len, \
+                                   sizeof(t), 0, sizeof(t),                  \
+                                   snifex_api_radix_kind(t));                \
+  } while (0)
+#endif
+
+/// @brief Sorts a vector with the ordering `name`, in parallel
+///
+/// Every thread sorts a contiguous run with the same introsort of @ref
+/// vec_sort, then runs are merged pairwise, in parallel, until one is left.
+/// Not stable, and allocates a temporary buffer as big as the vector.
+///
+/// @param name The name of the ordering passed to @ref DefineVecSort
+/// @param vec_ptr Pointer to the vector to sort
+/// @pre `vec_ptr != NULL`
+/// @see @ref DefineVecSort for more info
+/// @hideinitializer
+#define vec_parallel_sort(name, vec_ptr) vec_parallel_sort_##name(vec_ptr)
+
+/// @}
+
+/// @defgroup queue Concurrent queues
+/// @brief Bounded lock-free queues to pass elements between threads
+///
+/// Both queues have a fixed capacity (rounded up to a power of two) allocated
+/// on creation: pushing into a full queue or popping from an empty one fails
+/// right away instead of blocking, so the caller decides whether to spin,
+/// yield or do something else.
+///   - @ref DefineSpscQueue: one producer thread and one consumer thread. Just
+///     two indices, each written by a single thread.
+///   - @ref DefineMpmcQueue: any number of producers and consumers, E.G. an
+///     I/O thread handing requests to a pool of workers.
+///
+/// They use C11 atomics when compiling as C11 or later, and the equivalent
+/// GCC/Clang `__atomic` builtins otherwise. Without either (E.G. MSVC in C99
+/// mode) this group is not available.
+///
+/// All examples are <a
+/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
+/// @{
+
+/// @brief The size in bytes of a cache line
+///
+/// Indices written by different threads are kept this far apart, so that
+/// writing one does not invalidate the cache line of the other (false
+/// sharing).
+#ifndef SNIFEX_API_CACHE_LINE
+#define SNIFEX_API_CACHE_LINE 64
+#endif
+
+#ifdef SNIFEX_API_ATOMICS
+/// @cond EXCLUDE_DOC
+#if defined(SNIFEX_API_C11_ATOMICS)
+#define SNIFEX_API_ATOMIC(T) _Atomic(T)
+#define SNIFEX_API_RELAXED memory_order_relaxed
+#define SNIFEX_API_ACQUIRE memory_order_acquire
+#define SNIFEX_API_RELEASE memory_order_release
+#define SNIFEX_API_ACQ_REL memory_order_acq_rel
+#define SNIFEX_API_SEQ_CST memory_order_seq_cst
+#define snifex_api_atomic_load(ptr, order) atomic_load_explicit(ptr, order)
+#define snifex_api_atomic_store(ptr, val, order) \
+  atomic_store_explicit(ptr, val, order)
+#define snifex_api_atomic_exchange(ptr, val, order) \
+  atomic_exchange_explicit(ptr, val, order)
+#define snifex_api_atomic_cas(ptr, expected_ptr, desired, success, failure)  \
+  atomic_compare_exchange_weak_explicit(ptr, expected_ptr, desired, success, \
+                                        failure)
+#define snifex_api_atomic_fetch_add(ptr, val, order) \
+  atomic_fetch_add_explicit(ptr, val, order)
+#define snifex_api_atomic_fetch_sub(ptr, val, order) \
+  atomic_fetch_sub_explicit(ptr, val, order)
+#else
+#define SNIFEX_API_ATOMIC(T) T
+#define SNIFEX_API_RELAXED __ATOMIC_RELAXED
+#define SNIFEX_API_ACQUIRE __ATOMIC_ACQUIRE
+#define SNIFEX_API_RELEASE __ATOMIC_RELEASE
+#define SNIFEX_API_ACQ_REL __ATOMIC_ACQ_REL
+#define SNIFEX_API_SEQ_CST __ATOMIC_SEQ_CST
+#define snifex_api_atomic_load(ptr, order) __atomic_load_n(ptr, order)
+#define snifex_api_atomic_store(ptr, val, order) \
+  __atomic_store_n(ptr, val, order)
+#define snifex_api_atomic_exchange(ptr, val, order) \
+  __atomic_exchange_n(ptr, val, order)
+#define snifex_api_atomic_cas(ptr, expected_ptr, desired, success, failure) \
+  __atomic_compare_exchange_n(ptr, expected_ptr, desired, true, success,    \
+                              failure)
+#define snifex_api_atomic_fetch_add(ptr, val, order) \
+  __atomic_fetch_add(ptr, val, order)
+#define snifex_api_atomic_fetch_sub(ptr, val, order) \
+  __atomic_fetch_sub(ptr, val, order)
+#endif
+
+size_t snifex_api_queue_cap(const size_t min_cap);
+/// @endcond
+
+/// @brief Macro to declare a single-producer single-consumer queue of `t`s
+///
+/// A ring buffer where only the producer writes `tail` and only the consumer
+/// writes `head`, so neither needs a read-modify-write atomic: a push is a
+/// copy and a release store. Each side also caches the last index it read
+/// from the other one, and only reloads it (taking a cache miss) when the
+/// queue looks full or empty.
+///
+/// Example:
+/// @code
+/// DefineSpscQueue(Request);
+///
+/// // Shared between the two threads
+/// SpscQueue(Request) queue = spsc_create(Request, 1024);
+///
+/// // Producer thread
+/// while (!spsc_push(Request, &queue, req)) {}
+///
+/// // Consumer thread
+/// Request req;
+/// if (spsc_pop(Request, &queue, &req)) { ... }
+///
+/// spsc_free(&queue);
+/// @endcode
+///
+/// @param t The type of the elements in the queue. Must be a single
+/// identifier
+/// @see - @ref SpscQueue
+/// @see - @ref DefineMpmcQueue
+#define DefineSpscQueue(t)                                                    \
+  typedef struct {                                                            \
+    /* Written by the consumer */                                             \
+    SNIFEX_API_ATOMIC(size_t) head;                                           \
+    size_t cached_tail;                                                       \
+    char pad_consumer[SNIFEX_API_CACHE_LINE];                                 \
+    /* Written by the producer */                                             \
+    SNIFEX_API_ATOMIC(size_t) tail;                                           \
+    size_t cached_head;                                                       \
+    char pad_producer[SNIFEX_API_CACHE_LINE];                                 \
+    /* Read-only after creation */                                            \
+    t* buf;                                                                   \
+    size_t mask;                                                              \
+  } SpscQueue_##t;                                                            \
+                                                                              \
+  static inline SpscQueue_##t spsc_create_##t(const size_t min_cap) {         \
+    SpscQueue_##t queue;                                                      \
+    memset(&queue, 0, sizeof(queue));                                         \
+    const size_t cap = snifex_api_queue_cap(min_cap);                         \
+    queue.buf = (t*)malloc(cap * sizeof(t));                                  \
+    assert(queue.buf != NULL);                                                \
+    queue.mask = cap - 1;                                                     \
+    snifex_api_atomic_store(&queue.head, 0, SNIFEX_API_RELAXED);              \
+    snifex_api_atomic_store(&queue.tail, 0, SNIFEX_API_RELAXED);              \
+    return queue;                                                             \
+  }                                                                           \
+                                                                              \
+  static inline bool spsc_push_##t(SpscQueue_##t* const queue, const t val) { \
+    const size_t tail =                                                       \
+        snifex_api_atomic_load(&queue->tail, SNIFEX_API_RELAXED);             \
+    if (tail - queue->cached_head > queue->mask) {                            \
+      queue->cached_head =                                                    \
+          snifex_api_atomic_load(&queue->head, SNIFEX_API_ACQUIRE);           \
+      if (tail - queue->cached_head > queue->mask) { return false; }          \
+    }                                                                         \
+    queue->buf[tail & queue->mask] = val;                                     \
+    snifex_api_atomic_store(&queue->tail, tail + 1, SNIFEX_API_RELEASE);      \
+    return true;                                                              \
+  }                                                                           \
+                                                                              \
+  static inline bool spsc_pop_##t(SpscQueue_##t* const queue, t* const out) { \
+    const size_t head =                                                       \
+        snifex_api_atomic_load(&queue->head, SNIFEX_API_RELAXED);             \
+    if (head == queue->cached_tail) {                                         \
+      queue->cached_tail =                                                    \
+          snifex_api_atomic_load(&queue->tail, SNIFEX_API_ACQUIRE);           \
+      if (head == queue->cached_tail) { return false; }                       \
+    }                                                                         \
+    *out = queue->buf[head & queue->mask];                                    \
+    snifex_api_atomic_store(&queue->head, head + 1, SNIFEX_API_RELEASE);      \
+    return true;                                                              \
+  }
+
+/// @brief Macro to get the struct type of a single-producer single-consumer
+/// queue of `t`s
+///
+/// @param t The type of the elements in the queue
+/// @see @ref DefineSpscQueue for more info
+#define SpscQueue(t) SpscQueue_##t
+
+/// @brief Create a single-producer single-consumer queue of `t`s
+///
+/// @param t The type of the elements in the queue
+/// @param min_cap The minimum capacity, rounded up to a power of two
+/// @hideinitializer
+#define spsc_create(t, min_cap) spsc_create_##t(min_cap)
+
+/// @brief Pushes a value into the queue. Must only be called by the producer
+///
+/// @param t The type of the elements in the queue
+/// @param queue_ptr Pointer to the queue
+/// @param val Value to push
+/// @return `false` if the queue was full, and nothing was pushed
+/// @hideinitializer
+#define spsc_push(t, queue_ptr, val) spsc_push_##t((queue_ptr), (val))
+
+/// @brief Pops a value from the queue. Must only be called by the consumer
+///
+/// @param t The type of the elements in the queue
+/// @param queue_ptr Pointer to the queue
+/// @param out_ptr Pointer to where the popped value is going to be written
+/// @return `false` if the queue was empty, and nothing was popped
+/// @hideinitializer
+#define spsc_pop(t, queue_ptr, out_ptr) spsc_pop_##t((queue_ptr), (out_ptr))
+
+/// @brief Frees the queue. No thread must be using it anymore
+/// @hideinitializer
+#define spsc_free(queue_ptr) free((queue_ptr)->buf)
+
+/// @brief Macro to declare a multi-producer multi-consumer queue of `t`s
+///
+/// Dmitry Vyukov's bounded queue: every cell has a sequence number telling
+/// whether it is ready to be written (`seq == pos`) or read
+/// (`seq == pos + 1`) for the current lap around the buffer. Producers and
+/// consumers claim a position with a single compare-and-swap on their own
+/// index, and then publish the cell by storing its next sequence number, so
+/// they never wait on each other unless the queue is full or empty.
+///
+/// Example:
+/// @code
+/// DefineMpmcQueue(Job);
+///
+/// MpmcQueue(Job) jobs = mpmc_create(Job, 4096);
+///
+/// // Any thread
+/// while (!mpmc_push(Job, &jobs, job)) {}
+///
+/// // Any thread
+/// Job job;
+/// if (mpmc_pop(Job, &jobs, &job)) { ... }
+///
+/// mpmc_free(&jobs);
+/// @endcode
+///
+/// @param t The type of the elements in the queue. Must be a single
+/// identifier
+/// @see - @ref MpmcQueue
+/// @see - @ref DefineSpscQueue
+#define DefineMpmcQueue(t)                                                    \
+  typedef struct {                                                            \
+    SNIFEX_API_ATOMIC(size_t) seq;                                            \
+    t val;                                                                    \
+  } SnifexApiMpmcCell_##t;                                                    \
+                                                                              \
+  typedef struct {                                                            \
+    char pad_front[SNIFEX_API_CACHE_LINE];                                    \
+    SNIFEX_API_ATOMIC(size_t) tail; /* Next position to push */               \
+    char pad_tail[SNIFEX_API_CACHE_LINE];                                     \
+    SNIFEX_API_ATOMIC(size_t) head; /* Next position to pop */                \
+    char pad_head[SNIFEX_API_CACHE_LINE];                                     \
+    SnifexApiMpmcCell_##t* cells;                                             \
+    size_t mask;                                                              \
+  } MpmcQueue_##t;                                                            \
+                                                                              \
+  static inline MpmcQueue_##t mpmc_create_##t(const size_t min_cap) {         \
+    MpmcQueue_##t queue;                                                      \
+    memset(&queue, 0, sizeof(queue));                                         \
+    const size_t cap = snifex_api_queue_cap(min_cap);                         \
+    queue.cells =                                                             \
+        (SnifexApiMpmcCell_##t*)malloc(cap * sizeof(SnifexApiMpmcCell_##t));  \
+    assert(queue.cells != NULL);                                              \
+    queue.mask = cap - 1;                                                     \
+    for (size_t i = 0; i < cap; i++) {                                        \
+      snifex_api_atomic_store(&queue.cells[i].seq, i, SNIFEX_API_RELAXED);    \
+    }                                                                         \
+    snifex_api_atomic_store(&queue.head, 0, SNIFEX_API_RELAXED);              \
+    snifex_api_atomic_store(&queue.tail, 0, SNIFEX_API_RELAXED);              \
+    return queue;                                                             \
+  }                                                                           \
+                                                                              \
+  static inline bool mpmc_push_##t(MpmcQueue_##t* const queue, const t val) { \
+    size_t pos = snifex_api_atomic_load(&queue->tail, SNIFEX_API_RELAXED);    \
+    SnifexApiMpmcCell_##t* cell;                                              \
+    for (;;) {                                                                \
+      cell = &queue->cells[pos & queue->mask];                                \
+      const size_t seq =                                                      \
+          snifex_api_atomic_load(&cell->seq, SNIFEX_API_ACQUIRE);             \
+      const intptr_t diff = (intptr_t)seq - (intptr_t)pos;                    \
+      if (diff == 0) {                                                        \
+        /* On failure `pos` gets reloaded with the current tail */            \
+        if (snifex_api_atomic_cas(&queue->tail, &pos, pos + 1,                \
+                                  SNIFEX_API_RELAXED, SNIFEX_API_RELAXED)) {  \
+          break;                                                              \
+        }                                                                     \
+      } else if (diff < 0) {                                                  \
+        return false; /* Full: the cell is still from the previous lap */     \
+      } else {                                                                \
+        pos = snifex_api_atomic_load(&queue->tail, SNIFEX_API_RELAXED);       \
+      }                                                                       \
+    }                                                                         \
+    cell->val = val;                                                          \
+    snifex_api_atomic_store(&cell->seq, pos + 1, SNIFEX_API_RELEASE);         \
+    return true;                                                              \
+  }                                                                           \
+                                                                              \
+  static inline bool mpmc_pop_##t(MpmcQueue_##t* const queue, t* const out) { \
+    size_t pos = snifex_api_atomic_load(&queue->head, SNIFEX_API_RELAXED);    \
+    SnifexApiMpmcCell_##t* cell;                                              \
+    for (;;) {                                                                \
+      cell = &queue->cells[pos & queue->mask];                                \
+      const size_t seq =                                                      \
+          snifex_api_atomic_load(&cell->seq, SNIFEX_API_ACQUIRE);             \
+      const intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);              \
+      if (diff == 0) {                                                        \
+        if (snifex_api_atomic_cas(&queue->head, &pos, pos + 1,                \
+                                  SNIFEX_API_RELAXED, SNIFEX_API_RELAXED)) {  \
+          break;                                                              \
+        }                                                                     \
+      } else if (diff < 0) {                                                  \
+        return false; /* Empty: the cell has not been written yet */          \
+      } else {                                                                \
+        pos = snifex_api_atomic_load(&queue->head, SNIFEX_API_RELAXED);       \
+      }                                                                       \
+    }                                                                         \
+    *out = cell->val;                                                         \
+    /* Ready to be written again in the next lap */                           \
+    snifex_api_atomic_store(&cell->seq, pos + queue->mask + 1,                \
+                            SNIFEX_API_RELEASE);                              \
+    return true;                                                              \
+  }
+
+/// @brief Macro to get the struct type of a multi-producer multi-consumer
+/// queue of `t`s
+///
+/// @param t The type of the elements in the queue
+/// @see @ref DefineMpmcQueue for more info
+#define MpmcQueue(t) MpmcQueue_##t
+
+/// @brief Create a multi-producer multi-consumer queue of `t`s
+///
+/// @param t The type of the elements in the queue
+/// @param min_cap The minimum capacity, rounded up to a power of two
+/// @hideinitializer
+#define mpmc_create(t, min_cap) mpmc_create_##t(min_cap)
+
+/// @brief Pushes a value into the queue. Can be called by any thread
+///
+/// @param t The type of the elements in the queue
+/// @param queue_ptr Pointer to the queue
+/// @param val Value to push
+/// @return `false` if the queue was full, and nothing was pushed
+/// @hideinitializer
+#define mpmc_push(t, queue_ptr, val) mpmc_push_##t((queue_ptr), (val))
+
+/// @brief Pops a value from the queue. Can be called by any thread
+///
+/// @param t The type of the elements in the queue
+/// @param queue_ptr Pointer to the queue
+/// @param out_ptr Pointer to where the popped value is going to be written
+/// @return `false` if the queue was empty, and nothing was popped
+/// @hideinitializer
+#define mpmc_pop(t, queue_ptr, out_ptr) mpmc_pop_##t((queue_ptr), (out_ptr))
+
+/// @brief Frees the queue. No thread must be using it anymore
+/// @hideinitializer
+#define mpmc_free(queue_ptr) free((queue_ptr)->cells)
+#endif  // SNIFEX_API_ATOMICS
+
+/// @}
+
+/// @defgroup thread_pool Thread pool
+/// @brief A persistent pool of worker threads running small tasks
+///
+/// A @ref ThreadPool keeps its workers alive between tasks, and balances the
+/// load dynamically (the @ref parallel functions run on one of them):
+///   - Every worker has its own deque of tasks (Chase-Lev). It pushes and pops
+///     at the bottom without contention, while idle workers steal from the
+///     top of a random victim.
+///   - Tasks submitted from outside the pool go through a global injection
+///     queue, tasks submitted from inside a task go to the deque of the worker
+///     running it.
+///   - Workers with nothing to run or steal park on a condition variable
+///     instead of spinning, and get woken up by the next submit.
+///
+/// Completion is tracked with a @ref WaitGroup. Waiting from inside a task
+/// does not block the worker: it runs other tasks until the group is done, so
+/// tasks can freely spawn and wait for subtasks.
+///
+/// Every worker owns a scratch @ref Arena (of @ref
+/// SNIFEX_API_PARALLEL_SCRATCH_SIZE bytes) that is reset between tasks, so
+/// that temporaries (E.G. @ref str_fmt results) do not need `malloc`.
+///
+/// Needs atomics, just like @ref queue. On platforms without threads the pool
+/// has no workers and every task runs inside @ref thread_pool_submit.
+///
+/// All examples are <a
+/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
+/// @{
+
+#ifdef SNIFEX_API_ATOMICS
+/// @brief A pool of worker threads. Opaque, see @ref thread_pool_create
+typedef struct thread_pool ThreadPool;
+
+/// @brief Counts the tasks of a batch that are not done yet
+///
+/// Create it with @ref wait_group_create, pass it to every @ref
+/// thread_pool_submit of the batch, then @ref thread_pool_wait on it. Must
+/// outlive the wait.
+typedef struct wait_group {
+  SNIFEX_API_ATOMIC(size_t) pending;  ///< @brief Tasks submitted and not done
+} WaitGroup;
+
+/// @brief Creates a pool and starts its workers
+///
+/// @param threads Number of workers, `0` means @ref parallel_thread_count
+extern ThreadPool* thread_pool_create(size_t threads);
+/// @brief Runs the tasks still queued, then stops the workers and frees the
+/// pool
+///
+/// Must not be called from a task of the pool itself.
+extern void thread_pool_free(ThreadPool* const pool);
+/// @brief Returns the number of workers of the pool whose thread is running
+///
+/// It can be lower than asked for if the system refused to create threads,
+/// `0` meaning that tasks run inside @ref thread_pool_submit.
+extern size_t thread_pool_thread_count(const ThreadPool* const pool);
+/// @brief Returns an empty @ref WaitGroup
+extern WaitGroup wait_group_create(void);
+/// @brief Queues `task(ctx, scratch)` to run on one of the workers
+///
+/// Can be called from any thread, tasks of the pool included.
+/// @param wg The wait group to add the task to, or `NULL` if nobody waits for
+/// it (it still runs before @ref thread_pool_free returns)
+/// @pre `task != NULL`
+extern void thread_pool_submit(ThreadPool* const pool,
+                               WaitGroup* const wg,
+                               void (*task)(void* ctx, Arena* scratch),
+                               void* ctx);
+/// @brief Returns once every task added to `wg` is done
+///
+/// Called from a task of the pool, the worker runs other tasks in the
+/// meantime instead of blocking.
+extern void thread_pool_wait(ThreadPool* const pool, WaitGroup* const wg);
+/// @brief Runs `fn(ctx, start, end, scratch)` over [0, `len`) split in ranges
+/// of `grain` indices, and waits for all of them
+///
+/// Ranges are submitted all at once and load-balanced by stealing, so they can
+/// take very different amounts of time. Can be nested inside other tasks.
+/// @param grain Number of indices per range, `0` picks one that gives each
+/// worker a few ranges
+/// @pre `fn != NULL`
+extern void thread_pool_parallel_for(ThreadPool* const pool,
+                                     const size_t len,
+                                     size_t grain,
+                                     void (*fn)(void* ctx,
+                                                size_t start,
+                                                size_t end,
+                                                Arena* scratch),
+                                     void* ctx);
+#endif  // SNIFEX_API_ATOMICS
+
+/// @}
+
+/// @defgroup string String
+/// @brief Just... Strings 🙂
+///
+/// All examples are <a
+/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
+/// @{
+
+/// @brief A sized string view.
+///
+/// This a simple sized string view... Nothing else.
+/// For the uninitiated:
+/// - 'sized' means that we carry the length of the data with the data (the
+/// char*)
+/// - 'view' because the memory is not owned. That means that it is the user
+/// responsibility to manage the memory the string view is pointing to. The
+/// recommended way is using an arena.
+///
+/// @note
+/// These strings are NOT zero tailing (since they're string-views anyways)
+typedef struct string {
+  char* ptr;   ///< Internal string buffer
+  size_t len;  ///< Length of string
+} string;
+
+DefineVec(string);
+
+/// @brief Returns a string literal (char const*) to a @ref string format
+extern string strlit(char const* s);
+/// @brief Allocates a string of length `len` in an arena
+/// @pre `arena != NULL`
+extern string str_alloc(Arena* const arena, const size_t len);
+/// @brief Gets pointer to character at specific index
+///
+/// @pre `i >= 0` (since it's of type `size_t`)
+/// @pre `i < str.len`
+/// @pre `str.ptr != NULL` which should be true if the user did not mess with
+/// the `ptr` directly
+char* str_idx(const string str, const size_t i);
+/// @brief Returns whether the string is empty
+///
+/// An empty @ref string means that either the length is 0 or the internal `ptr`
+/// is NULL
+extern bool str_is_empty(const string str);
+
+/// @brief Returns whether two @ref strings are equal
+///
+/// @par Implementation details
+/// Short-circuing if the length is equal and is 0. This is because memcmp with
+/// NULL pointers is U.B. in c99, even if the number of bytes copied is 0,
+/// and in this library empty strings can have a NULL pointer.
+///
+/// @see @ref str_join for more info
+extern bool str_eq(const string a, const string b);
+
+/// @brief Returns result of concatination of string `b` into `a`
+///
+/// @par Implementation details
+/// If we are not careful we could execute memcpy(ptr, NULL, 0), where ptr is
+/// guaranteed not to be NULL, which is U.B. before c2y. Clang and GCC
+/// apparently handle this gratefully while MSVC does not. So to conform to c99
+/// we check for 0-len before memcpy-ing. This isn't not really a performance
+/// issue in release mode as it should just be optimised out (and gcc/clang with
+/// -O1 surely does)
+///
+/// @pre `arena != NULL`
+/// @see
+/// https://stackoverflow.com/questions/5243012/is-it-guaranteed-to-be-safe-to-perform-memcpy0-0-0
+extern string str_concat(Arena* const arena, const string a, const string b);
+/// @brief Returns copy of a string
+///
+/// If the arena is too full, the copy has a `NULL` `ptr`.
+/// @pre `arena != NULL`
+extern string str_copy(Arena* const arena, const string str);
+/// @brief Joins a list of strings together and returns the returning string
+///
+/// @pre `arena != NULL`
+extern string str_join(Arena* const arena, Vec(string) to_join);
+/// @brief Returns a formatted string
+///
+/// Formats straight into the free space of the arena, so no temporary buffer
+/// is ever allocated. `vsnprintf` also needs room for the terminator, which
+/// stays in the free space and is not counted by the arena. If the string does
+/// not fit, nothing is allocated and `ptr` is `NULL`, while `len` still holds
+/// the formatted length: reset or grow the arena and try again.
+///
+/// @pre `arena != NULL`
+/// @pre `fmt != NULL`
+extern string str_fmt(Arena* const arena, const char* fmt, ...);
+/// @brief Same as @ref str_fmt, but takes a `va_list`
+///
+/// `args` is consumed just like with `vsnprintf`.
+///
+/// @pre `arena != NULL`
+/// @pre `fmt != NULL`
+extern string str_vfmt(Arena* const arena, const char* fmt, va_list args);
+/// @brief Returns a string slice
+///
+/// @pre `start >= 0` (since it's of type `size_t`)
+/// @pre `end >= 0` (since it's of type `size_t`)
+/// @pre `start < str.len`
+/// @pre `end <= str.len`
+/// @pre `start <= end`
+extern string str_slice(const string str, const size_t start, const size_t end);
+/// @brief Returns a trimmed string
+extern string str_trim(const string str);
+
+/// @brief Returns the index of the first `c` in `str`, or `str.len` if there
+/// is none
+///
+/// The searches below are vectorized: on x86-64 they use AVX2 when the CPU
+/// supports it (checked at runtime) and SSE2 otherwise, comparing 16 or 32
+/// bytes per iteration. Substrings are searched by comparing the first and last
+/// byte of the needle on a whole block of positions at once, and only the
+/// positions where both match are checked with `memcmp`. Define
+/// `SNIFEX_API_NO_SIMD` before including the implementation to always use the
+/// scalar loops.
+extern size_t str_find_char(const string str, const char c);
+/// @brief Returns the index of the last `c` in `str`, or `str.len` if there is
+/// none
+/// @see @ref str_find_char for more info
+extern size_t str_rfind_char(const string str, const char c);
+/// @brief Returns the number of occurrences of `c` in `str`
+/// @see @ref str_find_char for more info
+extern size_t str_count_char(const string str, const char c);
+/// @brief Returns the index of the first occurrence of `needle` in `str`, or
+/// `str.len` if there is none
+///
+/// An empty needle is found at index 0.
+/// @see @ref str_find_char for more info
+extern size_t str_find(const string str, const string needle);
+/// @brief Returns the index of the last occurrence of `needle` in `str`, or
+/// `str.len` if there is none
+///
+/// An empty needle is found at index `str.len`.
+/// @see @ref str_find_char for more info
+extern size_t str_rfind(const string str, const string needle);
+/// @brief Returns the number of non-overlapping occurrences of `needle` in
+/// `str`
+/// @pre `needle.len > 0`
+/// @see @ref str_find_char for more info
+extern size_t str_count(const string str, const string needle);
+/// @brief Returns whether `needle` occurs in `str`
+extern bool str_contains(const string str, const string needle);
+/// @brief Returns whether `str` starts with `prefix`
+extern bool str_starts_with(const string str, const string prefix);
+/// @brief Returns whether `str` ends with `suffix`
+extern bool str_ends_with(const string str, const string suffix);
+
+/// @brief An iterator over the pieces of a string between separators
+///
+/// It does not allocate anything: the pieces are views into the original
+/// string. Create it with @ref str_split or @ref str_lines, and get the pieces
+/// with @ref str_split_next.
+typedef struct str_split {
+  string rest;  ///< @brief The part of the string left to split
+  string sep;   ///< @brief The separator
+  bool lines;   ///< @brief Whether it splits lines (see @ref str_lines)
+  bool done;    ///< @brief Whether the last piece was returned already
+} StrSplit;
+
+/// @brief Returns an iterator over the pieces of `str` separated by `sep`
+///
+/// `N` separators always give `N + 1` pieces, so an empty string gives a single
+/// empty piece.
+/// @pre `sep.len > 0`
+extern StrSplit str_split(const string str, const string sep);
+/// @brief Returns an iterator over the lines of `str`
+///
+/// Lines end with `"\n"` or `"\r\n"`, which are not part of the pieces. A
+/// trailing line ending does not start another (empty) line.
+extern StrSplit str_lines(const string str);
+/// @brief Sets `*piece` to the next piece, returning `false` when there is none
+/// @pre `it != NULL`
+/// @pre `piece != NULL`
+extern bool str_split_next(StrSplit* const it, string* const piece);
+
+/// @brief Parses an unsigned decimal integer
+///
+/// The whole string must be the number: no sign, no spaces, no other
+/// characters. Digits are checked and converted 8 at a time.
+/// @return Whether `str` is a number that fits in a `uint64_t`. If so it is
+/// written to `*out`
+/// @pre `out != NULL`
+extern bool str_parse_u64(const string str, uint64_t* const out);
+/// @brief Parses a signed decimal integer, with an optional `+` or `-`
+/// @see @ref str_parse_u64 for more info
+extern bool str_parse_i64(const string str, int64_t* const out);
+/// @brief Parses a decimal floating point number
+///
+/// The accepted syntax is `[+-]digits[.digits][(e|E)[+-]digits]`, where either
+/// the integer or the fractional digits can be missing. `inf` and `nan`, with
+/// an optional sign, are accepted as written by @ref str_from_f64, other
+/// spellings (`INF`, `infinity`) and hexadecimal floats are not. Numbers too
+/// large for a `double` give an infinity.
+///
+/// Numbers with up to 19 significant digits and a small enough exponent (the
+/// vast majority in practice) are converted exactly with a single
+/// multiplication or division. The others go through `strtod` on a bounded
+/// copy on the stack, holding only the significant digits (no decimal point,
+/// so the result doesn't depend on `LC_NUMERIC`). It never allocates.
+/// @pre `out != NULL`
+extern bool str_parse_f64(const string str, double* const out);
+/// @brief Returns the decimal representation of `n`, allocated in `arena`
+/// @pre `arena != NULL`
+extern string str_from_u64(Arena* const arena, const uint64_t n);
+/// @brief Returns the decimal representation of `n`, allocated in `arena`
+/// @pre `arena != NULL`
+extern string str_from_i64(Arena* const arena, const int64_t n);
+/// @brief Returns the shortest representation of `n` that reads back to the
+/// same value, allocated in `arena`
+///
+/// Integers below 10^15 are written without exponent, other numbers like
+/// `printf`'s `%g`, but always with a `.` as decimal point whatever the locale.
+/// Infinities and NaNs are written as `inf`, `-inf` and `nan`.
+/// @pre `arena != NULL`
+extern string str_from_f64(Arena* const arena, const double n);
+
+/// @brief A growing buffer to build a @ref string piece by piece
+///
+/// Appends are amortized O(1): the buffer doubles when full, so nothing that
+/// was already appended gets copied more than a constant number of times
+/// (unlike chaining @ref str_concat). The buffer lives either on the heap or in
+/// an @ref Arena. In an arena it grows in place while it is the last
+/// allocation, and otherwise moves to a bigger block (the old one is wasted).
+///
+/// In an arena, growth stops at the end of the arena. Reserving or appending
+/// more than fits returns `false` and leaves the builder unchanged, like @ref
+/// arena_alloc returning `NULL`. Heap builders always have room.
+typedef struct str_builder {
+  char* buf;     ///< @brief The buffer, `len` bytes of which are used
+  size_t len;    ///< @brief The length of the string built so far
+  size_t cap;    ///< @brief The size of `buf`
+  Arena* arena;  ///< @brief The arena `buf` lives in, `NULL` for the heap
+} StrBuilder;
+
+/// @brief Creates a @ref StrBuilder with its buffer on the heap
+extern StrBuilder str_builder_create(const size_t init_cap);
+/// @brief Creates a @ref StrBuilder with its buffer in `arena`
+///
+/// If `init_cap` bytes don't fit in the arena, the builder starts without a
+/// buffer.
+/// @pre `arena != NULL`
+extern StrBuilder str_builder_create_in(Arena* const arena,
+                                        const size_t init_cap);
+/// @brief Makes room for at least `additional` more bytes
+/// @return Whether there is room, the builder is unchanged otherwise
+/// @pre `sb != NULL`
+extern bool str_builder_reserve(StrBuilder* const sb, const size_t additional);
+/// @brief Appends a string
+/// @return Whether there was room, the builder is unchanged otherwise
+/// @pre `sb != NULL`
+extern bool str_builder_append(StrBuilder* const sb, const string str);
+/// @brief Appends a formatted string, formatting directly into the buffer
+///
+/// `vsnprintf` runs once when the result fits in the spare capacity (in an
+/// arena, also the free space right after the buffer), and once more after
+/// growing when it doesn't.
+/// @return Whether there was room, the builder is unchanged otherwise
+/// @pre `sb != NULL`
+/// @pre `fmt != NULL`
+extern bool str_builder_append_fmt(StrBuilder* const sb, const char* fmt, ...);
+/// @brief Same as @ref str_builder_append_fmt, but takes a `va_list`
+extern bool str_builder_append_vfmt(StrBuilder* const sb,
+                                    const char* fmt,
+                                    va_list args);
+/// @brief Appends an unsigned integer in decimal
+/// @return Whether there was room, the builder is unchanged otherwise
+/// @pre `sb != NULL`
+extern bool str_builder_append_u64(StrBuilder* const sb, const uint64_t n);
+/// @brief Appends a signed integer in decimal
+/// @return Whether there was room, the builder is unchanged otherwise
+/// @pre `sb != NULL`
+extern bool str_builder_append_i64(StrBuilder* const sb, const int64_t n);
+/// @brief Appends a double, like @ref str_from_f64
+/// @return Whether there was room, the builder is unchanged otherwise
+/// @pre `sb != NULL`
+extern bool str_builder_append_f64(StrBuilder* const sb, const double n);
+/// @brief Empties the builder, keeping its buffer
+extern void str_builder_clear(StrBuilder* const sb);
+/// @brief Frees the buffer of a heap builder
+///
+/// Arena builders keep their content (so views stay valid), and give the
+/// unused capacity back to the arena when the buffer is its last allocation.
+extern void str_builder_free(StrBuilder* const sb);
+
+/// @brief Appends a single character
+/// @return Whether there was room, the builder is unchanged otherwise
+/// @pre `sb != NULL`
+static inline bool str_builder_append_char(StrBuilder* const sb, const char c) {
+  if (sb->len == sb->cap && !str_builder_reserve(sb, 1)) { return false; }
+  sb->buf[sb->len++] = c;
+  return true;
+}
+/// @brief Returns the string built so far, without copying it
+///
+/// The view is invalidated by the next append, which could move the buffer.
+static inline string str_builder_view(const StrBuilder* const sb) {
+  return (string){.ptr = sb->buf, .len = sb->len};
+}
+
+/// @}
+
+/// @defgroup utf8 UTF-8
+/// @brief Validating, counting and decoding UTF-8 @ref string "strings"
+///
+/// Everything works on views and allocates nothing. Validation follows RFC
+/// 3629: overlong encodings, surrogates and code points above U+10FFFF are
+/// invalid. On x86-64 CPUs with AVX2 (checked at runtime) validation checks 32
+/// bytes at a time with the lookup tables approach from simdjson (Keiser &
+/// Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"), otherwise
+/// a scalar loop skips ASCII 8 bytes at a time. Define `SNIFEX_API_NO_SIMD`
+/// before including the implementation to always use the scalar loops.
+///
+/// All examples are <a
+/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
+/// @{
+
+/// @brief The code point invalid sequences decode to
+#define UTF8_REPLACEMENT 0xFFFD
+
+/// @brief Returns whether `str` is valid UTF-8
+extern bool str_utf8_valid(const string str);
+/// @brief Returns the number of code points in `str`
+///
+/// It counts the bytes that are not continuation bytes, 16 or 32 at a time.
+/// @pre `str` is valid UTF-8, otherwise the result is meaningless
+extern size_t str_utf8_count(const string str);
+/// @brief Decodes the code point at the start of `str`
+///
+/// @param str The string to decode. It can't be empty
+/// @param cp Where the code point is written. Invalid sequences decode to @ref
+/// UTF8_REPLACEMENT
+/// @return The number of bytes decoded: the length of the sequence, or 1 for
+/// invalid ones
+/// @pre `str.len > 0`
+/// @pre `cp != NULL`
+extern size_t str_utf8_decode(const string str, uint32_t* const cp);
+/// @brief Returns a string without leading and trailing Unicode white space
+///
+/// Unlike @ref str_trim it does not depend on the locale, and also trims
+/// non-ASCII spaces like U+00A0 (no-break space) or U+3000 (ideographic space).
+extern string str_utf8_trim(const string str);
+
+/// @brief An iterator over the code points of a string
+typedef struct utf8_iter {
+  string rest;  ///< @brief The part of the string left to decode
+} Utf8Iter;
+
+/// @brief Returns an iterator over the code points of `str`
+extern Utf8Iter str_utf8_iter(const string str);
+/// @brief Sets `*cp` to the next code point, returning `false` at the end
+///
+/// Each byte of an invalid sequence decodes to @ref UTF8_REPLACEMENT.
+/// @pre `it != NULL`
+/// @pre `cp != NULL`
+extern bool str_utf8_next(Utf8Iter* const it, uint32_t* const cp);
+
+/// @}
+
+/// @defgroup encoding Encoding
+/// @brief Escaping and encoding @ref string "strings" for JSON, URLs, hex and
+/// base64
+///
+/// The results are allocated in an @ref Arena, sized exactly before writing.
+/// When nothing needs escaping, @ref str_json_escape and @ref str_url_encode
+/// return the input view itself, and the decoders do the same when there is
+/// nothing to decode, so no allocation happens at all.
+///
+/// The scans looking for bytes to escape, and hex encoding, check 16 or 32
+/// bytes at a time on x86-64 (AVX2 is checked at runtime). Define
+/// `SNIFEX_API_NO_SIMD` before including the implementation to always use the
+/// scalar loops.
+///
+/// If the arena is too full, encoders return a string with a `NULL` `ptr`,
+/// and decoders return `false`. Whenever a decoder returns `false`, `*out` is
+/// left empty and, if its buffer is still the last allocation, the arena gets
+/// it back.
+///
+/// All examples are <a
+/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
+/// @{
+
+/// @brief Escapes `str` to be put between quotes in JSON
+///
+/// `"`, `\` and control characters are escaped, everything else (UTF-8
+/// included) is kept as is.
+/// @pre `arena != NULL`
+extern string str_json_escape(Arena* const arena, const string str);
+/// @brief Decodes the escape sequences of the content of a JSON string
+///
+/// `\uXXXX` escapes are written as UTF-8, and UTF-16 surrogate pairs are
+/// combined.
+/// @return Whether all the escape sequences are valid
+/// @pre `arena != NULL`
+/// @pre `out != NULL`
+extern bool str_json_unescape(Arena* const arena,
+                              const string str,
+                              string* const out);
+/// @brief Percent-encodes every byte except the unreserved characters of RFC
+/// 3986 (letters, digits, `-`, `.`, `_` and `~`)
+/// @pre `arena != NULL`
+extern string str_url_encode(Arena* const arena, const string str);
+/// @brief Decodes the `%XX` sequences of `str`
+///
+/// `+` is not turned into a space, as in RFC 3986.
+/// @return Whether all the `%` are followed by two hex digits
+/// @pre `arena != NULL`
+/// @pre `out != NULL`
+extern bool str_url_decode(Arena* const arena,
+                           const string str,
+                           string* const out);
+/// @brief Encodes every byte as two lowercase hex digits
+/// @pre `arena != NULL`
+extern string str_hex_encode(Arena* const arena, const string str);
+/// @brief Decodes pairs of hex digits, in either case
+/// @return Whether `str` is made of pairs of hex digits
+/// @pre `arena != NULL`
+/// @pre `out != NULL`
+extern bool str_hex_decode(Arena* const arena,
+                           const string str,
+                           string* const out);
+/// @brief Encodes `str` in base64 (RFC 4648), with padding
+/// @pre `arena != NULL`
+extern string str_base64_encode(Arena* const arena, const string str);
+/// @brief Decodes base64 (RFC 4648), with or without padding
+/// @return Whether `str` is valid base64
+/// @pre `arena != NULL`
+/// @pre `out != NULL`
+extern bool str_base64_decode(Arena* const arena,
+                              const string str,
+                              string* const out);
+
+/// @}
+
+/// @defgroup file Files
+/// @brief Reading and writing files as @ref string "strings"
+///
+/// @ref str_map_file maps a file in memory: nothing is copied and the OS
+/// reads pages only when they are touched, which suits large files read
+/// once. @ref str_read_file reads a file in an @ref Arena with a single
+/// allocation, for when the content must be modified or outlive the file.
+/// For streams, or files too large for the address space, @ref StrReader
+/// reads lines or other records through a fixed buffer. @ref StrWriter
+/// buffers output, and can write large strings without copying them.
+///
+/// These are only available on POSIX systems (`OS_UNIX`), where
+/// `SNIFEX_API_POSIX_IO` is defined.
+///
+/// All examples are <a
+/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
+/// @{
+
+#ifdef SNIFEX_API_POSIX_IO
+/// @brief Maps the regular file at `path` in memory, read-only
+///
+/// On Linux, and wherever `posix_madvise` is declared, the pages are advised
+/// to be read sequentially and ahead of time. Writing through the view is
+/// undefined behaviour. An empty file gives an empty view with a `NULL` `ptr`.
+/// @return Whether the file could be opened and mapped, `out` is set to an
+/// empty view when it couldn't
+/// @pre `path != NULL`
+/// @pre `out != NULL`
+extern bool str_map_file(const char* const path, string* const out);
+/// @brief Unmaps a view returned by @ref str_map_file
+/// @pre `str` is the whole view returned by @ref str_map_file
+extern void str_unmap_file(const string str);
+/// @brief Reads the whole regular file at `path` in `arena`
+///
+/// The allocation is sized by `fstat`, so if the file grows while being read
+/// only its old size is read, and if it shrinks the unused bytes are given
+/// back to the arena (when nothing was allocated after them). Like with
+/// @ref str_map_file, an empty file gives an empty view with a `NULL` `ptr`.
+/// @return Whether the file could be opened and read. If it couldn't, or
+/// the arena is too full, `out` is set to an empty view with a `NULL` `ptr`
+/// @pre `arena != NULL`
+/// @pre `path != NULL`
+/// @pre `out != NULL`
+extern bool str_read_file(Arena* const arena,
+                          const char* const path,
+                          string* const out);
+/// @brief Reads a file descriptor record by record through a reusable buffer
+///
+/// The records are views in the buffer: they're valid until the next read,
+/// and work with the other string functions (e.g. @ref str_trim and
+/// @ref str_slice). To keep one, @ref str_copy it in an @ref Arena.
+/// Delimiters are found with @ref str_find_char, and when the buffer is
+/// refilled only the unfinished record at its end is moved. A record longer
+/// than the buffer makes the buffer double.
+typedef struct str_reader {
+  int fd;        ///< @brief The file descriptor, which is not owned
+  char* buf;     ///< @brief The buffer, on the heap
+  size_t cap;    ///< @brief The size of `buf`
+  size_t start;  ///< @brief Where the bytes not yet returned start in `buf`
+  size_t end;    ///< @brief Where the bytes read from `fd` end in `buf`
+  bool eof;      ///< @brief Whether `fd` has no more bytes to read
+  bool failed;   ///< @brief Whether reading `fd` failed
+} StrReader;
+
+/// @brief Creates a @ref StrReader over `fd` with a `buf_size` bytes buffer
+/// @pre `buf_size > 0`
+extern StrReader str_reader_create(const int fd, const size_t buf_size);
+/// @brief Reads the next record, which ends at `delim` or at the end of file
+///
+/// `delim` is not part of the record. The end of file ends the last record
+/// only if it is not empty, so a trailing `delim` gives no empty record.
+/// @return Whether there was a record. At the end, check `reader->failed` to
+/// know whether it was caused by an error
+/// @pre `reader != NULL`
+/// @pre `record != NULL`
+extern bool str_reader_next(StrReader* const reader,
+                            const char delim,
+                            string* const record);
+/// @brief Reads the next line, without its `\n` or `\r\n`
+///
+/// Like @ref str_lines, there is no empty line after a trailing newline.
+/// @pre `reader != NULL`
+/// @pre `line != NULL`
+extern bool str_reader_next_line(StrReader* const reader, string* const line);
+/// @brief Frees the buffer of `reader`, leaving its file descriptor open
+/// @pre `reader != NULL`
+extern void str_reader_free(StrReader* const reader);
+#ifndef SNIFEX_API_WRITER_IOVS
+/// @brief The number of pending pieces after which a @ref StrWriter flushes
+///
+/// Flushes pass at most `IOV_MAX` of them to each `writev`.
+#define SNIFEX_API_WRITER_IOVS 64
+#endif
+#ifndef SNIFEX_API_WRITER_COPY_MAX
+/// @brief The longest @ref string that @ref str_writer_write_view copies
+/// instead of referencing
+#define SNIFEX_API_WRITER_COPY_MAX 128
+#endif
+
+/// @brief Writes @ref string "strings" to a file descriptor through a buffer
+///
+/// Pending output is a list of pieces, written by `writev` at every flush in
+/// as few calls as the system allows. @ref str_writer_write copies strings in
+/// the buffer, which gets flushed when full. @ref str_writer_write_view
+/// instead only references large strings, so that big payloads reach the file
+/// descriptor without being copied (unlike building them with @ref str_join).
+typedef struct str_writer {
+  int fd;           ///< @brief The file descriptor, which is not owned
+  char* buf;        ///< @brief The buffer, on the heap
+  size_t cap;       ///< @brief The size of `buf`
+  size_t len;       ///< @brief The bytes of `buf` pending
+  size_t iovs_len;  ///< @brief The pieces pending
+  /// @brief The pieces, pointing in `buf` or in referenced strings
+  struct iovec iovs[SNIFEX_API_WRITER_IOVS];
+} StrWriter;
+
+/// @brief Creates a @ref StrWriter over `fd` with a `buf_size` bytes buffer
+/// @pre `buf_size > 0`
+extern StrWriter str_writer_create(const int fd, const size_t buf_size);
+/// @brief Copies `str` in the buffer, flushing first if it doesn't fit
+///
+/// Strings at least as long as the buffer are written right away instead,
+/// together with the pending pieces and without being copied. Since they
+/// aren't copied, what a failed flush left of them is dropped.
+/// @return Whether the flushes it caused, if any, succeeded
+/// @pre `writer != NULL`
+extern bool str_writer_write(StrWriter* const writer, const string str);
+/// @brief Appends `str` without copying it, unless it is no longer than
+/// @ref SNIFEX_API_WRITER_COPY_MAX, in which case it's like
+/// @ref str_writer_write
+///
+/// `str` must stay valid and unchanged until the next flush.
+/// @return Whether the flushes it caused, if any, succeeded
+/// @pre `writer != NULL`
+extern bool str_writer_write_view(StrWriter* const writer, const string str);
+/// @brief Writes everything pending, retrying partial and interrupted writes
+/// @return Whether all of it was written. What wasn't stays pending, for a
+/// later flush to retry
+/// @pre `writer != NULL`
+extern bool str_writer_flush(StrWriter* const writer);
+/// @brief Frees the buffer of `writer`, leaving its file descriptor open
+///
+/// Pending output is not flushed, call @ref str_writer_flush first.
+/// @pre `writer != NULL`
+extern void str_writer_free(StrWriter* const writer);
+#endif  // SNIFEX_API_POSIX_IO
+
+/// @}
+
+/// @defgroup dict Dictionary
+/// @brief General type hashmaps
+///
+/// This implementation of hashmap is somewhat reminiscent of stb-db's one. The
+/// inner workings are the same: an hashmap that uses open addressing (or closed
+/// hashing) where buckets do not cointain the entries them self but contain an
+/// index to a vector where we store entries contigiously.
+/// Of course, since they mimic the generic-like feeling of my @ref Vec, we have
+/// a different way of implementing parametric polymorphism, but the core
+/// hashmap implementation details are pretty much the same.
+/// I also implemented a default very simplistic hashing function, but added a
+/// way for users to use a custom hashing algorithm, and I highly suggest you do
+/// so.
+///
+/// All examples are <a
+/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
+/// @{
+
+/// @cond EXCLUDE_DOC
+typedef struct bucket {
+  uint64_t hash;
+  size_t index;
+} Bucket;
+/// @endcond
+
+/// @brief Macro to get the entry type of a dictionary mapping `K`s to `V`s
+///
+/// @param K Type of keys of the dictionary
+/// @param V Type of values of the dictionary
+/// @see @ref DefineDict for more info
+#define Entry(K, V) Entry_##K##_##V
+/// @brief Macro to get the type of a dictionary mapping `K`s to `V`s
+///
+/// @param K Type of keys of the dictionary
+/// @param V Type of values of the dictionary
+/// @see @ref DefineDict for more info
+#define Dict(K, V) Dictionary_##K##_##V
+/// @brief Macro to get type of vector of entries from a dictionary mapping `K`s
+/// to `V`s
+///
+/// @param K Type of keys of the dictionary
+/// @param V Type of values of the dictionary
+/// @see @ref DefineDict for more info
+#define VecEntry(K, V) Vec_Entry_##K##_##V
+
+/// @brief Macro to declare a specifically typed dictionary
+///
+/// The way I implemented generic dictionary is similar to that of vectors:
+/// by having macros instead of functions.
+///
+/// This macro is the equivalent of @ref DefineVec for dictionaries.
+/// Take a look at this example:
+/// @code
+/// DefineDict(int, float);
+///
+/// int main() {
+///   Dict(int, float) dictionary;
+///   return 0;
+/// }
+/// @endcode
+///
+/// This is a general documentation for the structs generated by this macro:
+/// @code
+/// typedef struct {
+///   K key;
+///   V value;
+/// } Entry_K_V;
+///
+/// typedef struct {
+///   Vec_Entry_K_V entries; /* Vector of all entries in the dictionary. Order
+///                             of entries is not guaranteed to be stable */
+///   uint64_t key[2];       /* This key is used for hashing. When creating a
+///                             dictionary it gets set to {0, 0}.
+///                             It's a uint128_t where the first uint64_t in the
+///                             array is the least significant one.
+///                             Unless your hashing function depends on one
+///                             (which by default it does not), you can ignore
+///                             the key */
+///   ...                    // internal stuff
+/// } Dictionary_K_V; // Where `K` and `V` are the types of keys and values
+/// @endcode
+///
+/// @param t The type of the elements in the vector
+/// @see - @ref DefineVec
+/// @see - @ref Dict
+/// @hideinitializer
+#define DefineDict(K, V)      \
+  typedef struct {            \
+    K key;                    \
+    V value;                  \
+  } Entry(K, V);              \
+                              \
+  DefineVec(Entry_##K##_##V); \
+                              \
+  typedef struct {            \
+    VecEntry(K, V) entries;   \
+    Bucket* buckets;          \
+    size_t b_len;             \
+    size_t b_cap;             \
+    uint64_t key[2];          \
+  } Dict(K, V);
+
+// This is my way of implementing custom hashing algorithms. Honestly just
+// looking at the examples in the repo is the best way to see it in action
+#ifndef HASHFUNC
+#define hash_num(in_ptr, inlen, k0_u64, k1_u64) \
+  (snifex_api_hash_num_func(in_ptr, inlen))
+#endif
+
+/// @cond EXCLUDE_DOC
+uint64_t snifex_api_hash_num_func(const void* in, const size_t inlen);
+
+Bucket* snifex_api_find_bucket(Bucket* buckets,
+                               size_t bucket_cap,
+                               void* key,
+                               uint64_t hashed_key,
+                               void* entries,
+                               size_t entry_size,
+                               size_t key_size,
+                               bool include_tombs);
+void snifex_api_dict_grow(Bucket** buckets,
+                          size_t* bucket_cap,
+                          size_t* bucket_len);
+/// @endcond
+
+#ifdef SNIFEX_API_GNU_EXTENSIONS
+
+/// @brief Create a dictionary of `K`s to `V`s
+///
+/// @par Implementation details
+/// The number of initial buckets is 8
+///
+/// @param K The type of the keys of dictionary's entries
+/// @param V The type of the values of dictionary's entries
+/// @hideinitializer
+#define dict_create(K, V)                    \
+  ((Dict(K, V)){                             \
+      .entries = vec_create(Entry(K, V), 8), \
+      .buckets = calloc(8, sizeof(Bucket)),  \
+      .b_cap = 8,                            \
+      .b_len = 0,                            \
+      .key = {0, 0},                         \
+  })
+
+/// @brief Inserts an entry in the hashmap
+///
+/// @note
+/// Could trigger bucket resizing
+///
+/// @param dict_ptr Pointer to the dictionary
+/// @param k Key of the entry we're inserting
+/// @param v Value of the entry we're inserting
+/// @param old_value_ptr If it's non-null, the value of this pointer will be set
+/// to the old value associated with the key, if there was one. Otherwise
+/// nothing happens.
+/// @hideinitializer
+#define dict_put(dict_ptr, k, v, old_value_ptr)                               \
+  ({                                                                          \
+    __auto_type dp_dict_ptr = (dict_ptr);                                     \
+    __typeof(dp_dict_ptr->entries.ptr->key) dp_k = (k);                       \
+    __typeof(dp_dict_ptr->entries.ptr->value) dp_v = (v);                     \
+    __typeof(&dp_v) _old_value_ptr = (old_value_ptr);                         \
+    uint64_t hasheddp_k =                                                     \
+        hash_num(&dp_k, sizeof(dp_k), dp_dict_ptr->key[0], dp_dict_ptr->[1]); \
+    Bucket* b = snifex_api_find_bucket(                                       \
+        dp_dict_ptr->buckets, dp_dict_ptr->b_cap, &dp_k, hasheddp_k,          \
+        dp_dict_ptr->entries.ptr, sizeof(*(dp_dict_ptr->entries.ptr)),        \
+        sizeof(dp_dict_ptr->entries.ptr->key), true);                         \
+    if (b->index > 1) {                                                       \
+      __auto_type e = vec_idx(dp_dict_ptr->entries, b->index - 2);            \
+      if (_old_value_ptr != NULL) { *_old_value_ptr = e->value; }             \
+      e->value = dp_v;                                                        \
+      true;                                                                   \
+    } else {                                                                  \
+      if (b->index == 0) dp_dict_ptr->b_len++;                                \
+      b->hash = hasheddp_k;                                                   \
+      b->index = dp_dict_ptr->entries.len + 2;                                \
+                                                                              \
+      if (dp_dict_ptr->b_len >= dp_dict_ptr->b_cap * 0.75) {                  \
+        snifex_api_dict_grow(&dp_dict_ptr->buckets, &dp_dict_ptr->b_cap,      \
+                             &dp_dict_ptr->b_len);                            \
+      }                                                                       \
+      __typeof(*dp_dict_ptr->entries.ptr) to_push_entry = {.key = dp_k,       \
+                                                           .value = dp_v};    \
+      vec_push((&dp_dict_ptr->entries), to_push_entry);                       \
+      false;                                                                  \
+    }                                                                         \
+  })
+
+/// @brief Searches key in the dictionary, and returns pointer to the entry if
+/// found
+///
+/// @param dict_ptr Pointer to the dictionary
+/// @param k Key of the entry we're searching
+/// @return `NULL` if there is no entry with associated key, entry pointer
+/// otherwise
+/// @hideinitializer
+#define dict_get(dict_ptr, k)                                            \
+  ({                                                                     \
+    __auto_type dg_dict_ptr = (dict_ptr);                                \
+    __typeof(dg_dict_ptr->entries.ptr->key) dg_k = (k);                  \
+    __typeof(&dg_dict_ptr->entries.ptr->value) res;                      \
+                                                                         \
+    if (dg_dict_ptr->b_len == 0) {                                       \
+      res = NULL;                                                        \
+    } else {                                                             \
+      Bucket* b = snifex_api_find_bucket(                                \
+          dg_dict_ptr->buckets, dg_dict_ptr->b_cap, &dg_k,               \
+          hash_num(&dg_k, sizeof(dg_k), dg_dict_ptr->key[0],             \
+                   dg_dict_ptr->key[1]),                                 \
+          dg_dict_ptr->entries.ptr, sizeof(*(dg_dict_ptr->entries.ptr)), \
+          sizeof(dg_dict_ptr->entries.ptr->key), false);                 \
+      if (b->index == 0) {                                               \
+        res = NULL;                                                      \
+      } else {                                                           \
+        res = &vec_idx(dg_dict_ptr->entries, (b->index - 2))->value;     \
+      }                                                                  \
+    }                                                                    \
+    res;                                                                 \
+  })
+
+/// @brief Deletes entry from a dictionary
+///
+/// @par Implementation details
+/// It uses @ref vec_swap_remove to remove an entry. Because of that it does not
+/// guarantee order of the entry vector
+///
+/// @param dict_ptr Pointer to the dictionary
+/// @param k Key of the entry we're deleting
+/// @return Whether entry with associated key exists and was removed
+/// @hideinitializer
+#define dict_del(dict_ptr, k)                                              \
+  ({                                                                       \
+    __auto_type dd_dict_ptr = (dict_ptr);                                  \
+    __typeof(dd_dict_ptr->entries.ptr->key) dd_k = (k);                    \
+                                                                           \
+    if (dd_dict_ptr->b_len == 0) {                                         \
+      false;                                                               \
+    } else {                                                               \
+      Bucket* b = snifex_api_find_bucket(                                  \
+          dd_dict_ptr->buckets, dd_dict_ptr->b_cap, &dd_k,                 \
+          hash_num(&dd_k, sizeof(dd_k), dd_dict_ptr->key[0],               \
+                   dd_dict_ptr->key[1]),                                   \
+          dd_dict_ptr->entries.ptr, sizeof(*(dd_dict_ptr->entries.ptr)),   \
+          sizeof(dd_dict_ptr->entries.ptr->key), false);                   \
+      if (b->index == 0) {                                                 \
+        false;                                                             \
+      } else {                                                             \
+        __auto_type last_entry = *vec_last(dd_dict_ptr->entries);          \
+        __auto_type le_k = last_entry.key;                                 \
+        Bucket* last_b = snifex_api_find_bucket(                           \
+            dd_dict_ptr->buckets, dd_dict_ptr->b_cap, &le_k,               \
+            hash_num(&le_k, sizeof(le_k), dd_dict_ptr->key[0],             \
+                     dd_dict_ptr->key[1]),                                 \
+            dd_dict_ptr->entries.ptr, sizeof(*(dd_dict_ptr->entries.ptr)), \
+            sizeof(dd_dict_ptr->entries.ptr->key), false);                 \
+        last_b->index = b->index;                                          \
+        /* Remove and place tombstone */                                   \
+        vec_swap_remove(&dd_dict_ptr->entries, last_b->index - 2);         \
+        b->index = 1;                                                      \
+        true;                                                              \
+      }                                                                    \
+    }                                                                      \
+  })
+
+/// @brief Frees the dictionary
+///
+/// @param dict_ptr Pointer to the dictionary
+/// @hideinitializer
+#define dict_free(dict_ptr)               \
+  do {                                    \
+    __auto_type df_dict_ptr = (dict_ptr); \
+    free(df_dict_ptr->buckets);           \
+    vec_free(&df_dict_ptr->entries);      \
+  } while (0)
+
+#else  // !SNIFEX_API_GNU_EXTENSIONS
+
+/// @brief Create a dictionary of `K`s to `V`s
+///
+/// @par Implementation details
+/// The number of initial buckets is 8
+///
+/// @param lval_result_dict An lvalue of type `Dict(K, V)` to which the result
+/// is going to be set
+/// @param K The type of the keys of dictionary's entries
+/// @param V The type of the values of dictionary's entries
+/// @hideinitializer
+#define dict_create(lval_result_dict, K, V)   \
+  do {                                        \
+    Vec(Entry_##K##_##V) e;                   \
+    vec_create(e, Entry(K, V), 8);            \
+    lval_result_dict = (Dict(K, V)){          \
+        .entries = e,                         \
+        .buckets = calloc(8, sizeof(Bucket)), \
+        .b_cap = 8,                           \
+        .b_len = 0,                           \
+        .key = {0, 0},                        \
+    };                                        \
+  } while (0)
+
+/// @brief Inserts an entry in the hashmap
+///
+/// @note
+/// Could trigger bucket resizing
+///
+/// @param dict_ptr Pointer to the dictionary
+/// @param k_type The type of the keys in the dictionary
+/// @param v_type The type of the values in the dictionary
+/// @param k Key of the entry we're inserting
+/// @param v Value of the entry we're inserting
+/// @param old_value_ptr If it's non-null, the value of this pointer will be set
+/// to the old value associated with the key, if there was one. Otherwise
+/// nothing happens.
+/// @hideinitializer
+#define dict_put(k_type, v_type, dict_ptr, k, v, old_value_ptr)                \
+  ({                                                                           \
+    Dict(k_type, v_type)* dp_dict_ptr = (dict_ptr);                            \
+    k_type dp_k = (k);                                                         \
+    v_type dp_v = (v);                                                         \
+    v_type* _old_value_ptr = (old_value_ptr);                                  \
+    uint64_t hasheddp_k =                                                      \
+        hash_num(&dp_k, sizeof(dp_k), dp_dict_ptr->key[0], dp_dict_ptr->[1]);  \
+    Bucket* b = snifex_api_find_bucket(                                        \
+        dp_dict_ptr->buckets, dp_dict_ptr->b_cap, &dp_k, hasheddp_k,           \
+        dp_dict_ptr->entries.ptr, sizeof(*(dp_dict_ptr->entries.ptr)),         \
+        sizeof(dp_dict_ptr->entries.ptr->key), true);                          \
+    if (b->index > 1) {                                                        \
+      Entry(k_type, v_type) * e;                                               \
+      vec_idx(e, Entry(k_type, v_type), dp_dict_ptr->entries, b->index - 2);   \
+      if (_old_value_ptr != NULL) { *_old_value_ptr = e->value; }              \
+      e->value = dp_v;                                                         \
+      true;                                                                    \
+    } else {                                                                   \
+      if (b->index == 0) dp_dict_ptr->b_len++;                                 \
+      b->hash = hasheddp_k;                                                    \
+      b->index = dp_dict_ptr->entries.len + 2;                                 \
+                                                                               \
+      if (dp_dict_ptr->b_len >= dp_dict_ptr->b_cap * 0.75) {                   \
+        snifex_api_dict_grow(&dp_dict_ptr->buckets, &dp_dict_ptr->b_cap,       \
+                             &dp_dict_ptr->b_len);                             \
+      }                                                                        \
+      Entry(k_type, v_type) to_push_entry = {.key = dp_k, .value = dp_v};      \
+      vec_push(Entry(k_type, v_type), (&dp_dict_ptr->entries), to_push_entry); \
+      false;                                                                   \
+    }                                                                          \
+  })
+
+/// @brief Searches key in the dictionary, and returns pointer to the value if
+/// found
+///
+/// @param lval_result_val_ptr An lvalue of type `v_type*` to which the result
+/// is going to be set
+/// @param k_type The type of the keys in the dictionary
+/// @param v_type The type of the values in the dictionary
+/// @param dict_ptr Pointer to the dictionary
+/// @param k Key of the entry we're searching
+/// @hideinitializer
+#define dict_get(lval_result_val_ptr, k_type, v_type, dict_ptr, k)       \
+  do {                                                                   \
+    Dict(k_type, v_type)* dg_dict_ptr = (dict_ptr);                      \
+    k_type dg_k = (k);                                                   \
+                                                                         \
+    if (dg_dict_ptr->b_len == 0) {                                       \
+      lval_result_val_ptr = NULL;                                        \
+    } else {                                                             \
+      Bucket* b = snifex_api_find_bucket(                                \
+          dg_dict_ptr->buckets, dg_dict_ptr->b_cap, &dg_k,               \
+          hash_num(&dg_k, sizeof(dg_k), dg_dict_ptr->key[0],             \
+                   dg_dict_ptr->key[1]),                                 \
+          dg_dict_ptr->entries.ptr, sizeof(*(dg_dict_ptr->entries.ptr)), \
+          sizeof(dg_dict_ptr->entries.ptr->key), false);                 \
+      if (b->index == 0) {                                               \
+        lval_result_val_ptr = NULL;                                      \
+      } else {                                                           \
+        Entry(k_type, v_type) * e;                                       \
+        vec_idx(e, Entry(k_type, v_type), dg_dict_ptr->entries,          \
+                (b->index - 2));                                         \
+        lval_result_val_ptr = &e->value;                                 \
+      }                                                                  \
+    }                                                                    \
+  } while (0)
+
+/// @brief Deletes entry from a dictionary
+///
+/// @par Implementation details
+/// It uses @ref vec_swap_remove to remove an entry. Because of that it does not
+/// guarantee order of the entry vector
+///
+/// @param lval_result_bool An lvalue of type `bool` to which the we set whether
+/// entry with associated key exists and was removed
+/// @param k_type The type of the keys in the dictionary
+/// @param v_type The type of the values in the dictionary
+/// @param dict_ptr Pointer to the dictionary
+/// @param k Key of the entry we're deleting
+/// @hideinitializer
+#define dict_del(lval_result_bool, k_type, v_type, dict_ptr, k)          \
+  ({                                                                     \
+    Dict(k_type, v_type)* dd_dict_ptr = (dict_ptr);                      \
+    k_type dd_k = (k);                                                   \
+                                                                         \
+    if (dd_dict_ptr->b_len == 0) {                                       \
+      lval_result_bool = false;                                          \
+    } else {                                                             \
+      Bucket* b = snifex_api_find_bucket(                                \
+          dd_dict_ptr->buckets, dd_dict_ptr->b_cap, &dd_k,               \
+          hash_num(&dd_k, sizeof(dd_k), dd_dict_ptr->key[0],             \
+                   dd_dict_ptr->key[1]),                                 \
+          dd_dict_ptr->entries.ptr, sizeof(*(dd_dict_ptr->entries.ptr)), \
+          sizeof(dd_dict_ptr->entries.ptr->key), false);                 \
+      if (b->index == 0) {                                               \
+        lval_result_bool = false;                                        \
+      } else {                                                           \
+        /* Remove and place tombstone */                                 \
+        vec_swap_remove(Entry(k_type, v_type), &dd_dict_ptr->entries,    \
+                        b->index - 2);                                   \
+        b->index = 1;                                                    \
+        lval_result_bool = true;                                         \
+      }                                                                  \
+    }                                                                    \
+  })
+
+/// @brief Frees the dictionary
+///
+/// @param k_type The type of the keys in the dictionary
+/// @param v_type The type of the values in the dictionary
+/// @param dict_ptr Pointer to the dictionary
+/// @hideinitializer
+#define dict_free(k_type, v_type, dict_ptr)         \
+  do {                                              \
+    Dict(k_type, v_type)* df_dict_ptr = (dict_ptr); \
+    free(df_dict_ptr->buckets);                     \
+    vec_free(&df_dict_ptr->entries);                \
+  } while (0)
+#endif  // SNIFEX_API_GNU_EXTENSIONS
+
+/// @}
+
+/// @defgroup interner String interner
+/// @brief Unique strings mapped to dense integer IDs
+///
+/// Each distinct string is stored only once, in arenas owned by the interner,
+/// and gets a `uint32_t` ID: the first string gets 0, the next new one 1 and so
+/// on. Comparing interned strings becomes comparing IDs, and IDs make compact
+/// keys for a @ref Dict or indices for a @ref Vec. The views returned by the
+/// interner stay valid until it is freed.
+///
+/// Lookups use the same buckets as @ref Dict (hashed with `hash_num`, so custom
+/// hashing applies too), comparing candidate strings only when their hashes
+/// match.
+///
+/// @ref SyncStrInterner is the same, guarded by a mutex so it can be shared
+/// between threads.
+///
+/// All examples are <a
+/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
+/// @{
+
+#ifndef SNIFEX_API_INTERNER_CHUNK
+/// @brief Size of the arenas in which interned strings are stored
+///
+/// Longer strings get an arena of their own.
+#define SNIFEX_API_INTERNER_CHUNK 65536
+#endif
+
+/// @brief A string interner
+typedef struct str_interner {
+  string* strings;    ///< @brief The interned strings, indexed by ID
+  size_t len;         ///< @brief The number of interned strings
+  size_t cap;         ///< @brief The capacity of `strings`
+  Arena* arenas;      ///< @brief The arenas storing the strings
+  size_t arenas_len;  ///< @brief The number of arenas
+  Bucket* buckets;    ///< @brief Buckets mapping hashes to IDs
+  size_t b_len;       ///< @brief The number of used buckets
+  size_t b_cap;       ///< @brief The number of buckets
+  uint64_t key[2];    ///< @brief The hashing key, see @ref DefineDict
+} StrInterner;
+
+/// @brief A thread-safe @ref StrInterner
+typedef struct sync_str_interner SyncStrInterner;
+
+/// @brief Creates an empty interner
+extern StrInterner str_interner_create(void);
+/// @brief Returns the ID of `str`, interning it if it's new
+///
+/// The bytes of `str` are copied, so `str` does not have to outlive the
+/// interner.
+/// @pre `interner != NULL`
+/// @pre Fewer than `UINT32_MAX` strings interned
+extern uint32_t str_intern(StrInterner* const interner, const string str);
+/// @brief Looks for `str` without interning it
+///
+/// @return Whether `str` is interned. If so, `*id` is set to its ID
+/// @pre `interner != NULL`
+/// @pre `id != NULL`
+extern bool str_interner_find(const StrInterner* const interner,
+                              const string str,
+                              uint32_t* const id);
+/// @brief Frees the interner and all of its strings
+extern void str_interner_free(StrInterner* const interner);
+
+/// @brief Returns the canonical view of the string with ID `id`
+/// @pre `id < interner->len`
+static inline string str_interner_get(const StrInterner* const interner,
+                                      const uint32_t id) {
+  assert(id < interner->len);
+  return interner->strings[id];
+}
+
+/// @brief Creates an empty thread-safe interner
+extern SyncStrInterner* sync_str_interner_create(void);
+/// @brief Same as @ref str_intern
+extern uint32_t sync_str_intern(SyncStrInterner* const interner,
+                                const string str);
+/// @brief Same as @ref str_interner_find
+extern bool sync_str_interner_find(SyncStrInterner* const interner,
+                                   const string str,
+                                   uint32_t* const id);
+/// @brief Same as @ref str_interner_get
+///
+/// The view itself can be used without any locking.
+extern string sync_str_interner_get(SyncStrInterner* const interner,
+                                    const uint32_t id);
+/// @brief Returns the number of interned strings
+extern size_t sync_str_interner_len(SyncStrInterner* const interner);
+/// @brief Frees the interner and all of its strings
+extern void sync_str_interner_free(SyncStrInterner* const interner);
+
+/// @}
+
+/// @defgroup btree B-tree
+/// @brief Sorted maps, with ordered iteration and range queries
+///
+/// A @ref Dict finds a key in `O(1)` but knows nothing about order: listing
+/// the keys between two values means sorting all the entries. A @ref BTree
+/// keeps its keys sorted, so lookups, inserts and deletes are `O(log n)` and
+/// a range query is a lookup followed by a walk over the leaves.
+///
+/// It's a B+ tree: the values are all in the leaves, linked in order, and
+/// the inner nodes only hold keys to find the way down. Nodes are wide (@ref
+/// SNIFEX_API_BTREE_NODE_SIZE bytes, a few cache lines each) so the tree is
+/// shallow and every node visited is a handful of cache misses at most. They
+/// come from a pool owned by the tree: deleted nodes are reused, and freeing
+/// the tree frees a few big chunks instead of every node.
+///
+/// All examples are <a
+/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
+/// @{
+
+#ifndef SNIFEX_API_BTREE_NODE_SIZE
+/// @brief Target size in bytes of the nodes of a @ref BTree
+///
+/// Bigger nodes make a shallower tree but slower inserts and deletes, which
+/// move up to half a node. Nodes hold at least 4 keys whatever the size.
+#define SNIFEX_API_BTREE_NODE_SIZE 256
+#endif
+
+/// @cond EXCLUDE_DOC
+#define SNIFEX_API_BTREE_CAP(entry_size)                \
+  ((SNIFEX_API_BTREE_NODE_SIZE - 16) / (entry_size) < 4 \
+       ? 4                                              \
+       : (SNIFEX_API_BTREE_NODE_SIZE - 16) / (entry_size))
+
+// Fixed-size node allocator: nodes come from big chunks and go back to a free
+// list
+struct snifex_api_node_pool {
+  void* free;
+  void* chunks;
+  size_t node_size;
+};
+
+void* snifex_api_node_pool_alloc(struct snifex_api_node_pool* const pool);
+void snifex_api_node_pool_release(struct snifex_api_node_pool* const pool,
+                                  void* const node);
+void snifex_api_node_pool_free(struct snifex_api_node_pool* const pool);
+/// @endcond
+
+/// @brief Macro to declare a B-tree of `K` keys and `V` values ordered by
+/// `less`
+///
+/// Like @ref DefineDict, `K` and `V` must be single identifiers (typedef
+/// pointers and structs). Only one ordering can be declared per pair of
+/// types. Take a look at this example:
+/// @code
+/// typedef const char* cstr;
+/// #define cstr_less(a, b) (strcmp(a, b) < 0)
+/// DefineBTreeLess(cstr, int, cstr_less);
+///
+/// int main() {
+///   BTree(cstr, int) tree = btree_create(cstr, int);
+///   btree_put(cstr, int, &tree, "b", 2, NULL);
+///   btree_put(cstr, int, &tree, "a", 1, NULL);
+///   btree_free(&tree);
+///   return 0;
+/// }
+/// @endcode
+///
+/// This is a general documentation for the structs generated by this macro:
+/// @code
+/// typedef struct {
+///   size_t len;  /* The number of entries */
+///   ...          // internal stuff
+/// } BTree_K_V;
+///
+/// typedef struct {
+///   ...          // internal stuff, see btree_iter_valid
+/// } BTreeIter_K_V;
+/// @endcode
+///
+/// @param K The type of the keys
+/// @param V The type of the values
+/// @param less A function or function-like macro taking two `K` values `a`
+/// and `b` and returning whether `a` goes strictly before `b`
+/// @see - @ref DefineBTree for keys ordered by `<`
+/// @hideinitializer
+#define DefineBTreeLess(K, V, less)                                            \
+  enum {                                                                       \
+    snifex_api_btree_lcap_##K##_##V =                                          \
+        SNIFEX_API_BTREE_CAP(sizeof(K) + sizeof(V)),                           \
+    snifex_api_btree_icap_##K##_##V =                                          \
+        SNIFEX_API_BTREE_CAP(sizeof(K) + sizeof(void*)),                       \
+  };                                                                           \
+  typedef struct SnifexApiBTreeLeaf_##K##_##V {                                \
+    uint32_t len;                                                              \
+    struct SnifexApiBTreeLeaf_##K##_##V* next;                                 \
+    K keys[snifex_api_btree_lcap_##K##_##V];                                   \
+    V vals[snifex_api_btree_lcap_##K##_##V];                                   \
+  } SnifexApiBTreeLeaf_##K##_##V;                                              \
+  typedef struct {                                                             \
+    uint32_t len;                                                              \
+    K keys[snifex_api_btree_icap_##K##_##V];                                   \
+    void* children[snifex_api_btree_icap_##K##_##V + 1];                       \
+  } SnifexApiBTreeInner_##K##_##V;                                             \
+  typedef struct {                                                             \
+    void* root;                                                                \
+    size_t len;                                                                \
+    uint32_t height;                                                           \
+    struct snifex_api_node_pool pool;                                          \
+  } BTree_##K##_##V;                                                           \
+  typedef struct {                                                             \
+    SnifexApiBTreeLeaf_##K##_##V* leaf;                                        \
+    uint32_t i;                                                                \
+  } BTreeIter_##K##_##V;                                                       \
+                                                                               \
+  static inline BTree_##K##_##V btree_create_##K##_##V(void) {                 \
+    BTree_##K##_##V tree = {0};                                                \
+    tree.pool.node_size = sizeof(SnifexApiBTreeLeaf_##K##_##V) >               \
+                                  sizeof(SnifexApiBTreeInner_##K##_##V)        \
+                              ? sizeof(SnifexApiBTreeLeaf_##K##_##V)           \
+                              : sizeof(SnifexApiBTreeInner_##K##_##V);         \
+    return tree;                                                               \
+  }                                                                            \
+  /* Nodes are small enough that counting beats a binary search: no branch     \
+     to mispredict, and the loop vectorizes */                                 \
+  static inline uint32_t snifex_api_btree_lower_##K##_##V(                     \
+      const K* keys, const uint32_t len, const K key) {                        \
+    uint32_t pos = 0;                                                          \
+    for (uint32_t i = 0; i < len; i++) { pos += less(keys[i], key) ? 1 : 0; }  \
+    return pos;                                                                \
+  }                                                                            \
+  static inline uint32_t snifex_api_btree_upper_##K##_##V(                     \
+      const K* keys, const uint32_t len, const K key) {                        \
+    uint32_t pos = 0;                                                          \
+    for (uint32_t i = 0; i < len; i++) { pos += less(key, keys[i]) ? 0 : 1; }  \
+    return pos;                                                                \
+  }                                                                            \
+  static inline SnifexApiBTreeLeaf_##K##_##V* snifex_api_btree_leaf_##K##_##V( \
+      const BTree_##K##_##V* const tree, const K key) {                        \
+    void* node = tree->root;                                                   \
+    for (uint32_t h = tree->height; h > 0; h--) {                              \
+      SnifexApiBTreeInner_##K##_##V* inner = node;                             \
+      node = inner->children[snifex_api_btree_upper_##K##_##V(                 \
+          inner->keys, inner->len, key)];                                      \
+    }                                                                          \
+    return node;                                                               \
+  }                                                                            \
+  static inline V* btree_get_##K##_##V(const BTree_##K##_##V* const tree,      \
+                                       const K key) {                          \
+    if (tree->root == NULL) { return NULL; }                                   \
+    SnifexApiBTreeLeaf_##K##_##V* leaf =                                       \
+        snifex_api_btree_leaf_##K##_##V(tree, key);                            \
+    const uint32_t i =                                                         \
+        snifex_api_btree_lower_##K##_##V(leaf->keys, leaf->len, key);          \
+    if (i < leaf->len && !less(key, leaf->keys[i])) { return &leaf->vals[i]; } \
+    return NULL;                                                               \
+  }                                                                            \
+  static inline void snifex_api_btree_leaf_insert_##K##_##V(                   \
+      SnifexApiBTreeLeaf_##K##_##V* leaf, const uint32_t i, const K key,       \
+      const V val) {                                                           \
+    memmove(&leaf->keys[i + 1], &leaf->keys[i], (leaf->len - i) * sizeof(K));  \
+    memmove(&leaf->vals[i + 1], &leaf->vals[i], (leaf->len - i) * sizeof(V));  \
+    leaf->keys[i] = key;                                                       \
+    leaf->vals[i] = val;                                                       \
+    leaf->len++;                                                               \
+  }                                                                            \
+  /* Returns the new right sibling if `node` had to split, with its first key  \
+     in `*sep` */                                                              \
+  static void* snifex_api_btree_insert_##K##_##V(                              \
+      BTree_##K##_##V* tree, void* node, const uint32_t h, const K key,        \
+      const V val, V* old_val, bool* found, K* sep) {                          \
+    if (h == 0) {                                                              \
+      SnifexApiBTreeLeaf_##K##_##V* leaf = node;                               \
+      const uint32_t i =                                                       \
+          snifex_api_btree_lower_##K##_##V(leaf->keys, leaf->len, key);        \
+      if (i < leaf->len && !less(key, leaf->keys[i])) {                        \
+        if (old_val != NULL) { *old_val = leaf->vals[i]; }                     \
+        leaf->vals[i] = val;                                                   \
+        *found = true;                                                         \
+        return NULL;                                                           \
+      }                                                                        \
+      if (leaf->len < snifex_api_btree_lcap_##K##_##V) {                       \
+        snifex_api_btree_leaf_insert_##K##_##V(leaf, i, key, val);             \
+        return NULL;                                                           \
+      }                                                                        \
+      SnifexApiBTreeLeaf_##K##_##V* right =                                    \
+          snifex_api_node_pool_alloc(&tree->pool);                             \
+      const uint32_t mid = snifex_api_btree_lcap_##K##_##V / 2;                \
+      right->len = leaf->len - mid;                                            \
+      memcpy(right->keys, &leaf->keys[mid], right->len * sizeof(K));           \
+      memcpy(right->vals, &leaf->vals[mid], right->len * sizeof(V));           \
+      leaf->len = mid;                                                         \
+      right->next = leaf->next;                                                \
+      leaf->next = right;                                                      \
+      if (i <= mid) {                                                          \
+        snifex_api_btree_leaf_insert_##K##_##V(leaf, i, key, val);             \
+      } else {                                                                 \
+        snifex_api_btree_leaf_insert_##K##_##V(right, i - mid, key, val);      \
+      }                                                                        \
+      *sep = right->keys[0];                                                   \
+      return right;                                                            \
+    }                                                                          \
+                                                                               \
+    SnifexApiBTreeInner_##K##_##V* inner = node;                               \
+    const uint32_t c =                                                         \
+        snifex_api_btree_upper_##K##_##V(inner->keys, inner->len, key);        \
+    K child_sep;                                                               \
+    void* child = snifex_api_btree_insert_##K##_##V(                           \
+        tree, inner->children[c], h - 1, key, val, old_val, found,             \
+        &child_sep);                                                           \
+    if (child == NULL) { return NULL; }                                        \
+    if (inner->len < snifex_api_btree_icap_##K##_##V) {                        \
+      memmove(&inner->keys[c + 1], &inner->keys[c],                            \
+              (inner->len - c) * sizeof(K));                                   \
+      memmove(&inner->children[c + 2], &inner->children[c + 1],                \
+              (inner->len - c) * sizeof(void*));                               \
+      inner->keys[c] = child_sep;                                              \
+      inner->children[c + 1] = child;                                          \
+      inner->len++;                                                            \
+      return NULL;                                                             \
+    }                                                                          \
+    /* Full: lay out all the keys and children, then split them in half */     \
+    K keys[snifex_api_btree_icap_##K##_##V + 1];                               \
+    void* children[snifex_api_btree_icap_##K##_##V + 2];                       \
+    const uint32_t len = inner->len + 1;                                       \
+    memcpy(keys, inner->keys, c * sizeof(K));                                  \
+    keys[c] = child_sep;                                                       \
+    memcpy(&keys[c + 1], &inner->keys[c], (inner->len - c) * sizeof(K));       \
+    memcpy(children, inner->children, (c + 1) * sizeof(void*));                \
+    children[c + 1] = child;                                                   \
+    memcpy(&children[c + 2], &inner->children[c + 1],                          \
+           (inner->len - c) * sizeof(void*));                                  \
+    SnifexApiBTreeInner_##K##_##V* right =                                     \
+        snifex_api_node_pool_alloc(&tree->pool);                               \
+    const uint32_t mid = len / 2;                                              \
+    inner->len = mid;                                                          \
+    memcpy(inner->keys, keys, mid * sizeof(K));                                \
+    memcpy(inner->children, children, (mid + 1) * sizeof(void*));              \
+    right->len = len - mid - 1;                                                \
+    memcpy(right->keys, &keys[mid + 1], right->len * sizeof(K));               \
+    memcpy(right->children, &children[mid + 1],                                \
+           (right->len + 1) * sizeof(void*));                                  \
+    *sep = keys[mid];                                                          \
+    return right;                                                              \
+  }                                                                            \
+  static inline bool btree_put_##K##_##V(BTree_##K##_##V* const tree,          \
+                                         const K key, const V val,             \
+                                         V* const old_val) {                   \
+    if (tree->root == NULL) {                                                  \
+      SnifexApiBTreeLeaf_##K##_##V* leaf =                                     \
+          snifex_api_node_pool_alloc(&tree->pool);                             \
+      leaf->len = 1;                                                           \
+      leaf->next = NULL;                                                       \
+      leaf->keys[0] = key;                                                     \
+      leaf->vals[0] = val;                                                     \
+      tree->root = leaf;                                                       \
+      tree->height = 0;                                                        \
+      tree->len = 1;                                                           \
+      return false;                                                            \
+    }                                                                          \
+    bool found = false;                                                        \
+    K sep;                                                                     \
+    void* right = snifex_api_btree_insert_##K##_##V(                           \
+        tree, tree->root, tree->height, key, val, old_val, &found, &sep);      \
+    if (right != NULL) {                                                       \
+      SnifexApiBTreeInner_##K##_##V* root =                                    \
+          snifex_api_node_pool_alloc(&tree->pool);                             \
+      root->len = 1;                                                           \
+      root->keys[0] = sep;                                                     \
+      root->children[0] = tree->root;                                          \
+      root->children[1] = right;                                               \
+      tree->root = root;                                                       \
+      tree->height++;                                                          \
+    }                                                                          \
+    if (!found) { tree->len++; }                                               \
+    return found;                                                              \
+  }                                                                            \
+  static inline void snifex_api_btree_remove_##K##_##V(                        \
+      SnifexApiBTreeInner_##K##_##V* inner, const uint32_t k) {                \
+    memmove(&inner->keys[k], &inner->keys[k + 1],                              \
+            (inner->len - k - 1) * sizeof(K));                                 \
+    memmove(&inner->children[k + 1], &inner->children[k + 2],                  \
+            (inner->len - k - 1) * sizeof(void*));                             \
+    inner->len--;                                                              \
+  }                                                                            \
+  /* Refills child `c` of `parent`, under its minimum after a delete, from a   \
+     sibling: borrowing one entry if the sibling has some to spare, merging    \
+     the two otherwise */                                                      \
+  static void snifex_api_btree_fix_##K##_##V(                                  \
+      BTree_##K##_##V* tree, SnifexApiBTreeInner_##K##_##V* parent,            \
+      const uint32_t c, const uint32_t h) {                                    \
+    /* The first child has no left sibling, it's fixed with the second one */  \
+    const uint32_t l = c > 0 ? c - 1 : 0;                                      \
+    if (h == 0) {                                                              \
+      SnifexApiBTreeLeaf_##K##_##V* left = parent->children[l];                \
+      SnifexApiBTreeLeaf_##K##_##V* right = parent->children[l + 1];           \
+      const uint32_t min = snifex_api_btree_lcap_##K##_##V / 2;                \
+      if (c > 0 && left->len > min) {                                          \
+        snifex_api_btree_leaf_insert_##K##_##V(                                \
+            right, 0, left->keys[left->len - 1], left->vals[left->len - 1]);   \
+        left->len--;                                                           \
+      } else if (c == 0 && right->len > min) {                                 \
+        left->keys[left->len] = right->keys[0];                                \
+        left->vals[left->len] = right->vals[0];                                \
+        left->len++;                                                           \
+        right->len--;                                                          \
+        memmove(right->keys, &right->keys[1], right->len * sizeof(K));         \
+        memmove(right->vals, &right->vals[1], right->len * sizeof(V));         \
+      } else {                                                                 \
+        memcpy(&left->keys[left->len], right->keys, right->len * sizeof(K));   \
+        memcpy(&left->vals[left->len], right->vals, right->len * sizeof(V));   \
+        left->len += right->len;                                               \
+        left->next = right->next;                                              \
+        snifex_api_node_pool_release(&tree->pool, right);                      \
+        snifex_api_btree_remove_##K##_##V(parent, l);                          \
+        return;                                                                \
+      }                                                                        \
+      parent->keys[l] = right->keys[0];                                        \
+      return;                                                                  \
+    }                                                                          \
+                                                                               \
+    SnifexApiBTreeInner_##K##_##V* left = parent->children[l];                 \
+    SnifexApiBTreeInner_##K##_##V* right = parent->children[l + 1];            \
+    const uint32_t min = snifex_api_btree_icap_##K##_##V / 2;                  \
+    if (c > 0 && left->len > min) {                                            \
+      /* Rotate through the parent: its key goes down, the left one goes up */ \
+      memmove(&right->keys[1], right->keys, right->len * sizeof(K));           \
+      memmove(&right->children[1], right->children,                            \
+              (right->len + 1) * sizeof(void*));                               \
+      right->keys[0] = parent->keys[l];                                        \
+      right->children[0] = left->children[left->len];                          \
+      right->len++;                                                            \
+      parent->keys[l] = left->keys[left->len - 1];                             \
+      left->len--;                                                             \
+    } else if (c == 0 && right->len > min) {                                   \
+      left->keys[left->len] = parent->keys[l];                                 \
+      left->children[left->len + 1] = right->children[0];                      \
+      left->len++;                                                             \
+      parent->keys[l] = right->keys[0];                                        \
+      right->len--;                                                            \
+      memmove(right->keys, &right->keys[1], right->len * sizeof(K));           \
+      memmove(right->children, &right->children[1],                            \
+              (right->len + 1) * sizeof(void*));                               \
+    } else {                                                                   \
+      left->keys[left->len] = parent->keys[l];                                 \
+      memcpy(&left->keys[left->len + 1], right->keys, right->len * sizeof(K)); \
+      memcpy(&left->children[left->len + 1], right->children,                  \
+             (right->len + 1) * sizeof(void*));                                \
+      left->len += right->len + 1;                                             \
+      snifex_api_node_pool_release(&tree->pool, right);                        \
+      snifex_api_btree_remove_##K##_##V(parent, l);                            \
+    }                                                                          \
+  }                                                                            \
+  /* Returns whether `node` went under its minimum */                          \
+  static bool snifex_api_btree_delete_##K##_##V(BTree_##K##_##V* tree,         \
+                                                void* node, const uint32_t h,  \
+                                                const K key, V* old_val,       \
+                                                bool* found) {                 \
+    if (h == 0) {                                                              \
+      SnifexApiBTreeLeaf_##K##_##V* leaf = node;                               \
+      const uint32_t i =                                                       \
+          snifex_api_btree_lower_##K##_##V(leaf->keys, leaf->len, key);        \
+      if (i == leaf->len || less(key, leaf->keys[i])) { return false; }        \
+      if (old_val != NULL) { *old_val = leaf->vals[i]; }                       \
+      *found = true;                                                           \
+      leaf->len--;                                                             \
+      memmove(&leaf->keys[i], &leaf->keys[i + 1],                              \
+              (leaf->len - i) * sizeof(K));                                    \
+      memmove(&leaf->vals[i], &leaf->vals[i + 1],                              \
+              (leaf->len - i) * sizeof(V));                                    \
+      return leaf->len < snifex_api_btree_lcap_##K##_##V / 2;                  \
+    }                                                                          \
+    SnifexApiBTreeInner_##K##_##V* inner = node;                               \
+    const uint32_t c =                                                         \
+        snifex_api_btree_upper_##K##_##V(inner->keys, inner->len, key);        \
+    if (!snifex_api_btree_delete_##K##_##V(tree, inner->children[c], h - 1,    \
+                                           key, old_val, found)) {             \
+      return false;                                                            \
+    }                                                                          \
+    snifex_api_btree_fix_##K##_##V(tree, inner, c, h - 1);                     \
+    return inner->len < snifex_api_btree_icap_##K##_##V / 2;                   \
+  }                                                                            \
+  static inline bool btree_del_##K##_##V(BTree_##K##_##V* const tree,          \
+                                         const K key, V* const old_val) {      \
+    if (tree->root == NULL) { return false; }                                  \
+    bool found = false;                                                        \
+    snifex_api_btree_delete_##K##_##V(tree, tree->root, tree->height, key,     \
+                                      old_val, &found);                        \
+    if (!found) { return false; }                                              \
+    tree->len--;                                                               \
+    if (tree->height > 0) {                                                    \
+      SnifexApiBTreeInner_##K##_##V* root = tree->root;                        \
+      if (root->len == 0) {                                                    \
+        tree->root = root->children[0];                                        \
+        tree->height--;                                                        \
+        snifex_api_node_pool_release(&tree->pool, root);                       \
+      }                                                                        \
+    } else if (((SnifexApiBTreeLeaf_##K##_##V*)tree->root)->len == 0) {        \
+      snifex_api_node_pool_release(&tree->pool, tree->root);                   \
+      tree->root = NULL;                                                       \
+    }                                                                          \
+    return true;                                                               \
+  }                                                                            \
+  static inline BTreeIter_##K##_##V btree_lower_bound_##K##_##V(               \
+      const BTree_##K##_##V* const tree, const K key) {                        \
+    BTreeIter_##K##_##V it = {NULL, 0};                                        \
+    if (tree->root == NULL) { return it; }                                     \
+    it.leaf = snifex_api_btree_leaf_##K##_##V(tree, key);                      \
+    it.i = snifex_api_btree_lower_##K##_##V(it.leaf->keys, it.leaf->len, key); \
+    if (it.i == it.leaf->len) {                                                \
+      it.leaf = it.leaf->next;                                                 \
+      it.i = 0;                                                                \
+    }                                                                          \
+    return it;                                                                 \
+  }                                                                            \
+  static inline BTreeIter_##K##_##V btree_first_##K##_##V(                     \
+      const BTree_##K##_##V* const tree) {                                     \
+    BTreeIter_##K##_##V it = {NULL, 0};                                        \
+    void* node = tree->root;                                                   \
+    if (node == NULL) { return it; }                                           \
+    for (uint32_t h = tree->height; h > 0; h--) {                              \
+      node = ((SnifexApiBTreeInner_##K##_##V*)node)->children[0];              \
+    }                                                                          \
+    it.leaf = node;                                                            \
+    return it;                                                                 \
+  }                                                                            \
+  static inline void btree_iter_next_##K##_##V(                                \
+      BTreeIter_##K##_##V* const it) {                                         \
+    if (++it->i == it->leaf->len) {                                            \
+      it->leaf = it->leaf->next;                                               \
+      it->i = 0;                                                               \
+    }                                                                          \
+  }
+
+/// @cond EXCLUDE_DOC
+#define snifex_api_btree_less(a, b) ((a) < (b))
+/// @endcond
+
+/// @brief Macro to declare a B-tree of `K` keys and `V` values, with keys
+/// ordered by `<`
+///
+/// Meant for numerical keys, like timestamps or IDs. Take a look at this
+/// example:
+/// @code
+/// DefineBTree(uint64_t, float);
+///
+/// int main() {
+///   BTree(uint64_t, float) tree = btree_create(uint64_t, float);
+///   btree_put(uint64_t, float, &tree, 42, 1.0, NULL);
+///   // All the entries with 10 <= key < 100, in order
+///   for (BTreeIter(uint64_t, float) it =
+///            btree_lower_bound(uint64_t, float, &tree, 10);
+///        btree_iter_valid(it) && *btree_iter_key(it) < 100;
+///        btree_iter_next(uint64_t, float, &it)) {
+///     printf("%f\n", *btree_iter_val(it));
+///   }
+///   btree_free(&tree);
+///   return 0;
+/// }
+/// @endcode
+///
+/// @param K The type of the keys
+/// @param V The type of the values
+/// @see - @ref DefineBTreeLess for more info
+/// @hideinitializer
+#define DefineBTree(K, V) DefineBTreeLess(K, V, snifex_api_btree_less)
+
+/// @brief The type of a B-tree of `K` keys and `V` values
+///
+/// @see @ref DefineBTreeLess for more info
+#define BTree(K, V) BTree_##K##_##V
+
+/// @brief The type of an iterator over a B-tree of `K` keys and `V` values
+///
+/// @see @ref DefineBTreeLess for more info
+#define BTreeIter(K, V) BTreeIter_##K##_##V
+
+/// @brief Create an empty B-tree. It allocates nothing until the first put
+/// @hideinitializer
+#define btree_create(K, V) btree_create_##K##_##V()
+
+/// @brief Inserts an entry in the B-tree, or replaces its value
+///
+/// @param tree_ptr Pointer to the B-tree
+/// @param k Key of the entry
+/// @param v Value of the entry
+/// @param old_value_ptr If it's non-null and the key was already there, the
+/// old value is written to it
+/// @return Whether the key was already there
+/// @hideinitializer
+#define btree_put(K, V, tree_ptr, k, v, old_value_ptr) \
+  btree_put_##K##_##V((tree_ptr), (k), (v), (old_value_ptr))
+
+/// @brief Gets a pointer to the value associated with `k`
+///
+/// @param tree_ptr Pointer to the B-tree
+/// @param k Key of the entry
+/// @return A pointer to the value, valid until the next put or delete, or
+/// `NULL` if the key is not there
+/// @hideinitializer
+#define btree_get(K, V, tree_ptr, k) btree_get_##K##_##V((tree_ptr), (k))
+
+/// @brief Deletes an entry from the B-tree
+///
+/// @param tree_ptr Pointer to the B-tree
+/// @param k Key of the entry
+/// @param old_value_ptr If it's non-null and the key was there, the deleted
+/// value is written to it
+/// @return Whether the key was there
+/// @hideinitializer
+#define btree_del(K, V, tree_ptr, k, old_value_ptr) \
+  btree_del_##K##_##V((tree_ptr), (k), (old_value_ptr))
+
+/// @brief Returns an iterator to the first entry whose key is not less than
+/// `k`
+///
+/// Iterators are invalidated by puts and deletes.
+/// @param tree_ptr Pointer to the B-tree
+/// @param k The lower bound
+/// @hideinitializer
+#define btree_lower_bound(K, V, tree_ptr, k) \
+  btree_lower_bound_##K##_##V((tree_ptr), (k))
+
+/// @brief Returns an iterator to the entry with the smallest key
+/// @hideinitializer
+#define btree_first(K, V, tree_ptr) btree_first_##K##_##V(tree_ptr)
+
+/// @brief Whether the iterator points to an entry, `false` past the last one
+/// @hideinitializer
+#define btree_iter_valid(it) ((it).leaf != NULL)
+
+/// @brief Pointer to the key of the entry the iterator points to
+/// @pre @ref btree_iter_valid
+/// @hideinitializer
+#define btree_iter_key(it) (&(it).leaf->keys[(it).i])
+
+/// @brief Pointer to the value of the entry the iterator points to
+/// @pre @ref btree_iter_valid
+/// @hideinitializer
+#define btree_iter_val(it) (&(it).leaf->vals[(it).i])
+
+/// @brief Moves the iterator to the entry with the next key
+///
+/// @param it_ptr Pointer to the iterator
+/// @pre @ref btree_iter_valid
+/// @hideinitializer
+#define btree_iter_next(K, V, it_ptr) btree_iter_next_##K##_##V(it_ptr)
+
+/// @brief Frees the B-tree, all of its nodes at once
+/// @hideinitializer
+#define btree_free(tree_ptr)                      \
+  do {                                            \
+    snifex_api_node_pool_free(&(tree_ptr)->pool); \
+    (tree_ptr)->root = NULL;                      \
+    (tree_ptr)->len = 0;                          \
+  } while (0)
+
+/// @}
+
+/// @defgroup bloom Bloom filter
+/// @brief Probabilistic sets, for cheap negative lookups
+///
+/// A Bloom filter answers "is this key in the set?" with either "no" (always
+/// right) or "maybe" (wrong with a chosen false positive rate), using a few
+/// bits per key. Checking it before a big @ref Dict or the disk skips most of
+/// the lookups of keys that are not there.
+///
+/// Both filters here are blocked: all the bits (or counters) of a key are in
+/// one 64-byte block, so a lookup touches a single cache line. The price is a
+/// slightly higher false positive rate than a classic Bloom filter of the same
+/// size.
+///   - @ref BloomFilter: one bit per slot, keys can't be removed.
+///   - @ref CountingBloomFilter: one 4-bit counter per slot (4 times bigger),
+///     keys can be removed.
+///
+/// Keys are hashed with the same `hash_num` hook as dictionaries (see @ref
+/// DefineDict), seeded with the `key` of the filter. The hash is then mixed
+/// into two values for double hashing: one picks the block, the other the k
+/// slots in it.
+///
+/// All examples are <a
+/// href="https://github.com/Snifexx/snifex-api/tree/docs/src/examples-and-tests">here</a>
+/// @{
+
+/// @brief A blocked Bloom filter
+typedef struct bloom_filter {
+  uint64_t* words;    ///< @brief The bits, 8 words (one cache line) per block
+  size_t n_blocks;    ///< @brief The number of 512-bit blocks
+  uint32_t n_hashes;  ///< @brief The number of bits set per key
+  uint64_t key[2];    ///< @brief The key for hashing, like in @ref DefineDict.
+                      /// Set to {0, 0} on creation
+  void* buf;          ///< @brief The allocation `words` is aligned in
+} BloomFilter;
+
+/// @brief A blocked counting Bloom filter, whose keys can be removed
+///
+/// Counters are 4 bits, two per byte, and saturate at 15: a saturated counter
+/// is never decremented again, so removing can't introduce false negatives.
+typedef struct counting_bloom_filter {
+  uint8_t* counters;  ///< @brief The counters, 128 (one cache line) per block
+  size_t n_blocks;    ///< @brief The number of 128-counter blocks
+  uint32_t n_hashes;  ///< @brief The number of counters incremented per key
+  uint64_t key[2];    ///< @brief The key for hashing, like in @ref DefineDict.
+                      /// Set to {0, 0} on creation
+  void* buf;          ///< @brief The allocation `counters` is aligned in
+} CountingBloomFilter;
+
+/// @brief Returns the number of bits (or counters) needed to hold `expected`
+/// keys with a false positive rate of `fp_rate`
+///
+/// This is the classic `-n ln(p) / ln(2)^2`. Blocked filters need more than
+/// this for the same rate, which @ref bloom_create_for and @ref
+/// cbloom_create_for take into account.
+/// @pre `0 < fp_rate && fp_rate < 1`
+extern size_t bloom_bits_for(const size_t expected, const double fp_rate);
+/// @brief Returns the optimal number of hashes, `bits / n ln(2)`, between 1
+/// and 16
+extern uint32_t bloom_hashes_for(const size_t expected, const size_t bits);
+
+/// @brief Creates a filter of at least `bits` bits, rounded up to whole blocks
+/// @pre `n_hashes > 0`
+extern BloomFilter bloom_create(const size_t bits, const uint32_t n_hashes);
+/// @brief Creates a filter sized for `expected` keys and a false positive
+/// rate of `fp_rate`
+///
+/// Starts from @ref bloom_bits_for and adds blocks until the expected rate of
+/// the blocked filter is under `fp_rate`.
+extern BloomFilter bloom_create_for(const size_t expected,
+                                    const double fp_rate);
+/// @brief Adds an already hashed key
+extern void bloom_add_hash(BloomFilter* const bf, const uint64_t hash);
+/// @brief Checks an already hashed key
+/// @return `false` if the key was never added, `true` if it probably was
+extern bool bloom_contains_hash(const BloomFilter* const bf,
+                                const uint64_t hash);
+/// @brief Removes all the keys
+extern void bloom_clear(BloomFilter* const bf);
+/// @brief Frees the filter
+extern void bloom_free(BloomFilter* const bf);
+
+/// @brief Creates a counting filter of at least `counters` counters, rounded
+/// up to whole blocks
+/// @pre `n_hashes > 0`
+extern CountingBloomFilter cbloom_create(const size_t counters,
+                                         const uint32_t n_hashes);
+/// @brief Creates a counting filter sized for `expected` keys and a false
+/// positive rate of `fp_rate`, like @ref bloom_create_for
+extern CountingBloomFilter cbloom_create_for(const size_t expected,
+                                             const double fp_rate);
+/// @brief Adds an already hashed key
+extern void cbloom_add_hash(CountingBloomFilter* const bf,
+                            const uint64_t hash);
+/// @brief Removes an already hashed key
+/// @pre The key was added
+extern void cbloom_remove_hash(CountingBloomFilter* const bf,
+                               const uint64_t hash);
+/// @brief Checks an already hashed key
+/// @return `false` if the key is not in the filter, `true` if it probably is
+extern bool cbloom_contains_hash(const CountingBloomFilter* const bf,
+                                 const uint64_t hash);
+/// @brief Removes all the keys
+extern void cbloom_clear(CountingBloomFilter* const bf);
+/// @brief Frees the filter
+extern void cbloom_free(CountingBloomFilter* const bf);
+
+#ifdef SNIFEX_API_GNU_EXTENSIONS
+
+/// @brief Adds a key to a @ref BloomFilter
+///
+/// @param bf_ptr Pointer to the filter
+/// @param k The key, hashed with `hash_num`
+/// @hideinitializer
+#define bloom_add(bf_ptr, k)                                                   \
+  ({                                                                           \
+    BloomFilter* ba_bf_ptr = (bf_ptr);                                         \
+    __typeof(k) ba_k = (k);                                                    \
+    bloom_add_hash(ba_bf_ptr, hash_num(&ba_k, sizeof(ba_k),                    \
+                                       ba_bf_ptr->key[0], ba_bf_ptr->key[1])); \
+  })
+
+/// @brief Checks whether a key is in a @ref BloomFilter
+///
+/// @param bf_ptr Pointer to the filter
+/// @param k The key, hashed with `hash_num`
+/// @return `false` if the key was never added, `true` if it probably was
+/// @hideinitializer
+#define bloom_contains(bf_ptr, k)                                        \
+  ({                                                                     \
+    const BloomFilter* bc_bf_ptr = (bf_ptr);                             \
+    __typeof(k) bc_k = (k);                                              \
+    bloom_contains_hash(bc_bf_ptr,                                       \
+                        hash_num(&bc_k, sizeof(bc_k), bc_bf_ptr->key[0], \
+                                 bc_bf_ptr->key[1]));                    \
+  })
+
+/// @brief Adds a key to a @ref CountingBloomFilter
+///
+/// @param bf_ptr Pointer to the filter
+/// @param k The key, hashed with `hash_num`
+/// @hideinitializer
+#define cbloom_add(bf_ptr, k)                                           \
+  ({                                                                    \
+    CountingBloomFilter* cba_bf_ptr = (bf_ptr);                         \
+    __typeof(k) cba_k = (k);                                            \
+    cbloom_add_hash(cba_bf_ptr,                                         \
+                    hash_num(&cba_k, sizeof(cba_k), cba_bf_ptr->key[0], \
+                             cba_bf_ptr->key[1]));                      \
+  })
+
+/// @brief Removes a key from a @ref CountingBloomFilter
+///
+/// @param bf_ptr Pointer to the filter
+/// @param k The key, hashed with `hash_num`. Must have been added
+/// @hideinitializer
+#define cbloom_remove(bf_ptr, k)                                           \
+  ({                                                                       \
+    CountingBloomFilter* cbr_bf_ptr = (bf_ptr);                            \
+    __typeof(k) cbr_k = (k);                                               \
+    cbloom_remove_hash(cbr_bf_ptr,                                         \
+                       hash_num(&cbr_k, sizeof(cbr_k), cbr_bf_ptr->key[0], \
+                                cbr_bf_ptr->key[1]));                      \
+  })
+
+/// @brief Checks whether a key is in a @ref CountingBloomFilter
+///
+/// @param bf_ptr Pointer to the filter
+/// @param k The key, hashed with `hash_num`
+/// @return `false` if the key is not in the filter, `true` if it probably is
+/// @hideinitializer
+#define cbloom_contains(bf_ptr, k)                                           \
+  ({                                                                         \
+    const CountingBloomFilter* cbc_bf_ptr = (bf_ptr);                        \
+    __typeof(k) cbc_k = (k);                                                 \
+    cbloom_contains_hash(cbc_bf_ptr,                                         \
+                         hash_num(&cbc_k, sizeof(cbc_k), cbc_bf_ptr->key[0], \
+                                  cbc_bf_ptr->key[1]));                      \
+  })
+
+#else  // NON SNIFEX_API_GNU_EXTENSIONS
+
+/// @brief Adds a key to a @ref BloomFilter
+///
+/// @param t The type of the key
+/// @param bf_ptr Pointer to the filter
+/// @param k The key, hashed with `hash_num`
+/// @hideinitializer
+#define bloom_add(t, bf_ptr, k)                                                \
+  do {                                                                         \
+    BloomFilter* ba_bf_ptr = (bf_ptr);                                         \
+    t ba_k = (k);                                                              \
+    bloom_add_hash(ba_bf_ptr, hash_num(&ba_k, sizeof(ba_k),                    \
+                                       ba_bf_ptr->key[0], ba_bf_ptr->key[1])); \
+  } while (0)
+
+/// @brief Checks whether a key is in a @ref BloomFilter
+///
+/// @param lval_result_bool The result, `false` if the key was never added,
+/// `true` if it probably was
+/// @param t The type of the key
+/// @param bf_ptr Pointer to the filter
+/// @param k The key, hashed with `hash_num`
+/// @hideinitializer
+#define bloom_contains(lval_result_bool, t, bf_ptr, k)                        \
+  do {                                                                        \
+    const BloomFilter* bc_bf_ptr = (bf_ptr);                                  \
+    t bc_k = (k);                                                             \
+    lval_result_bool = bloom_contains_hash(                                   \
+        bc_bf_ptr,                                                            \
+        hash_num(&bc_k, sizeof(bc_k), bc_bf_ptr->key[0], bc_bf_ptr->key[1])); \
+  } while (0)
+
+/// @brief Adds a key to a @ref CountingBloomFilter
+///
+/// @param t The type of the key
+/// @param bf_ptr Pointer to the filter
+/// @param k The key, hashed with `hash_num`
+/// @hideinitializer
+#define cbloom_add(t, bf_ptr, k)                                        \
+  do {                                                                  \
+    CountingBloomFilter* cba_bf_ptr = (bf_ptr);                         \
+    t cba_k = (k);                                                      \
+    cbloom_add_hash(cba_bf_ptr,                                         \
+                    hash_num(&cba_k, sizeof(cba_k), cba_bf_ptr->key[0], \
+                             cba_bf_ptr->key[1]));                      \
+  } while (0)
+
+/// @brief Removes a key from a @ref CountingBloomFilter
+///
+/// @param t The type of the key
+/// @param bf_ptr Pointer to the filter
+/// @param k The key, hashed with `hash_num`. Must have been added
+/// @hideinitializer
+#define cbloom_remove(t, bf_ptr, k)                                        \
+  do {                                                                     \
+    CountingBloomFilter* cbr_bf_ptr = (bf_ptr);                            \
+    t cbr_k = (k);                                                         \
+    cbloom_remove_hash(cbr_bf_ptr,                                         \
+                       hash_num(&cbr_k, sizeof(cbr_k), cbr_bf_ptr->key[0], \
+                                cbr_bf_ptr->key[1]));                      \
+  } while (0)
+
+/// @brief Checks whether a key is in a @ref CountingBloomFilter
+///
+/// @param lval_result_bool The result, `false` if the key is not in the
+/// filter, `true` if it probably is
+/// @param t The type of the key
+/// @param bf_ptr Pointer to the filter
+/// @param k The key, hashed with `hash_num`
+/// @hideinitializer
+#define cbloom_contains(lval_result_bool, t, bf_ptr, k)                 \
+  do {                                                                  \
+    const CountingBloomFilter* cbc_bf_ptr = (bf_ptr);                   \
+    t cbc_k = (k);                                                      \
+    lval_result_bool = cbloom_contains_hash(                            \
+        cbc_bf_ptr, hash_num(&cbc_k, sizeof(cbc_k), cbc_bf_ptr->key[0], \
+                             cbc_bf_ptr->key[1]));                      \
+  } while (0)
+
+#endif  // SNIFEX_API_GNU_EXTENSIONS
+
+/// @}
+
+#endif  // SNIFEX_API_H
+
+// IMPLEMENTATION
+
+#ifdef SNIFEX_API_IMPLEMENTATION
+
+#if !defined(SNIFEX_API_NO_SIMD) && defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define SNIFEX_API_X86_SIMD
+#endif
+
+#ifndef SNIFEX_API_NO_ASSERT
+void __snifex_api_assert_fail(const char* expr,
+                              const char* file,
+                              const int line,
+                              const char* func) {
+  fprintf(stderr,
+          "\33[0;31m%s\33[0m:\33[0;33m%d\33[0m in func "
+          "\33[0;32m%s\33[0m():\n\t\33[0;91mAssert failed\33[0m -> %s\n",
+          file, line, func, expr);
+#ifdef OS_LINUX
+  fprintf(stderr, "\33[38;5;124mStacktrace:\33[0m\n");
+  char** strings;
+  size_t size;
+  void* array[1024];
+  size = backtrace(array, 1024);
+  strings = backtrace_symbols(array, size);
+  for (size_t i = 0; i < size; i++) printf("\33[0;37m%s\n", strings[i]);
+  printf("\33[0m\n");
+  free(strings);
+#endif
+#ifdef OS_WIN
+  fprintf(stderr, "\33[38;5;124mStacktrace:\33[0m\n");
+
+  const DWORD options = SymGetOptions();
+  SymSetOptions(options | SYMOPT_LOAD_LINES);
+  SymInitialize(GetCurrentProcess(), NULL, true);
+
+  void* array[48];
+  size_t size = CaptureStackBackTrace(0, 48, array, NULL);
+
+  for (size_t i = 0; i < size; i++) {
+    DWORD64 address = (DWORD64)(array[i]);
+    CHAR buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME * sizeof(CHAR)];
+    PSYMBOL_INFO symbol = (PSYMBOL_INFO)buffer;
+    symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+    symbol->MaxNameLen = MAX_SYM_NAME;
+
+    if (SymFromAddr(GetCurrentProcess(), address, 0, symbol)) {
+      fprintf(stderr, "\33[0;37mFrame %u: %s\n", i, symbol->Name);
+    } else {
+      fprintf(stderr,
+              "\33[0;37mFrame %u: Address = 0x%p (No debug info, if using MSVC "
+              "remember the /Zi flag)\n",
+              i, (void*)address);
+    }
+  }
+  printf("\33[0m\n");
+  SymCleanup(GetCurrentProcess());
+#endif  // OS_WIN
+  exit(1);
+}
+#endif  // SNIFEX_API_NO_ASSERT
+
+inline bool __snifex_api_is_power_of_two(const size_t x) {
+  return (x & (x - 1)) == 0;
+}
+
+// uint32_t ceil_powtwo(uint32_t v) {
+//   v--;
+//   v |= v >> 1;
+//   v |= v >> 2;
+//   v |= v >> 4;
+//   v |= v >> 8;
+//   v |= v >> 16;
+//   return v + 1;
+// }
+
+void dyn_arena_init(DynArena* const dyn_arena, const size_t init_cap) {
+  dyn_arena->buf = (char*)malloc(init_cap);
+  dyn_arena->cap = init_cap;
+  dyn_arena->top = 0;
+  assert(dyn_arena->buf != NULL);
+}
+
+void arena_init(Arena* const arena, const size_t size) {
+  arena->buf = (char*)malloc(size);
+  arena->size = size;
+  arena->top = 0;
+  assert(arena->buf != NULL);
+}
+
+DynArena dyn_arena_create(const size_t init_cap) {
+  DynArena dyn_arena = {0};
+  dyn_arena_init(&dyn_arena, init_cap);
+  return dyn_arena;
+}
+
+Arena arena_create(const size_t init_cap) {
+  Arena arena = {0};
+  arena_init(&arena, init_cap);
+  return arena;
+}
+
+size_t dyn_arena_alloc(DynArena* const dyn_arena,
+                       const size_t size,
+                       const size_t alignment) {
+  assert(!(size == 0 || alignment == 0 ||
+           (alignment != 1 && !__snifex_api_is_power_of_two(alignment)) ||
+           size % alignment != 0));
+
+  const size_t start = (dyn_arena->top + alignment - 1) & ~(alignment - 1);
+  if (start + size > dyn_arena->cap) {
+    dyn_arena->cap += start + size;
+    dyn_arena->cap *= 2;
+    dyn_arena->buf = (char*)realloc(dyn_arena->buf, dyn_arena->cap);
+    assert(dyn_arena->buf != NULL);
+  }
+
+  dyn_arena->top = start + size;
+  return start;
+}
+
+void* arena_alloc(Arena* const arena,
+                  const size_t size,
+                  const size_t alignment) {
+  if (size == 0) { return NULL; }
+  assert(!(alignment == 0 ||
+           (alignment != 1 && !__snifex_api_is_power_of_two(alignment)) ||
+           size % alignment != 0));
+
+  const size_t start = (arena->top + alignment - 1) & ~(alignment - 1);
+  if (start > arena->size || size > arena->size - start) { return NULL; }
+
+  arena->top = start + size;
+  return &arena->buf[start];
+}
+
+void dyn_arena_reserve(DynArena* const dyn_arena, const size_t min_cap) {
+  if (dyn_arena->cap < min_cap) {
+    dyn_arena->cap *= min_cap;
+    dyn_arena->buf = (char*)realloc(dyn_arena->buf, dyn_arena->cap);
+    assert(dyn_arena->buf != NULL);
+  }
+}
+
+void arena_reset(Arena* const arena) {
+  assert(arena != NULL);
+  arena->top = 0;
+}
+
+void dyn_arena_free(DynArena* const dyn_arena) { free(dyn_arena->buf); }
+void arena_free(Arena* const arena) { free(arena->buf); }
+
+size_t snifex_api_vec_next_cap(const size_t cap,
+                               const size_t min_cap,
+                               const size_t elem_size,
+                               const uint8_t policy) {
+  assert(elem_size > 0);
+
+  size_t new_cap;
+  switch (policy) {
+    case SNIFEX_API_VEC_GROWTH_ONE_AND_HALF:
+      new_cap = cap + cap / 2 + 1;
+      break;
+    case SNIFEX_API_VEC_GROWTH_PAGE:
+    case SNIFEX_API_VEC_GROWTH_DOUBLE:
+      new_cap = (cap + 1) * 2;
+      break;
+    default:
+      assert(false && "Unknown SNIFEX_API_VEC_GROWTH policy");
+      return 0;
+  }
+  if (new_cap < min_cap) { new_cap = min_cap; }
+
+  if (policy == SNIFEX_API_VEC_GROWTH_PAGE &&
+      new_cap * elem_size > SNIFEX_API_PAGE_SIZE) {
+    size_t bytes = (new_cap * elem_size + SNIFEX_API_PAGE_SIZE - 1) &
+                   ~((size_t)SNIFEX_API_PAGE_SIZE - 1);
+    new_cap = bytes / elem_size;
+  }
+  return new_cap;
+}
+
+void* snifex_api_vec_grow(void* ptr,
+                          size_t* const cap,
+                          const size_t min_cap,
+                          const size_t elem_size,
+                          const uint8_t policy) {
+  assert(cap != NULL);
+
+  *cap = snifex_api_vec_next_cap(*cap, min_cap, elem_size, policy);
+  ptr = realloc(ptr, *cap * elem_size);
+  assert(ptr != NULL);
+  return ptr;
+}
+
+void* snifex_api_vec_shrink(void* ptr,
+                            size_t* const cap,
+                            const size_t len,
+                            const size_t elem_size) {
+  assert(cap != NULL && len <= *cap);
+
+  // Vectors always own a buffer (see `vec_create`) and realloc(ptr, 0) is
+  // implementation defined anyways
+  size_t new_cap = len > 0 ? len : 1;
+  if (new_cap == *cap) { return ptr; }
+
+  ptr = realloc(ptr, new_cap * elem_size);
+  assert(ptr != NULL);
+  *cap = new_cap;
+  return ptr;
+}
+
+void* snifex_api_vec_splice(void* ptr,
+                            size_t* const cap,
+                            size_t* const len,
+                            const size_t at,
+                            const size_t remove_count,
+                            const void* items,
+                            const size_t insert_count,
+                            const size_t elem_size,
+                            const uint8_t policy) {
+  assert(cap != NULL && len != NULL);
+  assert(at <= *len && remove_count <= *len - at);
+  assert(insert_count == 0 || items != NULL);
+
+  const size_t tail = *len - at - remove_count;
+  const size_t new_len = *len - remove_count + insert_count;
+  if (new_len > *cap) {
+    ptr = snifex_api_vec_grow(ptr, cap, new_len, elem_size, policy);
+  }
+
+  char* const buf = (char*)ptr;
+  if (tail != 0 && remove_count != insert_count) {
+    memmove(buf + (at + insert_count) * elem_size,
+            buf + (at + remove_count) * elem_size, tail * elem_size);
+  }
+  if (insert_count != 0) {
+    memcpy(buf + at * elem_size, items, insert_count * elem_size);
+  }
+  *len = new_len;
+  return ptr;
+}
+
+void* snifex_api_smallvec_grow(void* heap,
+                               const void* inline_buf,
+                               size_t* const cap,
+                               const size_t len,
+                               const size_t min_cap,
+                               const size_t elem_size,
+                               const uint8_t policy) {
+  assert(cap != NULL && inline_buf != NULL);
+  if (heap != NULL) {
+    return snifex_api_vec_grow(heap, cap, min_cap, elem_size, policy);
+  }
+
+  // Spilling: the inline elements get moved to the heap, and from now on the
+  // small vector behaves just like a normal vector
+  size_t new_cap = snifex_api_vec_next_cap(*cap, min_cap, elem_size, policy);
+  heap = malloc(new_cap * elem_size);
+  assert(heap != NULL);
+  if (len != 0) { memcpy(heap, inline_buf, len * elem_size); }
+  *cap = new_cap;
+  return heap;
+}
+
+void* snifex_api_deque_grow(void* ptr,
+                            size_t* const cap,
+                            const size_t head,
+                            const size_t len,
+                            const size_t min_cap,
+                            const size_t elem_size) {
+  assert(cap != NULL && elem_size > 0);
+  const size_t old_cap = *cap;
+  if (min_cap <= old_cap) { return ptr; }
+
+  size_t new_cap = old_cap > 0 ? old_cap : 1;
+  while (new_cap < min_cap) { new_cap *= 2; }
+  ptr = realloc(ptr, new_cap * elem_size);
+  assert(ptr != NULL);
+
+  // The elements that wrapped around the end of the old buffer now go right
+  // after it, which has room for all of them since the capacity at least
+  // doubled
+  if (head + len > old_cap) {
+    memcpy((char*)ptr + old_cap * elem_size, ptr,
+           (head + len - old_cap) * elem_size);
+  }
+  *cap = new_cap;
+  return ptr;
+}
+
+static inline uint64_t snifex_api_radix_key(const char* const key,
+                                            const size_t key_size,
+                                            const uint8_t kind) {
+  uint64_t k;
+  switch (key_size) {
+    case 1: {
+      uint8_t v;
+      memcpy(&v, key, 1);
+      k = v;
+    } break;
+    case 2: {
+      uint16_t v;
+      memcpy(&v, key, 2);
+      k = v;
+    } break;
+    case 4: {
+      uint32_t v;
+      memcpy(&v, key, 4);
+      k = v;
+    } break;
+    default: {
+      memcpy(&k, key, 8);
+    } break;
+  }
+
+  const uint64_t sign = (uint64_t)1 << (key_size * 8 - 1);
+  const uint64_t mask = sign | (sign - 1);
+  if (kind == SNIFEX_API_RADIX_SIGNED) {
+    k ^= sign;
+  } else if (kind == SNIFEX_API_RADIX_FLOAT) {
+    // IEEE 754: negatives are reversed and go before positives
+    k = (k & sign) ? (~k & mask) : (k | sign);
+  }
+  return k;
+}
+
+void snifex_api_radix_sort(void* ptr,
+                           const size_t len,
+                           const size_t elem_size,
+                           const size_t key_offset,
+                           const size_t key_size,
+                           const uint8_t kind) {
+  assert(key_size == 1 || key_size == 2 || key_size == 4 || key_size == 8);
+  assert(key_offset + key_size <= elem_size);
+  if (len < 2) { return; }
+
+  // All histograms are computed in a single read of the input
+  size_t(*counts)[256] = calloc(key_size, sizeof(*counts));
+  assert(counts != NULL);
+  const char* elems = (const char*)ptr;
+  for (size_t i = 0; i < len; i++) {
+    uint64_t k = snifex_api_radix_key(elems + i * elem_size + key_offset,
+                                      key_size, kind);
+    for (size_t b = 0; b < key_size; b++) {
+      counts[b][(k >> (b * 8)) & 0xFF]++;
+    }
+  }
+
+  char* src = (char*)ptr;
+  char* dst = (char*)malloc(len * elem_size);
+  assert(dst != NULL);
+  char* const scratch = dst;
+
+  for (size_t b = 0; b < key_size; b++) {
+    size_t* count = counts[b];
+    // If every key has the same byte this pass would not move anything
+    bool skip = false;
+    for (size_t d = 0; d < 256; d++) {
+      if (count[d] == len) { skip = true; }
+      if (count[d] != 0) { break; }
+    }
+    if (skip) { continue; }
+
+    size_t offset = 0;
+    for (size_t d = 0; d < 256; d++) {
+      size_t c = count[d];
+      count[d] = offset;
+      offset += c;
+    }
+    for (size_t i = 0; i < len; i++) {
+      const char* elem = src + i * elem_size;
+      uint64_t k = snifex_api_radix_key(elem + key_offset, key_size, kind);
+      memcpy(dst + count[(k >> (b * 8)) & 0xFF]++ * elem_size, elem, elem_size);
+    }
+    char* tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+
+  if (src != (char*)ptr) { memcpy(ptr, src, len * elem_size); }
+  free(scratch);
+  free(counts);
+}
+
+// Scalar kernels, used as the portable fallback and for the tails of the SIMD
+// ones. `find` returns `len` when `x` is not there
+#define SNIFEX_API_SCALAR_KERNELS(t)                                        \
+  static size_t snifex_api_find_scalar_##t(const t* ptr, const size_t len,  \
+                                           const t x) {                     \
+    for (size_t i = 0; i < len; i++) {                                      \
+      if (ptr[i] == x) { return i; }                                        \
+    }                                                                       \
+    return len;                                                             \
+  }                                                                         \
+                                                                            \
+  static size_t snifex_api_count_scalar_##t(const t* ptr, const size_t len, \
+                                            const t x) {                    \
+    size_t count = 0;                                                       \
+    for (size_t i = 0; i < len; i++) { count += ptr[i] == x; }              \
+    return count;                                                           \
+  }                                                                         \
+                                                                            \
+  static t snifex_api_min_scalar_##t(const t* ptr, const size_t len,        \
+                                     t acc) {                               \
+    for (size_t i = 0; i < len; i++) { acc = ptr[i] < acc ? ptr[i] : acc; } \
+    return acc;                                                             \
+  }                                                                         \
+                                                                            \
+  static t snifex_api_max_scalar_##t(const t* ptr, const size_t len,        \
+                                     t acc) {                               \
+    for (size_t i = 0; i < len; i++) { acc = ptr[i] > acc ? ptr[i] : acc; } \
+    return acc;                                                             \
+  }
+
+SNIFEX_API_SCALAR_KERNELS(uint32_t)
+SNIFEX_API_SCALAR_KERNELS(uint64_t)
+SNIFEX_API_SCALAR_KERNELS(float)
+
+#ifdef SNIFEX_API_X86_SIMD
+// x86-64 always has SSE2, while AVX2 is checked at runtime. Each instruction
+// set and type gets the same handful of operations, so the kernels below can
+// be written once: `P` is the prefix of the operations, `lanes` the number of
+// elements in a vector
+#define SNIFEX_API_TARGET_SSE2
+#define SNIFEX_API_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+
+static inline size_t snifex_api_popcount4(const int mask) {
+  return (size_t)((mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) +
+                  ((mask >> 3) & 1));
+}
+
+// SSE2 has no unsigned 32 bit min/max nor 64 bit comparisons: flipping the
+// sign bit turns unsigned comparisons into signed ones
+static inline __m128i snifex_api_sse2_gt_u32(const __m128i a,
+                                             const __m128i b) {
+  const __m128i bias = _mm_set1_epi32((int32_t)0x80000000u);
+  return _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+static inline __m128i snifex_api_sse2_min_u32(const __m128i a,
+                                              const __m128i b) {
+  const __m128i gt = snifex_api_sse2_gt_u32(a, b);
+  return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+}
+static inline __m128i snifex_api_sse2_max_u32(const __m128i a,
+                                              const __m128i b) {
+  const __m128i gt = snifex_api_sse2_gt_u32(a, b);
+  return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+static inline __m128i snifex_api_sse2_eq_u64(const __m128i a,
+                                             const __m128i b) {
+  const __m128i eq = _mm_cmpeq_epi32(a, b);
+  return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+SNIFEX_API_TARGET_AVX2 static inline __m256i snifex_api_avx2_gt_u64(
+    const __m256i a, const __m256i b) {
+  const __m256i bias = _mm256_set1_epi64x((int64_t)0x8000000000000000u);
+  return _mm256_cmpgt_epi64(_mm256_xor_si256(a, bias),
+                            _mm256_xor_si256(b, bias));
+}
+SNIFEX_API_TARGET_AVX2 static inline __m256i snifex_api_avx2_min_u64(
+    const __m256i a, const __m256i b) {
+  return _mm256_blendv_epi8(a, b, snifex_api_avx2_gt_u64(a, b));
+}
+SNIFEX_API_TARGET_AVX2 static inline __m256i snifex_api_avx2_max_u64(
+    const __m256i a, const __m256i b) {
+  return _mm256_blendv_epi8(b, a, snifex_api_avx2_gt_u64(a, b));
+}
+
+#define SNIFEX_API_SSE2_U32_LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#define SNIFEX_API_SSE2_U32_SET1(x) _mm_set1_epi32((int32_t)(x))
+#define SNIFEX_API_SSE2_U32_EQ(a, b) _mm_cmpeq_epi32(a, b)
+#define SNIFEX_API_SSE2_U32_OR(a, b) _mm_or_si128(a, b)
+#define SNIFEX_API_SSE2_U32_MASK(v) _mm_movemask_ps(_mm_castsi128_ps(v))
+#define SNIFEX_API_SSE2_U32_MIN(a, b) snifex_api_sse2_min_u32(a, b)
+#define SNIFEX_API_SSE2_U32_MAX(a, b) snifex_api_sse2_max_u32(a, b)
+#define SNIFEX_API_SSE2_U32_STORE(p, v) _mm_storeu_si128((__m128i*)(p), v)
+#define SNIFEX_API_SSE2_U32_POPCOUNT(m) snifex_api_popcount4(m)
+
+#define SNIFEX_API_SSE2_U64_LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#define SNIFEX_API_SSE2_U64_SET1(x) _mm_set1_epi64x((int64_t)(x))
+#define SNIFEX_API_SSE2_U64_EQ(a, b) snifex_api_sse2_eq_u64(a, b)
+#define SNIFEX_API_SSE2_U64_OR(a, b) _mm_or_si128(a, b)
+#define SNIFEX_API_SSE2_U64_MASK(v) _mm_movemask_pd(_mm_castsi128_pd(v))
+#define SNIFEX_API_SSE2_U64_POPCOUNT(m) snifex_api_popcount4(m)
+
+#define SNIFEX_API_SSE2_F32_LOAD(p) _mm_loadu_ps(p)
+#define SNIFEX_API_SSE2_F32_SET1(x) _mm_set1_ps(x)
+#define SNIFEX_API_SSE2_F32_EQ(a, b) _mm_cmpeq_ps(a, b)
+#define SNIFEX_API_SSE2_F32_OR(a, b) _mm_or_ps(a, b)
+#define SNIFEX_API_SSE2_F32_MASK(v) _mm_movemask_ps(v)
+#define SNIFEX_API_SSE2_F32_MIN(a, b) _mm_min_ps(a, b)
+#define SNIFEX_API_SSE2_F32_MAX(a, b) _mm_max_ps(a, b)
+#define SNIFEX_API_SSE2_F32_STORE(p, v) _mm_storeu_ps(p, v)
+#define SNIFEX_API_SSE2_F32_POPCOUNT(m) snifex_api_popcount4(m)
+
+#define SNIFEX_API_AVX2_U32_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define SNIFEX_API_AVX2_U32_SET1(x) _mm256_set1_epi32((int32_t)(x))
+#define SNIFEX_API_AVX2_U32_EQ(a, b) _mm256_cmpeq_epi32(a, b)
+#define SNIFEX_API_AVX2_U32_OR(a, b) _mm256_or_si256(a, b)
+#define SNIFEX_API_AVX2_U32_MASK(v) _mm256_movemask_ps(_mm256_castsi256_ps(v))
+#define SNIFEX_API_AVX2_U32_MIN(a, b) _mm256_min_epu32(a, b)
+#define SNIFEX_API_AVX2_U32_MAX(a, b) _mm256_max_epu32(a, b)
+#define SNIFEX_API_AVX2_U32_STORE(p, v) _mm256_storeu_si256((__m256i*)(p), v)
+#define SNIFEX_API_AVX2_U32_POPCOUNT(m) (size_t) __builtin_popcount(m)
+
+#define SNIFEX_API_AVX2_U64_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define SNIFEX_API_AVX2_U64_SET1(x) _mm256_set1_epi64x((int64_t)(x))
+#define SNIFEX_API_AVX2_U64_EQ(a, b) _mm256_cmpeq_epi64(a, b)
+#define SNIFEX_API_AVX2_U64_OR(a, b) _mm256_or_si256(a, b)
+#define SNIFEX_API_AVX2_U64_MASK(v) _mm256_movemask_pd(_mm256_castsi256_pd(v))
+#define SNIFEX_API_AVX2_U64_MIN(a, b) snifex_api_avx2_min_u64(a, b)
+#define SNIFEX_API_AVX2_U64_MAX(a, b) snifex_api_avx2_max_u64(a, b)
+#define SNIFEX_API_AVX2_U64_STORE(p, v) _mm256_storeu_si256((__m256i*)(p), v)
+#define SNIFEX_API_AVX2_U64_POPCOUNT(m) (size_t) __builtin_popcount(m)
+
+#define SNIFEX_API_AVX2_F32_LOAD(p) _mm256_loadu_ps(p)
+#define SNIFEX_API_AVX2_F32_SET1(x) _mm256_set1_ps(x)
+#define SNIFEX_API_AVX2_F32_EQ(a, b) _mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+#define SNIFEX_API_AVX2_F32_OR(a, b) _mm256_or_ps(a, b)
+#define SNIFEX_API_AVX2_F32_MASK(v) _mm256_movemask_ps(v)
+#define SNIFEX_API_AVX2_F32_MIN(a, b) _mm256_min_ps(a, b)
+#define SNIFEX_API_AVX2_F32_MAX(a, b) _mm256_max_ps(a, b)
+#define SNIFEX_API_AVX2_F32_STORE(p, v) _mm256_storeu_ps(p, v)
+#define SNIFEX_API_AVX2_F32_POPCOUNT(m) (size_t) __builtin_popcount(m)
+
+// Four vectors are compared per iteration, and only when one of them matched
+// the exact index is looked for
+#define SNIFEX_API_SIMD_FIND_COUNT(isa, P, t, V, lanes)                    \
+  SNIFEX_API_TARGET_##isa static size_t snifex_api_find_##isa##_##t(       \
+      const t* ptr, const size_t len, const t x) {                         \
+    const V key = SNIFEX_API_##P##_SET1(x);                                \
+    size_t i = 0;                                                          \
+    for (; i + 4 * (lanes) <= len; i += 4 * (lanes)) {                     \
+      const V a = SNIFEX_API_##P##_LOAD(&ptr[i]);                          \
+      const V b = SNIFEX_API_##P##_LOAD(&ptr[i + (lanes)]);                \
+      const V c = SNIFEX_API_##P##_LOAD(&ptr[i + 2 * (lanes)]);            \
+      const V d = SNIFEX_API_##P##_LOAD(&ptr[i + 3 * (lanes)]);            \
+      const V ab = SNIFEX_API_##P##_OR(SNIFEX_API_##P##_EQ(a, key),        \
+                                       SNIFEX_API_##P##_EQ(b, key));       \
+      const V cd = SNIFEX_API_##P##_OR(SNIFEX_API_##P##_EQ(c, key),        \
+                                       SNIFEX_API_##P##_EQ(d, key));       \
+      const V any = SNIFEX_API_##P##_OR(ab, cd);                           \
+      if (SNIFEX_API_##P##_MASK(any) != 0) { break; }                      \
+    }                                                                      \
+    for (; i + (lanes) <= len; i += (lanes)) {                             \
+      const int mask = SNIFEX_API_##P##_MASK(                              \
+          SNIFEX_API_##P##_EQ(SNIFEX_API_##P##_LOAD(&ptr[i]), key));       \
+      if (mask != 0) { return i + (size_t)__builtin_ctz((unsigned)mask); } \
+    }                                                                      \
+    return i + snifex_api_find_scalar_##t(&ptr[i], len - i, x);            \
+  }                                                                        \
+                                                                           \
+  SNIFEX_API_TARGET_##isa static size_t snifex_api_count_##isa##_##t(      \
+      const t* ptr, const size_t len, const t x) {                         \
+    const V key = SNIFEX_API_##P##_SET1(x);                                \
+    size_t count = 0;                                                      \
+    size_t i = 0;                                                          \
+    for (; i + (lanes) <= len; i += (lanes)) {                             \
+      count += SNIFEX_API_##P##_POPCOUNT(SNIFEX_API_##P##_MASK(            \
+          SNIFEX_API_##P##_EQ(SNIFEX_API_##P##_LOAD(&ptr[i]), key)));      \
+    }                                                                      \
+    return count + snifex_api_count_scalar_##t(&ptr[i], len - i, x);       \
+  }
+
+// The accumulator starts from the first vector, so `len >= lanes` is required
+#define SNIFEX_API_SIMD_MIN_MAX(isa, P, t, V, lanes, op, OP)                  \
+  SNIFEX_API_TARGET_##isa static t snifex_api_##op##_##isa##_##t(             \
+      const t* ptr, const size_t len) {                                       \
+    V acc = SNIFEX_API_##P##_LOAD(ptr);                                       \
+    size_t i = (lanes);                                                       \
+    for (; i + 4 * (lanes) <= len; i += 4 * (lanes)) {                        \
+      const V a = SNIFEX_API_##P##_LOAD(&ptr[i]);                             \
+      const V b = SNIFEX_API_##P##_LOAD(&ptr[i + (lanes)]);                   \
+      const V c = SNIFEX_API_##P##_LOAD(&ptr[i + 2 * (lanes)]);               \
+      const V d = SNIFEX_API_##P##_LOAD(&ptr[i + 3 * (lanes)]);               \
+      const V ab = SNIFEX_API_##P##_##OP(a, b);                               \
+      const V cd = SNIFEX_API_##P##_##OP(c, d);                               \
+      acc = SNIFEX_API_##P##_##OP(acc, SNIFEX_API_##P##_##OP(ab, cd));        \
+    }                                                                         \
+    for (; i + (lanes) <= len; i += (lanes)) {                                \
+      acc = SNIFEX_API_##P##_##OP(acc, SNIFEX_API_##P##_LOAD(&ptr[i]));       \
+    }                                                                         \
+    t acc_lanes[lanes];                                                       \
+    SNIFEX_API_##P##_STORE(acc_lanes, acc);                                   \
+    const t result = snifex_api_##op##_scalar_##t(acc_lanes + 1, (lanes) - 1, \
+                                                  acc_lanes[0]);              \
+    return snifex_api_##op##_scalar_##t(&ptr[i], len - i, result);            \
+  }
+
+SNIFEX_API_SIMD_FIND_COUNT(SSE2, SSE2_U32, uint32_t, __m128i, 4)
+SNIFEX_API_SIMD_FIND_COUNT(SSE2, SSE2_U64, uint64_t, __m128i, 2)
+SNIFEX_API_SIMD_FIND_COUNT(SSE2, SSE2_F32, float, __m128, 4)
+SNIFEX_API_SIMD_FIND_COUNT(AVX2, AVX2_U32, uint32_t, __m256i, 8)
+SNIFEX_API_SIMD_FIND_COUNT(AVX2, AVX2_U64, uint64_t, __m256i, 4)
+SNIFEX_API_SIMD_FIND_COUNT(AVX2, AVX2_F32, float, __m256, 8)
+
+SNIFEX_API_SIMD_MIN_MAX(SSE2, SSE2_U32, uint32_t, __m128i, 4, min, MIN)
+SNIFEX_API_SIMD_MIN_MAX(SSE2, SSE2_U32, uint32_t, __m128i, 4, max, MAX)
+SNIFEX_API_SIMD_MIN_MAX(SSE2, SSE2_F32, float, __m128, 4, min, MIN)
+SNIFEX_API_SIMD_MIN_MAX(SSE2, SSE2_F32, float, __m128, 4, max, MAX)
+SNIFEX_API_SIMD_MIN_MAX(AVX2, AVX2_U32, uint32_t, __m256i, 8, min, MIN)
+SNIFEX_API_SIMD_MIN_MAX(AVX2, AVX2_U32, uint32_t, __m256i, 8, max, MAX)
+SNIFEX_API_SIMD_MIN_MAX(AVX2, AVX2_U64, uint64_t, __m256i, 4, min, MIN)
+SNIFEX_API_SIMD_MIN_MAX(AVX2, AVX2_U64, uint64_t, __m256i, 4, max, MAX)
+SNIFEX_API_SIMD_MIN_MAX(AVX2, AVX2_F32, float, __m256, 8, min, MIN)
+SNIFEX_API_SIMD_MIN_MAX(AVX2, AVX2_F32, float, __m256, 8, max, MAX)
+
+// SSE2 has no 64 bit comparison, so there is no SSE2 64 bit min/max
+#define snifex_api_min_SSE2_uint64_t(ptr, len) \
+  snifex_api_min_scalar_uint64_t((ptr) + 1, (len) - 1, (ptr)[0])
+#define snifex_api_max_SSE2_uint64_t(ptr, len) \
+  snifex_api_max_scalar_uint64_t((ptr) + 1, (len) - 1, (ptr)[0])
+
+#define SNIFEX_API_HAS_AVX2() __builtin_cpu_supports("avx2")
+#endif  // SNIFEX_API_X86_SIMD
+
+// The exported functions pick the widest available kernel
+#ifdef SNIFEX_API_X86_SIMD
+#define SNIFEX_API_SIMD_DISPATCH(t, lanes_avx2, lanes_sse2)       \
+  size_t snifex_api_vec_find_##t(const t* ptr, const size_t len,  \
+                                 const t x) {                     \
+    assert(ptr != NULL || len == 0);                              \
+    if (SNIFEX_API_HAS_AVX2()) {                                  \
+      return snifex_api_find_AVX2_##t(ptr, len, x);               \
+    }                                                             \
+    return snifex_api_find_SSE2_##t(ptr, len, x);                 \
+  }                                                               \
+  size_t snifex_api_vec_count_##t(const t* ptr, const size_t len, \
+                                  const t x) {                    \
+    assert(ptr != NULL || len == 0);                              \
+    if (SNIFEX_API_HAS_AVX2()) {                                  \
+      return snifex_api_count_AVX2_##t(ptr, len, x);              \
+    }                                                             \
+    return snifex_api_count_SSE2_##t(ptr, len, x);                \
+  }                                                               \
+  t snifex_api_vec_min_##t(const t* ptr, const size_t len) {      \
+    assert(ptr != NULL && len > 0);                               \
+    if (SNIFEX_API_HAS_AVX2() && len >= (lanes_avx2)) {           \
+      return snifex_api_min_AVX2_##t(ptr, len);                   \
+    }                                                             \
+    if (len >= (lanes_sse2)) {                                    \
+      return snifex_api_min_SSE2_##t(ptr, len);                   \
+    }                                                             \
+    return snifex_api_min_scalar_##t(ptr + 1, len - 1, ptr[0]);   \
+  }                                                               \
+  t snifex_api_vec_max_##t(const t* ptr, const size_t len) {      \
+    assert(ptr != NULL && len > 0);                               \
+    if (SNIFEX_API_HAS_AVX2() && len >= (lanes_avx2)) {           \
+      return snifex_api_max_AVX2_##t(ptr, len);                   \
+    }                                                             \
+    if (len >= (lanes_sse2)) {                                    \
+      return snifex_api_max_SSE2_##t(ptr, len);                   \
+    }                                                             \
+    return snifex_api_max_scalar_##t(ptr + 1, len - 1, ptr[0]);   \
+  }
+#else
+#define SNIFEX_API_SIMD_DISPATCH(t, lanes_avx2, lanes_sse2)                   \
+  size_t snifex_api_vec_find_##t(const t* ptr, const size_t len, const t x) { \
+    assert(ptr != NULL || len == 0);                                          \
+    return snifex_api_find_scalar_##t(ptr, len, x);                           \
+  }                                                                           \
+  size_t snifex_api_vec_count_##t(const t* ptr, const size_t len,             \
+                                  const t x) {                                \
+    assert(ptr != NULL || len == 0);                                          \
+    return snifex_api_count_scalar_##t(ptr, len, x);                          \
+  }                                                                           \
+  t snifex_api_vec_min_##t(const t* ptr, const size_t len) {                  \
+    assert(ptr != NULL && len > 0);                                           \
+    return snifex_api_min_scalar_##t(ptr + 1, len - 1, ptr[0]);               \
+  }                                                                           \
+  t snifex_api_vec_max_##t(const t* ptr, const size_t len) {                  \
+    assert(ptr != NULL && len > 0);                                           \
+    return snifex_api_max_scalar_##t(ptr + 1, len - 1, ptr[0]);               \
+  }
+#endif  // SNIFEX_API_X86_SIMD
+
+SNIFEX_API_SIMD_DISPATCH(uint32_t, 8, 4)
+SNIFEX_API_SIMD_DISPATCH(uint64_t, 4, 2)
+SNIFEX_API_SIMD_DISPATCH(float, 8, 4)
+
+static inline size_t snifex_api_popcount64(const uint64_t x) {
+#if defined(__GNUC__)
+  return (size_t)__builtin_popcountll(x);
+#else
+  uint64_t c = x - ((x >> 1) & 0x5555555555555555ull);
+  c = (c & 0x3333333333333333ull) + ((c >> 2) & 0x3333333333333333ull);
+  c = (c + (c >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+  return (size_t)((c * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// `x` must not be 0
+static inline size_t snifex_api_ctz64(const uint64_t x) {
+#if defined(__GNUC__)
+  return (size_t)__builtin_ctzll(x);
+#else
+  return snifex_api_popcount64((x & -x) - 1);
+#endif
+}
+
+// Index of the set bit of `x` with `r` set bits before it
+static inline size_t snifex_api_select64(uint64_t x, size_t r) {
+  size_t shift = 0;
+  for (size_t c; r >= (c = snifex_api_popcount64(x & 0xFF)); r -= c) {
+    x >>= 8;
+    shift += 8;
+  }
+  for (; r > 0; r--) { x &= x - 1; }
+  return shift + snifex_api_ctz64(x);
+}
+
+#ifdef SNIFEX_API_X86_SIMD
+__attribute__((target("popcnt"))) static size_t
+snifex_api_popcount_words_popcnt(const uint64_t* words, const size_t n) {
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    count += (size_t)__builtin_popcountll(words[i]);
+  }
+  return count;
+}
+#endif
+
+static size_t snifex_api_popcount_words(const uint64_t* words,
+                                        const size_t n) {
+#ifdef SNIFEX_API_X86_SIMD
+  if (__builtin_cpu_supports("popcnt")) {
+    return snifex_api_popcount_words_popcnt(words, n);
+  }
+#endif
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) { count += snifex_api_popcount64(words[i]); }
+  return count;
+}
+
+#ifndef SNIFEX_API_NODE_POOL_CHUNK
+// Number of nodes allocated at once by a node pool
+#define SNIFEX_API_NODE_POOL_CHUNK 64
+#endif
+
+void* snifex_api_node_pool_alloc(struct snifex_api_node_pool* const pool) {
+  assert(pool != NULL && pool->node_size >= sizeof(void*));
+  if (pool->free == NULL) {
+    // Nodes are aligned to cache lines, and the chunk list link goes before
+    // them
+    const size_t node_size =
+        (pool->node_size + SNIFEX_API_CACHE_LINE - 1) &
+        ~(size_t)(SNIFEX_API_CACHE_LINE - 1);
+    char* chunk = malloc(SNIFEX_API_CACHE_LINE +
+                         SNIFEX_API_NODE_POOL_CHUNK * node_size);
+    assert(chunk != NULL);
+    *(void**)chunk = pool->chunks;
+    pool->chunks = chunk;
+    char* nodes = (char*)(((uintptr_t)chunk + sizeof(void*) +
+                           SNIFEX_API_CACHE_LINE - 1) &
+                          ~(uintptr_t)(SNIFEX_API_CACHE_LINE - 1));
+    for (size_t i = SNIFEX_API_NODE_POOL_CHUNK; i-- > 0;) {
+      *(void**)(nodes + i * node_size) = pool->free;
+      pool->free = nodes + i * node_size;
+    }
+  }
+  void* node = pool->free;
+  pool->free = *(void**)node;
+  return node;
+}
+
+void snifex_api_node_pool_release(struct snifex_api_node_pool* const pool,
+                                  void* const node) {
+  assert(pool != NULL && node != NULL);
+  *(void**)node = pool->free;
+  pool->free = node;
+}
+
+void snifex_api_node_pool_free(struct snifex_api_node_pool* const pool) {
+  assert(pool != NULL);
+  while (pool->chunks != NULL) {
+    void* next = *(void**)pool->chunks;
+    free(pool->chunks);
+    pool->chunks = next;
+  }
+  pool->free = NULL;
+}
+
+#define SNIFEX_API_BITVEC_WORDS(len) (((len) + 63) / 64)
+
+BitVec bitvec_create(const size_t len) {
+  const size_t cap = SNIFEX_API_BITVEC_WORDS(len);
+  BitVec bv = {.len = len, .cap = cap, .in_arena = false};
+  if (cap > 0) {
+    bv.words = calloc(cap, sizeof(uint64_t));
+    assert(bv.words != NULL);
+  }
+  return bv;
+}
+
+BitVec bitvec_create_in(Arena* const arena, const size_t len) {
+  assert(arena != NULL);
+  const size_t cap = SNIFEX_API_BITVEC_WORDS(len);
+  BitVec bv = {.len = len, .cap = cap, .in_arena = true};
+  if (cap > 0) {
+    bv.words = arena_alloc(arena, cap * sizeof(uint64_t), sizeof(uint64_t));
+    assert(bv.words != NULL);
+    memset(bv.words, 0, cap * sizeof(uint64_t));
+  }
+  return bv;
+}
+
+// Words past `len` are always clear, so growing just moves `len`
+void bitvec_resize(BitVec* const bv, const size_t len) {
+  assert(bv != NULL);
+  const size_t words = SNIFEX_API_BITVEC_WORDS(len);
+  if (len < bv->len) {
+    const size_t old_words = SNIFEX_API_BITVEC_WORDS(bv->len);
+    if (len & 63) { bv->words[words - 1] &= ~(uint64_t)0 >> (64 - (len & 63)); }
+    memset(bv->words + words, 0, (old_words - words) * sizeof(uint64_t));
+  } else if (words > bv->cap) {
+    assert(!bv->in_arena);
+    size_t cap = bv->cap > 0 ? bv->cap * 2 : 1;
+    if (cap < words) { cap = words; }
+    uint64_t* grown = realloc(bv->words, cap * sizeof(uint64_t));
+    assert(grown != NULL);
+    memset(grown + bv->cap, 0, (cap - bv->cap) * sizeof(uint64_t));
+    bv->words = grown;
+    bv->cap = cap;
+  }
+  bv->len = len;
+}
+
+void bitvec_push(BitVec* const bv, const bool bit) {
+  assert(bv != NULL);
+  const size_t i = bv->len;
+  bitvec_resize(bv, i + 1);
+  bv->words[i >> 6] |= (uint64_t)bit << (i & 63);
+}
+
+void bitvec_fill(BitVec* const bv, const bool bit) {
+  assert(bv != NULL);
+  const size_t words = SNIFEX_API_BITVEC_WORDS(bv->len);
+  if (words == 0) { return; }
+  memset(bv->words, bit ? 0xFF : 0, words * sizeof(uint64_t));
+  if (bit && (bv->len & 63)) {
+    bv->words[words - 1] = ~(uint64_t)0 >> (64 - (bv->len & 63));
+  }
+}
+
+void bitvec_free(BitVec* const bv) {
+  assert(bv != NULL);
+  if (!bv->in_arena) { free(bv->words); }
+  *bv = (BitVec){0};
+}
+
+#define SNIFEX_API_BITVEC_OP(name, expr)                           \
+  void bitvec_##name(BitVec* const dst, const BitVec* const src) { \
+    assert(dst != NULL && src != NULL && dst->len == src->len);    \
+    uint64_t* d = dst->words;                                      \
+    const uint64_t* s = src->words;                                \
+    const size_t words = SNIFEX_API_BITVEC_WORDS(dst->len);        \
+    for (size_t i = 0; i < words; i++) { d[i] = (expr); }          \
+  }
+SNIFEX_API_BITVEC_OP(and, d[i] & s[i])
+SNIFEX_API_BITVEC_OP(or, d[i] | s[i])
+SNIFEX_API_BITVEC_OP(xor, d[i] ^ s[i])
+SNIFEX_API_BITVEC_OP(andnot, d[i] & ~s[i])
+#undef SNIFEX_API_BITVEC_OP
+
+void bitvec_not(BitVec* const bv) {
+  assert(bv != NULL);
+  const size_t words = SNIFEX_API_BITVEC_WORDS(bv->len);
+  for (size_t i = 0; i < words; i++) { bv->words[i] = ~bv->words[i]; }
+  if (bv->len & 63) {
+    bv->words[words - 1] &= ~(uint64_t)0 >> (64 - (bv->len & 63));
+  }
+}
+
+size_t bitvec_popcount(const BitVec* const bv) {
+  assert(bv != NULL);
+  return snifex_api_popcount_words(bv->words, SNIFEX_API_BITVEC_WORDS(bv->len));
+}
+
+size_t bitvec_next_set(const BitVec* const bv, const size_t from) {
+  assert(bv != NULL);
+  if (from >= bv->len) { return bv->len; }
+  const size_t words = SNIFEX_API_BITVEC_WORDS(bv->len);
+  size_t w = from >> 6;
+  uint64_t word = bv->words[w] & (~(uint64_t)0 << (from & 63));
+  while (word == 0) {
+    if (++w == words) { return bv->len; }
+    word = bv->words[w];
+  }
+  return w * 64 + snifex_api_ctz64(word);
+}
+
+size_t bitvec_next_clear(const BitVec* const bv, const size_t from) {
+  assert(bv != NULL);
+  if (from >= bv->len) { return bv->len; }
+  const size_t words = SNIFEX_API_BITVEC_WORDS(bv->len);
+  size_t w = from >> 6;
+  uint64_t word = ~bv->words[w] & (~(uint64_t)0 << (from & 63));
+  while (word == 0) {
+    if (++w == words) { return bv->len; }
+    word = ~bv->words[w];
+  }
+  // The clear bits past the end of the last word are not part of the vector
+  const size_t i = w * 64 + snifex_api_ctz64(word);
+  return i < bv->len ? i : bv->len;
+}
+
+// Rank9 (Vigna, "Broadword implementation of rank/select queries"): blocks of
+// 8 words, each with its absolute count and the 7 relative counts of its words
+// packed in 9 bits each
+#define SNIFEX_API_RANK_SUB(counts, b, j) \
+  ((j) == 0 ? 0 : ((counts)[2 * (b) + 1] >> (9 * ((j) - 1))) & 0x1FF)
+
+BitRank bitrank_create(const BitVec* const bv) {
+  assert(bv != NULL);
+  const size_t words = SNIFEX_API_BITVEC_WORDS(bv->len);
+  const size_t blocks = (words + 7) / 8;
+  BitRank rank = {.words = bv->words, .len = bv->len};
+  // One more block at the end, so ranking the whole vector needs no branch
+  rank.counts = malloc((blocks + 1) * 2 * sizeof(uint64_t));
+  assert(rank.counts != NULL);
+
+  size_t hints_cap = 16;
+  size_t n_hints = 0;
+  rank.hints = malloc(hints_cap * sizeof(size_t));
+  assert(rank.hints != NULL);
+
+  uint64_t total = 0;
+  for (size_t b = 0; b < blocks; b++) {
+    rank.counts[2 * b] = total;
+    uint64_t sub = 0;
+    uint64_t in_block = 0;
+    for (size_t j = 0; j < 8; j++) {
+      if (j > 0) { sub |= in_block << (9 * (j - 1)); }
+      const size_t w = b * 8 + j;
+      const size_t c = w < words ? snifex_api_popcount64(bv->words[w]) : 0;
+      // Every 512th set bit remembers its block
+      while (n_hints * 512 < total + in_block + c) {
+        if (n_hints == hints_cap) {
+          hints_cap *= 2;
+          rank.hints = realloc(rank.hints, hints_cap * sizeof(size_t));
+          assert(rank.hints != NULL);
+        }
+        rank.hints[n_hints++] = b;
+      }
+      in_block += c;
+    }
+    rank.counts[2 * b + 1] = sub;
+    total += in_block;
+  }
+  rank.counts[2 * blocks] = total;
+  rank.counts[2 * blocks + 1] = 0;
+  rank.ones = (size_t)total;
+  return rank;
+}
+
+size_t bitrank_rank1(const BitRank* const rank, const size_t i) {
+  assert(rank != NULL && i <= rank->len);
+  const size_t w = i >> 6;
+  const size_t b = w >> 3;
+  size_t r = (size_t)(rank->counts[2 * b] +
+                      SNIFEX_API_RANK_SUB(rank->counts, b, w & 7));
+  if (i & 63) {
+    r += snifex_api_popcount64(rank->words[w] &
+                               (~(uint64_t)0 >> (64 - (i & 63))));
+  }
+  return r;
+}
+
+size_t bitrank_rank0(const BitRank* const rank, const size_t i) {
+  return i - bitrank_rank1(rank, i);
+}
+
+size_t bitrank_select1(const BitRank* const rank, const size_t k) {
+  assert(rank != NULL);
+  if (k >= rank->ones) { return rank->len; }
+  const size_t blocks = (SNIFEX_API_BITVEC_WORDS(rank->len) + 7) / 8;
+  const size_t n_hints = (rank->ones + 511) / 512;
+  // The block is between the ones of the two closest hints
+  size_t lo = rank->hints[k / 512];
+  size_t hi = k / 512 + 1 < n_hints ? rank->hints[k / 512 + 1] + 1 : blocks;
+  while (hi - lo > 1) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (rank->counts[2 * mid] <= k) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  size_t r = k - (size_t)rank->counts[2 * lo];
+  size_t j = 7;
+  while (SNIFEX_API_RANK_SUB(rank->counts, lo, j) > r) { j--; }
+  r -= (size_t)SNIFEX_API_RANK_SUB(rank->counts, lo, j);
+  const size_t w = lo * 8 + j;
+  return w * 64 + snifex_api_select64(rank->words[w], r);
+}
+
+size_t bitrank_select0(const BitRank* const rank, const size_t k) {
+  assert(rank != NULL);
+  if (k >= rank->len - rank->ones) { return rank->len; }
+  const size_t blocks = (SNIFEX_API_BITVEC_WORDS(rank->len) + 7) / 8;
+  // No hints for clear bits: the zeros before a block are its bits minus its
+  // ones
+  size_t lo = 0;
+  size_t hi = blocks;
+  while (hi - lo > 1) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (mid * 512 - rank->counts[2 * mid] <= k) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  size_t r = k - (lo * 512 - (size_t)rank->counts[2 * lo]);
+  size_t j = 7;
+  while (j * 64 - SNIFEX_API_RANK_SUB(rank->counts, lo, j) > r) { j--; }
+  r -= j * 64 - (size_t)SNIFEX_API_RANK_SUB(rank->counts, lo, j);
+  const size_t w = lo * 8 + j;
+  return w * 64 + snifex_api_select64(~rank->words[w], r);
+}
+
+void bitrank_free(BitRank* const rank) {
+  assert(rank != NULL);
+  free(rank->counts);
+  free(rank->hints);
+  *rank = (BitRank){0};
+}
+
+#ifdef SNIFEX_API_ATOMICS
+static SNIFEX_API_ATOMIC(size_t) snifex_api_parallel_threads = 0;
+// The workers of the parallel functions, started by the first call
+static SNIFEX_API_ATOMIC(ThreadPool*) snifex_api_parallel_pool = NULL;
+#else
+static size_t snifex_api_parallel_threads = 0;
+#endif
+
+size_t parallel_thread_count(void) {
+#ifdef SNIFEX_API_ATOMICS
+  const size_t set = snifex_api_atomic_load(&snifex_api_parallel_threads,
+                                            SNIFEX_API_RELAXED);
+#else
+  const size_t set = snifex_api_parallel_threads;
+#endif
+  if (set != 0) { return set; }
+#if defined(SNIFEX_API_PTHREADS)
+  const long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (size_t)count : 1;
+#elif defined(SNIFEX_API_WIN_THREADS)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+  return 1;
+#endif
+}
+
+void parallel_set_thread_count(const size_t count) {
+#ifdef SNIFEX_API_ATOMICS
+  snifex_api_atomic_store(&snifex_api_parallel_threads, count,
+                          SNIFEX_API_RELAXED);
+  // The next call starts the workers again, as many as the new count
+  ThreadPool* const pool =
+      snifex_api_atomic_load(&snifex_api_parallel_pool, SNIFEX_API_ACQUIRE);
+  if (pool != NULL &&
+      thread_pool_thread_count(pool) != parallel_thread_count()) {
+    parallel_shutdown();
+  }
+#else
+  snifex_api_parallel_threads = count;
+#endif
+}
+
+struct snifex_api_par_run {
+  void (*task)(void* ctx, size_t i, Arena* scratch);
+  void* ctx;
+};
+
+static void snifex_api_par_run_range(void* ctx,
+                                     size_t start,
+                                     size_t end,
+                                     Arena* scratch) {
+  const struct snifex_api_par_run* run = (const struct snifex_api_par_run*)ctx;
+  for (size_t i = start; i < end; i++) {
+    // Every task finds the scratch arena as the range found it
+    const size_t mark = scratch->top;
+    run->task(run->ctx, i, scratch);
+    scratch->top = mark;
+  }
+}
+
+#ifdef SNIFEX_API_ATOMICS
+static ThreadPool* snifex_api_parallel_get_pool(void) {
+  ThreadPool* pool =
+      snifex_api_atomic_load(&snifex_api_parallel_pool, SNIFEX_API_ACQUIRE);
+  if (pool != NULL) { return pool; }
+
+  ThreadPool* created = thread_pool_create(parallel_thread_count());
+  // Threads racing to create the pool keep the first one published
+  if (!snifex_api_atomic_cas(&snifex_api_parallel_pool, &pool, created,
+                             SNIFEX_API_ACQ_REL, SNIFEX_API_ACQUIRE)) {
+    thread_pool_free(created);
+    return pool;
+  }
+  return created;
+}
+#endif
+
+void parallel_shutdown(void) {
+#ifdef SNIFEX_API_ATOMICS
+  // Taking the pool out in one step, so that two shutdowns can't both free it
+  ThreadPool* const pool = snifex_api_atomic_exchange(
+      &snifex_api_parallel_pool, NULL, SNIFEX_API_ACQ_REL);
+  if (pool != NULL) { thread_pool_free(pool); }
+#endif
+}
+
+void parallel_run(const size_t n_tasks,
+                  void (*task)(void* ctx, size_t i, Arena* scratch),
+                  void* ctx) {
+  assert(task != NULL);
+  if (n_tasks == 0) { return; }
+
+  struct snifex_api_par_run run = {.task = task, .ctx = ctx};
+#ifdef SNIFEX_API_ATOMICS
+  thread_pool_parallel_for(snifex_api_parallel_get_pool(), n_tasks, 0,
+                           snifex_api_par_run_range, &run);
+#else
+  Arena scratch = arena_create(SNIFEX_API_PARALLEL_SCRATCH_SIZE);
+  snifex_api_par_run_range(&run, 0, n_tasks, &scratch);
+  arena_free(&scratch);
+#endif
+}
+
+struct snifex_api_par_for {
+  char* ptr;
+  size_t len;
+  size_t elem_size;
+  size_t chunks;
+  void (*fn)(ParChunk chunk);
+  void* ctx;
+  char* accs;
+  size_t acc_size;
+};
+
+static void snifex_api_par_for_task(void* ctx, size_t i, Arena* scratch) {
+  struct snifex_api_par_for* job = (struct snifex_api_par_for*)ctx;
+  const size_t lo = i * job->len / job->chunks;
+  const size_t hi = (i + 1) * job->len / job->chunks;
+  job->fn((ParChunk){
+      .ptr = job->ptr + lo * job->elem_size,
+      .start = lo,
+      .len = hi - lo,
+      .index = i,
+      .scratch = scratch,
+      .acc = job->accs != NULL ? job->accs + i * job->acc_size : NULL,
+      .ctx = job->ctx,
+  });
+}
+
+static size_t snifex_api_par_chunks(const size_t len) {
+  size_t chunks = parallel_thread_count();
+  if (chunks > len / SNIFEX_API_PARALLEL_MIN_CHUNK) {
+    chunks = len / SNIFEX_API_PARALLEL_MIN_CHUNK;
+  }
+  return chunks > 0 ? chunks : 1;
+}
+
+void snifex_api_vec_parallel_for(void* ptr,
+                                 const size_t len,
+                                 const size_t elem_size,
+                                 void (*fn)(ParChunk chunk),
+                                 void* ctx) {
+  assert(fn != NULL);
+  if (len == 0) { return; }
+
+  struct snifex_api_par_for job = {
+      .ptr = (char*)ptr,
+      .len = len,
+      .elem_size = elem_size,
+      .chunks = snifex_api_par_chunks(len),
+      .fn = fn,
+      .ctx = ctx,
+      .accs = NULL,
+      .acc_size = 0,
+  };
+  parallel_run(job.chunks, snifex_api_par_for_task, &job);
+}
+
+void snifex_api_vec_parallel_reduce(void* ptr,
+                                    const size_t len,
+                                    const size_t elem_size,
+                                    void* result,
+                                    const size_t result_size,
+                                    void (*fn)(ParChunk chunk),
+                                    void (*combine)(void* result,
+                                                    const void* partial,
+                                                    void* ctx),
+                                    void* ctx) {
+  assert(fn != NULL && combine != NULL && result != NULL);
+  if (len == 0) { return; }
+
+  struct snifex_api_par_for job = {
+      .ptr = (char*)ptr,
+      .len = len,
+      .elem_size = elem_size,
+      .chunks = snifex_api_par_chunks(len),
+      .fn = fn,
+      .ctx = ctx,
+      .acc_size = result_size,
+  };
+  job.accs = malloc(job.chunks * result_size);
+  assert(job.accs != NULL);
+  for (size_t i = 0; i < job.chunks; i++) {
+    memcpy(job.accs + i * result_size, result, result_size);
+  }
+
+  parallel_run(job.chunks, snifex_api_par_for_task, &job);
+
+  for (size_t i = 0; i < job.chunks; i++) {
+    combine(result, job.accs + i * result_size, ctx);
+  }
+  free(job.accs);
+}
+
+struct snifex_api_par_radix {
+  char* src;
+  char* dst;
+  size_t len;
+  size_t elem_size;
+  size_t key_offset;
+  size_t key_size;
+  uint8_t kind;
+  size_t chunks;
+  size_t byte;
+  bool scatter;
+  size_t (*counts)[256];  // One histogram per chunk
+};
+
+static void snifex_api_par_radix_task(void* ctx, size_t i, Arena* scratch) {
+  struct snifex_api_par_radix* job = (struct snifex_api_par_radix*)ctx;
+  (void)scratch;
+  const size_t lo = i * job->len / job->chunks;
+  const size_t hi = (i + 1) * job->len / job->chunks;
+  const size_t shift = job->byte * 8;
+  size_t* count = job->counts[i];
+
+  if (!job->scatter) {
+    memset(count, 0, sizeof(*job->counts));
+    for (size_t j = lo; j < hi; j++) {
+      uint64_t k = snifex_api_radix_key(
+          job->src + j * job->elem_size + job->key_offset, job->key_size,
+          job->kind);
+      count[(k >> shift) & 0xFF]++;
+    }
+    return;
+  }
+
+  for (size_t j = lo; j < hi; j++) {
+    const char* elem = job->src + j * job->elem_size;
+    uint64_t k =
+        snifex_api_radix_key(elem + job->key_offset, job->key_size, job->kind);
+    memcpy(job->dst + count[(k >> shift) & 0xFF]++ * job->elem_size, elem,
+           job->elem_size);
+  }
+}
+
+void snifex_api_parallel_radix_sort(void* ptr,
+                                    const size_t len,
+                                    const size_t elem_size,
+                                    const size_t key_offset,
+                                    const size_t key_size,
+                                    const uint8_t kind) {
+  const size_t chunks = snifex_api_par_chunks(len);
+  if (chunks < 2) {
+    snifex_api_radix_sort(ptr, len, elem_size, key_offset, key_size, kind);
+    return;
+  }
+  assert(key_size == 1 || key_size == 2 || key_size == 4 || key_size == 8);
+  assert(key_offset + key_size <= elem_size);
+
+  struct snifex_api_par_radix job = {
+      .src = (char*)ptr,
+      .dst = (char*)malloc(len * elem_size),
+      .len = len,
+      .elem_size = elem_size,
+      .key_offset = key_offset,
+      .key_size = key_size,
+      .kind = kind,
+      .chunks = chunks,
+      .counts = malloc(chunks * 256 * sizeof(size_t)),
+  };
+  assert(job.dst != NULL && job.counts != NULL);
+  char* const scratch = job.dst;
+
+  for (job.byte = 0; job.byte < key_size; job.byte++) {
+    job.scatter = false;
+    parallel_run(chunks, snifex_api_par_radix_task, &job);
+
+    // Digit-major, chunk-minor offsets keep the sort stable across chunks
+    size_t offset = 0;
+    bool skip = false;
+    for (size_t d = 0; d < 256 && !skip; d++) {
+      const size_t digit_start = offset;
+      for (size_t c = 0; c < chunks; c++) {
+        const size_t count = job.counts[c][d];
+        job.counts[c][d] = offset;
+        offset += count;
+      }
+      skip = offset - digit_start == len;
+    }
+    if (skip) { continue; }
+
+    job.scatter = true;
+    parallel_run(chunks, snifex_api_par_radix_task, &job);
+    char* tmp = job.src;
+    job.src = job.dst;
+    job.dst = tmp;
+  }
+
+  if (job.src != (char*)ptr) { memcpy(ptr, job.src, len * elem_size); }
+  free(scratch);
+  free(job.counts);
+}
+
+#ifdef SNIFEX_API_ATOMICS
+size_t snifex_api_queue_cap(const size_t min_cap) {
+  assert(min_cap <= SIZE_MAX / 2);
+  // The MPMC queue needs at least 2 cells to tell a full queue from an empty
+  // one
+  size_t cap = 2;
+  while (cap < min_cap) { cap *= 2; }
+  return cap;
+}
+#endif  // SNIFEX_API_ATOMICS
+
+#if defined(SNIFEX_API_PTHREADS)
+#define SNIFEX_API_MUTEX pthread_mutex_t
+#define SNIFEX_API_COND pthread_cond_t
+#define SNIFEX_API_THREAD pthread_t
+#define snifex_api_mutex_init(m) pthread_mutex_init(m, NULL)
+#define snifex_api_mutex_lock(m) pthread_mutex_lock(m)
+#define snifex_api_mutex_unlock(m) pthread_mutex_unlock(m)
+#define snifex_api_mutex_destroy(m) pthread_mutex_destroy(m)
+#define snifex_api_cond_init(c) pthread_cond_init(c, NULL)
+#define snifex_api_cond_wait(c, m) pthread_cond_wait(c, m)
+#define snifex_api_cond_signal(c) pthread_cond_signal(c)
+#define snifex_api_cond_broadcast(c) pthread_cond_broadcast(c)
+#define snifex_api_cond_destroy(c) pthread_cond_destroy(c)
+#define snifex_api_thread_yield() sched_yield()
+#elif defined(SNIFEX_API_WIN_THREADS)
+#define SNIFEX_API_MUTEX CRITICAL_SECTION
+#define SNIFEX_API_COND CONDITION_VARIABLE
+#define SNIFEX_API_THREAD HANDLE
+#define snifex_api_mutex_init(m) InitializeCriticalSection(m)
+#define snifex_api_mutex_lock(m) EnterCriticalSection(m)
+#define snifex_api_mutex_unlock(m) LeaveCriticalSection(m)
+#define snifex_api_mutex_destroy(m) DeleteCriticalSection(m)
+#define snifex_api_cond_init(c) InitializeConditionVariable(c)
+#define snifex_api_cond_wait(c, m) SleepConditionVariableCS(c, m, INFINITE)
+#define snifex_api_cond_signal(c) WakeConditionVariable(c)
+#define snifex_api_cond_broadcast(c) WakeAllConditionVariable(c)
+#define snifex_api_cond_destroy(c) ((void)(c))
+#define snifex_api_thread_yield() SwitchToThread()
+#else
+// Without threads nothing ever runs concurrently, so nothing needs
+// synchronization
+#define SNIFEX_API_MUTEX char
+#define SNIFEX_API_COND char
+#define snifex_api_mutex_init(m) ((void)(m))
+#define snifex_api_mutex_lock(m) ((void)(m))
+#define snifex_api_mutex_unlock(m) ((void)(m))
+#define snifex_api_mutex_destroy(m) ((void)(m))
+#define snifex_api_cond_init(c) ((void)(c))
+#define snifex_api_cond_wait(c, m) ((void)(c), (void)(m))
+#define snifex_api_cond_signal(c) ((void)(c))
+#define snifex_api_cond_broadcast(c) ((void)(c))
+#define snifex_api_cond_destroy(c) ((void)(c))
+#define snifex_api_thread_yield() ((void)0)
+#endif
+
+#ifdef SNIFEX_API_ATOMICS
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define SNIFEX_API_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define SNIFEX_API_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define SNIFEX_API_THREAD_LOCAL __declspec(thread)
+#else
+#define SNIFEX_API_THREAD_LOCAL
+#endif
+
+#ifndef SNIFEX_API_POOL_DEQUE_CAP
+// Initial capacity of the deque of every worker, it doubles when full
+#define SNIFEX_API_POOL_DEQUE_CAP 256
+#endif
+
+struct snifex_api_task {
+  void (*fn)(void* ctx, Arena* scratch);
+  void* ctx;
+  WaitGroup* wg;
+  struct snifex_api_task* next;  // Link in the injection queue
+  bool owned;                    // Allocated by submit, freed once run
+};
+
+struct snifex_api_ws_array {
+  int64_t cap;
+  // Thieves may still read an array after it's been replaced by a bigger
+  // one, so old arrays are only freed with the pool
+  struct snifex_api_ws_array* retired;
+  SNIFEX_API_ATOMIC(struct snifex_api_task*) buf[];
+};
+
+// Chase-Lev deque: only the owner touches `bottom`, thieves race on `top`
+struct snifex_api_ws_deque {
+  SNIFEX_API_ATOMIC(int64_t) top;
+  char pad_top[SNIFEX_API_CACHE_LINE];
+  SNIFEX_API_ATOMIC(int64_t) bottom;
+  SNIFEX_API_ATOMIC(struct snifex_api_ws_array*) array;
+  char pad_bottom[SNIFEX_API_CACHE_LINE];
+};
+
+struct snifex_api_pool_worker {
+  struct snifex_api_ws_deque deque;
+  ThreadPool* pool;
+  Arena scratch;
+  uint64_t rng;
+};
+
+struct thread_pool {
+  struct snifex_api_pool_worker* workers;
+  size_t n_workers;
+#ifdef SNIFEX_API_THREAD
+  SNIFEX_API_THREAD* handles;
+  size_t n_started;  // Workers whose thread was created, the first ones
+#endif
+  SNIFEX_API_MUTEX lock;
+  SNIFEX_API_COND work_cond;  // Parked workers
+  SNIFEX_API_COND done_cond;  // Threads outside the pool in thread_pool_wait
+  struct snifex_api_task* inject_head;
+  struct snifex_api_task* inject_tail;
+  SNIFEX_API_ATOMIC(size_t) injected;  // Length of the injection queue
+  SNIFEX_API_ATOMIC(size_t) queued;    // Tasks submitted and not taken yet
+  SNIFEX_API_ATOMIC(size_t) sleepers;  // Parked workers
+  bool stop;
+  Arena scratch;  // Only used without threads, by the inline tasks
+};
+
+static SNIFEX_API_THREAD_LOCAL struct snifex_api_pool_worker*
+    snifex_api_pool_current = NULL;
+
+static struct snifex_api_ws_array* snifex_api_ws_array_create(
+    const int64_t cap) {
+  struct snifex_api_ws_array* array =
+      malloc(sizeof(struct snifex_api_ws_array) +
+             (size_t)cap * sizeof(struct snifex_api_task*));
+  assert(array != NULL);
+  array->cap = cap;
+  array->retired = NULL;
+  return array;
+}
+
+static void snifex_api_ws_push(struct snifex_api_ws_deque* const deque,
+                               struct snifex_api_task* const task) {
+  const int64_t b = snifex_api_atomic_load(&deque->bottom, SNIFEX_API_RELAXED);
+  const int64_t t = snifex_api_atomic_load(&deque->top, SNIFEX_API_ACQUIRE);
+  struct snifex_api_ws_array* array =
+      snifex_api_atomic_load(&deque->array, SNIFEX_API_RELAXED);
+  if (b - t >= array->cap) {
+    struct snifex_api_ws_array* grown =
+        snifex_api_ws_array_create(array->cap * 2);
+    for (int64_t i = t; i < b; i++) {
+      snifex_api_atomic_store(
+          &grown->buf[i & (grown->cap - 1)],
+          snifex_api_atomic_load(&array->buf[i & (array->cap - 1)],
+                                 SNIFEX_API_RELAXED),
+          SNIFEX_API_RELAXED);
+    }
+    grown->retired = array;
+    snifex_api_atomic_store(&deque->array, grown, SNIFEX_API_RELEASE);
+    array = grown;
+  }
+  snifex_api_atomic_store(&array->buf[b & (array->cap - 1)], task,
+                          SNIFEX_API_RELAXED);
+  // Publishes the slot, and the task it points to, to the thieves
+  snifex_api_atomic_store(&deque->bottom, b + 1, SNIFEX_API_RELEASE);
+}
+
+static struct snifex_api_task* snifex_api_ws_take(
+    struct snifex_api_ws_deque* const deque) {
+  const int64_t b =
+      snifex_api_atomic_load(&deque->bottom, SNIFEX_API_RELAXED) - 1;
+  struct snifex_api_ws_array* array =
+      snifex_api_atomic_load(&deque->array, SNIFEX_API_RELAXED);
+  // Reserving the bottom slot and then reading `top` must not be reordered,
+  // or a thief could take the same task
+  snifex_api_atomic_store(&deque->bottom, b, SNIFEX_API_SEQ_CST);
+  int64_t t = snifex_api_atomic_load(&deque->top, SNIFEX_API_SEQ_CST);
+  struct snifex_api_task* task = NULL;
+  if (t <= b) {
+    task = snifex_api_atomic_load(&array->buf[b & (array->cap - 1)],
+                                  SNIFEX_API_RELAXED);
+    if (t == b) {
+      // Last task: race the thieves for it
+      if (!snifex_api_atomic_cas(&deque->top, &t, t + 1, SNIFEX_API_SEQ_CST,
+                                 SNIFEX_API_RELAXED)) {
+        task = NULL;
+      }
+      snifex_api_atomic_store(&deque->bottom, b + 1, SNIFEX_API_RELAXED);
+    }
+  } else {
+    snifex_api_atomic_store(&deque->bottom, b + 1, SNIFEX_API_RELAXED);
+  }
+  return task;
+}
+
+static struct snifex_api_task* snifex_api_ws_steal(
+    struct snifex_api_ws_deque* const deque) {
+  int64_t t = snifex_api_atomic_load(&deque->top, SNIFEX_API_SEQ_CST);
+  const int64_t b = snifex_api_atomic_load(&deque->bottom, SNIFEX_API_SEQ_CST);
+  if (t >= b) { return NULL; }
+  struct snifex_api_ws_array* array =
+      snifex_api_atomic_load(&deque->array, SNIFEX_API_ACQUIRE);
+  struct snifex_api_task* task = snifex_api_atomic_load(
+      &array->buf[t & (array->cap - 1)], SNIFEX_API_RELAXED);
+  // Losing the race to the owner or another thief: try another victim
+  if (!snifex_api_atomic_cas(&deque->top, &t, t + 1, SNIFEX_API_SEQ_CST,
+                             SNIFEX_API_RELAXED)) {
+    return NULL;
+  }
+  return task;
+}
+
+static struct snifex_api_task* snifex_api_pool_find(
+    ThreadPool* const pool, struct snifex_api_pool_worker* const self) {
+  struct snifex_api_task* task = NULL;
+  if (self != NULL) { task = snifex_api_ws_take(&self->deque); }
+  if (task == NULL &&
+      snifex_api_atomic_load(&pool->injected, SNIFEX_API_ACQUIRE) > 0) {
+    snifex_api_mutex_lock(&pool->lock);
+    task = pool->inject_head;
+    if (task != NULL) {
+      pool->inject_head = task->next;
+      if (pool->inject_head == NULL) { pool->inject_tail = NULL; }
+      snifex_api_atomic_fetch_sub(&pool->injected, 1, SNIFEX_API_RELAXED);
+    }
+    snifex_api_mutex_unlock(&pool->lock);
+  }
+  if (task == NULL && self != NULL) {
+    // Victims are tried starting from a random one, so that thieves spread
+    // out instead of all hitting the first worker
+    self->rng ^= self->rng << 13;
+    self->rng ^= self->rng >> 7;
+    self->rng ^= self->rng << 17;
+    const size_t n = pool->n_workers;
+    const size_t first = (size_t)(self->rng % n);
+    for (size_t i = 0; i < n && task == NULL; i++) {
+      struct snifex_api_pool_worker* victim = &pool->workers[(first + i) % n];
+      if (victim != self) { task = snifex_api_ws_steal(&victim->deque); }
+    }
+  }
+  if (task != NULL) {
+    snifex_api_atomic_fetch_sub(&pool->queued, 1, SNIFEX_API_SEQ_CST);
+  }
+  return task;
+}
+
+static void snifex_api_pool_run(ThreadPool* const pool,
+                                struct snifex_api_task* const task,
+                                Arena* const scratch) {
+  // A task run while waiting inside another one must not throw away the
+  // scratch allocations of the outer task
+  const size_t mark = scratch->top;
+  task->fn(task->ctx, scratch);
+  scratch->top = mark;
+
+  WaitGroup* const wg = task->wg;
+  if (task->owned) { free(task); }
+  // Nothing can touch `task` past this point: the waiter may free it
+  if (wg != NULL &&
+      snifex_api_atomic_fetch_sub(&wg->pending, 1, SNIFEX_API_ACQ_REL) == 1) {
+    snifex_api_mutex_lock(&pool->lock);
+    snifex_api_cond_broadcast(&pool->done_cond);
+    snifex_api_mutex_unlock(&pool->lock);
+  }
+}
+
+// Queues a list of `count` tasks linked through `next`
+static void snifex_api_pool_push(ThreadPool* const pool,
+                                 struct snifex_api_task* const first,
+                                 struct snifex_api_task* const last,
+                                 const size_t count) {
+  if (pool->n_workers == 0) {
+    for (struct snifex_api_task *task = first, *next; task != NULL;
+         task = next) {
+      next = task->next;
+      snifex_api_pool_run(pool, task, &pool->scratch);
+    }
+    return;
+  }
+
+  // Counted before being visible, so that `queued` never goes below 0
+  snifex_api_atomic_fetch_add(&pool->queued, count, SNIFEX_API_SEQ_CST);
+  struct snifex_api_pool_worker* const self = snifex_api_pool_current;
+  if (self != NULL && self->pool == pool) {
+    for (struct snifex_api_task *task = first, *next; task != NULL;
+         task = next) {
+      next = task->next;
+      snifex_api_ws_push(&self->deque, task);
+    }
+  } else {
+    last->next = NULL;
+    snifex_api_mutex_lock(&pool->lock);
+    if (pool->inject_tail != NULL) {
+      pool->inject_tail->next = first;
+    } else {
+      pool->inject_head = first;
+    }
+    pool->inject_tail = last;
+    snifex_api_atomic_fetch_add(&pool->injected, count, SNIFEX_API_RELEASE);
+    snifex_api_mutex_unlock(&pool->lock);
+  }
+
+  // Pairs with the parking in snifex_api_pool_worker_run: both sides write
+  // their counter before reading the other one's, so either the worker sees
+  // the new tasks or this thread sees the worker parked
+  if (snifex_api_atomic_load(&pool->sleepers, SNIFEX_API_SEQ_CST) > 0) {
+    snifex_api_mutex_lock(&pool->lock);
+    if (count == 1) {
+      snifex_api_cond_signal(&pool->work_cond);
+    } else {
+      snifex_api_cond_broadcast(&pool->work_cond);
+    }
+    snifex_api_mutex_unlock(&pool->lock);
+  }
+}
+
+#ifdef SNIFEX_API_THREAD
+static void snifex_api_pool_worker_run(struct snifex_api_pool_worker* self) {
+  ThreadPool* const pool = self->pool;
+  snifex_api_pool_current = self;
+  for (;;) {
+    struct snifex_api_task* task = snifex_api_pool_find(pool, self);
+    if (task != NULL) {
+      arena_reset(&self->scratch);
+      snifex_api_pool_run(pool, task, &self->scratch);
+      continue;
+    }
+
+    snifex_api_mutex_lock(&pool->lock);
+    snifex_api_atomic_fetch_add(&pool->sleepers, 1, SNIFEX_API_SEQ_CST);
+    while (!pool->stop &&
+           snifex_api_atomic_load(&pool->queued, SNIFEX_API_SEQ_CST) == 0) {
+      snifex_api_cond_wait(&pool->work_cond, &pool->lock);
+    }
+    snifex_api_atomic_fetch_sub(&pool->sleepers, 1, SNIFEX_API_SEQ_CST);
+    // Tasks still queued are run before stopping
+    const bool stop =
+        pool->stop &&
+        snifex_api_atomic_load(&pool->queued, SNIFEX_API_SEQ_CST) == 0;
+    snifex_api_mutex_unlock(&pool->lock);
+    if (stop) { break; }
+  }
+  snifex_api_pool_current = NULL;
+}
+#endif
+
+#if defined(SNIFEX_API_PTHREADS)
+static void* snifex_api_pool_worker_main(void* arg) {
+  snifex_api_pool_worker_run((struct snifex_api_pool_worker*)arg);
+  return NULL;
+}
+#elif defined(SNIFEX_API_WIN_THREADS)
+static DWORD WINAPI snifex_api_pool_worker_main(LPVOID arg) {
+  snifex_api_pool_worker_run((struct snifex_api_pool_worker*)arg);
+  return 0;
+}
+#endif
+
+static void snifex_api_pool_free_workers(ThreadPool* const pool) {
+  for (size_t i = 0; i < pool->n_workers; i++) {
+    struct snifex_api_ws_array* array = snifex_api_atomic_load(
+        &pool->workers[i].deque.array, SNIFEX_API_RELAXED);
+    while (array != NULL) {
+      struct snifex_api_ws_array* retired = array->retired;
+      free(array);
+      array = retired;
+    }
+    arena_free(&pool->workers[i].scratch);
+  }
+  free(pool->workers);
+  pool->workers = NULL;
+}
+
+ThreadPool* thread_pool_create(size_t threads) {
+  if (threads == 0) { threads = parallel_thread_count(); }
+#ifndef SNIFEX_API_THREAD
+  threads = 0;
+#endif
+  ThreadPool* pool = calloc(1, sizeof(ThreadPool));
+  assert(pool != NULL);
+  pool->n_workers = threads;
+  snifex_api_mutex_init(&pool->lock);
+  snifex_api_cond_init(&pool->work_cond);
+  snifex_api_cond_init(&pool->done_cond);
+  snifex_api_atomic_store(&pool->injected, 0, SNIFEX_API_RELAXED);
+  snifex_api_atomic_store(&pool->queued, 0, SNIFEX_API_RELAXED);
+  snifex_api_atomic_store(&pool->sleepers, 0, SNIFEX_API_RELAXED);
+  if (threads == 0) {
+    pool->scratch = arena_create(SNIFEX_API_PARALLEL_SCRATCH_SIZE);
+    return pool;
+  }
+
+  pool->workers = calloc(threads, sizeof(struct snifex_api_pool_worker));
+  assert(pool->workers != NULL);
+  for (size_t i = 0; i < threads; i++) {
+    struct snifex_api_pool_worker* w = &pool->workers[i];
+    snifex_api_atomic_store(&w->deque.top, 0, SNIFEX_API_RELAXED);
+    snifex_api_atomic_store(&w->deque.bottom, 0, SNIFEX_API_RELAXED);
+    snifex_api_atomic_store(
+        &w->deque.array, snifex_api_ws_array_create(SNIFEX_API_POOL_DEQUE_CAP),
+        SNIFEX_API_RELAXED);
+    w->pool = pool;
+    w->scratch = arena_create(SNIFEX_API_PARALLEL_SCRATCH_SIZE);
+    w->rng = (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ull;
+  }
+
+#ifdef SNIFEX_API_THREAD
+  pool->handles = malloc(threads * sizeof(SNIFEX_API_THREAD));
+  assert(pool->handles != NULL);
+  // Workers whose thread can't be created just never run: nothing gets pushed
+  // on their deques, and the others steal from them in vain
+  for (; pool->n_started < threads; pool->n_started++) {
+    const size_t i = pool->n_started;
+#if defined(SNIFEX_API_PTHREADS)
+    if (pthread_create(&pool->handles[i], NULL, snifex_api_pool_worker_main,
+                       &pool->workers[i]) != 0) {
+      break;
+    }
+#else
+    pool->handles[i] = CreateThread(NULL, 0, snifex_api_pool_worker_main,
+                                    &pool->workers[i], 0, NULL);
+    if (pool->handles[i] == NULL) { break; }
+#endif
+  }
+  // Without any thread, tasks run inside submit like on platforms without
+  // threads
+  if (pool->n_started == 0) {
+    snifex_api_pool_free_workers(pool);
+    pool->n_workers = 0;
+    pool->scratch = arena_create(SNIFEX_API_PARALLEL_SCRATCH_SIZE);
+  }
+#endif
+  return pool;
+}
+
+void thread_pool_free(ThreadPool* const pool) {
+  assert(pool != NULL);
+  assert(snifex_api_pool_current == NULL ||
+         snifex_api_pool_current->pool != pool);
+  snifex_api_mutex_lock(&pool->lock);
+  pool->stop = true;
+  snifex_api_cond_broadcast(&pool->work_cond);
+  snifex_api_mutex_unlock(&pool->lock);
+
+#ifdef SNIFEX_API_THREAD
+  for (size_t i = 0; i < pool->n_started; i++) {
+#if defined(SNIFEX_API_PTHREADS)
+    pthread_join(pool->handles[i], NULL);
+#else
+    WaitForSingleObject(pool->handles[i], INFINITE);
+    CloseHandle(pool->handles[i]);
+#endif
+  }
+  free(pool->handles);
+#endif
+
+  snifex_api_pool_free_workers(pool);
+  if (pool->n_workers == 0) { arena_free(&pool->scratch); }
+  snifex_api_cond_destroy(&pool->work_cond);
+  snifex_api_cond_destroy(&pool->done_cond);
+  snifex_api_mutex_destroy(&pool->lock);
+  free(pool);
+}
+
+size_t thread_pool_thread_count(const ThreadPool* const pool) {
+  assert(pool != NULL);
+#ifdef SNIFEX_API_THREAD
+  // Workers past `n_started` exist but never run
+  return pool->n_started;
+#else
+  return pool->n_workers;
+#endif
+}
+
+WaitGroup wait_group_create(void) {
+  WaitGroup wg;
+  snifex_api_atomic_store(&wg.pending, 0, SNIFEX_API_RELAXED);
+  return wg;
+}
+
+void thread_pool_submit(ThreadPool* const pool,
+                        WaitGroup* const wg,
+                        void (*task)(void* ctx, Arena* scratch),
+                        void* ctx) {
+  assert(pool != NULL && task != NULL);
+  struct snifex_api_task* t = malloc(sizeof(struct snifex_api_task));
+  assert(t != NULL);
+  *t = (struct snifex_api_task){
+      .fn = task, .ctx = ctx, .wg = wg, .next = NULL, .owned = true};
+  if (wg != NULL) {
+    snifex_api_atomic_fetch_add(&wg->pending, 1, SNIFEX_API_RELAXED);
+  }
+  snifex_api_pool_push(pool, t, t, 1);
+}
+
+void thread_pool_wait(ThreadPool* const pool, WaitGroup* const wg) {
+  assert(pool != NULL && wg != NULL);
+  struct snifex_api_pool_worker* const self = snifex_api_pool_current;
+  if (self != NULL && self->pool == pool) {
+    // Blocking here could deadlock the pool if all workers did it, so the
+    // worker keeps running tasks, the ones of `wg` included
+    while (snifex_api_atomic_load(&wg->pending, SNIFEX_API_ACQUIRE) != 0) {
+      struct snifex_api_task* task = snifex_api_pool_find(pool, self);
+      if (task != NULL) {
+        snifex_api_pool_run(pool, task, &self->scratch);
+      } else {
+        snifex_api_thread_yield();
+      }
+    }
+    return;
+  }
+
+  snifex_api_mutex_lock(&pool->lock);
+  while (snifex_api_atomic_load(&wg->pending, SNIFEX_API_ACQUIRE) != 0) {
+    snifex_api_cond_wait(&pool->done_cond, &pool->lock);
+  }
+  snifex_api_mutex_unlock(&pool->lock);
+}
+
+struct snifex_api_pool_for {
+  void (*fn)(void* ctx, size_t start, size_t end, Arena* scratch);
+  void* ctx;
+};
+
+struct snifex_api_pool_range {
+  struct snifex_api_task task;
+  const struct snifex_api_pool_for* job;
+  size_t start;
+  size_t end;
+};
+
+static void snifex_api_pool_for_task(void* ctx, Arena* scratch) {
+  const struct snifex_api_pool_range* range =
+      (const struct snifex_api_pool_range*)ctx;
+  range->job->fn(range->job->ctx, range->start, range->end, scratch);
+}
+
+void thread_pool_parallel_for(ThreadPool* const pool,
+                              const size_t len,
+                              size_t grain,
+                              void (*fn)(void* ctx,
+                                         size_t start,
+                                         size_t end,
+                                         Arena* scratch),
+                              void* ctx) {
+  assert(pool != NULL && fn != NULL);
+  if (len == 0) { return; }
+  if (grain == 0) {
+    // A few ranges per worker leave room for stealing to even out the load
+    grain = len / (4 * (thread_pool_thread_count(pool) + 1));
+    if (grain == 0) { grain = 1; }
+  }
+  const size_t n_ranges = (len - 1) / grain + 1;
+
+  const struct snifex_api_pool_for job = {.fn = fn, .ctx = ctx};
+  WaitGroup wg = wait_group_create();
+  // One allocation for all the ranges, freed after the wait
+  struct snifex_api_pool_range* ranges =
+      malloc(n_ranges * sizeof(struct snifex_api_pool_range));
+  assert(ranges != NULL);
+  for (size_t i = 0; i < n_ranges; i++) {
+    ranges[i] = (struct snifex_api_pool_range){
+        .task = {.fn = snifex_api_pool_for_task,
+                 .ctx = &ranges[i],
+                 .wg = &wg,
+                 .next = i + 1 < n_ranges ? &ranges[i + 1].task : NULL,
+                 .owned = false},
+        .job = &job,
+        .start = i * grain,
+        .end = i + 1 < n_ranges ? (i + 1) * grain : len,
+    };
+  }
+  snifex_api_atomic_store(&wg.pending, n_ranges, SNIFEX_API_RELAXED);
+  snifex_api_pool_push(pool, &ranges[0].task, &ranges[n_ranges - 1].task,
+                       n_ranges);
+  thread_pool_wait(pool, &wg);
+  free(ranges);
+}
+#endif
+
+string strlit(char const* s) {
+  return (string){.ptr = (char*)s, .len = strlen(s)};
+}
+bool str_is_empty(const string str) {
+  return (str.ptr == NULL || str.len == 0);
+}
+
+string str_alloc(Arena* const arena, const size_t len) {
+  assert(arena != NULL);
+
+  return (string){
+      .ptr = (char*)arena_alloc(arena, len, 1),
+      .len = len,
+  };
+}
+
+string str_copy(Arena* const arena, const string str) {
+  if (str.len == 0) { return str; }
+  assert(arena != NULL);
+
+  char* dest = (char*)arena_alloc(arena, str.len, 1);
+  if (dest == NULL) { return (string){.ptr = NULL, .len = str.len}; }
+  return (string){
+      .ptr = (char*)memcpy(dest, str.ptr, str.len),
+      .len = str.len,
+  };
+}
+
+char* str_idx(const string str, const size_t i) {
+  assert(i < str.len && str.ptr != NULL);
+  return &str.ptr[i];
+}
+
+// Short-circuing if the length is equal and is 0 is because memcmp with NULL
+// pointers is U.B. in c99, even if the number of bytes copied is 0, and in this
+// library empty strings can have a NULL pointer.
+//
+// See `str_join` for more info
+bool str_eq(const string a, const string b) {
+  return a.len == b.len && (a.len == 0 || memcmp(a.ptr, b.ptr, a.len) == 0);
+}
+
+// Note! Can execute memcpy(ptr, NULL, 0), where ptr is guaranteed not to be
+// NULL, which is U.B. before c2y. Clang and GCC apparently handle this
+// gratefully while MSVC does not so, to conform to c99 we check for 0-len
+// before memcpy-ing. This isn't not really a performance issue in release mode
+// as it should just be optimised out (and gcc/clang with -O1 surely does)
+//
+// See
+// https://stackoverflow.com/questions/5243012/is-it-guaranteed-to-be-safe-to-perform-memcpy0-0-0
+string str_concat(Arena* const arena, const string a, const string b) {
+  assert(arena != NULL);
+
+  size_t new_len = a.len + b.len;
+  string buf = str_alloc(arena, new_len);
+  if (a.len != 0) { memcpy(buf.ptr, a.ptr, a.len); }
+  if (b.len != 0) { memcpy(buf.ptr + a.len, b.ptr, b.len); }
+  return buf;
+}
+
+string str_join(Arena* const arena, Vec(string) to_join) {
+  assert(arena != NULL);
+
+  size_t new_len = 0;
+  for (size_t i = 0; i < to_join.len; i++) {
+#ifdef SNIFEX_API_GNU_EXTENSIONS
+    new_len += vec_idx(to_join, i)->len;
+#else
+    string* str;
+    vec_idx(str, string, to_join, i);
+    new_len += str->len;
+#endif
+  }
+  string buf = str_alloc(arena, new_len);
+
+  char* dest = buf.ptr;
+  for (size_t i = 0; i < to_join.len; i++) {
+#ifdef SNIFEX_API_GNU_EXTENSIONS
+    string str = *vec_idx(to_join, i);
+#else
+    string* str_ptr;
+    vec_idx(str_ptr, string, to_join, i);
+    string str = *str_ptr;
+#endif
+    memcpy(dest, str.ptr, str.len);
+    dest += str.len;
+  }
+  return buf;
+}
+
+string str_vfmt(Arena* const arena, const char* fmt, va_list args) {
+  assert(arena != NULL && fmt != NULL);
+
+  char* const dest = arena->buf + arena->top;
+  const size_t avail = arena->size - arena->top;
+  const int written = vsnprintf(avail == 0 ? NULL : dest, avail, fmt, args);
+  assert(written >= 0);
+
+  const size_t len = (size_t)written;
+  if (len >= avail) { return (string){.ptr = NULL, .len = len}; }
+  arena->top += len;
+  return (string){.ptr = dest, .len = len};
+}
+
+string str_fmt(Arena* const arena, const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  const string str = str_vfmt(arena, fmt, args);
+  va_end(args);
+  return str;
+}
+
+string str_slice(const string str, const size_t start, const size_t end) {
+  assert(start < str.len && end <= str.len && start <= end);
+
+  return (string){
+      .ptr = str.ptr + start,
+      .len = end - start,
+  };
+}
+
+string str_trim(const string str) {
+  size_t start = 0;
+  size_t end = str.len;
+
+  while (start < end && isspace((unsigned char)*str_idx(str, start))) {
+    start++;
+  }
+  if (start == end) { return (string){0}; }
+  while (end > start && isspace((unsigned char)*str_idx(str, end - 1))) {
+    end--;
+  }
+
+  return str_slice(str, start, end);
+}
+
+static size_t snifex_api_find_char_scalar(const char* ptr,
+                                          const size_t len,
+                                          const char c) {
+  const char* const found = len == 0 ? NULL : (const char*)memchr(ptr, c, len);
+  return found == NULL ? len : (size_t)(found - ptr);
+}
+
+static size_t snifex_api_rfind_char_scalar(const char* ptr,
+                                           const size_t len,
+                                           const char c) {
+  for (size_t i = len; i > 0; i--) {
+    if (ptr[i - 1] == c) { return i - 1; }
+  }
+  return len;
+}
+
+static size_t snifex_api_count_char_scalar(const char* ptr,
+                                           const size_t len,
+                                           const char c) {
+  size_t count = 0;
+  for (size_t i = 0; i < len; i++) { count += ptr[i] == c; }
+  return count;
+}
+
+// Searches the needle starting at positions [start, len - n_len]. The needle
+// is at least 2 bytes long
+static size_t snifex_api_find_scalar(const char* ptr,
+                                     const size_t len,
+                                     const char* needle,
+                                     const size_t n_len,
+                                     size_t start) {
+  const size_t last = len - n_len;
+  while (start <= last) {
+    start += snifex_api_find_char_scalar(ptr + start, last + 1 - start,
+                                         needle[0]);
+    if (start > last) { break; }
+    if (memcmp(ptr + start + 1, needle + 1, n_len - 1) == 0) { return start; }
+    start++;
+  }
+  return len;
+}
+
+// Searches the needle starting at positions [0, end), backwards
+static size_t snifex_api_rfind_scalar(const char* ptr,
+                                      const size_t len,
+                                      const char* needle,
+                                      const size_t n_len,
+                                      size_t end) {
+  for (; end > 0; end--) {
+    if (ptr[end - 1] == needle[0] &&
+        memcmp(ptr + end, needle + 1, n_len - 1) == 0) {
+      return end - 1;
+    }
+  }
+  return len;
+}
+
+#ifdef SNIFEX_API_X86_SIMD
+#define SNIFEX_API_SSE2_U8_LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#define SNIFEX_API_SSE2_U8_SET1(x) _mm_set1_epi8(x)
+#define SNIFEX_API_SSE2_U8_EQ(a, b) _mm_cmpeq_epi8(a, b)
+#define SNIFEX_API_SSE2_U8_AND(a, b) _mm_and_si128(a, b)
+#define SNIFEX_API_SSE2_U8_MASK(v) (uint32_t) _mm_movemask_epi8(v)
+#define SNIFEX_API_SSE2_U8_OR(a, b) _mm_or_si128(a, b)
+#define SNIFEX_API_SSE2_U8_SUB(a, b) _mm_sub_epi8(a, b)
+#define SNIFEX_API_SSE2_U8_MIN(a, b) _mm_min_epu8(a, b)
+#define SNIFEX_API_SSE2_U8_MAX(a, b) _mm_max_epu8(a, b)
+
+#define SNIFEX_API_AVX2_U8_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define SNIFEX_API_AVX2_U8_SET1(x) _mm256_set1_epi8(x)
+#define SNIFEX_API_AVX2_U8_EQ(a, b) _mm256_cmpeq_epi8(a, b)
+#define SNIFEX_API_AVX2_U8_AND(a, b) _mm256_and_si256(a, b)
+#define SNIFEX_API_AVX2_U8_MASK(v) (uint32_t) _mm256_movemask_epi8(v)
+#define SNIFEX_API_AVX2_U8_OR(a, b) _mm256_or_si256(a, b)
+#define SNIFEX_API_AVX2_U8_SUB(a, b) _mm256_sub_epi8(a, b)
+#define SNIFEX_API_AVX2_U8_MIN(a, b) _mm256_min_epu8(a, b)
+#define SNIFEX_API_AVX2_U8_MAX(a, b) _mm256_max_epu8(a, b)
+
+// Each bit of a mask is a position of the block. Substring searches match the
+// first byte of the needle at the position and the last byte `n_len - 1` bytes
+// later, so the rare candidates left are checked with `memcmp`
+#define SNIFEX_API_STR_KERNELS(isa, P, V, lanes)                             \
+  SNIFEX_API_TARGET_##isa static size_t snifex_api_find_char_##isa(          \
+      const char* ptr, const size_t len, const char c) {                     \
+    const V key = SNIFEX_API_##P##_SET1(c);                                  \
+    size_t i = 0;                                                            \
+    for (; i + (lanes) <= len; i += (lanes)) {                               \
+      const uint32_t mask = SNIFEX_API_##P##_MASK(                           \
+          SNIFEX_API_##P##_EQ(SNIFEX_API_##P##_LOAD(ptr + i), key));         \
+      if (mask != 0) { return i + (size_t)__builtin_ctz(mask); }             \
+    }                                                                        \
+    return i + snifex_api_find_char_scalar(ptr + i, len - i, c);             \
+  }                                                                          \
+                                                                             \
+  SNIFEX_API_TARGET_##isa static size_t snifex_api_rfind_char_##isa(         \
+      const char* ptr, const size_t len, const char c) {                     \
+    const V key = SNIFEX_API_##P##_SET1(c);                                  \
+    size_t i = len;                                                          \
+    for (; i >= (lanes); i -= (lanes)) {                                     \
+      const uint32_t mask = SNIFEX_API_##P##_MASK(SNIFEX_API_##P##_EQ(       \
+          SNIFEX_API_##P##_LOAD(ptr + i - (lanes)), key));                   \
+      if (mask != 0) {                                                       \
+        return i - (lanes) + 31 - (size_t)__builtin_clz(mask);               \
+      }                                                                      \
+    }                                                                        \
+    const size_t found = snifex_api_rfind_char_scalar(ptr, i, c);            \
+    return found == i ? len : found;                                         \
+  }                                                                          \
+                                                                             \
+  SNIFEX_API_TARGET_##isa static size_t snifex_api_count_char_##isa(         \
+      const char* ptr, const size_t len, const char c) {                     \
+    const V key = SNIFEX_API_##P##_SET1(c);                                  \
+    size_t count = 0;                                                        \
+    size_t i = 0;                                                            \
+    for (; i + (lanes) <= len; i += (lanes)) {                               \
+      count += (size_t)__builtin_popcount(SNIFEX_API_##P##_MASK(             \
+          SNIFEX_API_##P##_EQ(SNIFEX_API_##P##_LOAD(ptr + i), key)));        \
+    }                                                                        \
+    return count + snifex_api_count_char_scalar(ptr + i, len - i, c);        \
+  }                                                                          \
+                                                                             \
+  SNIFEX_API_TARGET_##isa static size_t snifex_api_find_##isa(               \
+      const char* ptr, const size_t len, const char* needle,                 \
+      const size_t n_len) {                                                  \
+    const V first = SNIFEX_API_##P##_SET1(needle[0]);                        \
+    const V last = SNIFEX_API_##P##_SET1(needle[n_len - 1]);                 \
+    size_t i = 0;                                                            \
+    for (; i + n_len - 1 + (lanes) <= len; i += (lanes)) {                   \
+      const V a = SNIFEX_API_##P##_LOAD(ptr + i);                            \
+      const V b = SNIFEX_API_##P##_LOAD(ptr + i + n_len - 1);                \
+      uint32_t mask = SNIFEX_API_##P##_MASK(SNIFEX_API_##P##_AND(            \
+          SNIFEX_API_##P##_EQ(a, first), SNIFEX_API_##P##_EQ(b, last)));     \
+      for (; mask != 0; mask &= mask - 1) {                                  \
+        const size_t at = i + (size_t)__builtin_ctz(mask);                   \
+        if (memcmp(ptr + at + 1, needle + 1, n_len - 2) == 0) { return at; } \
+      }                                                                      \
+    }                                                                        \
+    return snifex_api_find_scalar(ptr, len, needle, n_len, i);               \
+  }                                                                          \
+                                                                             \
+  SNIFEX_API_TARGET_##isa static size_t snifex_api_rfind_##isa(              \
+      const char* ptr, const size_t len, const char* needle,                 \
+      const size_t n_len) {                                                  \
+    const V first = SNIFEX_API_##P##_SET1(needle[0]);                        \
+    const V last = SNIFEX_API_##P##_SET1(needle[n_len - 1]);                 \
+    size_t end = len - n_len + 1;                                            \
+    for (; end >= (lanes); end -= (lanes)) {                                 \
+      const char* const block = ptr + end - (lanes);                         \
+      const V a = SNIFEX_API_##P##_LOAD(block);                              \
+      const V b = SNIFEX_API_##P##_LOAD(block + n_len - 1);                  \
+      uint32_t mask = SNIFEX_API_##P##_MASK(SNIFEX_API_##P##_AND(            \
+          SNIFEX_API_##P##_EQ(a, first), SNIFEX_API_##P##_EQ(b, last)));     \
+      while (mask != 0) {                                                    \
+        const size_t bit = 31 - (size_t)__builtin_clz(mask);                 \
+        if (memcmp(block + bit + 1, needle + 1, n_len - 2) == 0) {           \
+          return end - (lanes) + bit;                                        \
+        }                                                                    \
+        mask &= ~((uint32_t)1 << bit);                                       \
+      }                                                                      \
+    }                                                                        \
+    return snifex_api_rfind_scalar(ptr, len, needle, n_len, end);            \
+  }
+
+SNIFEX_API_STR_KERNELS(SSE2, SSE2_U8, __m128i, 16)
+SNIFEX_API_STR_KERNELS(AVX2, AVX2_U8, __m256i, 32)
+#endif  // SNIFEX_API_X86_SIMD
+
+size_t str_find_char(const string str, const char c) {
+#ifdef SNIFEX_API_X86_SIMD
+  if (SNIFEX_API_HAS_AVX2()) {
+    return snifex_api_find_char_AVX2(str.ptr, str.len, c);
+  }
+  return snifex_api_find_char_SSE2(str.ptr, str.len, c);
+#else
+  return snifex_api_find_char_scalar(str.ptr, str.len, c);
+#endif
+}
+
+size_t str_rfind_char(const string str, const char c) {
+#ifdef SNIFEX_API_X86_SIMD
+  if (SNIFEX_API_HAS_AVX2()) {
+    return snifex_api_rfind_char_AVX2(str.ptr, str.len, c);
+  }
+  return snifex_api_rfind_char_SSE2(str.ptr, str.len, c);
+#else
+  return snifex_api_rfind_char_scalar(str.ptr, str.len, c);
+#endif
+}
+
+size_t str_count_char(const string str, const char c) {
+#ifdef SNIFEX_API_X86_SIMD
+  if (SNIFEX_API_HAS_AVX2()) {
+    return snifex_api_count_char_AVX2(str.ptr, str.len, c);
+  }
+  return snifex_api_count_char_SSE2(str.ptr, str.len, c);
+#else
+  return snifex_api_count_char_scalar(str.ptr, str.len, c);
+#endif
+}
+
+size_t str_find(const string str, const string needle) {
+  if (needle.len == 0) { return 0; }
+  if (needle.len == 1) { return str_find_char(str, needle.ptr[0]); }
+  if (needle.len > str.len) { return str.len; }
+#ifdef SNIFEX_API_X86_SIMD
+  if (SNIFEX_API_HAS_AVX2()) {
+    return snifex_api_find_AVX2(str.ptr, str.len, needle.ptr, needle.len);
+  }
+  return snifex_api_find_SSE2(str.ptr, str.len, needle.ptr, needle.len);
+#else
+  return snifex_api_find_scalar(str.ptr, str.len, needle.ptr, needle.len, 0);
+#endif
+}
+
+size_t str_rfind(const string str, const string needle) {
+  if (needle.len == 0) { return str.len; }
+  if (needle.len == 1) { return str_rfind_char(str, needle.ptr[0]); }
+  if (needle.len > str.len) { return str.len; }
+#ifdef SNIFEX_API_X86_SIMD
+  if (SNIFEX_API_HAS_AVX2()) {
+    return snifex_api_rfind_AVX2(str.ptr, str.len, needle.ptr, needle.len);
+  }
+  return snifex_api_rfind_SSE2(str.ptr, str.len, needle.ptr, needle.len);
+#else
+  return snifex_api_rfind_scalar(str.ptr, str.len, needle.ptr, needle.len,
+                                 str.len - needle.len + 1);
+#endif
+}
+
+size_t str_count(const string str, const string needle) {
+  assert(needle.len > 0);
+  if (needle.len == 1) { return str_count_char(str, needle.ptr[0]); }
+  size_t count = 0;
+  string rest = str;
+  for (;;) {
+    const size_t i = str_find(rest, needle);
+    if (i == rest.len) { return count; }
+    count++;
+    rest.ptr += i + needle.len;
+    rest.len -= i + needle.len;
+  }
+}
+
+bool str_contains(const string str, const string needle) {
+  return needle.len == 0 || str_find(str, needle) != str.len;
+}
+
+bool str_starts_with(const string str, const string prefix) {
+  return prefix.len <= str.len &&
+         (prefix.len == 0 || memcmp(str.ptr, prefix.ptr, prefix.len) == 0);
+}
+
+bool str_ends_with(const string str, const string suffix) {
+  return suffix.len <= str.len &&
+         (suffix.len == 0 ||
+          memcmp(str.ptr + str.len - suffix.len, suffix.ptr, suffix.len) == 0);
+}
+
+StrSplit str_split(const string str, const string sep) {
+  assert(sep.len > 0);
+  return (StrSplit){.rest = str, .sep = sep};
+}
+
+StrSplit str_lines(const string str) {
+  return (StrSplit){.rest = str, .sep = strlit("\n"), .lines = true};
+}
+
+bool str_split_next(StrSplit* const it, string* const piece) {
+  assert(it != NULL && piece != NULL);
+  // A trailing line ending does not start another line
+  if (it->done || (it->lines && it->rest.len == 0)) { return false; }
+
+  const size_t i = it->sep.len == 1 ? str_find_char(it->rest, it->sep.ptr[0])
+                                    : str_find(it->rest, it->sep);
+  *piece = (string){.ptr = it->rest.ptr, .len = i};
+  if (i == it->rest.len) {
+    it->done = true;
+  } else {
+    it->rest.ptr += i + it->sep.len;
+    it->rest.len -= i + it->sep.len;
+  }
+  if (it->lines && piece->len > 0 && piece->ptr[piece->len - 1] == '\r') {
+    piece->len--;
+  }
+  return true;
+}
+
+size_t str_utf8_decode(const string str, uint32_t* const cp) {
+  assert(str.len > 0 && cp != NULL);
+  const unsigned char* const p = (const unsigned char*)str.ptr;
+  if (p[0] < 0x80) {
+    *cp = p[0];
+    return 1;
+  }
+
+  size_t len;
+  uint32_t min;
+  if (p[0] >= 0xC2 && p[0] <= 0xDF) {
+    len = 2;
+    min = 0x80;
+    *cp = p[0] & 0x1F;
+  } else if ((p[0] & 0xF0) == 0xE0) {
+    len = 3;
+    min = 0x800;
+    *cp = p[0] & 0x0F;
+  } else if (p[0] >= 0xF0 && p[0] <= 0xF4) {
+    len = 4;
+    min = 0x10000;
+    *cp = p[0] & 0x07;
+  } else {
+    *cp = UTF8_REPLACEMENT;
+    return 1;
+  }
+
+  if (str.len < len) {
+    *cp = UTF8_REPLACEMENT;
+    return 1;
+  }
+  for (size_t i = 1; i < len; i++) {
+    if ((p[i] & 0xC0) != 0x80) {
+      *cp = UTF8_REPLACEMENT;
+      return 1;
+    }
+    *cp = (*cp << 6) | (p[i] & 0x3F);
+  }
+  // Overlong encodings, surrogates and values past the last code point
+  if (*cp < min || *cp > 0x10FFFF || (*cp >= 0xD800 && *cp <= 0xDFFF)) {
+    *cp = UTF8_REPLACEMENT;
+    return 1;
+  }
+  return len;
+}
+
+static bool snifex_api_utf8_valid_scalar(const char* ptr, const size_t len) {
+  size_t i = 0;
+  while (i < len) {
+    uint64_t word;
+    if (i + 8 <= len &&
+        (memcpy(&word, ptr + i, 8), (word & 0x8080808080808080ull) == 0)) {
+      i += 8;
+      continue;
+    }
+    if ((unsigned char)ptr[i] < 0x80) {
+      i++;
+      continue;
+    }
+    // Only an invalid sequence can decode to a single non-ASCII byte
+    uint32_t cp;
+    const size_t n =
+        str_utf8_decode((string){.ptr = (char*)ptr + i, .len = len - i}, &cp);
+    if (n == 1) { return false; }
+    i += n;
+  }
+  return true;
+}
+
+static size_t snifex_api_utf8_count_scalar(const char* ptr, const size_t len) {
+  size_t count = 0;
+  for (size_t i = 0; i < len; i++) {
+    count += ((unsigned char)ptr[i] & 0xC0) != 0x80;
+  }
+  return count;
+}
+
+#ifdef SNIFEX_API_X86_SIMD
+// Error flags of the lookup tables: every pair of consecutive bytes gets the
+// flags of its first byte's high nibble, of its first byte's low nibble and of
+// its second byte's high nibble, and is an error when a flag is in all three
+#define SNIFEX_API_UTF8_TOO_SHORT (1 << 0)   // 11______ 0_______/11______
+#define SNIFEX_API_UTF8_TOO_LONG (1 << 1)    // 0_______ 10______
+#define SNIFEX_API_UTF8_OVERLONG_3 (1 << 2)  // 11100000 100_____
+#define SNIFEX_API_UTF8_TOO_LARGE (1 << 3)   // 11110100 1001____ and up
+#define SNIFEX_API_UTF8_SURROGATE (1 << 4)   // 11101101 101_____
+#define SNIFEX_API_UTF8_OVERLONG_2 (1 << 5)  // 1100000_ 10______
+#define SNIFEX_API_UTF8_TOO_LARGE_1000 (1 << 6)  // 11110101+ 1000____
+#define SNIFEX_API_UTF8_OVERLONG_4 (1 << 6)      // 11110000 1000____
+#define SNIFEX_API_UTF8_TWO_CONTS (1 << 7)       // 10______ 10______
+#define SNIFEX_API_UTF8_CARRY                             \
+  (SNIFEX_API_UTF8_TOO_SHORT | SNIFEX_API_UTF8_TOO_LONG | \
+   SNIFEX_API_UTF8_TWO_CONTS)
+
+#define SNIFEX_API_AVX2_TABLE16(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+// The bytes of `input` shifted right by `n`, with the last `n` bytes of `prev`
+// shifted in
+#define SNIFEX_API_AVX2_PREV(input, prev, n)                              \
+  _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21), \
+                     16 - (n))
+
+SNIFEX_API_TARGET_AVX2 static inline __m256i snifex_api_utf8_check_AVX2(
+    const __m256i input, const __m256i prev_input) {
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i prev1 = SNIFEX_API_AVX2_PREV(input, prev_input, 1);
+
+  const __m256i byte_1_high = _mm256_shuffle_epi8(
+      SNIFEX_API_AVX2_TABLE16(
+          SNIFEX_API_UTF8_TOO_LONG, SNIFEX_API_UTF8_TOO_LONG,
+          SNIFEX_API_UTF8_TOO_LONG, SNIFEX_API_UTF8_TOO_LONG,
+          SNIFEX_API_UTF8_TOO_LONG, SNIFEX_API_UTF8_TOO_LONG,
+          SNIFEX_API_UTF8_TOO_LONG, SNIFEX_API_UTF8_TOO_LONG,
+          (char)SNIFEX_API_UTF8_TWO_CONTS, (char)SNIFEX_API_UTF8_TWO_CONTS,
+          (char)SNIFEX_API_UTF8_TWO_CONTS, (char)SNIFEX_API_UTF8_TWO_CONTS,
+          SNIFEX_API_UTF8_TOO_SHORT | SNIFEX_API_UTF8_OVERLONG_2,
+          SNIFEX_API_UTF8_TOO_SHORT,
+          SNIFEX_API_UTF8_TOO_SHORT | SNIFEX_API_UTF8_OVERLONG_3 |
+              SNIFEX_API_UTF8_SURROGATE,
+          SNIFEX_API_UTF8_TOO_SHORT | SNIFEX_API_UTF8_TOO_LARGE |
+              SNIFEX_API_UTF8_TOO_LARGE_1000 | SNIFEX_API_UTF8_OVERLONG_4),
+      _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+
+  const char carry = (char)SNIFEX_API_UTF8_CARRY;
+  const char large = (char)(SNIFEX_API_UTF8_CARRY | SNIFEX_API_UTF8_TOO_LARGE |
+                            SNIFEX_API_UTF8_TOO_LARGE_1000);
+  const __m256i byte_1_low = _mm256_shuffle_epi8(
+      SNIFEX_API_AVX2_TABLE16(
+          (char)(SNIFEX_API_UTF8_CARRY | SNIFEX_API_UTF8_OVERLONG_3 |
+                 SNIFEX_API_UTF8_OVERLONG_2 | SNIFEX_API_UTF8_OVERLONG_4),
+          (char)(SNIFEX_API_UTF8_CARRY | SNIFEX_API_UTF8_OVERLONG_2), carry,
+          carry, (char)(SNIFEX_API_UTF8_CARRY | SNIFEX_API_UTF8_TOO_LARGE),
+          large, large, large, large, large, large, large, large,
+          (char)(large | SNIFEX_API_UTF8_SURROGATE), large, large),
+      _mm256_and_si256(prev1, nibble));
+
+  const char too_short = SNIFEX_API_UTF8_TOO_SHORT;
+  const char cont = (char)(SNIFEX_API_UTF8_TOO_LONG |
+                           SNIFEX_API_UTF8_OVERLONG_2 |
+                           SNIFEX_API_UTF8_TWO_CONTS);
+  const __m256i byte_2_high = _mm256_shuffle_epi8(
+      SNIFEX_API_AVX2_TABLE16(
+          too_short, too_short, too_short, too_short, too_short, too_short,
+          too_short, too_short,
+          (char)(cont | SNIFEX_API_UTF8_OVERLONG_3 |
+                 SNIFEX_API_UTF8_TOO_LARGE_1000 | SNIFEX_API_UTF8_OVERLONG_4),
+          (char)(cont | SNIFEX_API_UTF8_OVERLONG_3 | SNIFEX_API_UTF8_TOO_LARGE),
+          (char)(cont | SNIFEX_API_UTF8_SURROGATE | SNIFEX_API_UTF8_TOO_LARGE),
+          (char)(cont | SNIFEX_API_UTF8_SURROGATE | SNIFEX_API_UTF8_TOO_LARGE),
+          too_short, too_short, too_short, too_short),
+      _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+
+  const __m256i special =
+      _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+  // The third and fourth bytes of a sequence must be continuations, which the
+  // tables flag as TWO_CONTS: the two cancel out when XORed
+  const __m256i prev2 = SNIFEX_API_AVX2_PREV(input, prev_input, 2);
+  const __m256i prev3 = SNIFEX_API_AVX2_PREV(input, prev_input, 3);
+  const __m256i is_third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0x60));
+  const __m256i is_fourth =
+      _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)0x70));
+  const __m256i must_be_cont = _mm256_and_si256(
+      _mm256_or_si256(is_third, is_fourth), _mm256_set1_epi8((char)0x80));
+  return _mm256_xor_si256(must_be_cont, special);
+}
+
+SNIFEX_API_TARGET_AVX2 static bool snifex_api_utf8_valid_AVX2(
+    const char* ptr, const size_t len) {
+  // Lead bytes in the last 3 positions of a block that need more bytes than
+  // there are left
+  const __m256i max_last = _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1),
+      (char)(0xE0 - 1), (char)(0xC0 - 1));
+  __m256i error = _mm256_setzero_si256();
+  __m256i prev_input = _mm256_setzero_si256();
+  __m256i prev_incomplete = _mm256_setzero_si256();
+
+  char tail[32] = {0};
+  for (size_t i = 0; i < len; i += 32) {
+    const char* block = ptr + i;
+    // The last partial block is padded with ASCII zeroes
+    if (len - i < 32) {
+      memcpy(tail, block, len - i);
+      block = tail;
+    }
+    const __m256i input = _mm256_loadu_si256((const __m256i*)block);
+    if (_mm256_movemask_epi8(input) == 0) {
+      error = _mm256_or_si256(error, prev_incomplete);
+    } else {
+      error = _mm256_or_si256(error,
+                              snifex_api_utf8_check_AVX2(input, prev_input));
+      prev_incomplete = _mm256_subs_epu8(input, max_last);
+    }
+    prev_input = input;
+  }
+  error = _mm256_or_si256(error, prev_incomplete);
+  return _mm256_testz_si256(error, error);
+}
+
+// Continuation bytes are the only ones below -64 when signed
+#define SNIFEX_API_UTF8_COUNT(isa, V, lanes, SET1, LOAD, GT, MASK)   \
+  SNIFEX_API_TARGET_##isa static size_t snifex_api_utf8_count_##isa( \
+      const char* ptr, const size_t len) {                           \
+    const V threshold = SET1(-65);                                   \
+    size_t count = 0;                                                \
+    size_t i = 0;                                                    \
+    for (; i + (lanes) <= len; i += (lanes)) {                       \
+      const V bytes = LOAD((const V*)(ptr + i));                     \
+      count += (size_t)__builtin_popcount(                           \
+          (uint32_t)MASK(GT(bytes, threshold)));                     \
+    }                                                                \
+    return count + snifex_api_utf8_count_scalar(ptr + i, len - i);   \
+  }
+
+SNIFEX_API_UTF8_COUNT(SSE2, __m128i, 16, _mm_set1_epi8, _mm_loadu_si128,
+                      _mm_cmpgt_epi8, _mm_movemask_epi8)
+SNIFEX_API_UTF8_COUNT(AVX2, __m256i, 32, _mm256_set1_epi8, _mm256_loadu_si256,
+                      _mm256_cmpgt_epi8, _mm256_movemask_epi8)
+#endif  // SNIFEX_API_X86_SIMD
+
+bool str_utf8_valid(const string str) {
+#ifdef SNIFEX_API_X86_SIMD
+  if (SNIFEX_API_HAS_AVX2()) {
+    return snifex_api_utf8_valid_AVX2(str.ptr, str.len);
+  }
+#endif
+  return snifex_api_utf8_valid_scalar(str.ptr, str.len);
+}
+
+size_t str_utf8_count(const string str) {
+#ifdef SNIFEX_API_X86_SIMD
+  if (SNIFEX_API_HAS_AVX2()) {
+    return snifex_api_utf8_count_AVX2(str.ptr, str.len);
+  }
+  return snifex_api_utf8_count_SSE2(str.ptr, str.len);
+#else
+  return snifex_api_utf8_count_scalar(str.ptr, str.len);
+#endif
+}
+
+// The White_Space property of the Unicode Character Database
+static bool snifex_api_utf8_is_space(const uint32_t cp) {
+  return (cp >= 0x09 && cp <= 0x0D) || cp == 0x20 || cp == 0x85 ||
+         cp == 0xA0 || cp == 0x1680 || (cp >= 0x2000 && cp <= 0x200A) ||
+         cp == 0x2028 || cp == 0x2029 || cp == 0x202F || cp == 0x205F ||
+         cp == 0x3000;
+}
+
+string str_utf8_trim(const string str) {
+  size_t start = 0;
+  size_t end = str.len;
+  uint32_t cp;
+
+  while (start < end) {
+    const size_t n = str_utf8_decode(
+        (string){.ptr = str.ptr + start, .len = end - start}, &cp);
+    if (!snifex_api_utf8_is_space(cp)) { break; }
+    start += n;
+  }
+  while (end > start) {
+    // Steps back to the lead byte of the last sequence (at most 4 bytes)
+    size_t lead = end - 1;
+    while (lead > start && end - lead < 4 &&
+           ((unsigned char)str.ptr[lead] & 0xC0) == 0x80) {
+      lead--;
+    }
+    const size_t n = str_utf8_decode(
+        (string){.ptr = str.ptr + lead, .len = end - lead}, &cp);
+    if (lead + n != end || !snifex_api_utf8_is_space(cp)) { break; }
+    end = lead;
+  }
+
+  if (start == end) { return (string){0}; }
+  return (string){.ptr = str.ptr + start, .len = end - start};
+}
+
+Utf8Iter str_utf8_iter(const string str) { return (Utf8Iter){.rest = str}; }
+
+bool str_utf8_next(Utf8Iter* const it, uint32_t* const cp) {
+  assert(it != NULL && cp != NULL);
+  if (it->rest.len == 0) { return false; }
+  const size_t n = str_utf8_decode(it->rest, cp);
+  it->rest.ptr += n;
+  it->rest.len -= n;
+  return true;
+}
+
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || \
+    defined(_MSC_VER)
+#define SNIFEX_API_LITTLE_ENDIAN
+#endif
+
+#ifdef SNIFEX_API_LITTLE_ENDIAN
+// Whether the 8 bytes are all ASCII digits
+static inline bool snifex_api_is_8_digits(const uint64_t bytes) {
+  return (((bytes + 0x4646464646464646ull) | (bytes - 0x3030303030303030ull)) &
+          0x8080808080808080ull) == 0;
+}
+
+// Converts 8 ASCII digits (the first one in the lowest byte) by combining
+// pairs of digits, then pairs of pairs and so on
+static inline uint64_t snifex_api_parse_8_digits(uint64_t bytes) {
+  bytes -= 0x3030303030303030ull;
+  bytes = (bytes * 10) + (bytes >> 8);
+  return (((bytes & 0x000000FF000000FFull) * 0x000F424000000064ull) +
+          (((bytes >> 16) & 0x000000FF000000FFull) * 0x0000271000000001ull)) >>
+         32;
+}
+#endif
+
+// Accumulates the digits at `*i` into `*acc`, as long as `*digits` stays below
+// `max_digits`
+static void snifex_api_parse_digits(const string str,
+                                    size_t* const i,
+                                    uint64_t* const acc,
+                                    size_t* const digits,
+                                    const size_t max_digits) {
+#ifdef SNIFEX_API_LITTLE_ENDIAN
+  uint64_t bytes;
+  while (*i + 8 <= str.len && *digits + 8 <= max_digits &&
+         (memcpy(&bytes, str.ptr + *i, 8), snifex_api_is_8_digits(bytes))) {
+    *acc = *acc * 100000000 + snifex_api_parse_8_digits(bytes);
+    *i += 8;
+    *digits += 8;
+  }
+#endif
+  while (*i < str.len && *digits < max_digits &&
+         (unsigned)(str.ptr[*i] - '0') < 10) {
+    *acc = *acc * 10 + (uint64_t)(str.ptr[*i] - '0');
+    (*i)++;
+    (*digits)++;
+  }
+}
+
+bool str_parse_u64(const string str, uint64_t* const out) {
+  assert(out != NULL);
+  if (str.len == 0) { return false; }
+  size_t i = 0;
+  while (i < str.len && str.ptr[i] == '0') { i++; }
+
+  // 19 digits always fit, the 20th needs checking
+  uint64_t n = 0;
+  size_t digits = 0;
+  snifex_api_parse_digits(str, &i, &n, &digits, 19);
+  if (i < str.len) {
+    const unsigned d = (unsigned)(str.ptr[i] - '0');
+    if (d >= 10 || digits != 19 || i + 1 != str.len ||
+        n > (UINT64_MAX - d) / 10) {
+      return false;
+    }
+    n = n * 10 + d;
+  }
+  *out = n;
+  return true;
+}
+
+bool str_parse_i64(const string str, int64_t* const out) {
+  assert(out != NULL);
+  const bool negative = str.len > 0 && str.ptr[0] == '-';
+  const size_t skip = str.len > 0 && (negative || str.ptr[0] == '+');
+  uint64_t n;
+  if (!str_parse_u64((string){.ptr = str.ptr + skip, .len = str.len - skip},
+                     &n) ||
+      n > (uint64_t)INT64_MAX + negative) {
+    return false;
+  }
+  // Negating in unsigned arithmetic, which is fine for INT64_MIN too
+  *out = negative ? (int64_t)(0 - n) : (int64_t)n;
+  return true;
+}
+
+// Significant digits given to strtod: the exact decimal expansion of a double
+// has at most 767 of them, so digits past these can only matter by being non
+// zero, and a final 1 stands for all of them
+#define SNIFEX_API_F64_DIGITS 800
+
+// Converts a number already validated by str_parse_f64 with strtod, on a copy
+// holding the significant digits as an integer and an exponent. Without a
+// decimal point the copy reads the same in every locale
+static double snifex_api_parse_f64_slow(const string str) {
+  char buf[SNIFEX_API_F64_DIGITS + 24];
+  size_t len = 0;
+  size_t i = 0;
+  if (str.ptr[0] == '-' || str.ptr[0] == '+') { buf[len++] = str.ptr[i++]; }
+
+  // Significant digits before the decimal point, negative for the zeroes
+  // between the point and the first significant digit
+  int64_t point = 0;
+  size_t kept = 0;
+  bool fraction = false;
+  bool sticky = false;
+  for (; i < str.len && str.ptr[i] != 'e' && str.ptr[i] != 'E'; i++) {
+    const char c = str.ptr[i];
+    if (c == '.') {
+      fraction = true;
+    } else if (kept == 0 && c == '0') {
+      point -= fraction;
+    } else {
+      point += !fraction;
+      if (kept < SNIFEX_API_F64_DIGITS) {
+        buf[len++] = c;
+        kept++;
+      } else {
+        sticky |= c != '0';
+      }
+    }
+  }
+  if (sticky) {
+    buf[len++] = '1';
+    kept++;
+  }
+
+  int64_t exp = 0;
+  if (i < str.len) {
+    i++;
+    const bool exp_negative = str.ptr[i] == '-';
+    if (exp_negative || str.ptr[i] == '+') { i++; }
+    for (; i < str.len; i++) {
+      if (exp < 1000000000) { exp = exp * 10 + (str.ptr[i] - '0'); }
+    }
+    if (exp_negative) { exp = -exp; }
+  }
+  exp += point - (int64_t)kept;
+
+  buf[len++] = 'e';
+  if (exp < 0) { buf[len++] = '-'; }
+  uint64_t abs_exp = (uint64_t)(exp < 0 ? -exp : exp);
+  char exp_digits[20];
+  size_t n_exp_digits = 0;
+  do {
+    exp_digits[n_exp_digits++] = (char)('0' + abs_exp % 10);
+    abs_exp /= 10;
+  } while (abs_exp > 0);
+  while (n_exp_digits > 0) { buf[len++] = exp_digits[--n_exp_digits]; }
+  buf[len] = '\0';
+  return strtod(buf, NULL);
+}
+
+bool str_parse_f64(const string str, double* const out) {
+  assert(out != NULL);
+  size_t i = 0;
+  const bool negative = str.len > 0 && str.ptr[0] == '-';
+  if (str.len > 0 && (negative || str.ptr[0] == '+')) { i++; }
+
+  // The special values, spelled like `str_from_f64` writes them
+  if (str.len - i == 3 && memcmp(str.ptr + i, "inf", 3) == 0) {
+    *out = negative ? -INFINITY : INFINITY;
+    return true;
+  }
+  if (str.len - i == 3 && memcmp(str.ptr + i, "nan", 3) == 0) {
+    *out = negative ? -NAN : NAN;
+    return true;
+  }
+
+  // The value is `mantissa * 10^exp10`, keeping at most 19 significant digits
+  // in the mantissa, and remembering if some non-zero ones were dropped
+  uint64_t mantissa = 0;
+  size_t digits = 0;
+  int64_t exp10 = 0;
+  bool truncated = false;
+
+  const size_t int_start = i;
+  while (i < str.len && str.ptr[i] == '0') { i++; }
+  for (;;) {
+    snifex_api_parse_digits(str, &i, &mantissa, &digits, 19);
+    if (i >= str.len || (unsigned)(str.ptr[i] - '0') >= 10) { break; }
+    truncated |= str.ptr[i] != '0';
+    exp10++;
+    i++;
+  }
+  size_t n_digits = i - int_start;
+
+  if (i < str.len && str.ptr[i] == '.') {
+    const size_t frac_start = ++i;
+    if (mantissa == 0) {
+      while (i < str.len && str.ptr[i] == '0') { i++; }
+    }
+    snifex_api_parse_digits(str, &i, &mantissa, &digits, 19);
+    exp10 -= (int64_t)(i - frac_start);
+    for (; i < str.len && (unsigned)(str.ptr[i] - '0') < 10; i++) {
+      truncated |= str.ptr[i] != '0';
+    }
+    n_digits += i - frac_start;
+  }
+  if (n_digits == 0) { return false; }
+
+  if (i < str.len && (str.ptr[i] == 'e' || str.ptr[i] == 'E')) {
+    i++;
+    const bool exp_negative = i < str.len && str.ptr[i] == '-';
+    if (i < str.len && (exp_negative || str.ptr[i] == '+')) { i++; }
+    if (i == str.len) { return false; }
+    // Past a few hundred the result is 0 or infinity anyway
+    int64_t exp = 0;
+    for (; i < str.len && (unsigned)(str.ptr[i] - '0') < 10; i++) {
+      if (exp < 100000) { exp = exp * 10 + (str.ptr[i] - '0'); }
+    }
+    exp10 += exp_negative ? -exp : exp;
+  }
+  if (i != str.len) { return false; }
+
+  // Both the mantissa and the power of 10 are exact doubles, so a single
+  // (correctly rounded) operation gives the correctly rounded result. This
+  // needs doubles not to be evaluated with extra precision (E.G. on x87)
+  if (mantissa == 0) {
+    *out = negative ? -0.0 : 0.0;
+    return true;
+  }
+  static const double pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                 1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                 1e18, 1e19, 1e20, 1e21, 1e22};
+#if !defined(__FLT_EVAL_METHOD__) || __FLT_EVAL_METHOD__ == 0
+  if (!truncated && mantissa <= (uint64_t)1 << 53 && exp10 >= -22 &&
+      exp10 <= 22) {
+    double value = (double)mantissa;
+    value = exp10 < 0 ? value / pow10[-exp10] : value * pow10[exp10];
+    *out = negative ? -value : value;
+    return true;
+  }
+#else
+  (void)pow10;
+#endif
+
+  *out = snifex_api_parse_f64_slow(str);
+  return true;
+}
+
+// Writes the digits of `n` at the end of `buf`, returning how many they are
+static size_t snifex_api_fmt_u64(char buf[20], uint64_t n) {
+  static const char pairs[] =
+      "0001020304050607080910111213141516171819202122232425262728293031323334"
+      "3536373839404142434445464748495051525354555657585960616263646566676869"
+      "707172737475767778798081828384858687888990919293949596979899";
+  size_t i = 20;
+  while (n >= 100) {
+    const size_t pair = (size_t)(n % 100) * 2;
+    n /= 100;
+    buf[--i] = pairs[pair + 1];
+    buf[--i] = pairs[pair];
+  }
+  if (n >= 10) {
+    buf[--i] = pairs[n * 2 + 1];
+    buf[--i] = pairs[n * 2];
+  } else {
+    buf[--i] = (char)('0' + n);
+  }
+  return 20 - i;
+}
+
+// Writes `n` with `%.*g`, turning the decimal point of the locale (which may
+// be longer than a byte) into a '.'. Returns 0 if it doesn't fit
+static size_t snifex_api_fmt_g(char buf[32],
+                               const int precision,
+                               const double n) {
+  const int written = snprintf(buf, 32, "%.*g", precision, n);
+  if (written < 0 || written >= 32) { return 0; }
+  size_t len = 0;
+  bool in_point = false;
+  for (int i = 0; i < written; i++) {
+    const char c = buf[i];
+    if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == 'e') {
+      buf[len++] = c;
+      in_point = false;
+    } else if (!in_point) {
+      buf[len++] = '.';
+      in_point = true;
+    }
+  }
+  return len;
+}
+
+// Writes the shortest representation of `n` that reads back the same. `buf`
+// needs 32 bytes
+//
+// For normal numbers, any decimal of at most 15 significant digits (`DBL_DIG`)
+// that reads back to `n` is also `n` rounded to 15 digits, which `%g` prints
+// without its trailing zeroes. So if 15 digits don't round-trip no shorter
+// form does, and 16 or 17 are needed: at most 3 `snprintf` calls, most values
+// taking a single one
+static size_t snifex_api_fmt_f64(char buf[32], const double n) {
+  if (n != n) {
+    memcpy(buf, "nan", 3);
+    return 3;
+  }
+  if (n > -1e15 && n < 1e15 && n == (double)(int64_t)n) {
+    uint64_t bits;
+    memcpy(&bits, &n, sizeof bits);
+    const bool negative = bits >> 63;
+    const uint64_t abs = (uint64_t)(negative ? -n : n);
+    char digits[20];
+    const size_t len = snifex_api_fmt_u64(digits, abs);
+    buf[0] = '-';
+    memcpy(buf + negative, digits + 20 - len, len);
+    return len + negative;
+  }
+  if (n == n + n) {
+    // Infinities, since zeroes were handled above
+    memcpy(buf, n > 0 ? "inf" : "-inf", n > 0 ? 3 : 4);
+    return n > 0 ? 3 : 4;
+  }
+
+  int precision = 15;
+  if (n > -DBL_MIN && n < DBL_MIN) {
+    // Subnormals have fewer significant bits, so shorter forms can read back
+    // the same. Any precision above a round-tripping one round-trips too, so
+    // the shortest is found with a binary search
+    int hi = 17;
+    precision = 1;
+    while (precision < hi) {
+      const int mid = (precision + hi) / 2;
+      const string written = {.ptr = buf,
+                              .len = snifex_api_fmt_g(buf, mid, n)};
+      double read_back;
+      if (str_parse_f64(written, &read_back) && read_back == n) {
+        hi = mid;
+      } else {
+        precision = mid + 1;
+      }
+    }
+  }
+  for (; precision < 17; precision++) {
+    const string written = {.ptr = buf,
+                            .len = snifex_api_fmt_g(buf, precision, n)};
+    double read_back;
+    if (str_parse_f64(written, &read_back) && read_back == n) {
+      return written.len;
+    }
+  }
+  return snifex_api_fmt_g(buf, 17, n);
+}
 
-/// @brief Searches key in the dictionary, and returns pointer to the value if
-/// found
-///
-/// @param lval_result_val_ptr An lvalue of type `v_type*` to which the result
-/// is going to be set
-/// @param k_type The type of the keys in the dictionary
-/// @param v_type The type of the values in the dictionary
-/// @param dict_ptr Pointer to the dictionary
-/// @param k Key of the entry we're searching
-/// @hideinitializer
-#define dict_get(lval_result_val_ptr, k_type, v_type, dict_ptr, k)       \
-  do {                                                                   \
-    Dict(k_type, v_type)* dg_dict_ptr = (dict_ptr);                      \
-    k_type dg_k = (k);                                                   \
-                                                                         \
-    if (dg_dict_ptr->b_len == 0) {                                       \
-      lval_result_val_ptr = NULL;                                        \
-    } else {                                                             \
-      Bucket* b = snifex_api_find_bucket(                                \
-          dg_dict_ptr->buckets, dg_dict_ptr->b_cap, &dg_k,               \
-          hash_num(&dg_k, sizeof(dg_k), dg_dict_ptr->key[0],             \
-                   dg_dict_ptr->key[1]),                                 \
-          dg_dict_ptr->entries.ptr, sizeof(*(dg_dict_ptr->entries.ptr)), \
-          sizeof(dg_dict_ptr->entries.ptr->key), false);                 \
-      if (b->index == 0) {                                               \
-        lval_result_val_ptr = NULL;                                      \
-      } else {                                                           \
-        Entry(k_type, v_type) * e;                                       \
-        vec_idx(e, Entry(k_type, v_type), dg_dict_ptr->entries,          \
-                (b->index - 2));                                         \
-        lval_result_val_ptr = &e->value;                                 \
-      }                                                                  \
-    }                                                                    \
-  } while (0)
+string str_from_u64(Arena* const arena, const uint64_t n) {
+  assert(arena != NULL);
+  char digits[20];
+  const size_t len = snifex_api_fmt_u64(digits, n);
+  return str_copy(arena, (string){.ptr = digits + 20 - len, .len = len});
+}
 
-/// @brief Deletes entry from a dictionary
-///
-/// @par Implementation details
-/// It uses @ref vec_swap_remove to remove an entry. Because of that it does not
-/// guarantee order of the entry vector
-///
-/// @param lval_result_bool An lvalue of type `bool` to which the we set whether
-/// entry with associated key exists and was removed
-/// @param k_type The type of the keys in the dictionary
-/// @param v_type The type of the values in the dictionary
-/// @param dict_ptr Pointer to the dictionary
-/// @param k Key of the entry we're deleting
-/// @hideinitializer
-#define dict_del(lval_result_bool, k_type, v_type, dict_ptr, k)          \
-  ({                                                                     \
-    Dict(k_type, v_type)* dd_dict_ptr = (dict_ptr);                      \
-    k_type dd_k = (k);                                                   \
-                                                                         \
-    if (dd_dict_ptr->b_len == 0) {                                       \
-      lval_result_bool = false;                                          \
-    } else {                                                             \
-      Bucket* b = snifex_api_find_bucket(                                \
-          dd_dict_ptr->buckets, dd_dict_ptr->b_cap, &dd_k,               \
-          hash_num(&dd_k, sizeof(dd_k), dd_dict_ptr->key[0],             \
-                   dd_dict_ptr->key[1]),                                 \
-          dd_dict_ptr->entries.ptr, sizeof(*(dd_dict_ptr->entries.ptr)), \
-          sizeof(dd_dict_ptr->entries.ptr->key), false);                 \
-      if (b->index == 0) {                                               \
-        lval_result_bool = false;                                        \
-      } else {                                                           \
-        /* Remove and place tombstone */                                 \
-        vec_swap_remove(Entry(k_type, v_type), &dd_dict_ptr->entries,    \
-                        b->index - 2);                                   \
-        b->index = 1;                                                    \
-        lval_result_bool = true;                                         \
-      }                                                                  \
-    }                                                                    \
-  })
+string str_from_i64(Arena* const arena, const int64_t n) {
+  assert(arena != NULL);
+  char digits[21];
+  // Negating in unsigned arithmetic, which is fine for INT64_MIN too
+  const uint64_t abs = n < 0 ? 0 - (uint64_t)n : (uint64_t)n;
+  size_t len = snifex_api_fmt_u64(digits + 1, abs);
+  if (n < 0) { digits[21 - ++len] = '-'; }
+  return str_copy(arena, (string){.ptr = digits + 21 - len, .len = len});
+}
 
-/// @brief Frees the dictionary
-///
-/// @param k_type The type of the keys in the dictionary
-/// @param v_type The type of the values in the dictionary
-/// @param dict_ptr Pointer to the dictionary
-/// @hideinitializer
-#define dict_free(k_type, v_type, dict_ptr)         \
-  do {                                              \
-    Dict(k_type, v_type)* df_dict_ptr = (dict_ptr); \
-    free(df_dict_ptr->buckets);                     \
-    vec_free(&df_dict_ptr->entries);                \
-  } while (0)
-#endif  // SNIFEX_API_GNU_EXTENSIONS
+string str_from_f64(Arena* const arena, const double n) {
+  assert(arena != NULL);
+  char digits[32];
+  const size_t len = snifex_api_fmt_f64(digits, n);
+  return str_copy(arena, (string){.ptr = digits, .len = len});
+}
 
-/// @}
+static inline bool snifex_api_json_needs_escape(const char c) {
+  return (unsigned char)c < 0x20 || c == '"' || c == '\\';
+}
 
-#endif  // SNIFEX_API_H
+static inline bool snifex_api_url_unreserved(const char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' ||
+         c == '~';
+}
 
-// IMPLEMENTATION
+#ifdef SNIFEX_API_X86_SIMD
+// Whether the bytes of `x` are in [lo, lo + span], with wrapping subtraction
+// turning the range check into a single unsigned comparison
+#define SNIFEX_API_U8_IN_RANGE(P, x, lo, span)                                \
+  SNIFEX_API_##P##_EQ(SNIFEX_API_##P##_MIN(                                   \
+                          SNIFEX_API_##P##_SUB(x, SNIFEX_API_##P##_SET1(lo)), \
+                          SNIFEX_API_##P##_SET1(span)),                       \
+                      SNIFEX_API_##P##_SUB(x, SNIFEX_API_##P##_SET1(lo)))
+
+// Both scans return the index of the first byte to escape, or `len`
+#define SNIFEX_API_ENCODE_SCANS(isa, P, V, lanes)                          \
+  SNIFEX_API_TARGET_##isa static size_t snifex_api_json_scan_##isa(        \
+      const char* ptr, const size_t len) {                                 \
+    const V quote = SNIFEX_API_##P##_SET1('"');                            \
+    const V backslash = SNIFEX_API_##P##_SET1('\\');                       \
+    const V control = SNIFEX_API_##P##_SET1(0x1F);                         \
+    size_t i = 0;                                                          \
+    for (; i + (lanes) <= len; i += (lanes)) {                             \
+      const V x = SNIFEX_API_##P##_LOAD(ptr + i);                          \
+      const V special = SNIFEX_API_##P##_OR(                               \
+          SNIFEX_API_##P##_OR(SNIFEX_API_##P##_EQ(x, quote),               \
+                              SNIFEX_API_##P##_EQ(x, backslash)),          \
+          SNIFEX_API_##P##_EQ(SNIFEX_API_##P##_MAX(x, control), control)); \
+      const uint32_t mask = SNIFEX_API_##P##_MASK(special);                \
+      if (mask != 0) { return i + (size_t)__builtin_ctz(mask); }           \
+    }                                                                      \
+    for (; i < len && !snifex_api_json_needs_escape(ptr[i]); i++) {}       \
+    return i;                                                              \
+  }                                                                        \
+                                                                           \
+  SNIFEX_API_TARGET_##isa static size_t snifex_api_url_scan_##isa(         \
+      const char* ptr, const size_t len) {                                 \
+    size_t i = 0;                                                          \
+    for (; i + (lanes) <= len; i += (lanes)) {                             \
+      const V x = SNIFEX_API_##P##_LOAD(ptr + i);                          \
+      const V letters = SNIFEX_API_##P##_OR(                               \
+          SNIFEX_API_U8_IN_RANGE(P, x, 'a', 'z' - 'a'),                    \
+          SNIFEX_API_U8_IN_RANGE(P, x, 'A', 'Z' - 'A'));                   \
+      const V marks = SNIFEX_API_##P##_OR(                                 \
+          SNIFEX_API_##P##_OR(                                             \
+              SNIFEX_API_##P##_EQ(x, SNIFEX_API_##P##_SET1('-')),          \
+              SNIFEX_API_##P##_EQ(x, SNIFEX_API_##P##_SET1('.'))),         \
+          SNIFEX_API_##P##_OR(                                             \
+              SNIFEX_API_##P##_EQ(x, SNIFEX_API_##P##_SET1('_')),          \
+              SNIFEX_API_##P##_EQ(x, SNIFEX_API_##P##_SET1('~'))));        \
+      const V unreserved = SNIFEX_API_##P##_OR(                            \
+          SNIFEX_API_##P##_OR(letters, marks),                             \
+          SNIFEX_API_U8_IN_RANGE(P, x, '0', '9' - '0'));                   \
+      const uint32_t mask = SNIFEX_API_##P##_MASK(unreserved) ^            \
+                            (uint32_t)((1ull << (lanes)) - 1);             \
+      if (mask != 0) { return i + (size_t)__builtin_ctz(mask); }           \
+    }                                                                      \
+    for (; i < len && snifex_api_url_unreserved(ptr[i]); i++) {}           \
+    return i;                                                              \
+  }
 
-#ifdef SNIFEX_API_IMPLEMENTATION
+SNIFEX_API_ENCODE_SCANS(SSE2, SSE2_U8, __m128i, 16)
+SNIFEX_API_ENCODE_SCANS(AVX2, AVX2_U8, __m256i, 32)
+
+// Hex digits of 16 bytes at once: every nibble `n` becomes `'0' + n`, plus
+// `'a' - '0' - 10` when it's over 9
+static inline size_t snifex_api_hex_encode_SSE2(char* dest,
+                                                const char* ptr,
+                                                const size_t len) {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  const __m128i nine = _mm_set1_epi8(9);
+  const __m128i zero_char = _mm_set1_epi8('0');
+  const __m128i letter_gap = _mm_set1_epi8('a' - '0' - 10);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    const __m128i x = _mm_loadu_si128((const __m128i*)(ptr + i));
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+    __m128i lo = _mm_and_si128(x, nibble);
+    hi = _mm_add_epi8(_mm_add_epi8(hi, zero_char),
+                      _mm_and_si128(_mm_cmpgt_epi8(hi, nine), letter_gap));
+    lo = _mm_add_epi8(_mm_add_epi8(lo, zero_char),
+                      _mm_and_si128(_mm_cmpgt_epi8(lo, nine), letter_gap));
+    _mm_storeu_si128((__m128i*)(dest + 2 * i), _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i*)(dest + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+  }
+  return i;
+}
+#endif  // SNIFEX_API_X86_SIMD
 
-#ifndef SNIFEX_API_NO_ASSERT
-void __snifex_api_assert_fail(const char* expr,
-                              const char* file,
-                              const int line,
-                              const char* func) {
-  fprintf(stderr,
-          "\33[0;31m%s\33[0m:\33[0;33m%d\33[0m in func "
-          "\33[0;32m%s\33[0m():\n\t\33[0;91mAssert failed\33[0m -> %s\n",
-          file, line, func, expr);
-#ifdef OS_LINUX
-  fprintf(stderr, "\33[38;5;124mStacktrace:\33[0m\n");
-  char** strings;
-  size_t size;
-  void* array[1024];
-  size = backtrace(array, 1024);
-  strings = backtrace_symbols(array, size);
-  for (size_t i = 0; i < size; i++) printf("\33[0;37m%s\n", strings[i]);
-  printf("\33[0m\n");
-  free(strings);
+static size_t snifex_api_json_scan(const char* ptr, const size_t len) {
+#ifdef SNIFEX_API_X86_SIMD
+  if (SNIFEX_API_HAS_AVX2()) { return snifex_api_json_scan_AVX2(ptr, len); }
+  return snifex_api_json_scan_SSE2(ptr, len);
+#else
+  size_t i = 0;
+  for (; i < len && !snifex_api_json_needs_escape(ptr[i]); i++) {}
+  return i;
 #endif
-#ifdef OS_WIN
-  fprintf(stderr, "\33[38;5;124mStacktrace:\33[0m\n");
+}
 
-  const DWORD options = SymGetOptions();
-  SymSetOptions(options | SYMOPT_LOAD_LINES);
-  SymInitialize(GetCurrentProcess(), NULL, true);
+static size_t snifex_api_url_scan(const char* ptr, const size_t len) {
+#ifdef SNIFEX_API_X86_SIMD
+  if (SNIFEX_API_HAS_AVX2()) { return snifex_api_url_scan_AVX2(ptr, len); }
+  return snifex_api_url_scan_SSE2(ptr, len);
+#else
+  size_t i = 0;
+  for (; i < len && snifex_api_url_unreserved(ptr[i]); i++) {}
+  return i;
+#endif
+}
 
-  void* array[48];
-  size_t size = CaptureStackBackTrace(0, 48, array, NULL);
+static const char snifex_api_hex_digits[] = "0123456789abcdef";
 
-  for (size_t i = 0; i < size; i++) {
-    DWORD64 address = (DWORD64)(array[i]);
-    CHAR buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME * sizeof(CHAR)];
-    PSYMBOL_INFO symbol = (PSYMBOL_INFO)buffer;
-    symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
-    symbol->MaxNameLen = MAX_SYM_NAME;
+// Value of a hex digit, or -1
+static inline int snifex_api_hex_value(const char c) {
+  if (c >= '0' && c <= '9') { return c - '0'; }
+  if (c >= 'a' && c <= 'f') { return c - 'a' + 10; }
+  if (c >= 'A' && c <= 'F') { return c - 'A' + 10; }
+  return -1;
+}
 
-    if (SymFromAddr(GetCurrentProcess(), address, 0, symbol)) {
-      fprintf(stderr, "\33[0;37mFrame %u: %s\n", i, symbol->Name);
+// Decoders never write more than they read, so they allocate `str.len` bytes
+// and give back what they did not use, when nothing was allocated after them
+static void snifex_api_shrink_last(Arena* const arena,
+                                   const string buf,
+                                   const size_t used) {
+  if (buf.ptr + buf.len == arena->buf + arena->top) {
+    arena->top -= buf.len - used;
+  }
+}
+
+// Gives back the buffer of a decoder that hit invalid input, or ran out of
+// space for it
+static bool snifex_api_decode_fail(Arena* const arena,
+                                   const string buf,
+                                   string* const out) {
+  if (buf.ptr != NULL) { snifex_api_shrink_last(arena, buf, 0); }
+  *out = (string){.ptr = NULL, .len = 0};
+  return false;
+}
+
+string str_json_escape(Arena* const arena, const string str) {
+  assert(arena != NULL);
+  size_t i = snifex_api_json_scan(str.ptr, str.len);
+  if (i == str.len) { return str; }
+
+  // Short escapes take 2 bytes, the others `\u00XX` 6
+  size_t len = str.len;
+  for (size_t j = i; j < str.len;) {
+    const char c = str.ptr[j];
+    len += c == '"' || c == '\\' || c == '\b' || c == '\f' || c == '\n' ||
+                   c == '\r' || c == '\t'
+               ? 1
+               : 5;
+    j++;
+    j += snifex_api_json_scan(str.ptr + j, str.len - j);
+  }
+
+  string out = str_alloc(arena, len);
+  if (out.ptr == NULL) { return out; }
+  memcpy(out.ptr, str.ptr, i);
+  char* dest = out.ptr + i;
+  while (i < str.len) {
+    const char c = str.ptr[i++];
+    *dest++ = '\\';
+    switch (c) {
+      case '"': *dest++ = '"'; break;
+      case '\\': *dest++ = '\\'; break;
+      case '\b': *dest++ = 'b'; break;
+      case '\f': *dest++ = 'f'; break;
+      case '\n': *dest++ = 'n'; break;
+      case '\r': *dest++ = 'r'; break;
+      case '\t': *dest++ = 't'; break;
+      default:
+        memcpy(dest, "u00", 3);
+        dest[3] = snifex_api_hex_digits[(unsigned char)c >> 4];
+        dest[4] = snifex_api_hex_digits[c & 0x0F];
+        dest += 5;
+    }
+    const size_t run = snifex_api_json_scan(str.ptr + i, str.len - i);
+    memcpy(dest, str.ptr + i, run);
+    dest += run;
+    i += run;
+  }
+  return out;
+}
+
+// Reads the 4 hex digits of a `\u` escape
+static bool snifex_api_json_hex4(const char* ptr, uint32_t* const value) {
+  *value = 0;
+  for (size_t i = 0; i < 4; i++) {
+    const int digit = snifex_api_hex_value(ptr[i]);
+    if (digit < 0) { return false; }
+    *value = (*value << 4) | (uint32_t)digit;
+  }
+  return true;
+}
+
+bool str_json_unescape(Arena* const arena,
+                       const string str,
+                       string* const out) {
+  assert(arena != NULL && out != NULL);
+  size_t i = str_find_char(str, '\\');
+  if (i == str.len) {
+    *out = str;
+    return true;
+  }
+
+  const string buf = str_alloc(arena, str.len);
+  if (buf.ptr == NULL) { return snifex_api_decode_fail(arena, buf, out); }
+  memcpy(buf.ptr, str.ptr, i);
+  char* dest = buf.ptr + i;
+
+  while (i < str.len) {
+    if (str.ptr[i] != '\\') {
+      const string rest = {.ptr = str.ptr + i, .len = str.len - i};
+      const size_t run = str_find_char(rest, '\\');
+      memcpy(dest, rest.ptr, run);
+      dest += run;
+      i += run;
+      continue;
+    }
+    if (i + 1 == str.len) { return snifex_api_decode_fail(arena, buf, out); }
+    const char c = str.ptr[i + 1];
+    i += 2;
+    switch (c) {
+      case '"': *dest++ = '"'; continue;
+      case '\\': *dest++ = '\\'; continue;
+      case '/': *dest++ = '/'; continue;
+      case 'b': *dest++ = '\b'; continue;
+      case 'f': *dest++ = '\f'; continue;
+      case 'n': *dest++ = '\n'; continue;
+      case 'r': *dest++ = '\r'; continue;
+      case 't': *dest++ = '\t'; continue;
+      case 'u': break;
+      default: return snifex_api_decode_fail(arena, buf, out);
+    }
+
+    uint32_t cp;
+    if (i + 4 > str.len || !snifex_api_json_hex4(str.ptr + i, &cp)) {
+      return snifex_api_decode_fail(arena, buf, out);
+    }
+    i += 4;
+    if (cp >= 0xDC00 && cp <= 0xDFFF) {
+      return snifex_api_decode_fail(arena, buf, out);
+    }
+    if (cp >= 0xD800 && cp <= 0xDBFF) {
+      uint32_t low;
+      if (i + 6 > str.len || str.ptr[i] != '\\' || str.ptr[i + 1] != 'u' ||
+          !snifex_api_json_hex4(str.ptr + i + 2, &low) || low < 0xDC00 ||
+          low > 0xDFFF) {
+        return snifex_api_decode_fail(arena, buf, out);
+      }
+      i += 6;
+      cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+    }
+
+    if (cp < 0x80) {
+      *dest++ = (char)cp;
+    } else if (cp < 0x800) {
+      *dest++ = (char)(0xC0 | (cp >> 6));
+      *dest++ = (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+      *dest++ = (char)(0xE0 | (cp >> 12));
+      *dest++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+      *dest++ = (char)(0x80 | (cp & 0x3F));
     } else {
-      fprintf(stderr,
-              "\33[0;37mFrame %u: Address = 0x%p (No debug info, if using MSVC "
-              "remember the /Zi flag)\n",
-              i, (void*)address);
+      *dest++ = (char)(0xF0 | (cp >> 18));
+      *dest++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+      *dest++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+      *dest++ = (char)(0x80 | (cp & 0x3F));
     }
   }
-  printf("\33[0m\n");
-  SymCleanup(GetCurrentProcess());
-#endif  // OS_WIN
-  exit(1);
+
+  *out = (string){.ptr = buf.ptr, .len = (size_t)(dest - buf.ptr)};
+  snifex_api_shrink_last(arena, buf, out->len);
+  return true;
 }
-#endif  // SNIFEX_API_NO_ASSERT
 
-inline bool __snifex_api_is_power_of_two(const size_t x) {
-  return (x & (x - 1)) == 0;
+string str_url_encode(Arena* const arena, const string str) {
+  assert(arena != NULL);
+  size_t i = snifex_api_url_scan(str.ptr, str.len);
+  if (i == str.len) { return str; }
+
+  size_t len = str.len;
+  for (size_t j = i; j < str.len;) {
+    len += 2;
+    j++;
+    j += snifex_api_url_scan(str.ptr + j, str.len - j);
+  }
+
+  string out = str_alloc(arena, len);
+  if (out.ptr == NULL) { return out; }
+  memcpy(out.ptr, str.ptr, i);
+  char* dest = out.ptr + i;
+  while (i < str.len) {
+    const unsigned char c = (unsigned char)str.ptr[i++];
+    dest[0] = '%';
+    dest[1] = "0123456789ABCDEF"[c >> 4];
+    dest[2] = "0123456789ABCDEF"[c & 0x0F];
+    dest += 3;
+    const size_t run = snifex_api_url_scan(str.ptr + i, str.len - i);
+    memcpy(dest, str.ptr + i, run);
+    dest += run;
+    i += run;
+  }
+  return out;
 }
 
-// uint32_t ceil_powtwo(uint32_t v) {
-//   v--;
-//   v |= v >> 1;
-//   v |= v >> 2;
-//   v |= v >> 4;
-//   v |= v >> 8;
-//   v |= v >> 16;
-//   return v + 1;
-// }
+bool str_url_decode(Arena* const arena, const string str, string* const out) {
+  assert(arena != NULL && out != NULL);
+  size_t i = str_find_char(str, '%');
+  if (i == str.len) {
+    *out = str;
+    return true;
+  }
 
-void dyn_arena_init(DynArena* const dyn_arena, const size_t init_cap) {
-  dyn_arena->buf = (char*)malloc(init_cap);
-  dyn_arena->cap = init_cap;
-  dyn_arena->top = 0;
-  assert(dyn_arena->buf != NULL);
+  const string buf = str_alloc(arena, str.len);
+  if (buf.ptr == NULL) { return snifex_api_decode_fail(arena, buf, out); }
+  memcpy(buf.ptr, str.ptr, i);
+  char* dest = buf.ptr + i;
+
+  while (i < str.len) {
+    if (i + 3 > str.len) { return snifex_api_decode_fail(arena, buf, out); }
+    const int hi = snifex_api_hex_value(str.ptr[i + 1]);
+    const int lo = snifex_api_hex_value(str.ptr[i + 2]);
+    if (hi < 0 || lo < 0) { return snifex_api_decode_fail(arena, buf, out); }
+    *dest++ = (char)(hi << 4 | lo);
+    i += 3;
+
+    const string rest = {.ptr = str.ptr + i, .len = str.len - i};
+    const size_t run = str_find_char(rest, '%');
+    memcpy(dest, rest.ptr, run);
+    dest += run;
+    i += run;
+  }
+
+  *out = (string){.ptr = buf.ptr, .len = (size_t)(dest - buf.ptr)};
+  snifex_api_shrink_last(arena, buf, out->len);
+  return true;
 }
 
-void arena_init(Arena* const arena, const size_t size) {
-  arena->buf = (char*)malloc(size);
-  arena->size = size;
-  arena->top = 0;
-  assert(arena->buf != NULL);
+string str_hex_encode(Arena* const arena, const string str) {
+  assert(arena != NULL);
+  if (str.len == 0) { return str; }
+  string out = str_alloc(arena, str.len * 2);
+  if (out.ptr == NULL) { return out; }
+
+  size_t i = 0;
+#ifdef SNIFEX_API_X86_SIMD
+  i = snifex_api_hex_encode_SSE2(out.ptr, str.ptr, str.len);
+#endif
+  for (; i < str.len; i++) {
+    out.ptr[2 * i] = snifex_api_hex_digits[(unsigned char)str.ptr[i] >> 4];
+    out.ptr[2 * i + 1] = snifex_api_hex_digits[str.ptr[i] & 0x0F];
+  }
+  return out;
 }
 
-DynArena dyn_arena_create(const size_t init_cap) {
-  DynArena dyn_arena = {0};
-  dyn_arena_init(&dyn_arena, init_cap);
-  return dyn_arena;
+bool str_hex_decode(Arena* const arena, const string str, string* const out) {
+  assert(arena != NULL && out != NULL);
+  if (str.len % 2 != 0) {
+    *out = (string){.ptr = NULL, .len = 0};
+    return false;
+  }
+  const string buf = str_alloc(arena, str.len / 2);
+  if (buf.ptr == NULL) {
+    snifex_api_decode_fail(arena, buf, out);
+    return str.len == 0;
+  }
+
+  for (size_t i = 0; i < buf.len; i++) {
+    const int hi = snifex_api_hex_value(str.ptr[2 * i]);
+    const int lo = snifex_api_hex_value(str.ptr[2 * i + 1]);
+    if (hi < 0 || lo < 0) { return snifex_api_decode_fail(arena, buf, out); }
+    buf.ptr[i] = (char)(hi << 4 | lo);
+  }
+  *out = buf;
+  return true;
 }
 
-Arena arena_create(const size_t init_cap) {
-  Arena arena = {0};
-  arena_init(&arena, init_cap);
-  return arena;
+static const char snifex_api_base64_digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Value of a base64 digit, or -1
+static inline int snifex_api_base64_value(const char c) {
+  if (c >= 'A' && c <= 'Z') { return c - 'A'; }
+  if (c >= 'a' && c <= 'z') { return c - 'a' + 26; }
+  if (c >= '0' && c <= '9') { return c - '0' + 52; }
+  if (c == '+') { return 62; }
+  if (c == '/') { return 63; }
+  return -1;
 }
 
-size_t dyn_arena_alloc(DynArena* const dyn_arena,
-                       const size_t size,
-                       const size_t alignment) {
-  assert(!(size == 0 || alignment == 0 ||
-           (alignment != 1 && !__snifex_api_is_power_of_two(alignment)) ||
-           size % alignment != 0));
+string str_base64_encode(Arena* const arena, const string str) {
+  assert(arena != NULL);
+  if (str.len == 0) { return str; }
+  string out = str_alloc(arena, (str.len + 2) / 3 * 4);
+  if (out.ptr == NULL) { return out; }
+
+  const unsigned char* const src = (const unsigned char*)str.ptr;
+  char* dest = out.ptr;
+  size_t i = 0;
+  for (; i + 3 <= str.len; i += 3) {
+    const uint32_t bits = (uint32_t)src[i] << 16 |
+                          (uint32_t)src[i + 1] << 8 | src[i + 2];
+    dest[0] = snifex_api_base64_digits[bits >> 18];
+    dest[1] = snifex_api_base64_digits[(bits >> 12) & 0x3F];
+    dest[2] = snifex_api_base64_digits[(bits >> 6) & 0x3F];
+    dest[3] = snifex_api_base64_digits[bits & 0x3F];
+    dest += 4;
+  }
+  if (i < str.len) {
+    const bool two = i + 2 == str.len;
+    const uint32_t bits =
+        (uint32_t)src[i] << 16 | (two ? (uint32_t)src[i + 1] << 8 : 0);
+    dest[0] = snifex_api_base64_digits[bits >> 18];
+    dest[1] = snifex_api_base64_digits[(bits >> 12) & 0x3F];
+    dest[2] = two ? snifex_api_base64_digits[(bits >> 6) & 0x3F] : '=';
+    dest[3] = '=';
+  }
+  return out;
+}
+
+bool str_base64_decode(Arena* const arena,
+                       const string str,
+                       string* const out) {
+  assert(arena != NULL && out != NULL);
+  size_t len = str.len;
+  if (len % 4 == 0 && len > 0 && str.ptr[len - 1] == '=') {
+    len -= 1 + (str.ptr[len - 2] == '=');
+  }
+  // A single digit left over can't make a byte
+  if (len % 4 == 1) {
+    *out = (string){.ptr = NULL, .len = 0};
+    return false;
+  }
+
+  const size_t tail = len % 4 > 0 ? len % 4 - 1 : 0;
+  const string buf = str_alloc(arena, len / 4 * 3 + tail);
+  if (buf.ptr == NULL) {
+    snifex_api_decode_fail(arena, buf, out);
+    return len == 0;
+  }
+
+  char* dest = buf.ptr;
+  for (size_t i = 0; i < len; i += 4) {
+    const size_t digits = len - i < 4 ? len - i : 4;
+    uint32_t bits = 0;
+    for (size_t j = 0; j < 4; j++) {
+      const int value =
+          j < digits ? snifex_api_base64_value(str.ptr[i + j]) : 0;
+      if (value < 0) { return snifex_api_decode_fail(arena, buf, out); }
+      bits = bits << 6 | (uint32_t)value;
+    }
+    // Bits past the last byte must be zero, for a single valid encoding
+    if ((digits == 2 && (bits & 0xFFFF) != 0) ||
+        (digits == 3 && (bits & 0xFF) != 0)) {
+      return snifex_api_decode_fail(arena, buf, out);
+    }
+    *dest++ = (char)(bits >> 16);
+    if (digits > 2) { *dest++ = (char)(bits >> 8); }
+    if (digits > 3) { *dest++ = (char)bits; }
+  }
+  *out = buf;
+  return true;
+}
+
+#ifdef SNIFEX_API_POSIX_IO
+#ifdef POSIX_MADV_SEQUENTIAL
+#define SNIFEX_API_MADV_SEQUENTIAL POSIX_MADV_SEQUENTIAL
+#define SNIFEX_API_MADV_WILLNEED POSIX_MADV_WILLNEED
+#elif defined(OS_LINUX)
+// glibc hides `posix_madvise` from strict ISO builds (`-std=c99`) that define
+// no POSIX feature-test macro, though libc always has it. A macro defined here
+// would come too late when a system header was included first. The values are
+// the same on every Linux architecture
+extern int posix_madvise(void* addr, size_t len, int advice);
+#define SNIFEX_API_MADV_SEQUENTIAL 2
+#define SNIFEX_API_MADV_WILLNEED 3
+#endif
 
-  size_t top = dyn_arena->top;
-  size_t padding = (top + alignment - 1) & ~(alignment - 1);
+// Opens a regular file and gets its size, or returns -1
+static int snifex_api_open_regular(const char* const path,
+                                   size_t* const size) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) { return -1; }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+      (uint64_t)st.st_size > SIZE_MAX) {
+    close(fd);
+    return -1;
+  }
+  *size = (size_t)st.st_size;
+  return fd;
+}
 
-  if (top + padding + size > dyn_arena->cap) {
-    dyn_arena->cap += top + padding + size;
-    dyn_arena->cap *= 2;
-    dyn_arena->buf = (char*)realloc(dyn_arena->buf, dyn_arena->cap);
-    assert(dyn_arena->buf != NULL);
+bool str_map_file(const char* const path, string* const out) {
+  assert(path != NULL && out != NULL);
+  *out = (string){.ptr = NULL, .len = 0};
+  size_t size;
+  const int fd = snifex_api_open_regular(path, &size);
+  if (fd < 0) { return false; }
+  // mmap refuses empty mappings
+  if (size == 0) {
+    close(fd);
+    return true;
   }
 
-  dyn_arena->top += size + padding;
-  return top;
+  void* const ptr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the file is closed
+  close(fd);
+  if (ptr == MAP_FAILED) { return false; }
+#ifdef SNIFEX_API_MADV_SEQUENTIAL
+  posix_madvise(ptr, size, SNIFEX_API_MADV_SEQUENTIAL);
+  posix_madvise(ptr, size, SNIFEX_API_MADV_WILLNEED);
+#endif
+  *out = (string){.ptr = (char*)ptr, .len = size};
+  return true;
 }
 
-void* arena_alloc(Arena* const arena,
-                  const size_t size,
-                  const size_t alignment) {
-  if (size == 0) { return NULL; }
-  assert(!(alignment == 0 ||
-           (alignment != 1 && !__snifex_api_is_power_of_two(alignment)) ||
-           size % alignment != 0));
+void str_unmap_file(const string str) {
+  if (str.ptr != NULL) { munmap(str.ptr, str.len); }
+}
+
+bool str_read_file(Arena* const arena,
+                   const char* const path,
+                   string* const out) {
+  assert(arena != NULL && path != NULL && out != NULL);
+  *out = (string){.ptr = NULL, .len = 0};
+  size_t size;
+  const int fd = snifex_api_open_regular(path, &size);
+  if (fd < 0) { return false; }
+  // Arenas return `NULL` for empty allocations
+  const string buf = str_alloc(arena, size);
+  if (buf.ptr == NULL) {
+    close(fd);
+    return size == 0;
+  }
 
-  size_t top = arena->top;
-  size_t padding = (top + alignment - 1) & ~(alignment - 1);
+  size_t len = 0;
+  bool failed = false;
+  while (len < size) {
+    const ssize_t n = read(fd, buf.ptr + len, size - len);
+    if (n > 0) {
+      len += (size_t)n;
+    } else if (n == 0) {
+      break;
+    } else if (errno != EINTR) {
+      failed = true;
+      break;
+    }
+  }
+  close(fd);
 
-  if (top + padding + size > arena->size) { return NULL; }
+  if (failed) {
+    snifex_api_shrink_last(arena, buf, 0);
+    return false;
+  }
+  snifex_api_shrink_last(arena, buf, len);
+  *out = (string){.ptr = buf.ptr, .len = len};
+  return true;
+}
 
-  void* ret = &arena->buf[top];
-  arena->top += size + padding;
-  return ret;
+StrReader str_reader_create(const int fd, const size_t buf_size) {
+  assert(buf_size > 0);
+  StrReader reader = {.fd = fd, .cap = buf_size};
+  reader.buf = (char*)malloc(buf_size);
+  assert(reader.buf != NULL);
+  return reader;
 }
 
-void dyn_arena_reserve(DynArena* const dyn_arena, const size_t min_cap) {
-  if (dyn_arena->cap < min_cap) {
-    dyn_arena->cap *= min_cap;
-    dyn_arena->buf = (char*)realloc(dyn_arena->buf, dyn_arena->cap);
-    assert(dyn_arena->buf != NULL);
+// Moves the unfinished record to the front of the buffer, growing it when
+// the record fills it all, and reads more after it. Returns whether anything
+// was read
+static bool snifex_api_reader_refill(StrReader* const reader) {
+  if (reader->start > 0) {
+    memmove(reader->buf, reader->buf + reader->start,
+            reader->end - reader->start);
+    reader->end -= reader->start;
+    reader->start = 0;
+  }
+  if (reader->end == reader->cap) {
+    reader->cap *= 2;
+    reader->buf = (char*)realloc(reader->buf, reader->cap);
+    assert(reader->buf != NULL);
+  }
+
+  for (;;) {
+    const ssize_t n =
+        read(reader->fd, reader->buf + reader->end, reader->cap - reader->end);
+    if (n > 0) {
+      reader->end += (size_t)n;
+      return true;
+    }
+    if (n == 0 || errno != EINTR) {
+      reader->eof = true;
+      reader->failed = n < 0;
+      return false;
+    }
   }
 }
 
-void dyn_arena_free(DynArena* const dyn_arena) { free(dyn_arena->buf); }
-void arena_free(Arena* const arena) { free(arena->buf); }
+bool str_reader_next(StrReader* const reader,
+                     const char delim,
+                     string* const record) {
+  assert(reader != NULL && record != NULL);
+  // Bytes of the record already known not to contain `delim`
+  size_t scanned = 0;
+  for (;;) {
+    const size_t pending = reader->end - reader->start;
+    const string window = {.ptr = reader->buf + reader->start + scanned,
+                           .len = pending - scanned};
+    const size_t i = str_find_char(window, delim);
+    if (i < window.len) {
+      *record = (string){.ptr = reader->buf + reader->start,
+                         .len = scanned + i};
+      reader->start += scanned + i + 1;
+      return true;
+    }
+    scanned = pending;
 
-string strlit(char const* s) {
-  return (string){.ptr = (char*)s, .len = strlen(s)};
+    if (reader->eof || !snifex_api_reader_refill(reader)) {
+      if (reader->failed || pending == 0) { return false; }
+      *record = (string){.ptr = reader->buf + reader->start, .len = pending};
+      reader->start = reader->end;
+      return true;
+    }
+  }
 }
-bool str_is_empty(const string str) {
-  return (str.ptr == NULL || str.len == 0);
+
+bool str_reader_next_line(StrReader* const reader, string* const line) {
+  if (!str_reader_next(reader, '\n', line)) { return false; }
+  if (line->len > 0 && line->ptr[line->len - 1] == '\r') { line->len--; }
+  return true;
 }
 
-string str_alloc(Arena* const arena, const size_t len) {
-  assert(arena != NULL);
+void str_reader_free(StrReader* const reader) {
+  assert(reader != NULL);
+  free(reader->buf);
+  reader->buf = NULL;
+  reader->cap = reader->start = reader->end = 0;
+}
 
-  return (string){
-      .ptr = (char*)arena_alloc(arena, len, 1),
-      .len = len,
-  };
+StrWriter str_writer_create(const int fd, const size_t buf_size) {
+  assert(buf_size > 0);
+  StrWriter writer = {.fd = fd, .cap = buf_size};
+  writer.buf = (char*)malloc(buf_size);
+  assert(writer.buf != NULL);
+  return writer;
 }
 
-string str_copy(Arena* const arena, const string str) {
-  if (str.len == 0) { return str; }
-  assert(arena != NULL);
+// Appends a piece, merging it with the previous one when contiguous, like
+// consecutive copies in the buffer
+static void snifex_api_writer_push(StrWriter* const writer,
+                                   char* const ptr,
+                                   const size_t len) {
+  if (writer->iovs_len > 0) {
+    struct iovec* const last = &writer->iovs[writer->iovs_len - 1];
+    if ((char*)last->iov_base + last->iov_len == ptr) {
+      last->iov_len += len;
+      return;
+    }
+  }
+  assert(writer->iovs_len < SNIFEX_API_WRITER_IOVS);
+  writer->iovs[writer->iovs_len++] =
+      (struct iovec){.iov_base = ptr, .iov_len = len};
+}
 
-  char* dest = (char*)arena_alloc(arena, str.len, 1);
-  return (string){
-      .ptr = (char*)memcpy(dest, str.ptr, str.len),
-      .len = str.len,
-  };
+bool str_writer_write(StrWriter* const writer, const string str) {
+  assert(writer != NULL);
+  if (str.len >= writer->cap) {
+    if (!str_writer_write_view(writer, str)) { return false; }
+    if (str_writer_flush(writer)) { return true; }
+    // What is left of `str` ends the last piece, which may have been merged
+    // with the one before
+    struct iovec* const last = &writer->iovs[writer->iovs_len - 1];
+    last->iov_len -= last->iov_len < str.len ? last->iov_len : str.len;
+    if (last->iov_len == 0) { writer->iovs_len--; }
+    return false;
+  }
+  if (str.len > writer->cap - writer->len ||
+      writer->iovs_len == SNIFEX_API_WRITER_IOVS) {
+    if (!str_writer_flush(writer)) { return false; }
+  }
+  if (str.len == 0) { return true; }
+
+  char* const dest = writer->buf + writer->len;
+  memcpy(dest, str.ptr, str.len);
+  writer->len += str.len;
+  snifex_api_writer_push(writer, dest, str.len);
+  return true;
 }
 
-char* str_idx(const string str, const size_t i) {
-  assert(i < str.len && str.ptr != NULL);
-  return &str.ptr[i];
+bool str_writer_write_view(StrWriter* const writer, const string str) {
+  assert(writer != NULL);
+  if (str.len <= SNIFEX_API_WRITER_COPY_MAX && str.len < writer->cap) {
+    return str_writer_write(writer, str);
+  }
+  if (writer->iovs_len == SNIFEX_API_WRITER_IOVS) {
+    if (!str_writer_flush(writer)) { return false; }
+  }
+  snifex_api_writer_push(writer, str.ptr, str.len);
+  return true;
 }
 
-// Short-circuing if the length is equal and is 0 is because memcmp with NULL
-// pointers is U.B. in c99, even if the number of bytes copied is 0, and in this
-// library empty strings can have a NULL pointer.
-//
-// See `str_join` for more info
-bool str_eq(const string a, const string b) {
-  return a.len == b.len && (a.len == 0 || memcmp(a.ptr, b.ptr, a.len) == 0);
+bool str_writer_flush(StrWriter* const writer) {
+  assert(writer != NULL);
+  // `writev` refuses more pieces than that. POSIX guarantees at least 16
+#ifdef IOV_MAX
+  const size_t iov_max = IOV_MAX;
+#else
+  const long sys_iov_max = sysconf(_SC_IOV_MAX);
+  const size_t iov_max = sys_iov_max > 0 ? (size_t)sys_iov_max : 16;
+#endif
+  struct iovec* iov = writer->iovs;
+  size_t n = writer->iovs_len;
+
+  while (n > 0) {
+    const ssize_t written =
+        writev(writer->fd, iov, (int)(n < iov_max ? n : iov_max));
+    if (written < 0) {
+      if (errno == EINTR) { continue; }
+      // The pieces left point where they did, `buf` included
+      memmove(writer->iovs, iov, n * sizeof *iov);
+      writer->iovs_len = n;
+      return false;
+    }
+    // Skips the pieces written whole, and the written part of the next one
+    size_t left = (size_t)written;
+    for (; n > 0 && left >= iov->iov_len; iov++, n--) { left -= iov->iov_len; }
+    if (n > 0) {
+      iov->iov_base = (char*)iov->iov_base + left;
+      iov->iov_len -= left;
+    }
+  }
+  writer->iovs_len = writer->len = 0;
+  return true;
 }
 
-// Note! Can execute memcpy(ptr, NULL, 0), where ptr is guaranteed not to be
-// NULL, which is U.B. before c2y. Clang and GCC apparently handle this
-// gratefully while MSVC does not so, to conform to c99 we check for 0-len
-// before memcpy-ing. This isn't not really a performance issue in release mode
-// as it should just be optimised out (and gcc/clang with -O1 surely does)
-//
-// See
-// https://stackoverflow.com/questions/5243012/is-it-guaranteed-to-be-safe-to-perform-memcpy0-0-0
-string str_concat(Arena* const arena, const string a, const string b) {
-  assert(arena != NULL);
+void str_writer_free(StrWriter* const writer) {
+  assert(writer != NULL);
+  free(writer->buf);
+  writer->buf = NULL;
+  writer->cap = writer->len = writer->iovs_len = 0;
+}
+#endif  // SNIFEX_API_POSIX_IO
 
-  size_t new_len = a.len + b.len;
-  string buf = str_alloc(arena, new_len);
-  if (a.len != 0) { memcpy(buf.ptr, a.ptr, a.len); }
-  if (b.len != 0) { memcpy(buf.ptr + a.len, b.ptr, b.len); }
-  return buf;
+StrBuilder str_builder_create(const size_t init_cap) {
+  StrBuilder sb = {.cap = init_cap};
+  if (init_cap > 0) {
+    sb.buf = (char*)malloc(init_cap);
+    assert(sb.buf != NULL);
+  }
+  return sb;
 }
 
-string str_join(Arena* const arena, Vec(string) to_join) {
+StrBuilder str_builder_create_in(Arena* const arena, const size_t init_cap) {
   assert(arena != NULL);
+  StrBuilder sb = {.arena = arena};
+  str_builder_reserve(&sb, init_cap);
+  return sb;
+}
 
-  size_t new_len = 0;
-  for (size_t i = 0; i < to_join.len; i++) {
-#ifdef SNIFEX_API_GNU_EXTENSIONS
-    new_len += vec_idx(to_join, i)->len;
-#else
-    string* str;
-    vec_idx(str, string, to_join, i);
-    new_len += str->len;
-#endif
+bool str_builder_reserve(StrBuilder* const sb, const size_t additional) {
+  assert(sb != NULL);
+  const size_t needed = sb->len + additional;
+  if (needed <= sb->cap) { return true; }
+
+  size_t cap = sb->cap > 0 ? sb->cap * 2 : 16;
+  if (cap < needed) { cap = needed; }
+
+  if (sb->arena == NULL) {
+    char* const grown = (char*)realloc(sb->buf, cap);
+    assert(grown != NULL);
+    sb->buf = grown;
+    sb->cap = cap;
+    return true;
   }
-  string buf = str_alloc(arena, new_len);
 
-  char* dest = buf.ptr;
-  for (size_t i = 0; i < to_join.len; i++) {
-#ifdef SNIFEX_API_GNU_EXTENSIONS
-    string str = *vec_idx(to_join, i);
-#else
-    string* str_ptr;
-    vec_idx(str_ptr, string, to_join, i);
-    string str = *str_ptr;
-#endif
-    memcpy(dest, str.ptr, str.len);
-    dest += str.len;
+  // Bump the arena directly, so that the buffer stays contiguous with its top.
+  // Doubling stops at the end of the arena, only `needed` has to fit
+  Arena* const arena = sb->arena;
+  char* const top = arena->buf + arena->top;
+  const size_t free_space = arena->size - arena->top;
+  if (sb->buf != NULL && sb->buf + sb->cap == top) {
+    if (needed - sb->cap > free_space) { return false; }
+    if (cap - sb->cap > free_space) { cap = sb->cap + free_space; }
+    arena->top += cap - sb->cap;
+  } else {
+    if (needed > free_space) { return false; }
+    if (cap > free_space) { cap = free_space; }
+    if (sb->len > 0) { memcpy(top, sb->buf, sb->len); }
+    sb->buf = top;
+    arena->top += cap;
   }
-  return buf;
+  sb->cap = cap;
+  return true;
 }
 
-string str_fmt(Arena* const arena, const char* fmt, ...) {
-  assert(arena != NULL && fmt != NULL);
+bool str_builder_append(StrBuilder* const sb, const string str) {
+  assert(sb != NULL);
+  if (str.len == 0) { return true; }
+  if (!str_builder_reserve(sb, str.len)) { return false; }
+  memcpy(sb->buf + sb->len, str.ptr, str.len);
+  sb->len += str.len;
+  return true;
+}
 
-  va_list args;
-  va_start(args, fmt);
+// Bytes that can be written past the end of the string: the spare capacity,
+// and in an arena the free space after the buffer when it's the last
+// allocation, which the buffer can grow over in place
+static size_t snifex_api_builder_room(const StrBuilder* const sb) {
+  const Arena* const arena = sb->arena;
+  if (arena != NULL && sb->buf != NULL &&
+      sb->buf + sb->cap == arena->buf + arena->top) {
+    return sb->cap - sb->len + arena->size - arena->top;
+  }
+  return sb->cap - sb->len;
+}
 
-  va_list args_temp;
-  va_copy(args_temp, args);
-  size_t needed = vsnprintf(NULL, 0, fmt, args_temp);
-  va_end(args_temp);
+bool str_builder_append_vfmt(StrBuilder* const sb,
+                             const char* fmt,
+                             va_list args) {
+  assert(sb != NULL && fmt != NULL);
+
+  va_list retry;
+  va_copy(retry, args);
+  const size_t room = snifex_api_builder_room(sb);
+  const int written =
+      vsnprintf(room == 0 ? NULL : sb->buf + sb->len, room, fmt, args);
+  assert(written >= 0);
+  const size_t len = (size_t)written;
+
+  // `vsnprintf` also writes a terminator, which is not part of the string.
+  // Heap buffers get a byte for it, in an arena it goes in the free space
+  // past the buffer, so that only `len` bytes are taken from the arena
+  const bool formatted = len < room;
+  const size_t extra = !formatted && sb->arena == NULL ? 1 : 0;
+  if (!str_builder_reserve(sb, len + extra)) {
+    va_end(retry);
+    return false;
+  }
+  if (!formatted) {
+    char* const dest = sb->buf + sb->len;
+    if (snifex_api_builder_room(sb) > len) {
+      vsnprintf(dest, len + 1, fmt, retry);
+    } else {
+      // The string ends on the arena's last byte, leaving none for the
+      // terminator
+      char* const tmp = (char*)malloc(len + 1);
+      assert(tmp != NULL);
+      vsnprintf(tmp, len + 1, fmt, retry);
+      memcpy(dest, tmp, len);
+      free(tmp);
+    }
+  }
+  va_end(retry);
+  sb->len += len;
+  return true;
+}
 
-  char* const buf = (char*)malloc(needed + 1);
-  vsprintf(buf, fmt, args);
-  string str = str_copy(arena, strlit(buf));
-  memcpy(str.ptr, buf, needed);
+bool str_builder_append_fmt(StrBuilder* const sb, const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  const bool appended = str_builder_append_vfmt(sb, fmt, args);
   va_end(args);
-  free(buf);
-  return str;
+  return appended;
 }
 
-string str_slice(const string str, const size_t start, const size_t end) {
-  assert(start < str.len && end <= str.len && start <= end);
+bool str_builder_append_u64(StrBuilder* const sb, const uint64_t n) {
+  assert(sb != NULL);
+  char digits[20];
+  const size_t len = snifex_api_fmt_u64(digits, n);
+  return str_builder_append(sb, (string){.ptr = digits + 20 - len, .len = len});
+}
 
-  return (string){
-      .ptr = str.ptr + start,
-      .len = end - start,
-  };
+bool str_builder_append_i64(StrBuilder* const sb, const int64_t n) {
+  assert(sb != NULL);
+  // The sign goes in the same buffer, so that the number is appended whole
+  // or not at all
+  char digits[21];
+  // Negating in unsigned arithmetic, which is fine for INT64_MIN too
+  const uint64_t magnitude = n < 0 ? (uint64_t)0 - (uint64_t)n : (uint64_t)n;
+  size_t len = snifex_api_fmt_u64(digits + 1, magnitude);
+  if (n < 0) {
+    len++;
+    digits[21 - len] = '-';
+  }
+  return str_builder_append(sb, (string){.ptr = digits + 21 - len, .len = len});
 }
 
-string str_trim(const string str) {
-  size_t start = 0;
-  size_t end = str.len;
+bool str_builder_append_f64(StrBuilder* const sb, const double n) {
+  assert(sb != NULL);
+  char digits[32];
+  const size_t len = snifex_api_fmt_f64(digits, n);
+  return str_builder_append(sb, (string){.ptr = digits, .len = len});
+}
 
-  while (start < end && isspace(*str_idx(str, start))) { start++; }
-  if (start == end) { return (string){0}; }
-  while (end > start && isspace(*str_idx(str, end - 1))) { end--; }
+void str_builder_clear(StrBuilder* const sb) {
+  assert(sb != NULL);
+  sb->len = 0;
+}
 
-  return str_slice(str, start, end);
+void str_builder_free(StrBuilder* const sb) {
+  assert(sb != NULL);
+  if (sb->arena == NULL) {
+    free(sb->buf);
+    *sb = (StrBuilder){0};
+    return;
+  }
+  Arena* const arena = sb->arena;
+  if (sb->buf != NULL && sb->buf + sb->cap == arena->buf + arena->top) {
+    arena->top -= sb->cap - sb->len;
+  }
+  sb->cap = sb->len;
 }
 
 Bucket* snifex_api_find_bucket(Bucket* buckets,
@@ -1555,13 +10035,441 @@ uint64_t snifex_api_hash_num_func(const void* in, const size_t inlen) {
             (uint64_t)d << 32 | (uint64_t)e << 24 | (uint64_t)f << 16 |
             (uint64_t)g << 8 | (uint64_t)h);
   }
+  // FNV-1a on the remaining bytes. Rotating `ret` by 8 with ROTL (made for
+  // bytes) and adding then xoring the same byte hashed every key shorter than
+  // 8 bytes to the same value
   for (; i < inlen; i++) {
-    ret += v[i];
     ret ^= v[i];
-    ret = ROTL(ret, 8);
+    ret *= 0x100000001B3ull;
   }
   return ret;
 #undef ROTL
 }
 
+StrInterner str_interner_create(void) {
+  StrInterner interner = {.b_cap = 16};
+  interner.buckets = (Bucket*)calloc(interner.b_cap, sizeof(Bucket));
+  assert(interner.buckets != NULL);
+  return interner;
+}
+
+// Returns the bucket of `str`, or the empty bucket where it would go. Bucket
+// indices are IDs + 2, like in dictionaries
+static Bucket* snifex_api_interner_probe(const StrInterner* const interner,
+                                         const string str,
+                                         const uint64_t hash) {
+  size_t index = hash % interner->b_cap;
+  for (;;) {
+    Bucket* const b = &interner->buckets[index];
+    if (b->index == 0 ||
+        (b->hash == hash && str_eq(interner->strings[b->index - 2], str))) {
+      return b;
+    }
+    index = (index + 1) % interner->b_cap;
+  }
+}
+
+// Copies the bytes of `str` in the last arena, starting a new one when full.
+// Arenas are never reallocated, so the copies never move
+static char* snifex_api_interner_store(StrInterner* const interner,
+                                       const string str) {
+  if (str.len == 0) { return NULL; }
+  Arena* arena = interner->arenas_len > 0
+                     ? &interner->arenas[interner->arenas_len - 1]
+                     : NULL;
+  if (arena == NULL || arena->size - arena->top < str.len) {
+    Arena* const arenas = (Arena*)realloc(
+        interner->arenas, (interner->arenas_len + 1) * sizeof(Arena));
+    assert(arenas != NULL);
+    interner->arenas = arenas;
+    arena = &arenas[interner->arenas_len++];
+    arena_init(arena, str.len > SNIFEX_API_INTERNER_CHUNK
+                          ? str.len
+                          : SNIFEX_API_INTERNER_CHUNK);
+  }
+  char* const dest = arena->buf + arena->top;
+  memcpy(dest, str.ptr, str.len);
+  arena->top += str.len;
+  return dest;
+}
+
+uint32_t str_intern(StrInterner* const interner, const string str) {
+  assert(interner != NULL);
+  const uint64_t hash =
+      hash_num(str.ptr, str.len, interner->key[0], interner->key[1]);
+  Bucket* const b = snifex_api_interner_probe(interner, str, hash);
+  if (b->index > 1) { return (uint32_t)(b->index - 2); }
+
+  assert(interner->len < UINT32_MAX);
+  if (interner->len == interner->cap) {
+    interner->cap = interner->cap > 0 ? interner->cap * 2 : 16;
+    string* const strings = (string*)realloc(
+        interner->strings, interner->cap * sizeof(string));
+    assert(strings != NULL);
+    interner->strings = strings;
+  }
+  const uint32_t id = (uint32_t)interner->len++;
+  interner->strings[id] = (string){
+      .ptr = snifex_api_interner_store(interner, str),
+      .len = str.len,
+  };
+
+  b->hash = hash;
+  b->index = (size_t)id + 2;
+  if (++interner->b_len >= interner->b_cap * 0.75) {
+    snifex_api_dict_grow(&interner->buckets, &interner->b_cap,
+                         &interner->b_len);
+  }
+  return id;
+}
+
+bool str_interner_find(const StrInterner* const interner,
+                       const string str,
+                       uint32_t* const id) {
+  assert(interner != NULL && id != NULL);
+  const uint64_t hash =
+      hash_num(str.ptr, str.len, interner->key[0], interner->key[1]);
+  const Bucket* const b = snifex_api_interner_probe(interner, str, hash);
+  if (b->index == 0) { return false; }
+  *id = (uint32_t)(b->index - 2);
+  return true;
+}
+
+void str_interner_free(StrInterner* const interner) {
+  assert(interner != NULL);
+  for (size_t i = 0; i < interner->arenas_len; i++) {
+    arena_free(&interner->arenas[i]);
+  }
+  free(interner->arenas);
+  free(interner->strings);
+  free(interner->buckets);
+  *interner = (StrInterner){0};
+}
+
+struct sync_str_interner {
+  StrInterner interner;
+  SNIFEX_API_MUTEX lock;
+};
+
+SyncStrInterner* sync_str_interner_create(void) {
+  SyncStrInterner* const interner =
+      (SyncStrInterner*)malloc(sizeof(SyncStrInterner));
+  assert(interner != NULL);
+  interner->interner = str_interner_create();
+  snifex_api_mutex_init(&interner->lock);
+  return interner;
+}
+
+uint32_t sync_str_intern(SyncStrInterner* const interner, const string str) {
+  assert(interner != NULL);
+  snifex_api_mutex_lock(&interner->lock);
+  const uint32_t id = str_intern(&interner->interner, str);
+  snifex_api_mutex_unlock(&interner->lock);
+  return id;
+}
+
+bool sync_str_interner_find(SyncStrInterner* const interner,
+                            const string str,
+                            uint32_t* const id) {
+  assert(interner != NULL);
+  snifex_api_mutex_lock(&interner->lock);
+  const bool found = str_interner_find(&interner->interner, str, id);
+  snifex_api_mutex_unlock(&interner->lock);
+  return found;
+}
+
+// `strings` can be reallocated by a concurrent intern, the bytes never move
+string sync_str_interner_get(SyncStrInterner* const interner,
+                             const uint32_t id) {
+  assert(interner != NULL);
+  snifex_api_mutex_lock(&interner->lock);
+  const string str = str_interner_get(&interner->interner, id);
+  snifex_api_mutex_unlock(&interner->lock);
+  return str;
+}
+
+size_t sync_str_interner_len(SyncStrInterner* const interner) {
+  assert(interner != NULL);
+  snifex_api_mutex_lock(&interner->lock);
+  const size_t len = interner->interner.len;
+  snifex_api_mutex_unlock(&interner->lock);
+  return len;
+}
+
+void sync_str_interner_free(SyncStrInterner* const interner) {
+  if (interner == NULL) { return; }
+  str_interner_free(&interner->interner);
+  snifex_api_mutex_destroy(&interner->lock);
+  free(interner);
+}
+
+// Natural logarithm without libm: x = m * 2^e with m in [1, 2), then
+// ln(m) = 2 atanh((m - 1) / (m + 1))
+static double snifex_api_ln(double x) {
+  assert(x > 0);
+  int e = 0;
+  while (x >= 2) {
+    x /= 2;
+    e++;
+  }
+  while (x < 1) {
+    x *= 2;
+    e--;
+  }
+  const double y = (x - 1) / (x + 1);
+  const double y2 = y * y;
+  double term = y;
+  double sum = 0;
+  for (int i = 1; i < 40; i += 2) {
+    sum += term / i;
+    term *= y2;
+  }
+  return 2 * sum + e * 0.6931471805599453;
+}
+
+size_t bloom_bits_for(const size_t expected, const double fp_rate) {
+  assert(0 < fp_rate && fp_rate < 1);
+  const double ln2 = 0.6931471805599453;
+  const double bits =
+      -(double)expected * snifex_api_ln(fp_rate) / (ln2 * ln2);
+  const size_t rounded = (size_t)bits;
+  return rounded < bits ? rounded + 1 : rounded;
+}
+
+uint32_t bloom_hashes_for(const size_t expected, const size_t bits) {
+  if (expected == 0) { return 1; }
+  const double k = (double)bits / (double)expected * 0.6931471805599453 + 0.5;
+  if (k < 1) { return 1; }
+  return k > 16 ? 16 : (uint32_t)k;
+}
+
+// e^x for x <= 0, without libm: e^x = (e^(x / 2^m))^(2^m), with x / 2^m small
+// enough for a few terms of the series
+static double snifex_api_exp_neg(const double x) {
+  assert(x <= 0);
+  int m = 0;
+  double y = x;
+  while (y < -0.5) {
+    y /= 2;
+    m++;
+  }
+  double term = 1;
+  double sum = 1;
+  for (int i = 1; i < 20; i++) {
+    term *= y / i;
+    sum += term;
+  }
+  for (; m > 0; m--) { sum *= sum; }
+  return sum;
+}
+
+// False positive rate of a filter with `blocks` blocks of `slots` slots: the
+// keys in a block follow a Poisson distribution, and each block behaves like
+// a classic Bloom filter of `slots` slots
+static double snifex_api_blocked_fp(const size_t expected,
+                                    const size_t blocks,
+                                    const uint32_t k,
+                                    const size_t slots) {
+  const double lambda = (double)expected / (double)blocks;
+  double miss_one = 1;  // (1 - 1/slots)^k, chance a key misses a given slot
+  for (uint32_t j = 0; j < k; j++) { miss_one *= 1 - 1.0 / (double)slots; }
+
+  double prob = snifex_api_exp_neg(-lambda);  // Of `i` keys in the block
+  double miss = 1;                            // miss_one^i
+  double fp = 0;
+  const double last = lambda + 10 * (lambda + 1);
+  for (size_t i = 0; i <= last; i++) {
+    double fp_block = 1;
+    for (uint32_t j = 0; j < k; j++) { fp_block *= 1 - miss; }
+    fp += prob * fp_block;
+    prob *= lambda / (double)(i + 1);
+    miss *= miss_one;
+  }
+  return fp;
+}
+
+// Blocking makes the false positive rate worse than the classic formula
+// says, the worse the smaller the blocks: grow the filter until it's right
+static size_t snifex_api_blocked_size(const size_t expected,
+                                      const double fp_rate,
+                                      const size_t slots) {
+  size_t size = bloom_bits_for(expected, fp_rate);
+  if (expected == 0) { return size; }
+  for (;;) {
+    const size_t blocks = size > 0 ? (size - 1) / slots + 1 : 1;
+    const uint32_t k = bloom_hashes_for(expected, blocks * slots);
+    if (snifex_api_blocked_fp(expected, blocks, k, slots) <= fp_rate) {
+      return blocks * slots;
+    }
+    size = blocks * slots + blocks * slots / 16 + slots;
+  }
+}
+
+// Murmur3 finalizer: the hashing hook may be weak, the block and the slots
+// need well spread bits
+static inline uint64_t snifex_api_bloom_mix(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDull;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ull;
+  x ^= x >> 33;
+  return x;
+}
+
+// Maps `h` to [0, n) with a multiplication instead of a division
+static inline size_t snifex_api_bloom_block(const uint64_t h, const size_t n) {
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef unsigned __int128 snifex_api_u128;
+  return (size_t)(((snifex_api_u128)h * n) >> 64);
+#else
+  return (size_t)(h % n);
+#endif
+}
+
+// Double hashing: the first hash picks the block, the second one is sliced
+// into the slots in it
+#define SNIFEX_API_BLOOM_HASHES(bf, hash, block, h2)                      \
+  const uint64_t block##_h = snifex_api_bloom_mix((hash) ^ (bf)->key[0]); \
+  const size_t block = snifex_api_bloom_block(block##_h, (bf)->n_blocks); \
+  uint64_t h2 =                                                           \
+      snifex_api_bloom_mix((hash) ^ (bf)->key[1] ^ 0x9E3779B97F4A7C15ull)
+
+// Slot of probe `i`, `bits` bits at a time out of `*h2`. Linear combinations
+// like `h2 + i * step` repeat slots within a small block, so once the bits
+// run out `*h2` is mixed again instead
+static inline size_t snifex_api_bloom_slot(uint64_t* const h2,
+                                           const uint32_t i,
+                                           const unsigned bits) {
+  if (i > 0 && i % (64 / bits) == 0) { *h2 = snifex_api_bloom_mix(*h2); }
+  const size_t slot = (size_t)(*h2 & (((uint64_t)1 << bits) - 1));
+  // Rotating instead of shifting keeps all the bits for the next mix
+  *h2 = (*h2 >> bits) | (*h2 << (64 - bits));
+  return slot;
+}
+
+static void* snifex_api_bloom_alloc(const size_t size, void** buf) {
+  *buf = calloc(1, size + SNIFEX_API_CACHE_LINE);
+  assert(*buf != NULL);
+  const uintptr_t addr = (uintptr_t)*buf;
+  return (void*)((addr + SNIFEX_API_CACHE_LINE - 1) &
+                 ~(uintptr_t)(SNIFEX_API_CACHE_LINE - 1));
+}
+
+BloomFilter bloom_create(const size_t bits, const uint32_t n_hashes) {
+  assert(n_hashes > 0);
+  BloomFilter bf = {.n_hashes = n_hashes, .key = {0, 0}};
+  bf.n_blocks = bits > 0 ? (bits + 511) / 512 : 1;
+  bf.words = snifex_api_bloom_alloc(bf.n_blocks * 64, &bf.buf);
+  return bf;
+}
+
+BloomFilter bloom_create_for(const size_t expected, const double fp_rate) {
+  const size_t bits = snifex_api_blocked_size(expected, fp_rate, 512);
+  return bloom_create(bits, bloom_hashes_for(expected, bits));
+}
+
+void bloom_add_hash(BloomFilter* const bf, const uint64_t hash) {
+  assert(bf != NULL);
+  SNIFEX_API_BLOOM_HASHES(bf, hash, block, h2);
+  uint64_t* const words = bf->words + block * 8;
+  for (uint32_t i = 0; i < bf->n_hashes; i++) {
+    const size_t slot = snifex_api_bloom_slot(&h2, i, 9);
+    words[slot >> 6] |= (uint64_t)1 << (slot & 63);
+  }
+}
+
+bool bloom_contains_hash(const BloomFilter* const bf, const uint64_t hash) {
+  assert(bf != NULL);
+  SNIFEX_API_BLOOM_HASHES(bf, hash, block, h2);
+  const uint64_t* const words = bf->words + block * 8;
+  // Building the mask of the block first leaves a single branch
+  uint64_t mask[8] = {0};
+  for (uint32_t i = 0; i < bf->n_hashes; i++) {
+    const size_t slot = snifex_api_bloom_slot(&h2, i, 9);
+    mask[slot >> 6] |= (uint64_t)1 << (slot & 63);
+  }
+  uint64_t missing = 0;
+  for (size_t w = 0; w < 8; w++) { missing |= mask[w] & ~words[w]; }
+  return missing == 0;
+}
+
+void bloom_clear(BloomFilter* const bf) {
+  assert(bf != NULL);
+  memset(bf->words, 0, bf->n_blocks * 64);
+}
+
+void bloom_free(BloomFilter* const bf) {
+  assert(bf != NULL);
+  free(bf->buf);
+  *bf = (BloomFilter){0};
+}
+
+CountingBloomFilter cbloom_create(const size_t counters,
+                                  const uint32_t n_hashes) {
+  assert(n_hashes > 0);
+  CountingBloomFilter bf = {.n_hashes = n_hashes, .key = {0, 0}};
+  bf.n_blocks = counters > 0 ? (counters + 127) / 128 : 1;
+  bf.counters = snifex_api_bloom_alloc(bf.n_blocks * 64, &bf.buf);
+  return bf;
+}
+
+CountingBloomFilter cbloom_create_for(const size_t expected,
+                                      const double fp_rate) {
+  const size_t counters = snifex_api_blocked_size(expected, fp_rate, 128);
+  return cbloom_create(counters, bloom_hashes_for(expected, counters));
+}
+
+// Slot i of a block is the low nibble of byte i / 2 when i is even, the high
+// one when it's odd
+#define SNIFEX_API_CBLOOM_SLOT(counters, h2, i, byte, shift)       \
+  const size_t byte##_slot = snifex_api_bloom_slot(&(h2), (i), 7); \
+  uint8_t* const byte = (uint8_t*)&(counters)[byte##_slot >> 1];   \
+  const unsigned shift = (unsigned)(byte##_slot & 1) * 4
+
+void cbloom_add_hash(CountingBloomFilter* const bf, const uint64_t hash) {
+  assert(bf != NULL);
+  SNIFEX_API_BLOOM_HASHES(bf, hash, block, h2);
+  uint8_t* const counters = bf->counters + block * 64;
+  for (uint32_t i = 0; i < bf->n_hashes; i++) {
+    SNIFEX_API_CBLOOM_SLOT(counters, h2, i, byte, shift);
+    if (((*byte >> shift) & 0xF) != 0xF) { *byte += (uint8_t)(1u << shift); }
+  }
+}
+
+void cbloom_remove_hash(CountingBloomFilter* const bf, const uint64_t hash) {
+  assert(bf != NULL);
+  assert(cbloom_contains_hash(bf, hash));
+  SNIFEX_API_BLOOM_HASHES(bf, hash, block, h2);
+  uint8_t* const counters = bf->counters + block * 64;
+  for (uint32_t i = 0; i < bf->n_hashes; i++) {
+    SNIFEX_API_CBLOOM_SLOT(counters, h2, i, byte, shift);
+    // A saturated counter lost track of how many keys it counts
+    if (((*byte >> shift) & 0xF) != 0xF) { *byte -= (uint8_t)(1u << shift); }
+  }
+}
+
+bool cbloom_contains_hash(const CountingBloomFilter* const bf,
+                          const uint64_t hash) {
+  assert(bf != NULL);
+  SNIFEX_API_BLOOM_HASHES(bf, hash, block, h2);
+  uint8_t* const counters = bf->counters + block * 64;
+  bool found = true;
+  for (uint32_t i = 0; i < bf->n_hashes; i++) {
+    SNIFEX_API_CBLOOM_SLOT(counters, h2, i, byte, shift);
+    found &= ((*byte >> shift) & 0xF) != 0;
+  }
+  return found;
+}
+
+void cbloom_clear(CountingBloomFilter* const bf) {
+  assert(bf != NULL);
+  memset(bf->counters, 0, bf->n_blocks * 64);
+}
+
+void cbloom_free(CountingBloomFilter* const bf) {
+  assert(bf != NULL);
+  free(bf->buf);
+  *bf = (CountingBloomFilter){0};
+}
+
 #endif  // SNIFEX_API_IMPLEMENTATION